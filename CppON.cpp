@@ -18,7 +18,7 @@
  *              when the code loses scope and also when the hierarchy is destroyed resulting in a crash.
  *
  *              The root of most "trees" is usually one of the two "container" classes: the Map object or an Array.  Usually an Map.
- *              A Map represents a hashmap and is actual implemented as an extension of a std::map< std::string, CppON *> container.  It is
+ *              A Map represents a hashmap and is actual implemented as an insertion ordered vector of std::pair< std::string, CppON *>.  It is
  *              represented as a map in JSON and TNetStrings as well as an object in JavaScript.  In fact the method value() returns a pointer
  *              to the internal map.  Care should be used not to modify the contents returned from this function.
  *              An Array represents a dynamic list of objects and is implement as extension of a std::vector< CppON *> container internally. Like
@@ -113,14 +113,18 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <unordered_map>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/shm.h>
 #include <sys/mman.h>
 #include <string>
 #include <vector>
-
-#define DIRECTORY_BIT 0x4000
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -171,6 +175,13 @@ CppON::CppON( CppONType type )
     siz = 0;
     data = NULL;
     precision = -1;
+    inArena = false;
+    flags = 0;
+    edits = 0;
+    hashValue = 0;
+    parent = NULL;
+    shared = NULL;
+    retired = NULL;
 }
 
 // cppcheck-suppress constParameter
@@ -178,6 +189,13 @@ CppON::CppON( CppON *jt )
 {
     siz = jt->siz;
     data = NULL;
+    inArena = false;
+    flags = 0;
+    edits = 0;
+    hashValue = 0;
+    parent = NULL;
+    shared = NULL;
+    retired = NULL;
     precision = jt->precision;
     switch ( typ = jt->typ )
     {
@@ -208,6 +226,13 @@ CppON::CppON( CppON &jt )
 {
     siz = jt.siz;
     data = NULL;
+    inArena = false;
+    flags = 0;
+    edits = 0;
+    hashValue = 0;
+    parent = NULL;
+    shared = NULL;
+    retired = NULL;
     precision = jt.precision;
     CppON *ptr = &jt;
 
@@ -236,6 +261,355 @@ CppON::CppON( CppON &jt )
     }
 }
 
+
+/*
+ * Data a node let go of in unshare().  Other threads reading the node may still be in it, so the node keeps its hold on
+ * it until it is destroyed.
+ */
+struct CppONRetired
+{
+    void            *data;
+    int             *shared;
+    CppONRetired    *next;
+};
+
+/*
+ * Taken by share() on the node shared from, and by unshare() and markExposed() on their own node, never two at once
+ */
+static std::mutex    shareLocks[ 64 ];
+
+static std::mutex &shareLock( const CppON *n )
+{
+    // cppcheck-suppress cstyleCast
+    return shareLocks[ ( (uintptr_t) n >> 6 ) % ( sizeof( shareLocks ) / sizeof( shareLocks[ 0 ] ) ) ];
+}
+
+/*
+ * Copy on write.  Copying a COMap or COArray (the copy constructors, operator=, factory()) gives the copy new nodes for
+ * its members, see copyMembers(), but a map or array member is a new node pointing at the same data as the original
+ * member, "shared" counting the nodes holding it.  The first call through any of them that could change the data or hand
+ * out a member (append, findElement, at, begin, value ...) calls unshare(), which gives that node data of its own made
+ * the same way.  So a copy costs a node per member and changing a member deep in it copies just the maps and arrays on
+ * the way down.  Walks that only read (the writers, hash(), diff(), ==) use the data as it is, through peek() as another
+ * thread's unshare() may swap it, see doUnshare().  A map or array that has handed out or taken in a member is marked
+ * exposed and is copied through rather than shared, as pointers into it may be held.  Data in a CppONArena is never
+ * shared.
+ */
+bool CppON::share( CppON &from )
+{
+    int     *c;
+    void    *d;
+
+    if( from.inArena || typ != from.typ || ( MAP_CPPON_OBJ_TYPE != typ && ARRAY_CPPON_OBJ_TYPE != typ ) )
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock( shareLock( &from ) );
+    if( ! ( d = from.data ) || ( CPPON_NODE_EXPOSED & __atomic_load_n( &from.flags, __ATOMIC_ACQUIRE ) ) )
+    {
+        return false;
+    }
+    if( ! ( c = from.shared ) )
+    {
+        c = new int( 1 );
+        __atomic_store_n( &from.shared, c, __ATOMIC_RELEASE );
+        from.changed();                                         // paths cached into "from" would lead into shared members
+    }
+    __atomic_add_fetch( c, 1, __ATOMIC_ACQ_REL );
+    data = d;
+    shared = c;
+    siz = from.siz;
+    if( from.hashed() )
+    {
+        hashValue = __atomic_load_n( &from.hashValue, __ATOMIC_RELAXED );
+        __atomic_or_fetch( &flags, CPPON_NODE_HASHED, __ATOMIC_RELEASE );
+    }
+    return true;
+}
+
+/*
+ * expose() the first time.  Under the lock share() takes, so a copy made at the same time either shares the data before
+ * this and the unshare() that follows sees it, or sees the mark and copies through.
+ */
+void CppON::markExposed()
+{
+    std::lock_guard<std::mutex> lock( shareLock( this ) );
+    __atomic_or_fetch( &flags, CPPON_NODE_EXPOSED, __ATOMIC_RELEASE );
+}
+
+/*
+ * Drop this node's hold on shared data.  True when nobody else holds it, the caller then frees the data as usual.
+ */
+bool CppON::release()
+{
+    if( shared )
+    {
+        if( 0 < __atomic_sub_fetch( shared, 1, __ATOMIC_ACQ_REL ) )
+        {
+            shared = NULL;
+            data = NULL;
+            changed();
+            return false;
+        }
+        delete shared;
+        shared = NULL;
+    }
+    return true;
+}
+
+/*
+ * A copy of a member for a new level: a leaf is copied, a map or array is a new node sharing the member's data unless the
+ * member is exposed (it has handed out or taken in members, so pointers into it may be held), then it is copied through.
+ * The member's hash comes along so a hashed owner never holds an unhashed member.
+ */
+CppON *CppON::copyMember( CppON *m, CppON *owner )
+{
+    CppON *c = NULL;
+
+    if( m )
+    {
+        if( MAP_CPPON_OBJ_TYPE == m->typ )
+        {
+            c = new COMap();
+        } else if( ARRAY_CPPON_OBJ_TYPE == m->typ )
+        {
+            c = new COArray();
+        }
+        if( c )
+        {
+            c->deleteData();
+            if( ! c->share( *m ) )
+            {
+                delete c;
+                c = NULL;
+            }
+        }
+    }
+    if( ! c && m )
+    {
+        c = factory( *m );
+    }
+    if( c )
+    {
+        if( m->hashed() )
+        {
+            c->hashValue = __atomic_load_n( &m->hashValue, __ATOMIC_RELAXED );
+            c->flags |= CPPON_NODE_HASHED;
+        }
+        c->parent = owner;
+    }
+    return c;
+}
+
+/*
+ * A map's or array's data holding copyMember()s of the members of "from", for this node to own
+ */
+void *CppON::copyData( void *from )
+{
+    if( MAP_CPPON_OBJ_TYPE == typ )
+    {
+        COMapData *m = new COMapData( *( (COMapData *) from ) );    // keys and index as they are
+        for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+        {
+            it->second = copyMember( it->second, this );
+        }
+        return m;
+    }
+    vector<CppON *> *v = new vector<CppON *>( *( (vector<CppON *> *) from ) );
+    for( size_t i = 0; v->size() > i; i++ )
+    {
+        (*v)[ i ] = copyMember( (*v)[ i ], this );
+    }
+    return v;
+}
+
+/*
+ * What the copy constructors and operator= of COMap and COArray do, false when "from" can't be copied this way and the
+ * caller copies it member by member.  The copy gets a level of its own: new nodes for every member (see copyMember()),
+ * so a pointer into "from" taken before the copy never leads into the copy, while the maps and arrays below share their
+ * data until one side changes it.  A copy costs a node per member rather than the whole tree.
+ */
+bool CppON::copyMembers( CppON &from )
+{
+    void    *d = from.peek();
+
+    if( from.inArena || ! d || typ != from.typ || ( MAP_CPPON_OBJ_TYPE != typ && ARRAY_CPPON_OBJ_TYPE != typ ) )
+    {
+        return false;
+    }
+    data = copyData( d );
+    siz = from.siz;
+    flags |= CPPON_NODE_ADOPTED;
+    if( from.hashed() )
+    {
+        hashValue = __atomic_load_n( &from.hashValue, __ATOMIC_RELAXED );
+        flags |= CPPON_NODE_HASHED;
+    }
+    return true;
+}
+
+/*
+ * unshare() when the data is shared.  Any number of threads reading the node may get here at once: the new data is built
+ * with no lock held and published in one store, the first to publish wins and the others throw their copy away.  The old
+ * data is retired rather than let go, a thread that read the pointer before the store may still be walking it.
+ */
+void CppON::doUnshare()
+{
+    std::mutex  &lock = shareLock( this );
+    int         *c;
+    void        *mine;
+
+    lock.lock();
+    if( ( c = shared ) && 1 == __atomic_load_n( c, __ATOMIC_ACQUIRE ) )   // the others have let go
+    {
+        delete c;
+        c = NULL;
+        adopt();                                                    // the members' parent may be a holder that is gone
+        __atomic_store_n( &shared, c, __ATOMIC_RELEASE );
+    }
+    lock.unlock();
+    if( ! c )
+    {
+        return;
+    }
+    mine = copyData( peek() );
+    lock.lock();
+    if( c == shared )
+    {
+        CppONRetired *r = new CppONRetired;
+        r->data = data;
+        r->shared = c;
+        r->next = retired;
+        retired = r;
+        __atomic_or_fetch( &flags, CPPON_NODE_ADOPTED, __ATOMIC_RELAXED );
+        __atomic_store_n( &data, mine, __ATOMIC_RELEASE );
+        __atomic_store_n( &shared, (int *) NULL, __ATOMIC_RELEASE );
+        mine = NULL;
+    }
+    lock.unlock();
+    if( mine )
+    {
+        freeData( mine );                                           // another thread published first
+    } else {
+        changed();
+    }
+}
+
+/*
+ * Free a map's or array's data that no node holds, members and all
+ */
+void CppON::freeData( void *d )
+{
+    if( MAP_CPPON_OBJ_TYPE == typ )
+    {
+        COMapData *m = (COMapData *) d;
+        for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+        {
+            delete it->second;
+        }
+        m->clear();
+        delete m;
+    } else {
+        vector<CppON *> *v = (vector<CppON *> *) d;
+        for( size_t i = 0; v->size() > i; i++ )
+        {
+            delete (*v)[ i ];
+        }
+        delete v;
+        changed();
+    }
+}
+
+/*
+ * Let go of the data unshare() retired, freeing what nobody else holds
+ */
+void CppON::dropRetired()
+{
+    while( retired )
+    {
+        CppONRetired *r = retired;
+        retired = r->next;
+        if( 0 == __atomic_sub_fetch( r->shared, 1, __ATOMIC_ACQ_REL ) )
+        {
+            delete r->shared;
+            freeData( r->data );
+        }
+        delete r;
+    }
+}
+
+/*
+ * The move constructors and move assignments of COString, COMap and COArray.  The payload (and any share of it) changes
+ * hands and "from" is left empty but usable.  A payload in a CppONArena can't change hands, its contents are moved into
+ * a fresh one instead.
+ */
+void CppON::take( CppON &from )
+{
+    bool    adopted = ( 0 != ( from.flags & CPPON_NODE_ADOPTED ) );
+
+    if( from.hashed() )
+    {
+        hashValue = from.hashValue;
+        flags |= CPPON_NODE_HASHED;
+    }
+    flags |= from.flags & CPPON_NODE_EXPOSED;                   // pointers into the payload may be held
+    from.touch();
+    from.flags &= (unsigned char) ~CPPON_NODE_ADOPTED;
+    siz = from.siz;
+    precision = from.precision;
+    switch( typ )
+    {
+        case STRING_CPPON_OBJ_TYPE:
+            if( from.inArena )
+            {
+                data = ( from.data ) ? new std::string( std::move( *( (std::string *) from.data ) ) ) : NULL;
+            } else {
+                data = from.data;
+                from.data = NULL;
+            }
+            break;
+
+        case MAP_CPPON_OBJ_TYPE:
+            if( from.inArena )
+            {
+                data = new COMapData();
+                ( (COMapData *) data )->swap( *( (COMapData *) from.data ) );
+            } else {
+                data = from.data;
+                shared = from.shared;
+                from.data = new COMapData();
+                from.shared = NULL;
+            }
+            break;
+
+        case ARRAY_CPPON_OBJ_TYPE:
+            if( from.inArena )
+            {
+                data = new vector<CppON *>();
+                ( (vector<CppON *> *) data )->swap( *( (vector<CppON *> *) from.data ) );
+            } else {
+                data = from.data;
+                shared = from.shared;
+                from.data = new vector<CppON *>();
+                from.shared = NULL;
+            }
+            from.siz = 0;
+            break;
+
+        default:
+            break;
+    }
+    if( adopted )
+    {
+        adopt();                                                // the members' parent was "from"
+    }
+    changed();                                                  // paths cached into either lead elsewhere now
+    from.changed();
+}
+
+/*
+ * Payloads that came from a CppONArena are only destroyed, the arena owns their memory.
+ */
 void CppON::deleteData()
 {
     if( data )
@@ -243,7 +617,7 @@ void CppON::deleteData()
         switch( typ )
         {
             case INTEGER_CPPON_OBJ_TYPE:
-                switch( siz )
+                switch( ( inArena ) ? 0 : siz )
                 {
                     case 1:
                         delete( (char *) data );
@@ -266,43 +640,73 @@ void CppON::deleteData()
                 }
                 break;
             case DOUBLE_CPPON_OBJ_TYPE:
-                delete( (double *) data );
+                if( ! inArena )
+                {
+                    delete( (double *) data );
+                }
                 break;
             case BOOLEAN_CPPON_OBJ_TYPE:
-                delete( (bool *) data );
+                if( ! inArena )
+                {
+                    delete( (bool *) data );
+                }
                 break;
             case NULL_CPPON_OBJ_TYPE:
                 break;
             case STRING_CPPON_OBJ_TYPE:
-                delete (std::string *) data;
+                if( inArena )
+                {
+                    ( (std::string *) data )->~basic_string();
+                } else {
+                    delete (std::string *) data;
+                }
                 break;
             case MAP_CPPON_OBJ_TYPE:
+                if( release() )
                 {
-                    map <string, CppON*> *m = ( map <string, CppON *> * ) data;
-                    map<string, CppON *>::iterator it;
+                    COMapData *m = ( COMapData * ) data;
+                    COMapData::iterator it;
                     // cppcheck-suppress postfixOperator
                     for( it = m->begin(); m->end() != it; it++ )
                     {
                         delete( it->second);
                     }
                     m->clear();
-                    delete ( m );
+                    changed();                                      // tells paths cached through this node
+                    if( inArena )
+                    {
+                        m->~COMapData();
+                    } else {
+                        delete ( m );
+                    }
                 }
                 break;
             case ARRAY_CPPON_OBJ_TYPE:
+                if( release() )
                 {
                     vector <CppON *> *v = ( vector<CppON *> * ) data;
                     for(unsigned int i = 0; v->size() > i; i++ )
                     {
                         delete( v->at( i ) );
                     }
-                    delete ( v );
+                    changed();
+                    if( inArena )
+                    {
+                        v->~vector();
+                    } else {
+                        delete ( v );
+                    }
                 }
                 break;
             default:
                 break;
         }
         data = NULL;
+        inArena = false;
+    }
+    if( retired )
+    {
+        dropRetired();
     }
     order.clear();
 }
@@ -362,65 +766,236 @@ bool CppON::operator == ( CppON &obj )
     return rtn;
 }
 
-CppON *CppON::guessDataType( const char *str )
-{
-    CppON      *rtn = NULL;
-    CppONType   _eType = NULL_CPPON_OBJ_TYPE;
+/*
+ * Structural hash of the tree under this node.  Two trees that compare equal with == always hash alike, map members are
+ * combined without regard to order (as == compares them by key) and array members in order.  Integers hash by the
+ * value == compares, so a short 5 and a long long 5 agree, and 0.0 and -0.0 agree.
+ *
+ * Every node keeps the value it last computed and hands it back until the node or something under it changes, so hashing
+ * a tree a second time, or hashing a tree that holds subtrees hashed earlier, touches only what has changed since.  A
+ * container's hash() makes itself the parent of each member it takes in and changing a node (any setter or container
+ * method, see touch()) drops the cached hash of the node and of its parents up to the first that has none.  As a hashed
+ * node only holds hashed members the walk stops early and nodes that were never hashed, like a tree still being parsed,
+ * change for free.  Changes made through a leaf's value() or getData() are not seen.
+ */
+static inline uint64_t hashMix( uint64_t h )
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
 
-    if( str && *str )
+static inline uint64_t hashBytes( const char *s, size_t len )
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for( size_t i = 0; len > i; i++ )
     {
-        if( !strcasecmp( str, "true" ) || !strcasecmp( str, "false" ) )    // If it is true or false its boolean
-        {
-            _eType = BOOLEAN_CPPON_OBJ_TYPE;
-        } else {
-            char  _ch;
-
-            _eType = INTEGER_CPPON_OBJ_TYPE;                                 // Assume integer
-            for( int i = 0; (_ch = str[ i ]); i++ )                         // Check each character
-            {
-                if( '.' == _ch )                                            // If we have a decimal point it may be double
-                {
-                    if( DOUBLE_CPPON_OBJ_TYPE == _eType )                    // Two decimal points means it can't be double
-                    {
-                        _eType = STRING_CPPON_OBJ_TYPE;                      // String is default
-                        break;
-                    }
-                    _eType = DOUBLE_CPPON_OBJ_TYPE;
-                } else if( '0' > _ch || '9' < _ch ) {                       // Any character that isn't a number or decimal
-                    _eType = STRING_CPPON_OBJ_TYPE;                          // means string;
-                    break;
-                }
-            }
-        }
+        h = ( h ^ (uint8_t) s[ i ] ) * 0x100000001B3ULL;
     }
+    return hashMix( h ^ len );
+}
 
-    switch( _eType )
+uint64_t CppON::hash()
+{
+    uint64_t    h;
+    void        *d;
+    bool        own = ! __atomic_load_n( &shared, __ATOMIC_ACQUIRE );  // members of shared data keep the parent they have
+
+    if( hashed() )
+    {
+        return __atomic_load_n( &hashValue, __ATOMIC_RELAXED );
+    }
+    h = (uint64_t) typ * 0x9E3779B97F4A7C15ULL;
+    switch( typ )
     {
         case INTEGER_CPPON_OBJ_TYPE:
-            rtn = new COInteger( (uint64_t) strtoll( str, NULL, 10 ) );
+            if( data )
+            {
+                // cppcheck-suppress cstyleCast
+                long long v = ( siz == sizeof( long long ) ) ? *( (long long *) data ) : ( siz == sizeof( int ) ) ? *( (int *) data ) :
+                              ( siz == sizeof( short ) ) ? *( (short *) data ) : *( (char *) data );
+                h = hashMix( h ^ (uint64_t) v );
+            }
             break;
 
         case DOUBLE_CPPON_OBJ_TYPE:
-            rtn = new CODouble( strtod( str, NULL ) ) ;
+            if( data )
+            {
+                double      d = *( (double *) data );
+                uint64_t    b = 0;
+                if( 0.0 != d )
+                {
+                    memcpy( &b, &d, sizeof( b ) );
+                }
+                h = hashMix( h ^ b );
+            }
             break;
 
-        case BOOLEAN_CPPON_OBJ_TYPE:
-            rtn = new COBoolean( 0 == strcasecmp( str, "true" ) );
+        case STRING_CPPON_OBJ_TYPE:
+            if( data )
+            {
+                // cppcheck-suppress cstyleCast
+                const char *cPtr = ( (std::string *) data )->c_str();
+                h ^= hashBytes( cPtr, strlen( cPtr ) );                         // == compares up to the first NUL
+            }
             break;
 
-        case STRING_CPPON_OBJ_TYPE:
-            rtn = new COString( str );
+        case BOOLEAN_CPPON_OBJ_TYPE:
+            // cppcheck-suppress cstyleCast
+            h = hashMix( h ^ ( ( data && *( (bool *) data ) ) ? 1 : 2 ) );
             break;
 
         case MAP_CPPON_OBJ_TYPE:
-            rtn = new COMap();
+            if( ( d = peek() ) )
+            {
+                uint64_t    sum = 0;
+                // cppcheck-suppress cstyleCast
+                COMapData   *m = (COMapData *) d;
+                for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+                {
+                    uint64_t v = 0;
+                    if( it->second )
+                    {
+                        v = it->second->hash();
+                        if( own )
+                        {
+                            __atomic_store_n( &it->second->parent, this, __ATOMIC_RELAXED );
+                        }
+                    }
+                    sum += hashMix( hashBytes( it->first.data(), it->first.size() ) + v );
+                }
+                h = hashMix( h ^ sum ^ m->size() );
+            }
             break;
 
         case ARRAY_CPPON_OBJ_TYPE:
-            rtn = new COArray();
-            break;
-
-        default:
+            if( ( d = peek() ) )
+            {
+                // cppcheck-suppress cstyleCast
+                std::vector<CppON *> *v = (std::vector<CppON *> *) d;
+                for( size_t i = 0; v->size() > i; i++ )
+                {
+                    CppON *e = (*v)[ i ];
+                    h = hashMix( h + ( ( e ) ? e->hash() : 0 ) );
+                    if( e && own )
+                    {
+                        __atomic_store_n( &e->parent, this, __ATOMIC_RELAXED );
+                    }
+                }
+                h = hashMix( h ^ v->size() );
+            }
+            break;
+
+        default:
+            break;
+    }
+    __atomic_store_n( &hashValue, h, __ATOMIC_RELAXED );
+    __atomic_or_fetch( &flags, ( own && ( MAP_CPPON_OBJ_TYPE == typ || ARRAY_CPPON_OBJ_TYPE == typ ) ) ?
+                        CPPON_NODE_HASHED | CPPON_NODE_ADOPTED : CPPON_NODE_HASHED, __ATOMIC_RELEASE );
+    return h;
+}
+
+/*
+ * touch() on a hashed node.  Its parents up to the first without a hash lose theirs too.
+ */
+void CppON::dropHash()
+{
+    for( CppON *n = this; n && ( CPPON_NODE_HASHED & __atomic_load_n( &n->flags, __ATOMIC_ACQUIRE ) ); n = __atomic_load_n( &n->parent, __ATOMIC_RELAXED ) )
+    {
+        __atomic_and_fetch( &n->flags, (unsigned char) ~CPPON_NODE_HASHED, __ATOMIC_RELEASE );
+    }
+}
+
+/*
+ * Point the members' parent at this node.  For members that just moved here from another node, which may not outlive them.
+ */
+void CppON::adopt()
+{
+    if( MAP_CPPON_OBJ_TYPE == typ && data )
+    {
+        COMapData *m = (COMapData *) data;
+        for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+        {
+            if( it->second )
+            {
+                __atomic_store_n( &it->second->parent, this, __ATOMIC_RELAXED );
+            }
+        }
+    } else if( ARRAY_CPPON_OBJ_TYPE == typ && data ) {
+        std::vector<CppON *> *v = (std::vector<CppON *> *) data;
+        for( size_t i = 0; v->size() > i; i++ )
+        {
+            if( (*v)[ i ] )
+            {
+                __atomic_store_n( &(*v)[ i ]->parent, this, __ATOMIC_RELAXED );
+            }
+        }
+    }
+    __atomic_or_fetch( &flags, CPPON_NODE_ADOPTED, __ATOMIC_RELAXED );
+}
+
+CppON *CppON::guessDataType( const char *str )
+{
+    CppON      *rtn = NULL;
+    CppONType   _eType = NULL_CPPON_OBJ_TYPE;
+
+    if( str && *str )
+    {
+        if( !strcasecmp( str, "true" ) || !strcasecmp( str, "false" ) )    // If it is true or false its boolean
+        {
+            _eType = BOOLEAN_CPPON_OBJ_TYPE;
+        } else {
+            char  _ch;
+
+            _eType = INTEGER_CPPON_OBJ_TYPE;                                 // Assume integer
+            for( int i = 0; (_ch = str[ i ]); i++ )                         // Check each character
+            {
+                if( '.' == _ch )                                            // If we have a decimal point it may be double
+                {
+                    if( DOUBLE_CPPON_OBJ_TYPE == _eType )                    // Two decimal points means it can't be double
+                    {
+                        _eType = STRING_CPPON_OBJ_TYPE;                      // String is default
+                        break;
+                    }
+                    _eType = DOUBLE_CPPON_OBJ_TYPE;
+                } else if( '0' > _ch || '9' < _ch ) {                       // Any character that isn't a number or decimal
+                    _eType = STRING_CPPON_OBJ_TYPE;                          // means string;
+                    break;
+                }
+            }
+        }
+    }
+
+    switch( _eType )
+    {
+        case INTEGER_CPPON_OBJ_TYPE:
+            rtn = new COInteger( (uint64_t) strtoll( str, NULL, 10 ) );
+            break;
+
+        case DOUBLE_CPPON_OBJ_TYPE:
+            rtn = new CODouble( strtod( str, NULL ) ) ;
+            break;
+
+        case BOOLEAN_CPPON_OBJ_TYPE:
+            rtn = new COBoolean( 0 == strcasecmp( str, "true" ) );
+            break;
+
+        case STRING_CPPON_OBJ_TYPE:
+            rtn = new COString( str );
+            break;
+
+        case MAP_CPPON_OBJ_TYPE:
+            rtn = new COMap();
+            break;
+
+        case ARRAY_CPPON_OBJ_TYPE:
+            rtn = new COArray();
+            break;
+
+        default:
             rtn = new CONull();
             break;
     }
@@ -493,49 +1068,24 @@ const char *CppON::c_str()
 std::string *CppON::toCompactJsonString()
 {
     std::string *sptr = NULL;
-    if( data )
+    if( data || NULL_CPPON_OBJ_TYPE == typ )
     {
-        switch( typ )
-        {
-            case INTEGER_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (COInteger *) this )->toJsonString();
-                break;
-
-            case DOUBLE_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (CODouble *) this )->toJsonString();
-                break;
-
-            case STRING_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (COString *) this )->toJsonString();
-                break;
-
-            case NULL_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (CONull *) this )->toJsonString();
-                break;
-
-            case BOOLEAN_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (COBoolean *) this )->toJsonString();
-                break;
-
-            case MAP_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (COMap *) this )->toCompactJsonString();
-                break;
-
-            case ARRAY_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                sptr = ( (COArray *) this )->toCompactJsonString();
-                break;
-            default:
-                break;
-        }
+        sptr = new std::string();
+        CppONWriter  w( *sptr );
+        w.write( this ).flush();
     }
+    return sptr;
+}
 
+std::string *CppON::toBinary()
+{
+    std::string *sptr = NULL;
+    if( data || NULL_CPPON_OBJ_TYPE == typ )
+    {
+        sptr = new std::string();
+        CppONWriter  w( *sptr, CPPON_WRITE_BINARY );
+        w.write( this ).flush();
+    }
     return sptr;
 }
 
@@ -692,11 +1242,6 @@ CppON *CppON::parseJson( json_t *ob, string &tabs )
 }
 #endif
 
-static __inline void DumpWhiteSpace( const char **str ) { char ch; while( 0 != (ch = **str ) &&( ' ' == ch || '\t' == ch || '\n' == ch || 'r' == ch ) ) { (*str)++; } }
-static __inline void DumpWhiteSpace( const char *(&str) ) { char ch; while( 0 != (ch = *str ) &&( ' ' == ch || '\t' == ch || '\n' == ch || 'r' == ch ) ) { str++; } }
-static __inline void DumpWhiteSpace( char &ch, const char **str ) { while( 0 != (ch = **str ) &&( ' ' == ch || '\t' == ch || '\n' == ch || 'r' == ch ) ) { (*str)++; } }
-static __inline void DumpWhiteSpace( char &ch, const char *(&str) ) { while( 0 != (ch = *str ) &&( ' ' == ch || '\t' == ch || '\n' == ch || 'r' == ch ) ) { str++; } }
-
 void CppON::RemoveWhiteSpace( const char *s, std::string &str )
 {
 	char	buf[ strlen( s ) + 1 ];
@@ -721,1061 +1266,4770 @@ void CppON::RemoveWhiteSpace( const char *s, std::string &str )
 	str = buf;
 }
 
-CppON *CppON::GetTNetstring( const char **str )
+/****************************************************************************************/
+/*                                                                                      */
+/*                                    CppONParser                                       */
+/*                                                                                      */
+/****************************************************************************************/
+/*
+ * Single pass, length aware parser for JSON and TNet strings.
+ *
+ * The input is walked exactly once and never needs to be NUL terminated.  String contents are copied straight into
+ * the std::string owned by the resulting COString (escapes, including \uXXXX, are decoded on the way), numbers are
+ * converted in place without a second scan for the decimal point and TNet strings are bounded by their length prefix
+ * so a TNet container is parsed in place instead of being copied out first.
+ *
+ * A TNet string may appear anywhere a JSON value can (a run of digits followed by a ':' can't be valid JSON) so mixed
+ * input continues to work as it did with the old GetObj()/GetTNetstring() pair.
+ *
+ * The parser never prints or exits.  The first failure is recorded (code and position) and everything unwinds by
+ * returning NULL/false, so rejecting a bad message costs nothing more than the scan up to the bad character.
+ *
+ * Given a CppONArena every node (and its fixed size payload) is made in the arena instead of on the heap.
+ */
+static const double PowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+										1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+class CppONParser
+{
+public:
+						CppONParser( const char *s, size_t len, CppONArena *a = NULL ) : start( s ), cur( s ), end( s + len ), errPos( NULL ), errCode( CPPON_PARSE_OK ), arena( a ), nesting( 0 ) {}
+			CppON		*value();
+			CppON		*binary();
+			bool		object( COMap *mp );
+			bool		array( COArray *arr );
+			bool		events( CppONHandler &h );
+			bool		select( const std::vector<CppONPath> &paths, size_t base, uint64_t mask, size_t depth, std::vector<CppON *> &found, uint64_t &open );
+			bool		skip();
+			bool		scalar( bool &real, uint64_t &i, double &d ) { return scanNumber( real, i, d ); }	// Just a number, for parseTable()
+			const char	*position() { return cur; }
+			char		peek() { return ( cur < end ) ? *cur : '\0'; }
+			void		skipWhiteSpace() { while( cur < end && ( ' ' == *cur || '\t' == *cur || '\n' == *cur || '\r' == *cur ) ) { cur++; } }
+			void		getError( CppONParseError &err );
+			void		nested( unsigned n ) { nesting = n; }							// Containers already open around the text
+private:
+			bool		fail( CppONParseErrorCode code, const char *at = NULL ) { if( CPPON_PARSE_OK == errCode ) { errCode = code; errPos = ( at ) ? at : cur; } return false; }
+			bool		unexpected() { return fail( ( cur < end ) ? CPPON_PARSE_UNEXPECTED_CHARACTER : CPPON_PARSE_UNEXPECTED_END ); }
+			bool		nest() { return ( CPPON_MAX_DEPTH > nesting && ++nesting ) || fail( CPPON_PARSE_TOO_DEEP ); }	// Entering a container, nesting-- on the way out
+			void		inherit( const CppONParser &outer ) { nesting = outer.nesting; }	// A TNet payload parsed on its own
+			bool		isTNet();
+			CppON		*tnet();
+			bool		tnetSpan( const char *&payload, size_t &len );
+			CppON		*number();
+			bool		scanNumber( bool &real, uint64_t &i, double &d );
+			bool		string( std::string &s );
+			bool		text( const char *&s, size_t &len );
+			bool		key( std::string &s );
+			bool		keyText( const char *&s, size_t &len );
+			bool		members( CppONHandler &h, bool isMap, char close );
+			bool		selectMembers( const std::vector<CppONPath> &paths, size_t base, uint64_t mask, size_t depth, std::vector<CppON *> &found, uint64_t &open, bool isMap, char close );
+			bool		word( const char *w, size_t n );
+			bool		hex4( const char *p, uint32_t &cp );
+			COMap		*newMap() { return ( arena ) ? arena->make<COMap>( *arena ) : new COMap(); }
+			COArray		*newArray() { return ( arena ) ? arena->make<COArray>( *arena ) : new COArray(); }
+			COString	*newString() { return ( arena ) ? arena->make<COString>( "", (size_t) 0, *arena ) : new COString( "" ); }
+			CppON		*newInteger( uint64_t v ) { return ( arena ) ? (CppON *) arena->make<COInteger>( v, *arena ) : new COInteger( v ); }
+			CppON		*newDouble( double d ) { return ( arena ) ? (CppON *) arena->make<CODouble>( d, *arena ) : new CODouble( d ); }
+			CppON		*newBoolean( bool b ) { return ( arena ) ? (CppON *) arena->make<COBoolean>( b, *arena ) : new COBoolean( b ); }
+			CppON		*newNull() { return ( arena ) ? (CppON *) arena->make<CONull>() : new CONull(); }
+
+			const char			*start;
+			const char			*cur;
+			const char			*end;
+			const char			*errPos;										// First failure and what it was
+			CppONParseErrorCode	errCode;
+			CppONArena			*arena;											// Where nodes come from, NULL for the heap
+			unsigned			nesting;										// Containers open around cur, left as is after a failure
+			std::string			scratch;										// Decoded text for events(), reused
+};
+
+static const char *ParseErrorMessages[] = { "OK", "Unexpected character", "Unexpected end of input", "Expected a key",
+										"Expected ':'", "Unterminated string", "Invalid escape sequence", "Invalid number",
+										"Invalid TNet string length", "Invalid TNet string type", "Stopped by the handler",
+										"Invalid binary tag", "Nested too deep", "Message too large" };
+
+const char *CppONParseError::message() const
 {
-	CppON			*base = NULL;
-	uint32_t		len = (uint32_t) strtol( *str, (char **) str, 10 );
-	char			ch;
-	char			typ = '\0';
+	return ( CPPON_PARSE_OK <= code && CPPON_PARSE_TOO_LARGE >= code ) ? ParseErrorMessages[ code ] : "Unknown error";
+}
 
-	while( 0 != (ch = *(*str)++) && ( ' ' == ch || '\t' == ch || '\r' == ch || '\n' == ch ) );
-//	fprintf( stderr, "%s[%d]: Length = %d, type = '%c', String: '%s'\n", __FILE__,__LINE__, len, (*str)[ len ], *str );
-	if( ':' == ch )
+/*
+ * Line and column are only worked out here, after the fact, so a successful parse never pays for them.
+ */
+void CppONParser::getError( CppONParseError &err )
+{
+	err.code = errCode;
+	err.line = 1;
+	err.column = 1;
+	err.offset = 0;
+	if( CPPON_PARSE_OK != errCode )
 	{
-		switch ( typ = (*str)[ len ] )
+		err.offset = errPos - start;
+		for( const char *p = start; p < errPos; p++ )
 		{
-			case ',':														// string
-				{
-					std::string s( *str, len );
-					base = new COString( s );
-				}
-				break;
-			case '#':														// Integer
-				base = new COInteger( (uint64_t) strtoll( *str, NULL, 0 ) );
-				break;
-			case '^':														// float
-				base = new CODouble( strtod( *str, NULL) );
-				break;
-			case '!':														// boolean
-				if( 0 == strncasecmp( *str, "true", 4 ) )
-				{
-					base = new COBoolean( true );
-				} else if(  0 == strncasecmp( *str, "false", 5 ) ) {
-					base = new COBoolean( true );
-				}
-				break;
-			case '~':														// NULL
-				base = new CONull();
-				break;
-			case '}':														// Map
-				{
-					base = new COMap();
-					std::string s( *str, len );
-					const char	*cptr = s.c_str();
-//					fprintf( stderr, "%s[%d]: Start of map: '%s'\n", __FILE__, __LINE__, cptr );
-					while( *cptr )
-					{
-						DumpWhiteSpace( ch, cptr );
-						for( unsigned i = 0; 0 != (ch = cptr[ i ] ) && ('0' <= ch && '9' >= ch); i++);
-						COString 	*name;
-						CppON		*val;
-//						fprintf( stderr, "%s[%d]: Next char '%c'\n", __FILE__,__LINE__, ch );
-						if( ':' != ch )
-						{
-							name = (COString *) GetObj( &cptr );
-						} else {
-							name = (COString *)  GetTNetstring( &cptr );
-						}
-						DumpWhiteSpace( ch, cptr );
-//						fprintf( stderr, "%s[%d]: Name: '%s'", __FILE__, __LINE__, name->c_str() );
-						if( *cptr  && CppON::isString( name ) )
-						{
-//							const char *dummy = cptr;
-							for( unsigned i = 0; 0 != (ch = cptr[ i ] ) && ('0' <= ch && '9' >= ch); i++);
-							if( ':' != ch )
-							{
-								val = (COString *) GetObj( &cptr );
-							} else {
-								val = (COString *)  GetTNetstring( &cptr );
-							}
-							if( CppON::isObj( val ) )
-							{
-//								fprintf( stderr, "%s[%d]: %s = %s\n", __FILE__, __LINE__, name->c_str(), val->c_str() );
-								((COMap *) base )->append( name->c_str(), val );
-								delete name;
-							} else {
-//								fprintf( stderr, "%s[%d]: Failed to load object from: '%s'\n", __FILE__, __LINE__, dummy );
-								delete name;
-								delete base;
-								base = NULL;
-								break;
-							}
-						} else {
-							fprintf( stderr, "%s[%d]: Unexpected Character: %c\n", __FILE__, __LINE__, *cptr );
-							if( name )
-							{
-								delete name;
-							}
-							delete base;
-							base = NULL;
-							break;
-						}
-					}
-				}
-				break;
-			case ']':														// Array
-				{
-					base = new COArray();
-					std::string s( *str, len );
-					const char	*cptr = s.c_str();
-					while( *cptr )
-					{
-						DumpWhiteSpace( ch, cptr );
-//						fprintf( stderr, "%s[%d]: PARSE: '%s'\n", __FILE__, __LINE__, cptr );
-						for( unsigned i = 0; 0 != (ch = cptr[ i ] ) && ('0' <= ch && '9' >= ch); i++);
-						if( ':' != ch )
-						{
-							( ( COArray *) base )->append( GetObj( &cptr ) );
-						} else {
-//							CppON *obj;
-//							fprintf( stderr, "%s[%d]: Get a tnet string string: '%s'\n", __FILE__, __LINE__, cptr );
-//							( ( COArray *) base )->append( obj = GetTNetstring( &cptr ) );
-//							fprintf( stderr, "%s[%d]: Got: '%s'\n", __FILE__, __LINE__, obj->c_str() );
-							( ( COArray *) base )->append( GetTNetstring( &cptr ) );
-						}
-						if( 0 != *cptr )
-						{
-							DumpWhiteSpace( ch, cptr );
-//							if( ',' == ( ch = *cptr ) )
-							if( ',' == ch )
-							{
-								++cptr;
-							} else if(  '0' > ch || '9' < ch ) {
-								fprintf( stderr, "%s[%d]: Unexpected Character: %c\n", __FILE__, __LINE__, *cptr );
-								delete base;
-								base = NULL;
-								break;
-							}
-						}
-					}
-				}
-				break;
-			default:														// Illegal
-				break;
+			if( '\n' == *p )
+			{
+				err.line++;
+				err.column = 1;
+			} else {
+				err.column++;
+			}
 		}
-		*str += (len + 1);
-//		fprintf( stderr, "String now: '%s'\n", *str );
 	}
-	return base;
+	err.consumed = cur - start;
 }
-CppON *CppON::GetObj( const char **str )
-{
-	DumpWhiteSpace( str );
-	CppON		*base = NULL;
-	const char	*nc = *str;
-//	const char  *save = nc;
-	char		ch = *nc++;
 
-//	fprintf( stderr, "Parse: '%c%s'\n", ch, nc );
-	if( '{' == ch )
+CppON *CppONParser::value()
+{
+	skipWhiteSpace();
+	if( cur >= end )
 	{
-		COMap	*mp = new COMap();
-		bool	fail = false;
-		DumpWhiteSpace( ch, nc );
-
-//		fprintf( stderr, "Map: '%c%s;\n", ch, nc );
-		while( ! fail && 0 != ch && '}' != ch )
-		{
-			DumpWhiteSpace( ch, nc );
-			while( 0 != (ch = *nc++ ) && '"' != ch );
-			if( ch )
+		fail( CPPON_PARSE_UNEXPECTED_END );
+		return NULL;
+	}
+	switch( *cur )
+	{
+		case '{':
+			if( nest() )
 			{
-				int n = 0;
-				while( 0 != ( ch = nc[ n ] ) && '"' != ch ) { n++; };
-				if( ch )
+				COMap *mp = newMap();
+				if( object( mp ) )
 				{
-					string name( nc, n++ );
-					nc += n;
-					DumpWhiteSpace( ch, nc );
-//					fprintf( stderr, "Str:'%s'\n", nc );
-//					fprintf( stderr, "'%s' = ", name.c_str() );
-//					if( ':' == ( ch = *nc ) )
-					if( ':' == ch )
-					{
-						nc++;
-						CppON *obj;
-
-						DumpWhiteSpace( ch, nc );
-						for( unsigned i = 0; 0 != (ch = nc[ i ] ) && ('0' <= ch && '9' >= ch); i++);
-						if( ':' != ch )
-						{
-							obj = GetObj( &nc );
-						} else {
-							obj = GetTNetstring( &nc );
-						}
-						if( obj )
-						{
-//							fprintf( stderr, "%s\n", obj->c_str() );
-							mp->append( name.c_str(), obj );
-							DumpWhiteSpace( ch, nc );
-							// Character should be a comma or a '}';
-//							if( ',' == (ch = *nc ) )
-							if( ',' == ch )
-							{
-								nc++;
-							} else if( ch && '}' != ch ) {
-								fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-								const char *ree = &nc[ -2 ];
-								std::string sub( &nc[ -2 ], 48 );
-
-								fprintf( stderr, "INPUT: %s\n", sub.c_str() );
-
-								fprintf( stderr, " 0x%.2X 0x%.2X 0x%.2X 0x%.2X\n", (unsigned) ree[ 0 ], (unsigned) ree[ 1 ], (unsigned) ree[ 2 ], (unsigned) ree[ 3 ] );
-								fail = true;
-							}
-						} else {
-							fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-							fail = true;
-						}
-					} else {
-						fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-						fail = true;
-					}
-				} else {
-					fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-					fail = true;
+					nesting--;
+					return mp;
 				}
-			} else {
-				fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-				fail = true;
+				delete mp;
 			}
-		}
-		if( ! fail )
-		{
-			base = mp;
-		} else {
-			fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-			delete mp;
-		}
-		*str = &nc[ 1 ];
-		DumpWhiteSpace( ch, str );
-
-	} else if( '[' == ch ) {
-//		fprintf( stderr, "ARRAY: '%c%s'\n", ch, nc );
-		COArray		*arr = new COArray();
-		bool		fail = false;
-		DumpWhiteSpace( nc );
-		while( !fail && 0 != ch && ']' != ch )
-		{
-			CppON *obj;
-			for( unsigned i = 0; 0 != (ch = nc[ i ] ) && ('0' <= ch && '9' >= ch); i++);
-			if( ':' != ch )
+			return NULL;
+		case '[':
+			if( nest() )
 			{
-				obj = GetObj( &nc );
-			} else {
-				obj = GetTNetstring( &nc );
+				COArray *arr = newArray();
+				if( array( arr ) )
+				{
+					nesting--;
+					return arr;
+				}
+				delete arr;
 			}
-			if( obj )
+			return NULL;
+		case '"':
 			{
-				DumpWhiteSpace( ch, nc );
-//				fprintf( stderr, "Val: '%s'\n", obj->c_str() );
-				// Character should be a comma or a '}';
-//				if( ',' == ( ch = *nc ) )
-				if( ',' == ch )
+				COString *s = newString();
+				// cppcheck-suppress cstyleCast
+				if( string( *( (std::string *) s->data ) ) )
 				{
-					nc++;
-				} else if( ch && ']' != ch ) {
-					fail = true;
+					return s;
 				}
-				arr->append( obj );
-			} else {
-				fail = true;
+				delete s;
+			}
+			break;
+		case 't':
+		case 'T':
+			if( word( "true", 4 ) )
+			{
+				return newBoolean( true );
+			}
+			break;
+		case 'f':
+		case 'F':
+			if( word( "false", 5 ) )
+			{
+				return newBoolean( false );
+			}
+			break;
+		case 'n':
+		case 'N':
+			if( word( "null", 4 ) )
+			{
+				return newNull();
 			}
+			break;
+		case '-':
+		case '+':
+		case '.':
+			return number();
+		default:
+			if( '0' <= *cur && '9' >= *cur )
+			{
+				return ( isTNet() ) ? tnet() : number();
+			}
+			break;
+	}
+	fail( CPPON_PARSE_UNEXPECTED_CHARACTER );
+	return NULL;
+}
+
+/*
+ * Parse the members of a JSON object straight into the given map.  cur points at the '{'.
+ */
+bool CppONParser::object( COMap *mp )
+{
+	cur++;
+	skipWhiteSpace();
+	if( '}' == peek() )
+	{
+		cur++;
+		return true;
+	}
+	while( cur < end )
+	{
+		std::string		name;
+		CppON			*obj;
+
+		if( ! key( name ) )
+		{
+			return false;
 		}
-		if( ! fail )
+		skipWhiteSpace();
+		if( ':' != peek() )
 		{
-			base = arr;
-		} else {
-			fprintf( stderr, "%s[%d] ch = 0x%.2X => '%c'\n", __FILE__,__LINE__, (unsigned)ch, ch  );
-			delete arr;
+			return ( cur < end ) ? fail( CPPON_PARSE_EXPECTED_COLON ) : fail( CPPON_PARSE_UNEXPECTED_END );
 		}
-		*str = &nc[ 1 ];
-		DumpWhiteSpace( ch, str );
-	} else if( '"' == ch ) {
-		int n = 0;
-		std::vector<char> acum;
-		while( '"' != ( ch = nc[ n ] ) && 0 != ch )
+		cur++;
+		if( ! ( obj = value() ) )
 		{
-			if( 0x5C == ch )
-			{
-				ch = nc[ ++n ];
-			}
-			acum.push_back( ch );
-			n++;
-		};
-		std::string s( acum.begin(), acum.end() );
-		base = new COString( s.c_str() );
-		*str = &nc[ ++n ];
-		DumpWhiteSpace( ch, str );
-	} else if( ( 't' == ch || 'T' == ch ) && 0 == strncasecmp( nc, "rue", 3 ) && ( ! (ch == *(nc + 3)) || ',' == ch || ' ' == ch || '\t' == ch || '\n' == ch || '\r' == ch ) ) {
-		*str += 4;
-		base = new COBoolean( true );
-		DumpWhiteSpace( ch, str );
-	} else if( ( 'f' == ch || 'F' == ch ) && 0 == strncasecmp( nc, "alse", 4 )  && ( ! (ch == *(nc + 4)) || ',' == ch || ' ' == ch || '\t' == ch || '\n' == ch || '\r' == ch ) ) {
-		*str += 5;
-		base = new COBoolean( false );
-		DumpWhiteSpace( ch, str );
-	} else if( ( '0' <= ch && '9' >= ch ) || '-' == ch || '+' == ch ) {
-		char c;
-		const char *dot = NULL;
-		bool	neg = false;
-		if( '+' == ch )
-		{
-			nc++;
-		} else if( '-' == ch ) {
-			nc++;
-			neg = true;
-		}
-		for( int i = 0; 0 != ( c = nc[ i ] ) && ',' != c && '}' != c; i++){ if( '.' == c ){ dot = &nc[ i ]; break;}}
-		if( ! dot )
-		{
-			uint64_t n = 0;
-			if( '0' == ch && 'x' == *nc )
+			return false;
+		}
+		mp->put( std::move( name ), obj, false );
+		skipWhiteSpace();
+		if( ',' == peek() )
+		{
+			cur++;
+			skipWhiteSpace();
+			if( '}' == peek() )														// tolerate a trailing comma
 			{
-				n = strtoll( &nc[ -1 ], (char**) str, 16 );
-			} else {
-				n = strtoll( &nc[ -1 ], (char**) str, 10 );
+				cur++;
+				return true;
 			}
-			if( neg ) {n = -n;}
-			base = new COInteger( n );
+		} else if( '}' == peek() ) {
+			cur++;
+			return true;
 		} else {
-			double d = strtod( &nc[ -1 ], (char**) str );
-			if( neg ) {d = -d;}
-			base = new CODouble( d );
+			return unexpected();
 		}
-		DumpWhiteSpace( ch, str );
-	} else {
-		fprintf( stderr, "\n%c%s is not an object\n", ch, nc );
-		exit( 0 );
 	}
-	return base;
+	return fail( CPPON_PARSE_UNEXPECTED_END );
 }
 
-CppON *CppON::parseJson( const char *str )
+/*
+ * Parse the elements of a JSON array straight into the given array.  cur points at the '['.
+ */
+bool CppONParser::array( COArray *arr )
 {
-	if( str )
+	cur++;
+	skipWhiteSpace();
+	if( ']' == peek() )
 	{
-		char ch;
-		while( 0 != (ch = *str ) && ( ' ' == ch || '\t' == ch || '\n' == ch || '\r' == ch ) ) { ++str; }
-		if( '0' <= ch && '9' >= ch )
+		cur++;
+		return true;
+	}
+	while( cur < end )
+	{
+		CppON	*obj = value();
+
+		if( ! obj )
 		{
-			return GetTNetstring( &str );
-		} else if( ch ) {
-			return GetObj( &str );
-//			const char	*nc;
-//			std::string dat;
-//			RemoveWhiteSpace( str, dat );
-//			nc = dat.c_str();
-//			return ( GetObj( &nc ) );
+			return false;
+		}
+		arr->put( obj );
+		skipWhiteSpace();
+		if( ',' == peek() )
+		{
+			cur++;
+			skipWhiteSpace();
+			if( ']' == peek() )														// tolerate a trailing comma
+			{
+				cur++;
+				return true;
+			}
+		} else if( ']' == peek() ) {
+			cur++;
+			return true;
+		} else {
+			return unexpected();
 		}
 	}
-	return NULL;
+	return fail( CPPON_PARSE_UNEXPECTED_END );
 }
 
-#if 0
-CppON *CppON::parseJson( const char *str )
+/*
+ * A map key is either a JSON string or a TNet string
+ */
+bool CppONParser::key( std::string &s )
 {
-    CppON     *rtn = NULL;
-    string tabs = "";
+	skipWhiteSpace();
+	if( '"' == peek() )
+	{
+		return string( s );
+	} else if( isTNet() ) {
+		const char	*p = cur;
+		CppON		*k = tnet();
+		if( CppON::isString( k ) )
+		{
+			// cppcheck-suppress cstyleCast
+			s.swap( *( (std::string *) k->data ) );
+			delete k;
+			return true;
+		}
+		if( k )
+		{
+			delete k;
+			return fail( CPPON_PARSE_EXPECTED_KEY, p );
+		}
+		return false;
+	}
+	return ( cur < end ) ? fail( CPPON_PARSE_EXPECTED_KEY ) : fail( CPPON_PARSE_UNEXPECTED_END );
+}
 
-    if( str )
-    {
-        json_t      *root = NULL;
-        json_error_t  error;
-        char      *np;
-        int       cnt = strtol( str, &np, 0 );      								// Check to see if it is a tnetstring
-        if( np )
-        {
-            np++;
-            if( cnt && ',' == np[ cnt ] )
-            {
-                char *tmp = strdup( np );                							// make a copy so it can be modified
-                tmp[ cnt ] = '\0';                      							// remove the ',' at  the end of it
-                root = json_loads( tmp, 0, &error );    							// load it as JSON
-                free( tmp );
-            } else if ( cnt ) {
-                root = json_loads( np, 0, &error );      							// load it as JSON
-            }
-        }
+/*
+ * cur points at the opening quote.  Runs without escapes are appended in one piece.
+ */
+bool CppONParser::string( std::string &s )
+{
+	const char	*open = cur;
+	const char	*p = ++cur;
 
-    	while( ' ' == *str || '\t' == *str || '\n' == *str )						// Trim beginning of string
-    	{
-    		str++;
-    	}
-        if( '"' != str[ 0 ] )
-        {
-            if( !root )                                  							// I guess it wasn't TNetstring so load it as JSON
-            {
-                if( !( str && str[ 0 ] ) )
-                {
-                    fprintf( stderr, "%s[%d] Error: Attempt to parse zero length JSON string\n",__FILE__, __LINE__ );
-                }
-                root = json_loads( str, 0, &error );
-            }
-            if( ! root  )
-            {
-                fprintf( stderr, "%s[%d] Error: on line %d %s\n", __FILE__,__LINE__, error.line, error.text );
-                fprintf( stderr, "%s\n",str );
-                return NULL;
-            }
+	while( p < end )
+	{
+		char ch = *p;
+		if( '"' == ch )
+		{
+			s.append( cur, p - cur );
+			cur = p + 1;
+			return true;
+		} else if( '\\' != ch ) {
+			p++;
+			continue;
+		}
+		s.append( cur, p - cur );
+		if( ++p >= end )
+		{
+			break;
+		}
+		switch( ch = *p++ )
+		{
+			case 'b': s.push_back( '\b' ); break;
+			case 'f': s.push_back( '\f' ); break;
+			case 'n': s.push_back( '\n' ); break;
+			case 'r': s.push_back( '\r' ); break;
+			case 't': s.push_back( '\t' ); break;
+			case 'u':
+				{
+					uint32_t	cp, lo;
+					if( ! hex4( p, cp ) )
+					{
+						cur = p;
+						return fail( CPPON_PARSE_BAD_ESCAPE, p - 2 );
+					}
+					p += 4;
+					if( 0xD800 <= cp && 0xDBFF >= cp && p + 1 < end && '\\' == p[ 0 ] && 'u' == p[ 1 ] && hex4( &p[ 2 ], lo ) && 0xDC00 <= lo && 0xDFFF >= lo )
+					{
+						cp = 0x10000 + ( ( cp - 0xD800 ) << 10 ) + ( lo - 0xDC00 );
+						p += 6;
+					}
+					if( 0x80 > cp )
+					{
+						s.push_back( (char) cp );
+					} else if( 0x800 > cp ) {
+						s.push_back( (char) ( 0xC0 | ( cp >> 6 ) ) );
+						s.push_back( (char) ( 0x80 | ( cp & 0x3F ) ) );
+					} else if( 0x10000 > cp ) {
+						s.push_back( (char) ( 0xE0 | ( cp >> 12 ) ) );
+						s.push_back( (char) ( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+						s.push_back( (char) ( 0x80 | ( cp & 0x3F ) ) );
+					} else {
+						s.push_back( (char) ( 0xF0 | ( cp >> 18 ) ) );
+						s.push_back( (char) ( 0x80 | ( ( cp >> 12 ) & 0x3F ) ) );
+						s.push_back( (char) ( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+						s.push_back( (char) ( 0x80 | ( cp & 0x3F ) ) );
+					}
+				}
+				break;
+			default:																// '"', '\\', '/' and anything else we don't know about
+				s.push_back( ch );
+				break;
+		}
+		cur = p;
+	}
+	cur = p;
+	return fail( CPPON_PARSE_UNTERMINATED_STRING, open );
+}
 
-            rtn = parseJson( root, tabs );
-            json_decref( root );
-        } else {
-        	std::string s( "{" );
-        	s.append( str );
-        	s += "}";
+bool CppONParser::hex4( const char *p, uint32_t &cp )
+{
+	cp = 0;
+	if( 4 > end - p )
+	{
+		return false;
+	}
+	for( int i = 0; 4 > i; i++ )
+	{
+		char ch = p[ i ];
+		cp <<= 4;
+		if( '0' <= ch && '9' >= ch )
+		{
+			cp |= ch - '0';
+		} else if( 'a' <= ch && 'f' >= ch ) {
+			cp |= ch - 'a' + 10;
+		} else if( 'A' <= ch && 'F' >= ch ) {
+			cp |= ch - 'A' + 10;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
 
-            if( !root )                                  							// I guess it wasn't TNetstring so load it as JSON
-            {
-                root = json_loads( s.c_str(), 0, &error );
-            }
-            if( ! root  )
-            {
-                fprintf( stderr, "%s[%d] Error: on line %d %s\n", __FILE__,__LINE__, error.line, error.text );
-                fprintf( stderr, "%s\n",str );
-            } else {
-            	COMap *mp = (COMap *) parseJson( root, tabs );
-            	rtn = mp->extract( mp->begin()->first.c_str() );
-            	delete( mp );
-            	json_decref( root );
-            }
-        }
-    } else {
-        fprintf( stderr, "ERROR: Asked to parse NULL JSON string\n" );
-    }
-    return rtn;
+/*
+ * Keywords are case insensitive and must not run into another word
+ */
+bool CppONParser::word( const char *w, size_t n )
+{
+	if( (size_t) ( end - cur ) >= n && 0 == strncasecmp( cur, w, n ) )
+	{
+		char ch = ( cur + n < end ) ? cur[ n ] : '\0';
+		if( ! ( ( 'a' <= ch && 'z' >= ch ) || ( 'A' <= ch && 'Z' >= ch ) || ( '0' <= ch && '9' >= ch ) || '_' == ch ) )
+		{
+			cur += n;
+			return true;
+		}
+	}
+	return false;
 }
-#endif
-// cppcheck-suppress unusedFunction
-CppON *CppON::parseJsonFile( const char *path )
+
+/*
+ * Integers are accumulated as they are scanned.  Reals with no more than 15 significant digits and a small exponent are
+ * exact after a single multiply or divide by a power of ten, the rest are handed to strtod().
+ */
+CppON *CppONParser::number()
 {
-    int     sz = 1024;
-    char    *buf,*bSave;
-    FILE    *fp = fopen( path, "r" );
-    int     rd = 0;
-    int     c;
-    CppON *rtn = NULL;
+	bool		real;
+	uint64_t	i;
+	double		d;
 
-    if( !fp )
-    {
-        char estr[ 1024 ];
-        snprintf( estr, 1023, "fopen Failed to open JSON FILE \"%s\"", path );
-        perror( estr );
-        return rtn;
-    }
+	if( ! scanNumber( real, i, d ) )
+	{
+		return NULL;
+	}
+	return ( real ) ? newDouble( d ) : newInteger( i );
+}
 
-    if( !( buf = (char *) malloc( sz ) ) )
-    {
-        fclose( fp );
-        perror( "malloc Memory allocation error" );
-        return rtn;
-    }
+bool CppONParser::scanNumber( bool &real, uint64_t &i, double &d )
+{
+	const char	*p = cur;
+	bool		neg = false;
+	uint64_t	mant = 0;
+	int			digits = 0;
+	int			exp10 = 0;
 
-    while( EOF != ( c = fgetc( fp ) ) )
-    {
-        buf[ rd++ ] = ( char ) c;
-        if( rd == sz )
-        {
-            if( !( buf = (char *) realloc( (void *) (bSave = buf ), sz += 512 ) ) )
-            {
-                snprintf( bSave, 1023, "realloc Failed to allocate %d bytes of memory", sz );
-                perror( bSave );
-                free( bSave );
-                return rtn;
-         }
-        }
-    }
-    buf[ rd ] = '\0';
-    fclose( fp );
+	real = false;
+	if( '+' == *p || '-' == *p )
+	{
+		neg = ( '-' == *p++ );
+	}
+	if( p + 1 < end && '0' == p[ 0 ] && ( 'x' == p[ 1 ] || 'X' == p[ 1 ] ) )
+	{
+		const char *h = p += 2;
+		for( ; p < end; p++ )
+		{
+			char ch = *p;
+			if( '0' <= ch && '9' >= ch )
+			{
+				mant = ( mant << 4 ) | ( ch - '0' );
+			} else if( 'a' <= ch && 'f' >= ch ) {
+				mant = ( mant << 4 ) | ( ch - 'a' + 10 );
+			} else if( 'A' <= ch && 'F' >= ch ) {
+				mant = ( mant << 4 ) | ( ch - 'A' + 10 );
+			} else {
+				break;
+			}
+		}
+		if( h == p )
+		{
+			return fail( CPPON_PARSE_BAD_NUMBER );
+		}
+		cur = p;
+		i = ( neg ) ? -mant : mant;
+		return true;
+	}
+	for( ; p < end && '0' <= *p && '9' >= *p; p++, digits++ )
+	{
+		if( 19 > digits )
+		{
+			mant = mant * 10 + ( *p - '0' );
+		} else {
+			exp10++;
+		}
+	}
+	if( p < end && '.' == *p )
+	{
+		real = true;
+		for( p++; p < end && '0' <= *p && '9' >= *p; p++, digits++ )
+		{
+			if( 19 > digits )
+			{
+				mant = mant * 10 + ( *p - '0' );
+				exp10--;
+			}
+		}
+	}
+	if( 0 == digits )
+	{
+		return fail( CPPON_PARSE_BAD_NUMBER );
+	}
+	if( p < end && ( 'e' == *p || 'E' == *p ) )
+	{
+		const char	*e = p++;
+		bool		eneg = false;
+		int			ex = 0;
+		if( p < end && ( '+' == *p || '-' == *p ) )
+		{
+			eneg = ( '-' == *p++ );
+		}
+		if( p < end && '0' <= *p && '9' >= *p )
+		{
+			real = true;
+			for( ; p < end && '0' <= *p && '9' >= *p; p++ )
+			{
+				if( 100000 > ex )
+				{
+					ex = ex * 10 + ( *p - '0' );
+				}
+			}
+			exp10 += ( eneg ) ? -ex : ex;
+		} else {
+			p = e;																	// Not an exponent, leave it for the caller
+		}
+	}
+	if( ! real )
+	{
+		cur = p;
+		if( 19 < digits )															// Out of range, clamp it like strtoll() did
+		{
+			i = (uint64_t) ( ( neg ) ? INT64_MIN : INT64_MAX );
+		} else {
+			i = ( neg ) ? -mant : mant;
+		}
+		return true;
+	}
 
-    rtn = parseJson( buf );
-    free(buf );
+	if( 15 >= digits && -22 <= exp10 && 22 >= exp10 )
+	{
+		d = ( 0 > exp10 ) ? (double) mant / PowersOfTen[ -exp10 ] : (double) mant * PowersOfTen[ exp10 ];
+	} else {
+		std::string s( cur, p - cur );
+		d = strtod( s.c_str(), NULL );
+		neg = false;
+	}
+	cur = p;
+	if( neg )
+	{
+		d = -d;
+	}
+	return true;
+}
 
-    return ( rtn );
+bool CppONParser::isTNet()
+{
+	const char *p = cur;
+	while( p < end && '0' <= *p && '9' >= *p )
+	{
+		p++;
+	}
+	return ( p != cur && p < end && ':' == *p );
 }
 
-CppON *CppON::readObj( FILE *fp )
+/*
+ * cur points at the length prefix.  On success payload and len bound the payload, its type character is payload[ len ] and
+ * cur is left past it.
+ */
+bool CppONParser::tnetSpan( const char *&payload, size_t &len )
 {
-	CppON 		*rtn = NULL;
-	int			otype = -1;
-	int			stype = -1;
-	unsigned	rd = 0;
-	int			c;
-	unsigned	levels = 0;
-	bool 		done = false;
+	const char	*begin = cur;
+	uint64_t	n = 0;
 
-	if( fp )
+	for( ; '0' <= *cur && '9' >= *cur; cur++ )
 	{
-	    unsigned	sz = 1024;
-	    char    	*buf,*bSave;
+		n = n * 10 + ( *cur - '0' );
+	}
+	cur++;																			// skip the ':'
+	if( n >= (uint64_t) ( end - cur ) )
+	{
+		fail( CPPON_PARSE_BAD_TNET_LENGTH, begin );
+		cur = end;
+		return false;
+	}
+	payload = cur;
+	len = (size_t) n;
+	cur += len + 1;
+	return true;
+}
 
-	    if( !( buf = (char *) malloc( sz ) ) )
-	    {
-	        fclose( fp );
-	        perror( "malloc Memory allocation error" );
-	    } else {
-	    	buf[ 0 ] = '\0';
-	    	while( 0 > otype && EOF != ( c = fgetc( fp ) ) )								// Read characters until we get the first character of the json
-	    	{
-	    		if( '{' == c )																// Start of a Map?
-	    		{
-	    			levels = 1;
-	    			otype = 0;
-	    		} else if( '\"' == c ) {													// Start of an Object?
-	    			levels = 1;
-	    			otype = 2;
-	    		} else if( '[' == c ) {														// Start of an Array?
-	    			levels = 1;
-	    			otype = 1;
-	    		}
-	    	}
+/*
+ * cur points at the length prefix. The payload is parsed in place, bounded by its length.
+ */
+CppON *CppONParser::tnet()
+{
+	const char	*payload;
+	size_t		len;
+	CppON		*rtn = NULL;
 
-	    	if( 0 <= otype )																// if we got a '"', '{' or a '[' then we may have something
-	    	{
-	    		buf[ rd++ ] = c;
-	    	    buf[ rd ] = '\0';
-	    	    while( !done && EOF != ( c = fgetc( fp ) ) )
-	    	    {
-	    	        buf[ rd++ ] = ( char ) c;
+	if( ! tnetSpan( payload, len ) )
+	{
+		return NULL;
+	}
+	CppONParser	sub( payload, len, arena );
 
-	    	        if( rd == sz )
-	    	        {
-	    	            if( !( buf = (char *) realloc( (void *) (bSave = buf ), sz += 512 ) ) )
-	    	            {
-	    	                perror( bSave );
-	    	                free( bSave );
+	sub.inherit( *this );
+	switch( payload[ len ] )
+	{
+		case ',':																	// string
+			rtn = ( arena ) ? arena->make<COString>( std::string( payload, len ) ) : new COString( std::string( payload, len ) );
+			break;
+		case '#':																	// Integer
+			sub.skipWhiteSpace();
+			if( ( rtn = sub.number() ) && CppON::isDouble( rtn ) )
+			{
+				// cppcheck-suppress cstyleCast
+				CppON *i = newInteger( (uint64_t) (int64_t) ( (CODouble *) rtn )->doubleValue() );
+				delete rtn;
+				rtn = i;
+			}
+			break;
+		case '^':																	// float
+			sub.skipWhiteSpace();
+			if( ( rtn = sub.number() ) && CppON::isInteger( rtn ) )
+			{
+				// cppcheck-suppress cstyleCast
+				CppON *d = newDouble( (double) ( (COInteger *) rtn )->longValue() );
+				delete rtn;
+				rtn = d;
+			}
+			break;
+		case '!':																	// boolean
+			sub.skipWhiteSpace();
+			rtn = newBoolean( sub.word( "true", 4 ) );
+			break;
+		case '~':																	// NULL
+			rtn = newNull();
+			break;
+		case '}':																	// Map
+			if( sub.nest() )
+			{
+				COMap	*mp = newMap();
+				for( sub.skipWhiteSpace(); sub.cur < sub.end; sub.skipWhiteSpace() )
+				{
+					std::string	name;
+					CppON		*obj;
+					if( ! sub.key( name ) || ! ( obj = sub.value() ) )
+					{
+						fail( sub.errCode, sub.errPos );
+						delete mp;
+						return NULL;
+					}
+					mp->put( std::move( name ), obj, false );
+					sub.skipWhiteSpace();
+					if( ',' == sub.peek() )
+					{
+						sub.cur++;
+					}
+				}
+				rtn = mp;
+			}
+			break;
+		case ']':																	// Array
+			if( sub.nest() )
+			{
+				COArray	*arr = newArray();
+				for( sub.skipWhiteSpace(); sub.cur < sub.end; sub.skipWhiteSpace() )
+				{
+					CppON *obj = sub.value();
+					if( ! obj )
+					{
+						fail( sub.errCode, sub.errPos );
+						delete arr;
+						return NULL;
+					}
+					arr->put( obj );
+					sub.skipWhiteSpace();
+					if( ',' == sub.peek() )
+					{
+						sub.cur++;
+					}
+				}
+				rtn = arr;
+			}
+			break;
+		default:																	// Illegal
+			fail( CPPON_PARSE_BAD_TNET_TYPE, &payload[ len ] );
+			break;
+	}
+	if( ! rtn && CPPON_PARSE_OK != sub.errCode )
+	{
+		fail( sub.errCode, sub.errPos );
+	}
+	return rtn;
+}
+
+/*
+ * cur points at the opening quote.  Text without escapes is handed back where it lies in the input, otherwise it is decoded
+ * into scratch.  Either way it is only good until the next call.
+ */
+bool CppONParser::text( const char *&s, size_t &len )
+{
+	const char	*p = cur + 1;
+
+	while( p < end && '"' != *p && '\\' != *p )
+	{
+		p++;
+	}
+	if( p < end && '"' == *p )
+	{
+		s = cur + 1;
+		len = p - s;
+		cur = p + 1;
+		return true;
+	}
+	scratch.clear();
+	if( ! string( scratch ) )
+	{
+		return false;
+	}
+	s = scratch.data();
+	len = scratch.size();
+	return true;
+}
+
+/*
+ * key() without the copy
+ */
+bool CppONParser::keyText( const char *&s, size_t &len )
+{
+	skipWhiteSpace();
+	if( '"' == peek() )
+	{
+		return text( s, len );
+	} else if( isTNet() ) {
+		const char	*p = cur;
+		if( ! tnetSpan( s, len ) )
+		{
+			return false;
+		}
+		return ( ',' == s[ len ] ) ? true : fail( CPPON_PARSE_EXPECTED_KEY, p );
+	}
+	return ( cur < end ) ? fail( CPPON_PARSE_EXPECTED_KEY ) : fail( CPPON_PARSE_UNEXPECTED_END );
+}
+
+/*
+ * One value as CppONHandler events.  Same grammar as value(), nothing is allocated.
+ */
+bool CppONParser::events( CppONHandler &h )
+{
+	const char	*s;
+	size_t		len;
+	bool		real;
+	uint64_t	i;
+	double		d;
+
+	skipWhiteSpace();
+	if( cur >= end )
+	{
+		return fail( CPPON_PARSE_UNEXPECTED_END );
+	}
+	switch( *cur )
+	{
+		case '{':
+		case '[':
+			{
+				bool	isMap = ( '{' == *cur++ );
+				if( ! nest() || ! ( ( ( isMap ) ? h.startObject() : h.startArray() ) || fail( CPPON_PARSE_STOPPED ) ) ||
+					! members( h, isMap, ( isMap ) ? '}' : ']' ) )
+				{
+					return false;
+				}
+				nesting--;
+			}
+			return true;
+		case '"':
+			return text( s, len ) && ( h.stringValue( s, len ) || fail( CPPON_PARSE_STOPPED ) );
+		case 't':
+		case 'T':
+			if( word( "true", 4 ) )
+			{
+				return h.boolValue( true ) || fail( CPPON_PARSE_STOPPED );
+			}
+			break;
+		case 'f':
+		case 'F':
+			if( word( "false", 5 ) )
+			{
+				return h.boolValue( false ) || fail( CPPON_PARSE_STOPPED );
+			}
+			break;
+		case 'n':
+		case 'N':
+			if( word( "null", 4 ) )
+			{
+				return h.nullValue() || fail( CPPON_PARSE_STOPPED );
+			}
+			break;
+		default:
+			if( '0' <= *cur && '9' >= *cur && isTNet() )
+			{
+				bool		ok = false;
+
+				if( ! tnetSpan( s, len ) )
+				{
+					return false;
+				}
+				CppONParser	sub( s, len );
+				sub.inherit( *this );
+				switch( s[ len ] )
+				{
+					case ',':
+						ok = h.stringValue( s, len ) || fail( CPPON_PARSE_STOPPED );
+						break;
+					case '#':
+						sub.skipWhiteSpace();
+						ok = sub.scanNumber( real, i, d ) && ( h.intValue( ( real ) ? (int64_t) d : (int64_t) i ) || fail( CPPON_PARSE_STOPPED ) );
+						break;
+					case '^':
+						sub.skipWhiteSpace();
+						ok = sub.scanNumber( real, i, d ) && ( h.doubleValue( ( real ) ? d : (double) (int64_t) i ) || fail( CPPON_PARSE_STOPPED ) );
+						break;
+					case '!':
+						sub.skipWhiteSpace();
+						ok = h.boolValue( sub.word( "true", 4 ) ) || fail( CPPON_PARSE_STOPPED );
+						break;
+					case '~':
+						ok = h.nullValue() || fail( CPPON_PARSE_STOPPED );
+						break;
+					case '}':
+						ok = sub.nest() && ( h.startObject() || fail( CPPON_PARSE_STOPPED ) ) && sub.members( h, true, '\0' );
+						break;
+					case ']':
+						ok = sub.nest() && ( h.startArray() || fail( CPPON_PARSE_STOPPED ) ) && sub.members( h, false, '\0' );
+						break;
+					default:
+						return fail( CPPON_PARSE_BAD_TNET_TYPE, &s[ len ] );
+				}
+				if( ! ok && CPPON_PARSE_OK != sub.errCode )
+				{
+					fail( sub.errCode, sub.errPos );
+				}
+				return ok;
+			}
+			if( ( '0' <= *cur && '9' >= *cur ) || '-' == *cur || '+' == *cur || '.' == *cur )
+			{
+				return scanNumber( real, i, d ) && ( ( ( real ) ? h.doubleValue( d ) : h.intValue( (int64_t) i ) ) || fail( CPPON_PARSE_STOPPED ) );
+			}
+			break;
+	}
+	return fail( CPPON_PARSE_UNEXPECTED_CHARACTER );
+}
+
+/*
+ * The members of a container as events, cur is just past the '{' or '['.  close is '\0' for a TNet payload, which runs to
+ * the end of this parser and has no ':' between key and value.
+ */
+bool CppONParser::members( CppONHandler &h, bool isMap, char close )
+{
+	skipWhiteSpace();
+	while( cur < end && !( close && close == *cur ) )
+	{
+		if( isMap )
+		{
+			const char	*s;
+			size_t		len;
+
+			if( ! keyText( s, len ) )
+			{
+				return false;
+			}
+			if( ! h.key( s, len ) )
+			{
+				return fail( CPPON_PARSE_STOPPED );
+			}
+			skipWhiteSpace();
+			if( close )
+			{
+				if( ':' != peek() )
+				{
+					return ( cur < end ) ? fail( CPPON_PARSE_EXPECTED_COLON ) : fail( CPPON_PARSE_UNEXPECTED_END );
+				}
+				cur++;
+			}
+		}
+		if( ! events( h ) )
+		{
+			return false;
+		}
+		skipWhiteSpace();
+		if( ',' == peek() )
+		{
+			cur++;
+			skipWhiteSpace();														// tolerate a trailing comma
+		} else if( close && close != peek() ) {
+			return unexpected();
+		}
+	}
+	if( close )
+	{
+		if( cur >= end )
+		{
+			return fail( CPPON_PARSE_UNEXPECTED_END );
+		}
+		cur++;
+	}
+	return ( ( isMap ) ? h.endObject() : h.endArray() ) || fail( CPPON_PARSE_STOPPED );
+}
+
+/*
+ * Step over one value without building or decoding anything.  The structure is still checked, string contents are not.
+ */
+bool CppONParser::skip()
+{
+	bool		real;
+	uint64_t	i;
+	double		d;
+
+	skipWhiteSpace();
+	if( cur >= end )
+	{
+		return fail( CPPON_PARSE_UNEXPECTED_END );
+	}
+	switch( *cur )
+	{
+		case '{':
+		case '[':
+			{
+				bool	isMap = ( '{' == *cur );
+				char	close = ( isMap ) ? '}' : ']';
+
+				if( ! nest() )
+				{
+					return false;
+				}
+				for( cur++, skipWhiteSpace(); cur < end && close != *cur; )
+				{
+					if( isMap )
+					{
+						const char	*s;
+						size_t		len;
+
+						if( ! keyText( s, len ) )
+						{
+							return false;
+						}
+						skipWhiteSpace();
+						if( ':' != peek() )
+						{
+							return ( cur < end ) ? fail( CPPON_PARSE_EXPECTED_COLON ) : fail( CPPON_PARSE_UNEXPECTED_END );
+						}
+						cur++;
+					}
+					if( ! skip() )
+					{
+						return false;
+					}
+					skipWhiteSpace();
+					if( ',' == peek() )
+					{
+						cur++;
+						skipWhiteSpace();
+					} else if( close != peek() ) {
+						return unexpected();
+					}
+				}
+				if( cur >= end )
+				{
+					return fail( CPPON_PARSE_UNEXPECTED_END );
+				}
+				cur++;
+				nesting--;
+			}
+			return true;
+		case '"':
+			for( const char *p = cur + 1; p < end && NULL != ( p = (const char *) memchr( p, '"', end - p ) ); p++ )
+			{
+				const char *b = p;
+				while( '\\' == b[ -1 ] )
+				{
+					b--;
+				}
+				if( !( ( p - b ) & 1 ) )												// not escaped by an odd run of backslashes
+				{
+					cur = p + 1;
+					return true;
+				}
+			}
+			return fail( CPPON_PARSE_UNTERMINATED_STRING );
+		case 't':
+		case 'T':
+			return word( "true", 4 ) || fail( CPPON_PARSE_UNEXPECTED_CHARACTER );
+		case 'f':
+		case 'F':
+			return word( "false", 5 ) || fail( CPPON_PARSE_UNEXPECTED_CHARACTER );
+		case 'n':
+		case 'N':
+			return word( "null", 4 ) || fail( CPPON_PARSE_UNEXPECTED_CHARACTER );
+		default:
+			if( ( '0' <= *cur && '9' >= *cur ) || '-' == *cur || '+' == *cur || '.' == *cur )
+			{
+				const char	*p = cur;
+
+				while( p < end && '0' <= *p && '9' >= *p )
+				{
+					p++;
+				}
+				if( p != cur && p < end && ':' == *p )								// A TNet length, it says how far to go
+				{
+					const char	*s;
+					size_t		len;
+
+					if( ! tnetSpan( s, len ) )
+					{
+						return false;
+					}
+					return ( strchr( ",#^!~}]", s[ len ] ) && s[ len ] ) ? true : fail( CPPON_PARSE_BAD_TNET_TYPE, &s[ len ] );
+				}
+				while( p < end && ( ( '0' <= *p && '9' >= *p ) || '.' == *p ) )			// Plain decimals, the common case, aren't converted
+				{
+					p++;
+				}
+				if( p < end && ( '-' == *p || '+' == *p || 'e' == *p || 'E' == *p || 'x' == *p || 'X' == *p ) )
+				{
+					return scanNumber( real, i, d );
+				}
+				if( p == cur || ( 1 == p - cur && '.' == *cur ) )
+				{
+					return fail( CPPON_PARSE_BAD_NUMBER );
+				}
+				cur = p;
+				return true;
+			}
+			break;
+	}
+	return fail( CPPON_PARSE_UNEXPECTED_CHARACTER );
+}
+
+/*
+ * Follow the rest of a path's steps through a tree that has already been built.  Keys only match members of maps and
+ * indexes only match elements of arrays.
+ */
+static CppON *followSteps( CppON *obj, const std::vector<CppONPath::Step> &steps, size_t from )
+{
+	for( size_t s = from; obj && steps.size() > s; s++ )
+	{
+		if( 0 > steps[ s ].index )
+		{
+			COMapData::iterator	it;
+
+			// cppcheck-suppress cstyleCast
+			if( ! CppON::isMap( obj ) || ( (COMap *) obj )->value()->end() == ( it = ( (COMap *) obj )->value()->find( steps[ s ].key ) ) )
+			{
+				return NULL;
+			}
+			obj = it->second;
+		} else {
+			// cppcheck-suppress cstyleCast
+			obj = ( CppON::isArray( obj ) ) ? ( (COArray *) obj )->at( steps[ s ].index ) : NULL;
+		}
+	}
+	return obj;
+}
+
+/*
+ * Selective parse of one value.  Bit b of mask is set when paths[ base + b ] has matched the first depth steps on the way
+ * here, open holds the paths not found yet.  With nothing left to match the value is skipped, when a path ends here the
+ * subtree is built and anything deeper that also matched is picked out of it, otherwise only the members that some path
+ * continues into are looked at.  Once open is empty everything unwinds without reading further.
+ */
+bool CppONParser::select( const std::vector<CppONPath> &paths, size_t base, uint64_t mask, size_t depth, std::vector<CppON *> &found, uint64_t &open )
+{
+	uint64_t	whole = 0;
+
+	if( !( mask &= open ) )
+	{
+		return skip();
+	}
+	for( uint64_t m = mask; m; m &= m - 1 )
+	{
+		if( paths[ base + __builtin_ctzll( m ) ].getSteps().size() == depth )
+		{
+			whole |= m & -m;
+		}
+	}
+	if( whole )
+	{
+		CppON	*obj = value();
+
+		if( ! obj )
+		{
+			return false;
+		}
+		for( uint64_t m = mask; m; m &= m - 1 )
+		{
+			size_t	b = __builtin_ctzll( m );
+			CppON	*o = obj;
+
+			if( ( whole & m & -m ) && ( m & -m ) != ( whole & -whole ) )			// The same path again, give it a copy
+			{
+				o = CppON::factory( obj );
+			} else if( !( whole & m & -m ) && ( o = followSteps( obj, paths[ base + b ].getSteps(), depth ) ) ) {
+				o = CppON::factory( o );
+			}
+			if( o )
+			{
+				found[ base + b ] = o;
+				open &= ~( m & -m );
+			}
+		}
+		open &= ~whole;
+		return true;
+	}
+	skipWhiteSpace();
+	if( '{' == peek() || '[' == peek() )
+	{
+		bool	isMap = ( '{' == *cur++ );
+		if( ! nest() || ! selectMembers( paths, base, mask, depth, found, open, isMap, ( isMap ) ? '}' : ']' ) )
+		{
+			return false;
+		}
+		nesting--;
+		return true;
+	}
+	if( '0' <= peek() && '9' >= peek() && isTNet() )
+	{
+		const char	*at = cur;
+		const char	*s;
+		size_t		len;
+
+		if( ! tnetSpan( s, len ) )
+		{
+			return false;
+		}
+		if( '}' == s[ len ] || ']' == s[ len ] )
+		{
+			CppONParser	sub( s, len, arena );
+			sub.inherit( *this );
+			if( ! sub.nest() || ! sub.selectMembers( paths, base, mask, depth, found, open, '}' == s[ len ], '\0' ) )
+			{
+				return fail( sub.errCode, sub.errPos );
+			}
+			return true;
+		}
+		cur = at;
+	}
+	return skip();																	// A scalar, the paths go deeper than this
+}
+
+bool CppONParser::selectMembers( const std::vector<CppONPath> &paths, size_t base, uint64_t mask, size_t depth, std::vector<CppON *> &found, uint64_t &open, bool isMap, char close )
+{
+	size_t		idx = 0;
+
+	skipWhiteSpace();
+	while( cur < end && !( close && close == *cur ) )
+	{
+		uint64_t	next = 0;
+
+		if( isMap )
+		{
+			const char	*s;
+			size_t		len;
+
+			if( ! keyText( s, len ) )
+			{
+				return false;
+			}
+			for( uint64_t m = mask; m; m &= m - 1 )
+			{
+				const CppONPath::Step &step = paths[ base + __builtin_ctzll( m ) ].getSteps()[ depth ];
+				if( 0 > step.index && len == step.key.size() && 0 == memcmp( s, step.key.data(), len ) )
+				{
+					next |= m & -m;
+				}
+			}
+			skipWhiteSpace();
+			if( close )
+			{
+				if( ':' != peek() )
+				{
+					return ( cur < end ) ? fail( CPPON_PARSE_EXPECTED_COLON ) : fail( CPPON_PARSE_UNEXPECTED_END );
+				}
+				cur++;
+			}
+		} else {
+			for( uint64_t m = mask; m; m &= m - 1 )
+			{
+				if( (int) idx == paths[ base + __builtin_ctzll( m ) ].getSteps()[ depth ].index )
+				{
+					next |= m & -m;
+				}
+			}
+			idx++;
+		}
+		if( ! select( paths, base, next, depth + 1, found, open ) )
+		{
+			return false;
+		}
+		if( ! open )
+		{
+			return true;
+		}
+		skipWhiteSpace();
+		if( ',' == peek() )
+		{
+			cur++;
+			skipWhiteSpace();
+		} else if( close && close != peek() ) {
+			return unexpected();
+		}
+	}
+	if( close )
+	{
+		if( cur >= end )
+		{
+			return fail( CPPON_PARSE_UNEXPECTED_END );
+		}
+		cur++;
+	}
+	return true;
+}
+
+/*
+ * Parse a JSON or TNet value starting at *str and leave *str pointing past it and any trailing white space.
+ */
+CppON *CppON::GetTNetstring( const char **str )
+{
+	return GetObj( str );
+}
+
+CppON *CppON::GetObj( const char **str )
+{
+	CppONParser	p( *str, strlen( *str ) );
+	CppON		*rtn = p.value();
+
+	p.skipWhiteSpace();
+	*str = p.position();
+	return rtn;
+}
+
+/*
+ * Parse a JSON or TNet value and report how it went in err.  This never writes to stderr or exits so it is safe to use on
+ * untrusted input in a receive loop: on failure NULL is returned and err says where and why.  err.consumed is the number of
+ * bytes used by the value (plus trailing white space) so anything following it can be picked up by the caller.
+ * With an arena the whole tree is built in it, see CppONArena.
+ */
+CppON *CppON::parseJson( const char *str, size_t len, CppONParseError &err, CppONArena *arena )
+{
+	CppON	*rtn = NULL;
+
+	if( str )
+	{
+		CppONParser	p( str, len, arena );
+		if( ( rtn = p.value() ) )
+		{
+			p.skipWhiteSpace();
+		}
+		p.getError( err );
+	} else {
+		err.code = CPPON_PARSE_UNEXPECTED_END;
+		err.offset = err.consumed = 0;
+		err.line = err.column = 1;
+	}
+	return rtn;
+}
+
+/*
+ * Walk a JSON or TNet value and report it to h as events instead of building a tree, see CppONHandler.  Returns false
+ * with err filled in on a syntax error or when a callback asks to stop (CPPON_PARSE_STOPPED).
+ */
+bool CppON::parseEvents( const char *str, size_t len, CppONHandler &h, CppONParseError &err )
+{
+	bool	rtn = false;
+
+	if( str )
+	{
+		CppONParser	p( str, len );
+		if( ( rtn = p.events( h ) ) )
+		{
+			p.skipWhiteSpace();
+		}
+		p.getError( err );
+	} else {
+		err.code = CPPON_PARSE_UNEXPECTED_END;
+		err.offset = err.consumed = 0;
+		err.line = err.column = 1;
+	}
+	return rtn;
+}
+
+/*
+ * Parse only the parts of a message that the given paths lead to.  found is resized to match paths and found[ i ] gets the
+ * subtree paths[ i ] names (the caller owns it) or NULL when the message has no such member.  Everything else is skipped
+ * without being built, decoded or allocated, and the scan stops as soon as every path has been found.
+ *
+ * Paths are matched strictly: a key only matches a member of a map and an index (as in "list:3") only an element of an array.
+ * They are looked for 64 at a time, each group being one pass over the input.  Returns how many were found.  On a syntax
+ * error before that point nothing is returned, found is all NULL and err says what went wrong.
+ */
+size_t CppON::parseSelect( const char *str, size_t len, const std::vector<CppONPath> &paths, std::vector<CppON *> &found, CppONParseError &err )
+{
+	size_t	rtn = 0;
+
+	found.assign( paths.size(), NULL );
+	err.code = CPPON_PARSE_OK;
+	err.offset = err.consumed = 0;
+	err.line = err.column = 1;
+	if( ! str )
+	{
+		err.code = CPPON_PARSE_UNEXPECTED_END;
+		return 0;
+	}
+	for( size_t base = 0; paths.size() > base; base += 64 )
+	{
+		size_t		n = ( 64 < paths.size() - base ) ? 64 : paths.size() - base;
+		uint64_t	all = ( 64 == n ) ? ~( uint64_t ) 0 : ( ( uint64_t ) 1 << n ) - 1;
+		uint64_t	open = all;
+		CppONParser	p( str, len );
+
+		if( ! p.select( paths, base, all, 0, found, open ) )
+		{
+			p.getError( err );
+			for( std::vector<CppON *>::iterator it = found.begin(); found.end() != it; ++it )
+			{
+				delete *it;
+				*it = NULL;
+			}
+			return 0;
+		}
+		p.getError( err );
+		rtn += n - __builtin_popcountll( open );
+	}
+	return rtn;
+}
+
+CppON *CppON::parseJson( const char *str, size_t len )
+{
+	CppONParseError	err;
+	CppON			*rtn = parseJson( str, len, err );
+
+	if( ! rtn && len )
+	{
+		fprintf( stderr, "%s[%d]: Parse error: %s at line %u column %u\n", __FILE__, __LINE__, err.message(), err.line, err.column );
+	}
+	return rtn;
+}
+
+CppON *CppON::parseJson( const char *str )
+{
+	return ( str ) ? parseJson( str, strlen( str ) ) : NULL;
+}
+
+/****************************************************************************************/
+/*                                                                                      */
+/*                                   Binary encoding                                    */
+/*                                                                                      */
+/****************************************************************************************/
+/*
+ * The tags of the CPPON_WRITE_BINARY encoding, see CppONView for the whole table.
+ */
+#define CPPON_BIN_FIXMAP		0x80
+#define CPPON_BIN_FIXARRAY		0x90
+#define CPPON_BIN_FIXSTR		0xA0
+#define CPPON_BIN_NULL			0xC0
+#define CPPON_BIN_FALSE			0xC2
+#define CPPON_BIN_TRUE			0xC3
+#define CPPON_BIN_INT8			0xC4											// then INT16, INT32 and INT64
+#define CPPON_BIN_UINT8			0xC8											// then UINT16, UINT32 and UINT64
+#define CPPON_BIN_DOUBLE		0xCC
+#define CPPON_BIN_DOUBLE_PREC	0xCD
+#define CPPON_BIN_STR8			0xD0											// then STR16 and STR32
+#define CPPON_BIN_ARRAY16		0xD4											// then ARRAY32
+#define CPPON_BIN_MAP16			0xD6											// then MAP32
+
+/*
+ * One decoded tag.  n is the member, element or byte count of a map, array or string and s a string's bytes.
+ */
+struct CppONBinaryItem
+{
+	CppONType			type;
+	uint64_t			n;
+	int64_t				i;
+	double				d;
+	int					precision;
+	const uint8_t		*s;
+};
+
+static uint64_t binaryLoad( const uint8_t *p, unsigned n )
+{
+	uint64_t v = 0;
+	while( n-- )
+	{
+		v = ( v << 8 ) | p[ n ];
+	}
+	return v;
+}
+
+/*
+ * Decode the value starting at p up to, for a map or an array, its first member.  Returns where that leaves off or NULL,
+ * with code saying why, if the buffer ends first or the tag isn't one of ours.
+ */
+static const uint8_t *binaryItem( const uint8_t *p, const uint8_t *end, CppONBinaryItem &it, CppONParseErrorCode &code )
+{
+	uint8_t		tag;
+	unsigned	w = 0;
+	uint64_t	v;
+
+	if( p >= end )
+	{
+		code = CPPON_PARSE_UNEXPECTED_END;
+		return NULL;
+	}
+	tag = *p++;
+	it.n = 0;
+	it.precision = 10;
+	if( CPPON_BIN_FIXMAP > tag || 0xE0 <= tag )
+	{
+		it.type = INTEGER_CPPON_OBJ_TYPE;
+		it.i = (int8_t) tag;
+		return p;
+	}
+	if( CPPON_BIN_NULL > tag )
+	{
+		it.type = ( CPPON_BIN_FIXARRAY > tag ) ? MAP_CPPON_OBJ_TYPE : ( CPPON_BIN_FIXSTR > tag ) ? ARRAY_CPPON_OBJ_TYPE : STRING_CPPON_OBJ_TYPE;
+		it.n = tag & ( ( CPPON_BIN_FIXSTR > tag ) ? 0x0F : 0x1F );
+	} else {
+		switch( tag )
+		{
+			case CPPON_BIN_NULL:
+				it.type = NULL_CPPON_OBJ_TYPE;
+				return p;
+			case CPPON_BIN_FALSE:
+			case CPPON_BIN_TRUE:
+				it.type = BOOLEAN_CPPON_OBJ_TYPE;
+				it.i = tag & 1;
+				return p;
+			case CPPON_BIN_INT8:
+			case CPPON_BIN_INT8 + 1:
+			case CPPON_BIN_INT8 + 2:
+			case CPPON_BIN_INT8 + 3:
+			case CPPON_BIN_UINT8:
+			case CPPON_BIN_UINT8 + 1:
+			case CPPON_BIN_UINT8 + 2:
+			case CPPON_BIN_UINT8 + 3:
+				w = 1U << ( tag & 3 );
+				if( (size_t) ( end - p ) < w )
+				{
+					code = CPPON_PARSE_UNEXPECTED_END;
+					return NULL;
+				}
+				v = binaryLoad( p, w );
+				it.type = INTEGER_CPPON_OBJ_TYPE;
+				if( CPPON_BIN_UINT8 <= tag )
+				{
+					it.i = (int64_t) v;
+				} else {
+					it.i = ( 1 == w ) ? (int8_t) v : ( 2 == w ) ? (int16_t) v : ( 4 == w ) ? (int32_t) v : (int64_t) v;
+				}
+				return p + w;
+			case CPPON_BIN_DOUBLE_PREC:
+			case CPPON_BIN_DOUBLE:
+				w = ( CPPON_BIN_DOUBLE_PREC == tag ) ? 9 : 8;
+				if( (size_t) ( end - p ) < w )
+				{
+					code = CPPON_PARSE_UNEXPECTED_END;
+					return NULL;
+				}
+				if( 9 == w )
+				{
+					it.precision = (int8_t) *p++;
+				}
+				v = binaryLoad( p, 8 );
+				memcpy( &it.d, &v, sizeof( it.d ) );
+				it.type = DOUBLE_CPPON_OBJ_TYPE;
+				return p + 8;
+			case CPPON_BIN_STR8:
+			case CPPON_BIN_STR8 + 1:
+			case CPPON_BIN_STR8 + 2:
+				it.type = STRING_CPPON_OBJ_TYPE;
+				w = 1U << ( tag - CPPON_BIN_STR8 );
+				break;
+			case CPPON_BIN_ARRAY16:
+			case CPPON_BIN_ARRAY16 + 1:
+				it.type = ARRAY_CPPON_OBJ_TYPE;
+				w = 2U << ( tag - CPPON_BIN_ARRAY16 );
+				break;
+			case CPPON_BIN_MAP16:
+			case CPPON_BIN_MAP16 + 1:
+				it.type = MAP_CPPON_OBJ_TYPE;
+				w = 2U << ( tag - CPPON_BIN_MAP16 );
+				break;
+			default:
+				code = CPPON_PARSE_BAD_BINARY_TAG;
+				return NULL;
+		}
+		if( (size_t) ( end - p ) < w )
+		{
+			code = CPPON_PARSE_UNEXPECTED_END;
+			return NULL;
+		}
+		it.n = binaryLoad( p, w );
+		p += w;
+	}
+	if( STRING_CPPON_OBJ_TYPE == it.type )
+	{
+		if( (uint64_t) ( end - p ) < it.n )
+		{
+			code = CPPON_PARSE_UNEXPECTED_END;
+			return NULL;
+		}
+		it.s = p;
+		p += it.n;
+	}
+	return p;
+}
+
+/*
+ * Step over one whole value, returns the byte after it or NULL if it runs past end or nests deeper than CPPON_MAX_DEPTH.
+ * outer holds what is left of each container still open.
+ */
+static const uint8_t *binarySkip( const uint8_t *p, const uint8_t *end )
+{
+	uint64_t			outer[ CPPON_MAX_DEPTH ];
+	size_t				open = 0;
+	uint64_t			pending = 1;
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+
+	for( ;; )
+	{
+		if( ! pending )
+		{
+			if( ! open )
+			{
+				return p;
+			}
+			pending = outer[ --open ];
+			continue;
+		}
+		pending--;
+		if( ! ( p = binaryItem( p, end, it, code ) ) )
+		{
+			return NULL;
+		}
+		if( ARRAY_CPPON_OBJ_TYPE == it.type || MAP_CPPON_OBJ_TYPE == it.type )
+		{
+			if( CPPON_MAX_DEPTH <= open )
+			{
+				return NULL;
+			}
+			if( it.n )
+			{
+				outer[ open++ ] = pending;
+				pending = ( MAP_CPPON_OBJ_TYPE == it.type ) ? 2 * it.n : it.n;
+			}
+		}
+	}
+}
+
+/*
+ * One value of the binary encoding.  The counts up front let each map and array be sized once, though never larger than
+ * what is left of the buffer could hold, so a corrupt count can't force a huge allocation.
+ */
+CppON *CppONParser::binary()
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code = CPPON_PARSE_OK;
+	const char			*at = cur;
+	// cppcheck-suppress cstyleCast
+	const uint8_t		*p = binaryItem( (const uint8_t *) cur, (const uint8_t *) end, it, code );
+
+	if( ! p )
+	{
+		fail( code, at );
+		return NULL;
+	}
+	// cppcheck-suppress cstyleCast
+	cur = (const char *) p;
+	switch( it.type )
+	{
+		case MAP_CPPON_OBJ_TYPE:
+			if( ! nest() )
+			{
+				return NULL;
+			}
+			{
+				COMap *mp = newMap();
+				mp->reserve( (size_t) std::min<uint64_t>( it.n, (uint64_t) ( end - cur ) / 2 ) );
+				for( uint64_t i = 0; it.n > i; i++ )
+				{
+					CppONBinaryItem	k;
+					CppON			*obj;
+
+					at = cur;
+					// cppcheck-suppress cstyleCast
+					if( ! ( p = binaryItem( (const uint8_t *) cur, (const uint8_t *) end, k, code ) ) || STRING_CPPON_OBJ_TYPE != k.type )
+					{
+						fail( ( p ) ? CPPON_PARSE_EXPECTED_KEY : code, at );
+						delete mp;
+						return NULL;
+					}
+					// cppcheck-suppress cstyleCast
+					cur = (const char *) p;
+					if( ! ( obj = binary() ) )
+					{
+						delete mp;
+						return NULL;
+					}
+					// cppcheck-suppress cstyleCast
+					mp->put( std::string( (const char *) k.s, k.n ), obj, false );
+				}
+				nesting--;
+				return mp;
+			}
+		case ARRAY_CPPON_OBJ_TYPE:
+			if( ! nest() )
+			{
+				return NULL;
+			}
+			{
+				COArray *arr = newArray();
+				arr->reserve( (size_t) std::min<uint64_t>( it.n, (uint64_t) ( end - cur ) ) );
+				for( uint64_t i = 0; it.n > i; i++ )
+				{
+					CppON *obj = binary();
+					if( ! obj )
+					{
+						delete arr;
+						return NULL;
+					}
+					arr->put( obj );
+				}
+				nesting--;
+				return arr;
+			}
+		case STRING_CPPON_OBJ_TYPE:
+			{
+				COString *s = newString();
+				// cppcheck-suppress cstyleCast
+				( (std::string *) s->data )->assign( (const char *) it.s, it.n );
+				return s;
+			}
+		case INTEGER_CPPON_OBJ_TYPE:
+			return newInteger( (uint64_t) it.i );
+		case DOUBLE_CPPON_OBJ_TYPE:
+			{
+				CppON *d = newDouble( it.d );
+				if( 10 != it.precision )
+				{
+					// cppcheck-suppress cstyleCast
+					( (CODouble *) d )->Precision( (unsigned char) it.precision );
+				}
+				return d;
+			}
+		case BOOLEAN_CPPON_OBJ_TYPE:
+			return newBoolean( 0 != it.i );
+		default:
+			return newNull();
+	}
+}
+
+/*
+ * Build the tree toBinary() (or a writer in CPPON_WRITE_BINARY mode) encoded.  Like parseJson( str, len, err, arena ) it
+ * never prints, err.consumed is the size of the value and given an arena the tree is built in it.
+ */
+CppON *CppON::parseBinary( const char *buf, size_t len, CppONParseError &err, CppONArena *arena )
+{
+	CppON	*rtn = NULL;
+
+	if( buf )
+	{
+		CppONParser	p( buf, len, arena );
+		rtn = p.binary();
+		p.getError( err );
+	} else {
+		err.code = CPPON_PARSE_UNEXPECTED_END;
+		err.offset = err.consumed = 0;
+		err.line = err.column = 1;
+	}
+	return rtn;
+}
+
+CppONType CppONView::type() const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+	return ( binaryItem( cur, end, it, code ) ) ? it.type : UNKNOWN_CPPON_OBJ_TYPE;
+}
+
+size_t CppONView::size() const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+	return ( binaryItem( cur, end, it, code ) ) ? (size_t) it.n : 0;
+}
+
+int64_t CppONView::intValue() const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+
+	if( binaryItem( cur, end, it, code ) )
+	{
+		if( INTEGER_CPPON_OBJ_TYPE == it.type || BOOLEAN_CPPON_OBJ_TYPE == it.type )
+		{
+			return it.i;
+		} else if( DOUBLE_CPPON_OBJ_TYPE == it.type ) {
+			return (int64_t) it.d;
+		}
+	}
+	return 0;
+}
+
+double CppONView::doubleValue() const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+
+	if( binaryItem( cur, end, it, code ) )
+	{
+		if( DOUBLE_CPPON_OBJ_TYPE == it.type )
+		{
+			return it.d;
+		} else if( INTEGER_CPPON_OBJ_TYPE == it.type || BOOLEAN_CPPON_OBJ_TYPE == it.type ) {
+			return (double) it.i;
+		}
+	}
+	return 0.0;
+}
+
+bool CppONView::boolValue() const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+
+	if( binaryItem( cur, end, it, code ) )
+	{
+		if( INTEGER_CPPON_OBJ_TYPE == it.type || BOOLEAN_CPPON_OBJ_TYPE == it.type )
+		{
+			return 0 != it.i;
+		} else if( DOUBLE_CPPON_OBJ_TYPE == it.type ) {
+			return 0.0 != it.d;
+		}
+	}
+	return false;
+}
+
+const char *CppONView::stringValue( size_t &len ) const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+
+	len = 0;
+	if( binaryItem( cur, end, it, code ) && STRING_CPPON_OBJ_TYPE == it.type )
+	{
+		len = (size_t) it.n;
+		// cppcheck-suppress cstyleCast
+		return (const char *) it.s;
+	}
+	return NULL;
+}
+
+CppONView CppONView::first() const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+	const uint8_t		*p = binaryItem( cur, end, it, code );
+
+	if( p && it.n && ( MAP_CPPON_OBJ_TYPE == it.type || ARRAY_CPPON_OBJ_TYPE == it.type ) )
+	{
+		return CppONView( p, end );
+	}
+	return CppONView();
+}
+
+CppONView CppONView::next() const
+{
+	const uint8_t *p = binarySkip( cur, end );
+	return ( p ) ? CppONView( p, end ) : CppONView();
+}
+
+CppONView CppONView::at( size_t i ) const
+{
+	CppONBinaryItem		it;
+	CppONParseErrorCode	code;
+	const uint8_t		*p = binaryItem( cur, end, it, code );
+
+	if( ! p || ARRAY_CPPON_OBJ_TYPE != it.type || it.n <= i )
+	{
+		return CppONView();
+	}
+	while( p && i-- )
+	{
+		p = binarySkip( p, end );
+	}
+	return ( p ) ? CppONView( p, end ) : CppONView();
+}
+
+CppONView CppONView::find( const char *key, size_t len ) const
+{
+	CppONBinaryItem		it;
+	CppONBinaryItem		k;
+	CppONParseErrorCode	code;
+	const uint8_t		*p = binaryItem( cur, end, it, code );
+
+	if( ! p || MAP_CPPON_OBJ_TYPE != it.type )
+	{
+		return CppONView();
+	}
+	for( uint64_t i = 0; p && it.n > i; i++ )
+	{
+		if( ! ( p = binaryItem( p, end, k, code ) ) || STRING_CPPON_OBJ_TYPE != k.type )
+		{
+			break;
+		}
+		if( len == k.n && ! memcmp( key, k.s, len ) )
+		{
+			return CppONView( p, end );
+		}
+		p = binarySkip( p, end );
+	}
+	return CppONView();
+}
+
+/*
+ * Follow a compiled path the way parseSelect does:  a key only matches a member of a map and an index only an element of
+ * an array.
+ */
+CppONView CppONView::findElement( const CppONPath &path ) const
+{
+	CppONView	v = *this;
+
+	for( std::vector<CppONPath::Step>::const_iterator step = path.getSteps().begin(); path.getSteps().end() != step && v.cur; ++step )
+	{
+		v = ( 0 <= step->index ) ? v.at( (size_t) step->index ) : v.find( step->key.data(), step->key.size() );
+	}
+	return v;
+}
+
+size_t CppONView::bytes() const
+{
+	const uint8_t *p = binarySkip( cur, end );
+	return ( p ) ? (size_t) ( p - cur ) : 0;
+}
+
+CppON *CppONView::toCppON( CppONArena *arena ) const
+{
+	if( ! cur )
+	{
+		return NULL;
+	}
+	// cppcheck-suppress cstyleCast
+	CppONParser p( (const char *) cur, (size_t) ( end - cur ), arena );
+	return p.binary();
+}
+
+/****************************************************************************************/
+/*                                                                                      */
+/*                                    CppONArena                                        */
+/*                                                                                      */
+/****************************************************************************************/
+
+CppONArena::~CppONArena()
+{
+	for( std::vector<char *>::iterator it = blocks.begin(); blocks.end() != it; ++it )
+	{
+		free( *it );
+	}
+}
+
+/*
+ * Start a new block.  Requests bigger than the block size get a block of their own.
+ */
+void *CppONArena::grow( size_t sz )
+{
+	size_t	bs = ( sz > blockSize ) ? sz : blockSize;
+	char	*b = (char *) malloc( bs );
+
+	if( ! b )
+	{
+		throw std::bad_alloc();
+	}
+	if( blocks.empty() )
+	{
+		firstSize = bs;
+	}
+	blocks.push_back( b );
+	total += bs;
+	cur = b + sz;
+	limit = b + bs;
+	return b;
+}
+
+/*
+ * Release everything but the first block which is kept for reuse.  Any tree built in the arena must be gone by now.
+ */
+void CppONArena::clear()
+{
+	if( blocks.size() )
+	{
+		for( std::vector<char *>::iterator it = blocks.begin() + 1; blocks.end() != it; ++it )
+		{
+			free( *it );
+		}
+		blocks.resize( 1 );
+		cur = blocks[ 0 ];
+		limit = cur + firstSize;
+		total = firstSize;
+	}
+}
+
+/****************************************************************************************/
+/*                                                                                      */
+/*                                    CppONWriter                                       */
+/*                                                                                      */
+/****************************************************************************************/
+
+CppONWriter::CppONWriter( std::string &o, CppONWriteMode m ) : out( &o ), fixed( NULL ), fixedSize( 0 ), fp( NULL ), fd( -1 ), mode( m ),
+		error( false ), total( 0 ), used( 0 ), nextSize( 0 )
+{
+}
+
+CppONWriter::CppONWriter( char *buf, size_t size, CppONWriteMode m ) : out( NULL ), fixed( buf ), fixedSize( size ), fp( NULL ), fd( -1 ),
+		mode( m ), error( false ), total( 0 ), used( 0 ), nextSize( 0 )
+{
+	if( fixed && fixedSize )
+	{
+		fixed[ 0 ] = '\0';
+	}
+}
+
+CppONWriter::CppONWriter( FILE *f, CppONWriteMode m ) : out( NULL ), fixed( NULL ), fixedSize( 0 ), fp( f ), fd( -1 ), mode( m ),
+		error( false ), total( 0 ), used( 0 ), nextSize( 0 )
+{
+}
+
+CppONWriter::CppONWriter( int d, CppONWriteMode m ) : out( NULL ), fixed( NULL ), fixedSize( 0 ), fp( NULL ), fd( d ), mode( m ),
+		error( false ), total( 0 ), used( 0 ), nextSize( 0 )
+{
+}
+
+void CppONWriter::put( const char *s, size_t len )
+{
+	if( sizeof( chunk ) - used < len )
+	{
+		drain();
+		if( sizeof( chunk ) <= len )									// Too big to stage, hand it straight to the sink
+		{
+			emit( s, len );
+			return;
+		}
+	}
+	memcpy( chunk + used, s, len );
+	used += len;
+}
+
+/*
+ * Hand bytes to the sink.  A fixed buffer keeps its last byte for the terminating NUL.
+ */
+void CppONWriter::emit( const char *s, size_t len )
+{
+	if( ! len )
+	{
+		return;
+	}
+	if( out )
+	{
+		out->append( s, len );
+	} else if( fixed ) {
+		size_t room = ( fixedSize > total + 1 ) ? fixedSize - total - 1 : 0;
+		if( room < len )
+		{
+			error = true;
+		}
+		memcpy( fixed + total, s, ( room < len ) ? room : len );
+	} else if( fp ) {
+		if( len != fwrite( s, 1, len, fp ) )
+		{
+			error = true;
+		}
+	} else if( 0 <= fd ) {
+		for( size_t done = 0; done < len; )
+		{
+			ssize_t n = ::write( fd, s + done, len - done );
+			if( 0 < n )
+			{
+				done += n;
+			} else if( 0 > n && EINTR == errno ) {
+				continue;
+			} else {
+				error = true;
+				break;
+			}
+		}
+	}
+	total += len;
+}
+
+void CppONWriter::flush()
+{
+	drain();
+	if( fixed && fixedSize )
+	{
+		fixed[ ( total < fixedSize ) ? total : fixedSize - 1 ] = '\0';
+	} else if( fp ) {
+		fflush( fp );
+	}
+}
+
+CppONWriter &CppONWriter::write( CppON *obj, const char *indent )
+{
+	if( obj )
+	{
+		switch( mode )
+		{
+			case CPPON_WRITE_PRETTY:
+			case CPPON_WRITE_JSON:
+				{
+					std::string ind( indent ? indent : "" );
+					pretty( obj, ind );
+				}
+				break;
+			case CPPON_WRITE_TNET:
+				sizes.clear();
+				nextSize = 0;
+				tnetSize( obj );
+				tnet( obj );
+				break;
+			case CPPON_WRITE_BINARY:
+				binary( obj );
+				break;
+			default:
+				compact( obj );
+				break;
+		}
+	}
+	return *this;
+}
+
+static const char DigitPairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+								 "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+								 "8081828384858687888990919293949596979899";
+
+static const uint64_t IntPowersOfTen[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+										100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+										10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+										100000000000000000ULL };
+
+/*
+ * Write v in decimal, two digits per division, and return the length.  buf needs 20 bytes, it is not NUL terminated.
+ */
+static size_t formatUnsigned( uint64_t v, char *buf )
+{
+	char    tmp[ 20 ];
+	char    *p = tmp + sizeof( tmp );
+
+	while( 100 <= v )
+	{
+		unsigned r = (unsigned) ( v % 100 );
+		v /= 100;
+		p -= 2;
+		memcpy( p, DigitPairs + 2 * r, 2 );
+	}
+	if( 10 <= v )
+	{
+		p -= 2;
+		memcpy( p, DigitPairs + 2 * v, 2 );
+	} else {
+		*--p = (char) ( '0' + v );
+	}
+	size_t len = tmp + sizeof( tmp ) - p;
+	memcpy( buf, p, len );
+	return len;
+}
+
+/*
+ * v as exactly "width" digits with leading zeros.
+ */
+static void formatPadded( uint64_t v, size_t width, char *buf )
+{
+	for( char *p = buf + width; buf < p; )
+	{
+		if( buf + 1 < p )
+		{
+			unsigned r = (unsigned) ( v % 100 );
+			v /= 100;
+			p -= 2;
+			memcpy( p, DigitPairs + 2 * r, 2 );
+		} else {
+			*--p = (char) ( '0' + v % 10 );
+		}
+	}
+}
+
+/*
+ * Integers are written the way they always were, including the one byte kind which goes out as a character.
+ * The result is NUL terminated, buf needs 24 bytes.
+ */
+static size_t formatInteger( COInteger *n, char *buf )
+{
+	size_t  len = 0;
+	int64_t v = n->longValue();
+
+	switch( n->size() )
+	{
+		case sizeof( char ):
+			buf[ len++ ] = (char) v;
+			break;
+		case sizeof( short ):
+		case sizeof( int ):
+		case sizeof( long long ):
+			if( 0 > v )
+			{
+				buf[ len++ ] = '-';
+			}
+			len += formatUnsigned( ( 0 > v ) ? 0 - (uint64_t) v : (uint64_t) v, buf + len );
+			break;
+		default:
+			break;
+	}
+	buf[ len ] = '\0';
+	return len;
+}
+
+/*
+ * p + e is exactly a * b.  With a hardware fma that is one instruction, otherwise Dekker's product is used.
+ */
+static void twoProduct( double a, double b, double &p, double &e )
+{
+	p = a * b;
+#ifdef FP_FAST_FMA
+	e = fma( a, b, -p );
+#else
+	const double split = 134217729.0;									// 2^27 + 1
+	double t = split * a;
+	double ah = t - ( t - a );
+	double al = a - ah;
+	t = split * b;
+	double bh = t - ( t - b );
+	double bl = b - bh;
+	e = ( ( ah * bh - p ) + ah * bl + al * bh ) + al * bl;
+#endif
+}
+
+/*
+ * The same text as printf( "%.*f", precision, v ) for 0 - 16 places, from integer arithmetic.  The scaled value is
+ * carried exactly (as a product and its rounding error) so ties round to even on the true binary value just as printf
+ * does.  Returns 0 when the scaled value is too large for this path.
+ */
+static size_t formatFixed( double v, int precision, char *buf )
+{
+	double  prod;
+	double  err;
+
+	twoProduct( fabs( v ), PowersOfTen[ precision ], prod, err );
+	if( !( 4503599627370496.0 > prod ) )								// 2^52, also refuses NaN and infinity
+	{
+		return 0;
+	}
+	double      fl = floor( prod );
+	double      frac = prod - fl;
+	uint64_t    m = (uint64_t) fl;
+	if( 0.5 < frac || ( 0.5 == frac && ( 0 < err || ( 0 == err && ( m & 1 ) ) ) ) )
+	{
+		m++;
+	}
+
+	size_t len = 0;
+	if( signbit( v ) )
+	{
+		buf[ len++ ] = '-';
+	}
+	len += formatUnsigned( m / IntPowersOfTen[ precision ], buf + len );
+	if( precision )
+	{
+		buf[ len++ ] = '.';
+		formatPadded( m % IntPowersOfTen[ precision ], precision, buf + len );
+		len += precision;
+	}
+	buf[ len ] = '\0';
+	return len;
+}
+
+/*
+ * The shortest text that reads back as exactly v.  For a fixed number of places p, m / 10^p with m below 2^53 and p no
+ * more than 22 is one correctly rounded division, which is exactly what strtod() makes of the decimal "m e-p", so the
+ * first p whose nearest m divides back to v gives the shortest fixed notation.  That finds every value of 1e-3 or more
+ * with up to 15 significant digits, the rest try %.15g (only below 1e-3 or from 2^53 up), %.16g and %.17g checked with
+ * strtod().  A ".0" is added when needed so the text still reads back as a double.  JSON has no NaN or infinity, those
+ * are written as null.
+ */
+static size_t formatShortest( double v, char *buf )
+{
+	double  a = fabs( v );
+	size_t  len = 0;
+
+	if( ! isfinite( v ) )
+	{
+		strcpy( buf, "null" );
+		return 4;
+	}
+
+	if( 9007199254740992.0 > a )										// 2^53
+	{
+		for( int p = 0; 17 >= p; p++ )
+		{
+			double x = a * PowersOfTen[ p ];
+			if( !( 9007199254740992.0 > x ) )
+			{
+				break;
+			}
+			uint64_t guess = (uint64_t) ( x + 0.5 );
+			for( uint64_t m = ( guess ? guess - 1 : 0 ); guess + 1 >= m; m++ )
+			{
+				if( (double) m / PowersOfTen[ p ] == a )
+				{
+					if( signbit( v ) )
+					{
+						buf[ len++ ] = '-';
+					}
+					len += formatUnsigned( m / IntPowersOfTen[ p ], buf + len );
+					buf[ len++ ] = '.';
+					if( p )
+					{
+						formatPadded( m % IntPowersOfTen[ p ], p, buf + len );
+						len += p;
+					} else {
+						buf[ len++ ] = '0';
+					}
+					buf[ len ] = '\0';
+					return len;
+				}
+			}
+		}
+	}
+
+	for( int digits = ( 1e-3 <= a && 9007199254740992.0 > a ) ? 16 : 15; 17 >= digits; digits++ )
+	{
+		len = snprintf( buf, 32, "%.*g", digits, v );
+		if( strtod( buf, NULL ) == v )
+		{
+			break;
+		}
+	}
+	if( ! strpbrk( buf, ".eE" ) )
+	{
+		strcpy( buf + len, ".0" );
+		len += 2;
+	}
+	return len;
+}
+
+/*
+ * JSON and c_str() honor the object's precision when it is set (0 - 16 places) and otherwise write the shortest text that
+ * reads back as the same double, TNet always uses the shortest text.  The result is NUL terminated, buf needs 64 bytes.
+ */
+static size_t formatDouble( double v, int p, char *buf )
+{
+	size_t  len;
+
+	if( 0 <= p && 16 >= p && isfinite( v ) )
+	{
+		if( ( len = formatFixed( v, p, buf ) ) )
+		{
+			return len;
+		}
+		int l = snprintf( buf, 64, "%.*lf", (int) p, v );
+		if( 0 < l && 64 > l )
+		{
+			return l;
+		}
+	}
+	return formatShortest( v, buf );
+}
+
+static size_t formatDouble( CODouble *n, char *buf, bool tnet )
+{
+	return formatDouble( n->doubleValue(), ( tnet ) ? -1 : (int) (char) n->Precision(), buf );
+}
+
+/*
+ * The JSON string encoding used by COString::toJsonString().
+ */
+static const char *jsonEscape( unsigned char ch )
+{
+	switch( ch )
+	{
+		case '"':	return "%22";
+		case '{':	return "%7B";
+		case '}':	return "%7D";
+		case '<':	return "%3C";
+		case '>':	return "%3E";
+		case '\\':	return "%5C";
+		case '\'':	return "%60";
+		case '^':	return "%5E";
+		case '&':	return "%26";
+		case '\r':	return "%0D";
+		case '\n':
+		case '\a':	return "%0A";
+		case '\t':	return " ";
+		default:	return NULL;
+	}
+}
+
+/*
+ * Standard JSON string escapes, which every JSON reader (our parser included) turns back into the original bytes.  buf takes
+ * the \u form of the other control characters.
+ */
+static const char *jsonStandardEscape( unsigned char ch, char *buf )
+{
+	switch( ch )
+	{
+		case '"':	return "\\\"";
+		case '\\':	return "\\\\";
+		case '\b':	return "\\b";
+		case '\f':	return "\\f";
+		case '\n':	return "\\n";
+		case '\r':	return "\\r";
+		case '\t':	return "\\t";
+		default:
+			if( 0x20 > ch )
+			{
+				snprintf( buf, 8, "\\u%04X", (unsigned) ch );
+				return buf;
+			}
+			return NULL;
+	}
+}
+
+void CppONWriter::putString( const char *s, size_t len )
+{
+	const char  *cPtr = s;
+	const char  *run = cPtr;
+	const char  *end = cPtr + len;
+	char		buf[ 8 ];
+
+	put( '"' );
+	for( ; end > cPtr; cPtr++ )
+	{
+		const char *e = ( CPPON_WRITE_JSON == mode ) ? jsonStandardEscape( (unsigned char) *cPtr, buf ) : jsonEscape( (unsigned char) *cPtr );
+		if( e )
+		{
+			put( run, cPtr - run );
+			put( e );
+			run = cPtr + 1;
+		}
+	}
+	put( run, cPtr - run );
+	put( '"' );
+}
+
+void CppONWriter::putInt( int64_t v )
+{
+	char    buf[ 24 ];
+	size_t  len = 0;
+
+	if( 0 > v )
+	{
+		buf[ len++ ] = '-';
+	}
+	len += formatUnsigned( ( 0 > v ) ? 0 - (uint64_t) v : (uint64_t) v, buf + len );
+	put( buf, len );
+}
+
+void CppONWriter::putDouble( double v, int precision )
+{
+	char    buf[ 64 ];
+	put( buf, formatDouble( v, precision, buf ) );
+}
+
+void CppONWriter::leaf( CppON *obj )
+{
+	char    buf[ 64 ];
+	switch( obj->type() )
+	{
+		case INTEGER_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			put( buf, formatInteger( (COInteger *) obj, buf ) );
+			break;
+		case DOUBLE_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			put( buf, formatDouble( (CODouble *) obj, buf, false ) );
+			break;
+		case STRING_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			if( ( (COString *) obj )->value() )
+			{
+				// cppcheck-suppress cstyleCast
+				quoted( *( (COString *) obj )->value() );
+			}
+			break;
+		case BOOLEAN_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			put( ( (COBoolean *) obj )->value() ? "true" : "false" );
+			break;
+		case NULL_CPPON_OBJ_TYPE:
+			put( "null", 4 );
+			break;
+		default:
+			break;
+	}
+}
+
+void CppONWriter::compact( CppON *obj )
+{
+	if( CppON::isMap( obj ) )
+	{
+		bool first = true;
+		put( '{' );
+		// cppcheck-suppress cstyleCast
+		COMapData	*m = (COMapData *) obj->peek();
+		for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+		{
+			if( ! first )
+			{
+				put( ',' );
+			}
+			first = false;
+			put( '"' );
+			put( it->first.data(), it->first.size() );
+			put( "\":", 2 );
+			compact( it->second );
+		}
+		put( '}' );
+	} else if( CppON::isArray( obj ) ) {
+		bool first = true;
+		put( '[' );
+		// cppcheck-suppress cstyleCast
+		std::vector<CppON *>	*v = (std::vector<CppON *> *) obj->peek();
+		for( std::vector<CppON *>::iterator it = v->begin(); v->end() != it; ++it )
+		{
+			if( ! first )
+			{
+				put( ',' );
+			}
+			first = false;
+			compact( *it );
+		}
+		put( ']' );
+	} else if( obj ) {
+		leaf( obj );
+	}
+}
+
+/*
+ * The layout of toJsonString( indent ): two spaces per level, a container that is a map member starts on the next line
+ * and a container that is an array element is indented twice.
+ */
+void CppONWriter::pretty( CppON *obj, std::string &indent )
+{
+	if( CppON::isMap( obj ) || CppON::isArray( obj ) )
+	{
+		bool        first = true;
+		bool        isMap = CppON::isMap( obj );
+		std::string newIndent = indent;
+
+		newIndent.append( "  " );
+		put( indent.data(), indent.size() );
+		put( isMap ? "{\n" : "[\n", 2 );
+		if( isMap )
+		{
+			// cppcheck-suppress cstyleCast
+			COMapData	*m = (COMapData *) obj->peek();
+			for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+			{
+				if( ! first )
+				{
+					put( ",\n", 2 );
+				}
+				first = false;
+				put( newIndent.data(), newIndent.size() );
+				if( CPPON_WRITE_JSON == mode )
+				{
+					quoted( it->first );
+					put( ": ", 2 );
+				} else {
+					put( '"' );
+					put( it->first.data(), it->first.size() );
+					put( "\": ", 3 );
+				}
+				if( CppON::isMap( it->second ) || CppON::isArray( it->second ) )
+				{
+					put( '\n' );
+					pretty( it->second, newIndent );
+				} else if( it->second ) {
+					leaf( it->second );
+				}
+			}
+		} else {
+			// cppcheck-suppress cstyleCast
+			std::vector<CppON *>	*v = (std::vector<CppON *> *) obj->peek();
+			for( std::vector<CppON *>::iterator it = v->begin(); v->end() != it; ++it )
+			{
+				if( ! first )
+				{
+					put( ",\n", 2 );
+				}
+				first = false;
+				put( newIndent.data(), newIndent.size() );
+				if( CppON::isMap( *it ) || CppON::isArray( *it ) )
+				{
+					pretty( *it, newIndent );
+				} else if( *it ) {
+					leaf( *it );
+				}
+			}
+		}
+		put( '\n' );
+		put( indent.data(), indent.size() );
+		put( isMap ? '}' : ']' );
+	} else if( obj ) {
+		leaf( obj );
+	}
+}
+
+/*
+ * The payload of a TNet leaf, either formatted into buf or pointing at the string itself.
+ */
+static const char *tnetPayload( CppON *obj, char *buf, size_t *len, char *styp )
+{
+	switch( obj->type() )
+	{
+		case INTEGER_CPPON_OBJ_TYPE:
+			*styp = '#';
+			// cppcheck-suppress cstyleCast
+			*len = formatInteger( (COInteger *) obj, buf );
+			return buf;
+		case DOUBLE_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			if( ! isfinite( ( (CODouble *) obj )->doubleValue() ) )
+			{
+				*styp = '~';												// null, as in JSON
+				*len = 0;
+				return "";
+			}
+			*styp = '^';
+			// cppcheck-suppress cstyleCast
+			*len = formatDouble( (CODouble *) obj, buf, true );
+			return buf;
+		case STRING_CPPON_OBJ_TYPE:
+			*styp = ',';
+			// cppcheck-suppress cstyleCast
+			if( ( (COString *) obj )->value() )
+			{
+				// cppcheck-suppress cstyleCast
+				const char *cPtr = ( (COString *) obj )->c_str();
+				*len = strlen( cPtr );
+				return cPtr;
+			}
+			*len = 0;
+			return "";
+		case BOOLEAN_CPPON_OBJ_TYPE:
+			*styp = '!';
+			// cppcheck-suppress cstyleCast
+			*len = ( ( (COBoolean *) obj )->value() ) ? 4 : 5;
+			// cppcheck-suppress cstyleCast
+			return ( ( (COBoolean *) obj )->value() ) ? "true" : "false";
+		case NULL_CPPON_OBJ_TYPE:
+			*styp = '~';
+			*len = 0;
+			return "";
+		default:
+			*styp = '\0';
+			*len = 0;
+			return NULL;
+	}
+}
+
+static size_t tnetDigits( size_t len )
+{
+	size_t d = 1;
+	for( ; 10 <= len; len /= 10 )
+	{
+		d++;
+	}
+	return d;
+}
+
+void CppONWriter::tnetHeader( size_t len )
+{
+	char buf[ 24 ];
+	put( buf, snprintf( buf, sizeof( buf ), "%zu:", len ) );
+}
+
+/*
+ * Sizing pass.  Returns the full encoded size of obj and records the payload size of every container in pre-order so the
+ * writing pass can read them back in the same order.
+ */
+size_t CppONWriter::tnetSize( CppON *obj )
+{
+	size_t payload = 0;
+	if( CppON::isMap( obj ) || CppON::isArray( obj ) )
+	{
+		size_t slot = sizes.size();
+		sizes.push_back( 0 );
+		if( CppON::isMap( obj ) )
+		{
+			// cppcheck-suppress cstyleCast
+			COMapData	*m = (COMapData *) obj->peek();
+			for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+			{
+				size_t k = strlen( it->first.c_str() );
+				payload += tnetDigits( k ) + k + 2 + tnetSize( it->second );
+			}
+		} else {
+			// cppcheck-suppress cstyleCast
+			std::vector<CppON *>	*v = (std::vector<CppON *> *) obj->peek();
+			for( std::vector<CppON *>::iterator it = v->begin(); v->end() != it; ++it )
+			{
+				payload += tnetSize( *it );
+			}
+		}
+		sizes[ slot ] = payload;
+	} else if( obj ) {
+		char    buf[ 64 ];
+		char    styp;
+		if( ! tnetPayload( obj, buf, &payload, &styp ) )
+		{
+			return 0;
+		}
+	} else {
+		return 0;
+	}
+	return tnetDigits( payload ) + payload + 2;
+}
+
+void CppONWriter::tnet( CppON *obj )
+{
+	if( CppON::isMap( obj ) )
+	{
+		tnetHeader( sizes[ nextSize++ ] );
+		// cppcheck-suppress cstyleCast
+		COMapData	*m = (COMapData *) obj->peek();
+		for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+		{
+			size_t k = strlen( it->first.c_str() );
+			tnetHeader( k );
+			put( it->first.c_str(), k );
+			put( ',' );
+			tnet( it->second );
+		}
+		put( '}' );
+	} else if( CppON::isArray( obj ) ) {
+		tnetHeader( sizes[ nextSize++ ] );
+		// cppcheck-suppress cstyleCast
+		std::vector<CppON *>	*v = (std::vector<CppON *> *) obj->peek();
+		for( std::vector<CppON *>::iterator it = v->begin(); v->end() != it; ++it )
+		{
+			tnet( *it );
+		}
+		put( ']' );
+	} else if( obj ) {
+		char        buf[ 64 ];
+		char        styp;
+		size_t      len;
+		const char  *payload = tnetPayload( obj, buf, &len, &styp );
+		if( payload )
+		{
+			tnetHeader( len );
+			put( payload, len );
+			put( styp );
+		}
+	}
+}
+
+void CppONWriter::binaryLE( uint64_t v, unsigned n )
+{
+	char b[ 8 ];
+	for( unsigned i = 0; n > i; i++ )
+	{
+		b[ i ] = (char) ( v >> ( 8 * i ) );
+	}
+	put( b, n );
+}
+
+/*
+ * The tag and count of a map or an array.  fix is the tag that holds counts up to 15 itself, tag the one with a 16 bit count.
+ */
+void CppONWriter::binaryCount( uint8_t fix, uint8_t tag, size_t n )
+{
+	if( 16 > n )
+	{
+		put( (char) ( fix | n ) );
+	} else if( 0xFFFF >= n ) {
+		put( (char) tag );
+		binaryLE( n, 2 );
+	} else {
+		put( (char) ( tag + 1 ) );
+		binaryLE( n, 4 );
+	}
+}
+
+void CppONWriter::binaryString( const char *s, size_t len )
+{
+	if( 32 > len )
+	{
+		put( (char) ( CPPON_BIN_FIXSTR | len ) );
+	} else {
+		unsigned w = ( 0xFF >= len ) ? 0 : ( 0xFFFF >= len ) ? 1 : 2;
+		put( (char) ( CPPON_BIN_STR8 + w ) );
+		binaryLE( len, 1U << w );
+	}
+	put( s, len );
+}
+
+/*
+ * The fewest bytes that hold v.
+ */
+void CppONWriter::binaryInt( int64_t v )
+{
+	unsigned w;
+
+	if( -32 <= v && 0x80 > v )
+	{
+		put( (char) v );
+	} else if( 0 < v ) {
+		w = ( 0xFF >= v ) ? 0 : ( 0xFFFF >= v ) ? 1 : ( 0xFFFFFFFFLL >= v ) ? 2 : 3;
+		put( (char) ( CPPON_BIN_UINT8 + w ) );
+		binaryLE( (uint64_t) v, 1U << w );
+	} else {
+		w = ( -128 <= v ) ? 0 : ( -32768 <= v ) ? 1 : ( -2147483648LL <= v ) ? 2 : 3;
+		put( (char) ( CPPON_BIN_INT8 + w ) );
+		binaryLE( (uint64_t) v, 1U << w );
+	}
+}
+
+void CppONWriter::binary( CppON *obj )
+{
+	switch( ( obj ) ? obj->type() : NULL_CPPON_OBJ_TYPE )
+	{
+		case MAP_CPPON_OBJ_TYPE:
+			{
+				// cppcheck-suppress cstyleCast
+				COMapData	*m = (COMapData *) obj->peek();
+				binaryCount( CPPON_BIN_FIXMAP, CPPON_BIN_MAP16, m->size() );
+				for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+				{
+					binaryString( it->first.data(), it->first.size() );
+					binary( it->second );
+				}
+			}
+			break;
+		case ARRAY_CPPON_OBJ_TYPE:
+			{
+				// cppcheck-suppress cstyleCast
+				std::vector<CppON *>	*v = (std::vector<CppON *> *) obj->peek();
+				binaryCount( CPPON_BIN_FIXARRAY, CPPON_BIN_ARRAY16, v->size() );
+				for( std::vector<CppON *>::iterator it = v->begin(); v->end() != it; ++it )
+				{
+					binary( *it );
+				}
+			}
+			break;
+		case STRING_CPPON_OBJ_TYPE:
+			{
+				// cppcheck-suppress cstyleCast
+				std::string *s = ( (COString *) obj )->value();
+				binaryString( ( s ) ? s->data() : "", ( s ) ? s->size() : 0 );
+			}
+			break;
+		case INTEGER_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			binaryInt( ( (COInteger *) obj )->longValue() );
+			break;
+		case DOUBLE_CPPON_OBJ_TYPE:
+			{
+				// cppcheck-suppress cstyleCast
+				double		d = ( (CODouble *) obj )->doubleValue();
+				// cppcheck-suppress cstyleCast
+				char		p = (char) ( (CODouble *) obj )->Precision();
+				uint64_t	bits;
+
+				memcpy( &bits, &d, sizeof( bits ) );
+				if( 10 == p )
+				{
+					put( (char) CPPON_BIN_DOUBLE );
+				} else {
+					put( (char) CPPON_BIN_DOUBLE_PREC );
+					put( p );
+				}
+				binaryLE( bits, 8 );
+			}
+			break;
+		case BOOLEAN_CPPON_OBJ_TYPE:
+			// cppcheck-suppress cstyleCast
+			put( (char) ( ( (COBoolean *) obj )->value() ? CPPON_BIN_TRUE : CPPON_BIN_FALSE ) );
+			break;
+		default:
+			put( (char) CPPON_BIN_NULL );											// keeps the container's count right
+			break;
+	}
+}
+
+#if 0
+CppON *CppON::parseJson( const char *str )
+{
+    CppON     *rtn = NULL;
+    string tabs = "";
+
+    if( str )
+    {
+        json_t      *root = NULL;
+        json_error_t  error;
+        char      *np;
+        int       cnt = strtol( str, &np, 0 );      								// Check to see if it is a tnetstring
+        if( np )
+        {
+            np++;
+            if( cnt && ',' == np[ cnt ] )
+            {
+                char *tmp = strdup( np );                							// make a copy so it can be modified
+                tmp[ cnt ] = '\0';                      							// remove the ',' at  the end of it
+                root = json_loads( tmp, 0, &error );    							// load it as JSON
+                free( tmp );
+            } else if ( cnt ) {
+                root = json_loads( np, 0, &error );      							// load it as JSON
+            }
+        }
+
+    	while( ' ' == *str || '\t' == *str || '\n' == *str )						// Trim beginning of string
+    	{
+    		str++;
+    	}
+        if( '"' != str[ 0 ] )
+        {
+            if( !root )                                  							// I guess it wasn't TNetstring so load it as JSON
+            {
+                if( !( str && str[ 0 ] ) )
+                {
+                    fprintf( stderr, "%s[%d] Error: Attempt to parse zero length JSON string\n",__FILE__, __LINE__ );
+                }
+                root = json_loads( str, 0, &error );
+            }
+            if( ! root  )
+            {
+                fprintf( stderr, "%s[%d] Error: on line %d %s\n", __FILE__,__LINE__, error.line, error.text );
+                fprintf( stderr, "%s\n",str );
+                return NULL;
+            }
+
+            rtn = parseJson( root, tabs );
+            json_decref( root );
+        } else {
+        	std::string s( "{" );
+        	s.append( str );
+        	s += "}";
+
+            if( !root )                                  							// I guess it wasn't TNetstring so load it as JSON
+            {
+                root = json_loads( s.c_str(), 0, &error );
+            }
+            if( ! root  )
+            {
+                fprintf( stderr, "%s[%d] Error: on line %d %s\n", __FILE__,__LINE__, error.line, error.text );
+                fprintf( stderr, "%s\n",str );
+            } else {
+            	COMap *mp = (COMap *) parseJson( root, tabs );
+            	rtn = mp->extract( mp->begin()->first.c_str() );
+            	delete( mp );
+            	json_decref( root );
+            }
+        }
+    } else {
+        fprintf( stderr, "ERROR: Asked to parse NULL JSON string\n" );
+    }
+    return rtn;
+}
+#endif
+
+/****************************************************************************************/
+/*                                                                                      */
+/*                                    CppONFileImage                                    */
+/*                                                                                      */
+/****************************************************************************************/
+
+/*
+ * The whole contents of a file, ready to be handed to the length aware parser.
+ *
+ * Regular files are mmap'd read only and parsed straight out of the page cache so a large configuration file costs one
+ * fstat and one mmap instead of a libc call and a possible realloc per byte.  Anything that can't be mapped (pipes,
+ * character devices, /proc files that report a zero size) is read with read() into a buffer that doubles as it fills.
+ * The mapping is never NUL terminated, CppONParser is bounded by the length so it never needs to be.
+ */
+class CppONFileImage
+{
+public:
+	explicit	CppONFileImage( const char *path ) : map( NULL ), buf( NULL ), len( 0 ) { load( path ); }
+				~CppONFileImage();
+	bool		ok() const { return NULL != map || NULL != buf; }
+	const char	*data() const { return ( map ) ? ( const char * ) map : buf; }
+	size_t		length() const { return len; }
+private:
+				CppONFileImage( const CppONFileImage & );
+	CppONFileImage	&operator = ( const CppONFileImage & );
+	void		load( const char *path );
+	bool		slurp( int fd );
+
+	void		*map;
+	char		*buf;
+	size_t		len;
+};
+
+CppONFileImage::~CppONFileImage()
+{
+	if( map )
+	{
+		munmap( map, len );
+	}
+	free( buf );
+}
+
+void CppONFileImage::load( const char *path )
+{
+	struct stat	st;
+	int			fd;
+
+	if( ! path || 0 > ( fd = open( path, O_RDONLY | O_CLOEXEC ) ) )
+	{
+		return;
+	}
+	if( fstat( fd, &st ) )
+	{
+		close( fd );
+		return;
+	}
+	if( S_ISDIR( st.st_mode ) )
+	{
+		errno = EISDIR;
+	} else if( S_ISREG( st.st_mode ) && 0 < st.st_size ) {
+		len = ( size_t ) st.st_size;
+		if( MAP_FAILED == ( map = mmap( NULL, len, PROT_READ, MAP_PRIVATE, fd, 0 ) ) )
+		{
+			map = NULL;
+			len = 0;
+			slurp( fd );										// e.g. a file system that can't mmap, just read it
+		} else {
+			madvise( map, len, MADV_SEQUENTIAL );
+		}
+	} else {
+		slurp( fd );
+	}
+	close( fd );
+}
+
+bool CppONFileImage::slurp( int fd )
+{
+	size_t		sz = 64 * 1024;
+	ssize_t		rd;
+
+	len = 0;
+	if( !( buf = ( char * ) malloc( sz ) ) )
+	{
+		return false;
+	}
+	for( ;; )
+	{
+		if( len == sz )
+		{
+			char *nb = ( char * ) realloc( buf, sz *= 2 );
+			if( ! nb )
+			{
+				free( buf );
+				buf = NULL;
+				len = 0;
+				errno = ENOMEM;
+				return false;
+			}
+			buf = nb;
+		}
+		if( 0 < ( rd = read( fd, buf + len, sz - len ) ) )
+		{
+			len += ( size_t ) rd;
+		} else if( 0 == rd ) {
+			return true;
+		} else if( EINTR != errno ) {
+			free( buf );
+			buf = NULL;
+			len = 0;
+			return false;
+		}
+	}
+}
+
+/*
+ * Read and parse a JSON (or TNet) file.  See CppONFileImage, the file is parsed in place without being copied.
+ */
+// cppcheck-suppress unusedFunction
+CppON *CppON::parseJsonFile( const char *path )
+{
+    CppONFileImage  img( path );
+
+    if( ! img.ok() )
+    {
+        char estr[ 1024 ];
+        snprintf( estr, 1023, "Failed to open JSON FILE \"%s\"", ( path ) ? path : "NULL" );
+        perror( estr );
+        return NULL;
+    }
+    return parseJson( img.data(), img.length() );
+}
+
+CppON *CppON::readObj( FILE *fp )
+{
+	CppON 		*rtn = NULL;
+	int			otype = -1;
+	int			stype = -1;
+	unsigned	rd = 0;
+	int			c;
+	unsigned	levels = 0;
+	bool 		done = false;
+
+	if( fp )
+	{
+	    unsigned	sz = 1024;
+	    char    	*buf,*bSave;
+
+	    if( !( buf = (char *) malloc( sz ) ) )
+	    {
+	        fclose( fp );
+	        perror( "malloc Memory allocation error" );
+	    } else {
+	    	buf[ 0 ] = '\0';
+	    	while( 0 > otype && EOF != ( c = fgetc( fp ) ) )								// Read characters until we get the first character of the json
+	    	{
+	    		if( '{' == c )																// Start of a Map?
+	    		{
+	    			levels = 1;
+	    			otype = 0;
+	    		} else if( '\"' == c ) {													// Start of an Object?
+	    			levels = 1;
+	    			otype = 2;
+	    		} else if( '[' == c ) {														// Start of an Array?
+	    			levels = 1;
+	    			otype = 1;
+	    		}
+	    	}
+
+	    	if( 0 <= otype )																// if we got a '"', '{' or a '[' then we may have something
+	    	{
+	    		buf[ rd++ ] = c;
+	    	    buf[ rd ] = '\0';
+	    	    while( !done && EOF != ( c = fgetc( fp ) ) )
+	    	    {
+	    	        buf[ rd++ ] = ( char ) c;
+
+	    	        if( rd == sz )
+	    	        {
+	    	            if( !( buf = (char *) realloc( (void *) (bSave = buf ), sz += 512 ) ) )
+	    	            {
+	    	                perror( bSave );
+	    	                free( bSave );
 	    	                break;
 	    	            }
 	    	        }
-		    	    buf[ rd ] = '\0';
+		    	    buf[ rd ] = '\0';
+
+	    	        switch ( otype )
+	    	        {
+	    	        	case 0:
+	    	        		if( '}' == c )
+	    	        		{
+	    	        			if( !( --levels ) )
+	    	        			{
+	    	        				done = true;
+	    	        				break;
+	    	        			}
+	    	        		} else if( '{' == c ) {
+	    	        			levels++;
+	    	        		}
+	    	        		break;
+	    	        	case 2:
+	    	        		if( 1 == levels && '\"' == c )
+	    	        		{
+	    	        			levels = 2;
+	    	        		} else if( 2 == levels && ':' == c ) {
+	    	        			levels = 3;
+	    	        		} else if( 3 == levels ) {
+	    	        			if( 0 > stype )
+	    	        			{
+	    	        				if( '\"' == c )
+	    	        				{
+	    	        					stype = 0;
+	    	        					levels = 4;
+	    	        				} else if( '{' == c) {
+	    	        					levels = 4;
+	    	        					stype = 1;
+	    	       					} else if( '[' == c ) {
+	    	       						levels = 4;
+	    	       						stype = 2;
+	    	       					} else if ( ('0' <= c && c <= 9 ) || '-' == c || '+' == c ) {
+	    	       						levels = 4;
+	    	       						stype = 3;
+	    	       					} else if( 't' == c || 'T' == c	) {								// true?
+	    	       						stype = 4;
+	    	       						levels = 4;
+	    	       					} else if( 'f' == c || 'F' == c ) {								// false?
+	    	       						stype = 5;
+	    	       						levels = 4;
+	    	       					}
+	    	        			}
+	    	        		} else if( 4 <= levels ) {
+	    	        			if( 0 == stype  && '\"' == c )										// string
+	    	        			{
+ 	    	        				done = true;
+	    	        			} else if ( 1 == stype ) {											// map
+	    	        				if( '{' == c )
+									{
+										levels++;
+									} else if( '}' == c ) {
+										if( 3 == --levels )
+										{
+											done = true;
+										}
+									}
+	    	        			} else if ( 2 == stype ) {											// array
+	    	        				if( '[' == c )
+									{
+										levels++;
+									} else if( ']' == c ) {
+										if( 3 == --levels )
+										{
+											done = true;
+										}
+									}
+	    	        			} else if( 3 == stype ) {											// number
+	    	        				if( ( '0' > c || '9' < c ) && '.' != c )
+	    	        				{
+	    	        					done = true;
+	    	        				}
+	    	        			} else if( 4 == stype ) {											// boolean true?
+	    	        				char tc = '\0';
+	    	        				switch( levels )
+	    	        				{
+	    	        					case 4:														// 'r'
+	    	        						tc = 'r';
+	    	        						break;
+	    	        					case 5:														// 'u'
+	    	        						tc = 'u';
+	    	        						break;
+	    	        					case 6:														// 'e'
+	    	        						tc = 'e';
+	    	        						break;
+	    	        				}
+	        						if( tc == tolower( c ) )
+	        						{
+	        							if( 7 == ++levels )
+	        							{
+	        								done = true;
+	        								rtn = new COBoolean( true );
+		        							free( buf );
+		        							buf = NULL;
+	        							}
+	        						} else {
+	        							done = true;
+	        							free( buf );
+	        							buf = NULL;
+	        						}
+
+	    	        			} else if( 5 == stype ) {											// boolean false?
+	    	        				char tc = '\0';
+	    	        				switch( levels )
+	    	        				{
+	    	        					case 4:														// 'a'
+	    	        						tc = 'a';
+	    	        						break;
+	    	        					case 5:														// 'l'
+	    	        						tc = 'l';
+	    	        						break;
+	    	        					case 6:														// 's'
+	    	        						tc = 's';
+	    	        						break;
+	    	        					default:													// 'e'
+	    	        						tc = 'e';
+	    	        						break;
+	    	        				}
+	        						if( tc == tolower( c ) )
+	        						{
+	        							if( 8 == ++levels )
+	        							{
+	        								done = true;
+	        								rtn = new COBoolean( false );
+		        							free( buf );
+		        							buf = NULL;
+	        							}
+	        						} else {
+	        							done = true;
+	        							free( buf );
+	        							buf = NULL;
+	        						}
+	    	        			}
+
+	    	        		}
+        					break;
+	    	        	case 1:
+	    	        		if( ']' == c )
+	    	        		{
+	    	        			if( !( --levels ) )
+	    	        			{
+	    	        				done = true;
+	    	        				break;
+	    	        			}
+	    	        		} else if( '[' == c ) {
+	    	        			levels++;
+	    	        		}
+	    	        		break;
+	    	        }
+	    	    }
+	    	}
+	    }
+		if( buf && buf[ 0 ] )
+		{
+		    rtn = parseJson( buf );
+			free( buf );
+		}
+	}
+	return rtn;
+}
+
+/****************************************************************************************/
+/*                                                                                      */
+/*                                 CppONStreamParser                                    */
+/*                                                                                      */
+/****************************************************************************************/
+
+CppONStreamParser::CppONStreamParser( void (*f)( CppON *obj, void *ctx ), void *ctx ) :
+	callback( f ), context( ctx ), tok( NONE ), expect( VALUE ), digits( false ), escape( false ), discarding( false ), whole( true ),
+	inString( false ), inNumber( false ), last( '\0' ), depth( 0 ), number( 0 ), skip( 0 ), fed( 0 ), begin( 0 ), tokenBegin( 0 ),
+	lineBegin( 0 ), line( 1 ), limit( CPPON_STREAM_LIMIT ), errorCount( 0 )
+{
+	error.code = CPPON_PARSE_OK;
+	error.offset = error.consumed = 0;
+	error.line = error.column = 1;
+}
+
+CppONStreamParser::~CppONStreamParser()
+{
+	drop();
+	for( std::deque<CppON *>::iterator it = queue.begin(); queue.end() != it; ++it )
+	{
+		delete *it;
+	}
+}
+
+/*
+ * Free the part of the message built so far
+ */
+void CppONStreamParser::drop()
+{
+	for( std::vector<CppON *>::iterator it = stack.begin(); stack.end() != it; ++it )
+	{
+		delete *it;
+	}
+	stack.clear();
+	names.clear();
+	name.clear();
+	token.clear();
+	tok = NONE;
+}
+
+void CppONStreamParser::reset()
+{
+	drop();
+	discarding = inString = escape = inNumber = false;
+	depth = 0;
+	skip = 0;
+}
+
+CppON *CppONStreamParser::next()
+{
+	CppON *rtn = NULL;
+
+	if( ! queue.empty() )
+	{
+		rtn = queue.front();
+		queue.pop_front();
+	}
+	return rtn;
+}
+
+ssize_t CppONStreamParser::read( int fd )
+{
+	ssize_t	rd;
+
+	if( block.empty() )
+	{
+		block.resize( 64 * 1024 );
+	}
+	while( 0 > ( rd = ::read( fd, block.data(), block.size() ) ) && EINTR == errno ) {}
+	if( 0 < rd )
+	{
+		feed( block.data(), ( size_t ) rd );
+	}
+	return rd;
+}
+
+/*
+ * Record why the message at begin failed and drop it.  Whatever is still open is stepped over by discard():  depth
+ * containers, plus the string or TNet payload the caller left in inString or skip.  Returns 0, the messages it completed.
+ */
+size_t CppONStreamParser::fail( CppONParseErrorCode code, uint64_t at )
+{
+	error.code = code;
+	error.offset = error.consumed = (size_t) ( at - begin );
+	error.line = line;
+	error.column = (size_t) ( at - lineBegin ) + 1;
+	errorCount++;
+	depth = (unsigned) stack.size();
+	drop();
+	inNumber = false;
+	last = '{';
+	discarding = ( depth || inString || skip );
+	return 0;
+}
+
+/*
+ * A value is done.  It goes into the container on top of the stack, or out as a message if there isn't one.
+ */
+size_t CppONStreamParser::place( CppON *obj )
+{
+	CppON	*top = ( stack.empty() ) ? NULL : stack.back();
+
+	if( ! top )
+	{
+		if( callback )
+		{
+			callback( obj, context );
+		} else {
+			queue.push_back( obj );
+		}
+		return 1;
+	}
+	if( CppON::isMap( top ) )
+	{
+		// cppcheck-suppress cstyleCast
+		( (COMap *) top )->put( std::move( name ), obj, false );
+		name.clear();
+	} else {
+		// cppcheck-suppress cstyleCast
+		( (COArray *) top )->put( obj );
+	}
+	expect = NEXT;
+	return 0;
+}
+
+/*
+ * The token that started at tokenBegin ends before s[ i ].  Parse it, out of the piece if it all arrived in this one.
+ */
+size_t CppONStreamParser::finish( const char *s, size_t i )
+{
+	const char		*p;
+	size_t			n;
+	bool			word = ( WORD == tok );
+	CppON			*obj;
+
+	if( ! fits( i ) )
+	{
+		return fail( CPPON_PARSE_TOO_LARGE, fed + i );
+	}
+	if( tokenBegin < fed )
+	{
+		token.append( s, i );
+		p = token.data();
+		n = token.size();
+	} else {
+		p = s + ( tokenBegin - fed );
+		n = (size_t) ( fed + i - tokenBegin );
+	}
+	tok = NONE;
+
+	CppONParser		prs( p, n );
+	prs.nested( (unsigned) stack.size() );
+	if( NULL == ( obj = prs.value() ) || p + n != prs.position() )
+	{
+		CppONParseError	err;
+		if( obj )
+		{
+			delete obj;
+			return fail( CPPON_PARSE_UNEXPECTED_CHARACTER, tokenBegin + ( prs.position() - p ) );
+		}
+		prs.getError( err );
+		return fail( err.code, tokenBegin + err.offset );
+	}
+	token.clear();
+	if( stack.empty() && word )															// A bare number or word isn't a message
+	{
+		delete obj;
+		return fail( CPPON_PARSE_UNEXPECTED_CHARACTER, tokenBegin );
+	}
+	if( KEY == expect )
+	{
+		if( ! CppON::isString( obj ) )
+		{
+			delete obj;
+			return fail( CPPON_PARSE_EXPECTED_KEY, tokenBegin );
+		}
+		// cppcheck-suppress cstyleCast
+		name.swap( *( (COString *) obj )->value() );
+		delete obj;
+		expect = COLON;
+		return 0;
+	}
+	return place( obj );
+}
+
+/*
+ * One character outside any token.  Either it is dealt with here and i moves past it, or it starts a token which the caller
+ * goes on scanning.  A map or array is first parsed in one go out of the piece;  only if that runs into the end of the piece
+ * (or fails) is it built a value at a time, and then no more are tried in that piece, so at most one piece's worth of
+ * bytes is ever looked at twice.
+ */
+size_t CppONStreamParser::structural( const char *s, size_t &i, size_t len )
+{
+	char	c = s[ i ];
+	bool	top = stack.empty();
+
+	switch( c )
+	{
+		case '\n':
+			line++;
+			lineBegin = fed + i + 1;
+			i++;
+			return 0;
+		case ' ':
+		case '\t':
+		case '\r':
+			i++;
+			return 0;
+		default:
+			break;
+	}
+	if( top )
+	{
+		if( ',' == c || ';' == c || '\0' == c )
+		{
+			i++;
+			return 0;
+		}
+		begin = lineBegin = fed + i;
+		line = 1;
+		expect = VALUE;
+	}
+	if( '"' == c && ( VALUE == expect || KEY == expect ) )
+	{
+		tok = STRING;
+		tokenBegin = fed + i++;
+		escape = false;
+		return 0;
+	}
+	switch( expect )
+	{
+		case KEY:
+			if( '}' == c )
+			{
+				break;
+			} else if( '0' <= c && '9' >= c ) {
+				tok = WORD;
+				tokenBegin = fed + i++;
+				digits = true;
+				number = c - '0';
+				return 0;
+			}
+			return fail( CPPON_PARSE_EXPECTED_KEY, fed + i );
+		case COLON:
+			if( ':' == c )
+			{
+				expect = VALUE;
+				i++;
+				return 0;
+			}
+			return fail( CPPON_PARSE_EXPECTED_COLON, fed + i );
+		case NEXT:
+			if( ',' == c )
+			{
+				expect = ( CppON::isMap( stack.back() ) ) ? KEY : VALUE;
+				i++;
+				return 0;
+			}
+			break;
+		default:
+			if( '{' == c || '[' == c )
+			{
+				if( CPPON_MAX_DEPTH <= stack.size() )
+				{
+					return fail( CPPON_PARSE_TOO_DEEP, fed + i );
+				}
+				if( ! fits( i ) )
+				{
+					return fail( CPPON_PARSE_TOO_LARGE, fed + i );
+				}
+				if( whole )														// Most of the time it closes in this piece
+				{
+					CppONParser	prs( s + i, len - i );
+					CppON		*obj;
+
+					prs.nested( (unsigned) stack.size() );
+					if( NULL != ( obj = prs.value() ) )
+					{
+						const char	*e = prs.position();
+						for( const char *nl = s + i; NULL != ( nl = (const char *) memchr( nl, '\n', e - nl ) ); nl++ )
+						{
+							line++;
+							lineBegin = fed + ( nl - s ) + 1;
+						}
+						i = e - s;
+						if( ! fits( i ) )
+						{
+							delete obj;
+							return fail( CPPON_PARSE_TOO_LARGE, fed + i );
+						}
+						return place( obj );
+					}
+					whole = false;												// It doesn't, build it as the bytes go by
+				}
+				names.push_back( std::move( name ) );
+				name.clear();
+				stack.push_back( ( '{' == c ) ? (CppON *) new COMap() : (CppON *) new COArray() );
+				expect = ( '{' == c ) ? KEY : VALUE;
+				i++;
+				return 0;
+			} else if( ( '0' <= c && '9' >= c ) || ( 'a' <= ( c | 0x20 ) && 'z' >= ( c | 0x20 ) ) || '-' == c || '+' == c || '.' == c ) {
+				tok = WORD;
+				tokenBegin = fed + i++;
+				digits = ( '0' <= c && '9' >= c );
+				number = c - '0';
+				return 0;
+			} else if( ']' == c && ! top && CppON::isArray( stack.back() ) ) {
+				break;
+			}
+			return fail( CPPON_PARSE_UNEXPECTED_CHARACTER, fed + i );
+	}
+
+	/*
+	 * What's left is a '}' or ']', it has to close the container on top of the stack.
+	 */
+	if( top || ( '}' == c ) != CppON::isMap( stack.back() ) || ( '}' != c && ']' != c ) )
+	{
+		return fail( CPPON_PARSE_UNEXPECTED_CHARACTER, fed + i );
+	}
+	i++;
+	CppON	*obj = stack.back();
+	stack.pop_back();
+	name.swap( names.back() );
+	names.pop_back();
+	return place( obj );
+}
+
+/*
+ * Step over the rest of a dropped message without keeping any of it, the way the message boundary used to be found:  brace
+ * depth, strings and their escapes and TNet payloads, including ones nested in JSON.
+ */
+size_t CppONStreamParser::discard( const char *s, size_t i, size_t len )
+{
+	while( i < len && discarding )
+	{
+		if( skip )
+		{
+			size_t take = ( skip < len - i ) ? ( size_t ) skip : len - i;
+			i += take;
+			skip -= take;
+			discarding = ( skip || depth );
+			continue;
+		}
+		char c = s[ i++ ];
+		if( inString )
+		{
+			if( escape )
+			{
+				escape = false;
+			} else if( '\\' == c ) {
+				escape = true;
+			} else if( '"' == c ) {
+				inString = false;
+				discarding = ( 0 != depth );
+			}
+			continue;
+		}
+		if( '0' <= c && '9' >= c )
+		{
+			if( inNumber )
+			{
+				number = ( 1000000000000ULL > number ) ? number * 10 + ( c - '0' ) : number;
+			} else if( '{' == last || '[' == last || ',' == last || ':' == last ) {
+				inNumber = true;
+				number = c - '0';
+			} else {
+				last = c;
+			}
+			continue;
+		}
+		if( inNumber )
+		{
+			inNumber = false;
+			last = '0';
+			if( ':' == c )
+			{
+				skip = number + 1;
+				continue;
+			}
+		}
+		switch( c )
+		{
+			case '"':
+				inString = true;
+				last = c;
+				break;
+			case '{':
+			case '[':
+				depth++;
+				last = c;
+				break;
+			case '}':
+			case ']':
+				discarding = ( depth && 0 != --depth );
+				last = c;
+				break;
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\n':
+				break;
+			default:
+				last = c;
+				break;
+		}
+	}
+	return i;
+}
+
+size_t CppONStreamParser::feed( const char *s, size_t len )
+{
+	size_t		done = 0;
+	size_t		i = 0;
+
+	whole = true;
+	while( i < len )
+	{
+		if( discarding )
+		{
+			i = discard( s, i, len );
+			continue;
+		}
+		switch( tok )
+		{
+			case STRING:
+				for( ; i < len; i++ )
+				{
+					char c = s[ i ];
+					if( escape )
+					{
+						escape = false;
+					} else if( '\\' == c ) {
+						escape = true;
+					} else if( '"' == c ) {
+						break;
+					}
+				}
+				if( i < len )
+				{
+					done += finish( s, ++i );
+				}
+				break;
+
+			case WORD:
+				for( ; i < len; i++ )
+				{
+					char c = s[ i ];
+					if( '0' <= c && '9' >= c )
+					{
+						number = ( 1000000000000ULL > number ) ? number * 10 + ( c - '0' ) : number;
+					} else if( ( 'a' <= ( c | 0x20 ) && 'z' >= ( c | 0x20 ) ) || '-' == c || '+' == c || '.' == c ) {
+						digits = false;
+					} else {
+						break;
+					}
+				}
+				if( i < len )
+				{
+					if( ':' == s[ i ] && digits )											// A TNet length, the payload and its type follow
+					{
+						i++;
+						if( fed + i - begin + number + 1 > limit )
+						{
+							skip = number + 1;
+							done += fail( CPPON_PARSE_TOO_LARGE, tokenBegin );
+						} else {
+							tok = TNET_BODY;
+							skip = number + 1;
+						}
+					} else {
+						done += finish( s, i );
+					}
+				}
+				break;
+
+			case TNET_BODY:
+				{
+					size_t take = ( skip < len - i ) ? ( size_t ) skip : len - i;
+					i += take;
+					skip -= take;
+					if( ! skip )
+					{
+						done += finish( s, i );
+					}
+				}
+				break;
+
+			default:
+				{
+					size_t at = i;
+					done += structural( s, i, len );
+					if( at == i && NONE == tok && ! discarding )						// Nothing could use it and it has been counted
+					{
+						i++;
+					}
+				}
+				break;
+		}
+	}
+
+	/*
+	 * Hold on to the start of a token that runs into the next piece
+	 */
+	if( NONE != tok )
+	{
+		token.append( s + ( ( tokenBegin < fed ) ? 0 : tokenBegin - fed ), ( tokenBegin < fed ) ? len : (size_t) ( fed + len - tokenBegin ) );
+	}
+	if( ( NONE != tok || ! stack.empty() ) && ! fits( len ) )
+	{
+		inString = ( STRING == tok );
+		done += fail( CPPON_PARSE_TOO_LARGE, fed + len );
+	}
+	fed += len;
+	return done;
+}
+
+CppON  *CppON::diff( CppON &newObj, const char *name )
+{
+
+    if(  typ == newObj.typ )
+    {
+        switch ( typ )
+        {
+            case INTEGER_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                if( *( ( COInteger *) this ) != *(( COInteger *) &newObj) )
+                {
+                    return new COInteger( (( COInteger &) newObj) );
+                }
+                break;
+            case DOUBLE_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                if( *( ( CODouble *) this ) != *(( CODouble *) &newObj) )
+                {
+                    return new CODouble( (( CODouble &) newObj) );
+                }
+                break;
+            case BOOLEAN_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                if( *( ( COBoolean *) this ) != *(( COBoolean *) &newObj) )
+                {
+                    return new COBoolean( (( COBoolean &) newObj) );
+                }
+                break;
+            case MAP_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                return  ((COMap *) this)->diff( (COMap &)newObj, name );
+                break;
+            case ARRAY_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                return  ((COArray *) this)->diff( (COArray &)newObj, name );
+                break;
+            case NULL_CPPON_OBJ_TYPE:
+                fprintf(stderr, "CppON:diff - Null being ignored\n");
+                break;
+            default:
+                break;
+        }
+    }
+    return NULL;
+}
+#if HAS_XML
+
+/*
+ * Routine to trim white space off the beginning and end of the content of a text node
+ */
+
+static char *trimTag( xmlNodePtr con )
+{
+    char  *rtn = NULL;
+    if( con )
+    {
+        if( !( xmlStrcmp( con->name, (const xmlChar *) "text" ) )  && con->content )        // Make sure it is a text node with content
+        {
+            char   *oPtr;
+            char   *inPtr = (char *)con->content;
+            char   *ePtr;
+            char   ch;
+
+            rtn  = new char[ strlen( (const char *) con->content ) + 1 ];                   // Create a string that is at least the same size
+            oPtr = ePtr = rtn;                                                              //  as the original string
+
+            while( ' ' == ( ch = *inPtr++ ) || '\n' == ch || '\t' == ch  );                 // Skip over Leading white space
+
+            if( ch )                                                                        // If string had at least one non-white space character it is good
+            {
+                do                                                                          // Copy all characters until end of string
+                {
+                    *oPtr++ = ch;
+                    if( ' ' != ch && '\t' != ch && '\n' != ch )                             // Remember place of last non-white space, + 1
+                    {
+                        ePtr = oPtr;
+                    }
+                } while( ( ch = *inPtr++ ) );                                               // Keep going until null is found
+
+                *ePtr = '\0';                                                               // Put a null at place saved of space after last non white space
+            } else {
+                delete[] rtn;                                                               // empty string so delete it, and return NULL.
+                rtn = NULL;
+            }
+        }
+    }
+    return rtn;
+}
+
+/*
+ * Simple static routine to just check if the cursor has any non-text children.
+ */
+
+static bool hasChildren( xmlNodePtr cur )
+{
+    bool rtn = false;
+    while( cur )
+    {
+        if( 1 == cur->type )
+        {
+            rtn = true;
+        }
+        cur = cur->next;
+    }
+    return rtn;
+}
+
+/*
+ * Iterative routine to parse XML nodes.
+ * A node may be a simple node of type string, integer, double, boolean or null
+ * A map that contains children
+ * An array that contains children
+ * attributes are considered children and will have a '-' prepended to the name.
+ * Nodes that have attributes or other children along with text will have the text added as a node named "#text"
+ * This routing will call itself to resolve all of its children do do the simple node level
+ */
+
+static int parseNode( xmlNodePtr cur, CppON *parent, std:: string indent )
+{
+    xmlNodePtr           childCur;
+    xmlNodePtr           cur2;
+    xmlNodePtr          cur3;
+    CppON              *root = NULL;
+    CppON              *childObj = NULL;
+    _xmlAttr             *attr = NULL;
+    int                  rtn = 0;
+    char                *value;
+    static std::string  preStr = "";
+
+    indent += "  ";
+    if( !cur )
+    {
+        return 0;
+    }
+
+    if( 1 == cur->type )                                                                // Don't parse non-nodes
+    {
+        bool children = hasChildren( cur->xmlChildrenNode );
+        if( ( attr = cur->properties ) || children )                                      // If it has properties it must be at least a map
+        {
+            if( parent->isMap() )
+            {
+                // cppcheck-suppress cstyleCast
+                ((COMap *)parent )->append( (const char * ) cur->name, root = new COMap() );
+            } else if( parent->isArray() ) {
+                // cppcheck-suppress cstyleCast
+                ((COArray *)parent )->append( root = new COMap() );
+            }
+            parent = root;
+
+            /*
+             * do attributes
+             */
+
+            for( ; attr; attr = attr->next )
+            {
+                std::string name = "-";                                                            // Attributes are children with the '-' prepended to their name
+                name += (const char *) attr->name;
 
-	    	        switch ( otype )
-	    	        {
-	    	        	case 0:
-	    	        		if( '}' == c )
-	    	        		{
-	    	        			if( !( --levels ) )
-	    	        			{
-	    	        				done = true;
-	    	        				break;
-	    	        			}
-	    	        		} else if( '{' == c ) {
-	    	        			levels++;
-	    	        		}
-	    	        		break;
-	    	        	case 2:
-	    	        		if( 1 == levels && '\"' == c )
-	    	        		{
-	    	        			levels = 2;
-	    	        		} else if( 2 == levels && ':' == c ) {
-	    	        			levels = 3;
-	    	        		} else if( 3 == levels ) {
-	    	        			if( 0 > stype )
-	    	        			{
-	    	        				if( '\"' == c )
-	    	        				{
-	    	        					stype = 0;
-	    	        					levels = 4;
-	    	        				} else if( '{' == c) {
-	    	        					levels = 4;
-	    	        					stype = 1;
-	    	       					} else if( '[' == c ) {
-	    	       						levels = 4;
-	    	       						stype = 2;
-	    	       					} else if ( ('0' <= c && c <= 9 ) || '-' == c || '+' == c ) {
-	    	       						levels = 4;
-	    	       						stype = 3;
-	    	       					} else if( 't' == c || 'T' == c	) {								// true?
-	    	       						stype = 4;
-	    	       						levels = 4;
-	    	       					} else if( 'f' == c || 'F' == c ) {								// false?
-	    	       						stype = 5;
-	    	       						levels = 4;
-	    	       					}
-	    	        			}
-	    	        		} else if( 4 <= levels ) {
-	    	        			if( 0 == stype  && '\"' == c )										// string
-	    	        			{
- 	    	        				done = true;
-	    	        			} else if ( 1 == stype ) {											// map
-	    	        				if( '{' == c )
-									{
-										levels++;
-									} else if( '}' == c ) {
-										if( 3 == --levels )
-										{
-											done = true;
-										}
-									}
-	    	        			} else if ( 2 == stype ) {											// array
-	    	        				if( '[' == c )
-									{
-										levels++;
-									} else if( ']' == c ) {
-										if( 3 == --levels )
-										{
-											done = true;
-										}
-									}
-	    	        			} else if( 3 == stype ) {											// number
-	    	        				if( ( '0' > c || '9' < c ) && '.' != c )
-	    	        				{
-	    	        					done = true;
-	    	        				}
-	    	        			} else if( 4 == stype ) {											// boolean true?
-	    	        				char tc = '\0';
-	    	        				switch( levels )
-	    	        				{
-	    	        					case 4:														// 'r'
-	    	        						tc = 'r';
-	    	        						break;
-	    	        					case 5:														// 'u'
-	    	        						tc = 'u';
-	    	        						break;
-	    	        					case 6:														// 'e'
-	    	        						tc = 'e';
-	    	        						break;
-	    	        				}
-	        						if( tc == tolower( c ) )
-	        						{
-	        							if( 7 == ++levels )
-	        							{
-	        								done = true;
-	        								rtn = new COBoolean( true );
-		        							free( buf );
-		        							buf = NULL;
-	        							}
-	        						} else {
-	        							done = true;
-	        							free( buf );
-	        							buf = NULL;
-	        						}
+                childObj = CppON::guessDataType( (const char *) attr->children->content );  // decide data type from content
 
-	    	        			} else if( 5 == stype ) {											// boolean false?
-	    	        				char tc = '\0';
-	    	        				switch( levels )
-	    	        				{
-	    	        					case 4:														// 'a'
-	    	        						tc = 'a';
-	    	        						break;
-	    	        					case 5:														// 'l'
-	    	        						tc = 'l';
-	    	        						break;
-	    	        					case 6:														// 's'
-	    	        						tc = 's';
-	    	        						break;
-	    	        					default:													// 'e'
-	    	        						tc = 'e';
-	    	        						break;
-	    	        				}
-	        						if( tc == tolower( c ) )
-	        						{
-	        							if( 8 == ++levels )
-	        							{
-	        								done = true;
-	        								rtn = new COBoolean( false );
-		        							free( buf );
-		        							buf = NULL;
-	        							}
-	        						} else {
-	        							done = true;
-	        							free( buf );
-	        							buf = NULL;
-	        						}
-	    	        			}
+                if( parent->isMap() )                                                          // different routines to add node to array or map
+                {
+                    // cppcheck-suppress cstyleCast
+                    ( ( COMap *) parent)->append( name, childObj );
+                } else if( parent->isArray() ) {
+                    // cppcheck-suppress cstyleCast
+                    ( ( COArray *) parent)->append( childObj );
+                }
+            }
+
+            if( ( childCur = cur->xmlChildrenNode ) )
+            {
+                for( cur2 = childCur; cur2; cur2 = cur2->next )                                // Process all children
+                {
+                    if( 1 == cur2->type )
+                    {
+                        bool         arrayMember = false;
+                        std::string  tagName = (const char *)cur2->name;
+
+                        for( cur3 = cur2->next; cur3; cur3 = cur3->next )                          // See if they are part of an array
+                        {
+                            if( !xmlStrcmp( (const xmlChar *)tagName.c_str(), cur3->name ) )
+                            {
+                                arrayMember = true;                                                    //    if the same name appears it must be an array
+                            }
+                        }
+                        if( arrayMember )                                                          // Process all array children together
+                        {
+                            if( parent->isMap() )
+                            {
+                                // cppcheck-suppress cstyleCast
+                                ( ( COMap *) parent)->append( tagName, childObj = new COArray() );
+                            } else if( parent->isArray() ) {
+                                // cppcheck-suppress cstyleCast
+                                ( ( COArray *) parent)->append( childObj = new COArray() );
+                            }
+                            preStr = "\n  ";
+                            preStr += indent;
+                            parseNode( cur2, childObj, indent + "  " );
+
+                            for( cur3 = cur2->next; cur3; )                                          // See if they are part of an array
+                            {
+                                xmlNodePtr cur4 = cur3;
+                                cur3 = cur3->next;                                                    // Get next pointer in case we delete this one
+                                if( !xmlStrcmp( (const xmlChar *)tagName.c_str(), cur4->name ) )
+                                {
+                                    parseNode( cur4, childObj, indent + "  " );
+                                    xmlUnlinkNode( cur4 );
+                                    xmlFreeNode( cur4 );
+                                }
+                            }
+                        } else {
+                            preStr = "";
+                            parseNode( cur2, parent, indent );
+                        }
+                    } else if( ( value = trimTag( cur->xmlChildrenNode ) ) ) {                  // Node has attribute and content
+                        // cppcheck-suppress cstyleCast
+                        ( ( COMap *) parent)->append( "#text", childObj = new COString( value ) );
+                        delete[] value;
+                    }
+                }
+            }
+        } else if( ( value = trimTag( cur->xmlChildrenNode ) ) ) {
+            childObj = CppON::guessDataType( value );
+            delete[] value;
+
+            if( parent->isMap() )
+            {
+                // cppcheck-suppress cstyleCast
+                ( ( COMap *) parent)->append( (const char *)cur->name, childObj  );
+            } else if( parent->isArray() ) {
+                // cppcheck-suppress cstyleCast
+                ( ( COArray *) parent)->append( childObj );
+            }
+        }
+    } else {
+        if( (value = trimTag( cur ) ) )
+        {
+            childObj = CppON::guessDataType( value );
+            delete[] value;
+
+            if( parent->isMap() )
+            {
+                // cppcheck-suppress cstyleCast
+                ( ( COMap *) parent)->append( indent, childObj );
+            } else if( parent->isArray() ) {
+                // cppcheck-suppress cstyleCast
+                ( ( COArray *) parent)->append( childObj );
+            }
+        }
+    }
+    return rtn;
+}
+
+// cppcheck-suppress unusedFunction
+CppON *CppON::parseXML( const char *str )
+{
+    CppON         *rtn = NULL;
+    xmlDocPtr       doc;
+    xmlNodePtr       cur;
+
+    if( ! str )
+    {
+        fprintf( stderr, "Attempt to convert an empty string to a data Object\n");
+    } else if( !( doc = ( '.' == *str || '/' == *str) ? xmlParseFile( str ) : xmlParseDoc( (const xmlChar *)str ) ) ) {
+        fprintf( stderr, "Empty Document!\n" );
+        xmlFreeDoc( doc );
+    } else if( !(cur = xmlDocGetRootElement( doc ) ) ) {
+        fprintf( stderr, "Failed to get root node!\n" );
+        xmlFreeDoc( doc );
+    } else {
+        rtn = new COMap( );                                      // Create the new Map object to return
+        parseNode( cur, rtn, std::string( "" ) );
+        xmlFreeDoc( doc );
+    }
+    return rtn;
+}
+#endif
+
+/****************************************************************************************/
+/*                                                                                      */
+/*                                    Delimited text                                    */
+/*                                                                                      */
+/****************************************************************************************/
 
-	    	        		}
-        					break;
-	    	        	case 1:
-	    	        		if( ']' == c )
-	    	        		{
-	    	        			if( !( --levels ) )
-	    	        			{
-	    	        				done = true;
-	    	        				break;
-	    	        			}
-	    	        		} else if( '[' == c ) {
-	    	        			levels++;
-	    	        		}
-	    	        		break;
-	    	        }
-	    	    }
-	    	}
-	    }
-		if( buf && buf[ 0 ] )
+#define CPPON_TABLE_MIN_CHUNK	( 1 << 20 )										// Least input worth a thread of its own
+
+enum CppONCellKind																	// In order, a column is the highest kind of its cells
+{
+	CPPON_CELL_EMPTY,
+	CPPON_CELL_INTEGER,
+	CPPON_CELL_REAL,
+	CPPON_CELL_TEXT
+};
+
+/*
+ * Splits delimited text into cells.  Delimiters, newlines and quotes are found 16 bytes at a time with SSE2 (a plain loop
+ * where there is none) and the mask of the last block is kept so a row of short cells is only loaded once.  A cell that
+ * starts with a quote runs to the matching quote, "" inside being a quote, and can hold delimiters and newlines;  a quote
+ * anywhere else is just a character.  A carriage return before a newline is dropped.
+ */
+class CppONTableScanner
+{
+public:
+						CppONTableScanner( const char *s, const char *e, char d, bool q );
+			bool		next( const char *&cell, size_t &len, bool &quoted, bool &rowEnd );
+			const char	*position() const { return cur; }
+			bool		unterminated() const { return open; }						// A quoted cell ran into the end
+private:
+			const char	*special( const char *p );
+
+			const char	*cur;
+			const char	*end;
+			const char	*blk;													// Block bits is the mask of
+			uint32_t	bits;
+			char		delim;
+			char		quote;													// '\n' when quotes are off so it adds nothing
+			bool		quotes;
+			bool		open;
+			bool		trailing;												// The input ended with a delimiter, one empty cell to go
+#if defined( __SSE2__ )
+			__m128i		vDelim;
+			__m128i		vNewLine;
+			__m128i		vQuote;
+#endif
+};
+
+CppONTableScanner::CppONTableScanner( const char *s, const char *e, char d, bool q ) : cur( s ), end( e ), blk( NULL ), bits( 0 ),
+		delim( d ), quote( ( q ) ? '"' : '\n' ), quotes( q ), open( false ), trailing( false )
+{
+#if defined( __SSE2__ )
+	vDelim = _mm_set1_epi8( delim );
+	vNewLine = _mm_set1_epi8( '\n' );
+	vQuote = _mm_set1_epi8( quote );
+#endif
+}
+
+/*
+ * The first delimiter, newline or quote at or after p, end if there is none
+ */
+const char *CppONTableScanner::special( const char *p )
+{
+#if defined( __SSE2__ )
+	for( ;; )
+	{
+		if( blk && p >= blk && p < blk + 16 )
 		{
-		    rtn = parseJson( buf );
-			free( buf );
+			uint32_t b = bits & ( 0xFFFFFFFFU << ( p - blk ) );
+			if( b )
+			{
+				return blk + __builtin_ctz( b );
+			}
+			p = blk + 16;
+		}
+		if( p + 16 > end )
+		{
+			break;
 		}
+		// cppcheck-suppress cstyleCast
+		__m128i v = _mm_loadu_si128( (const __m128i *) p );
+		blk = p;
+		bits = (uint32_t) _mm_movemask_epi8( _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( v, vDelim ), _mm_cmpeq_epi8( v, vNewLine ) ), _mm_cmpeq_epi8( v, vQuote ) ) );
 	}
-	return rtn;
+#endif
+	while( p < end && delim != *p && '\n' != *p && quote != *p )
+	{
+		p++;
+	}
+	return p;
 }
 
+/*
+ * The next cell as it is in the text, quotes and all.  rowEnd is set on the last cell of a row.  Returns false at the end.
+ */
+bool CppONTableScanner::next( const char *&cell, size_t &len, bool &quoted, bool &rowEnd )
+{
+	const char *p = cur;
 
+	if( cur >= end )
+	{
+		if( ! trailing )
+		{
+			return false;
+		}
+		trailing = false;
+		cell = end;
+		len = 0;
+		quoted = false;
+		rowEnd = true;
+		return true;
+	}
+	cell = cur;
+	if( ( quoted = ( quotes && '"' == *p ) ) )
+	{
+		for( p++; ; p++ )
+		{
+			if( end <= ( p = special( p ) ) )
+			{
+				open = true;
+				break;
+			}
+			if( '"' == *p )
+			{
+				if( p + 1 >= end || '"' != p[ 1 ] )
+				{
+					p++;
+					break;
+				}
+				p++;															// "" is a quote, skip the second one too
+			}
+		}
+	}
+	while( end > ( p = special( p ) ) && '"' == *p )
+	{
+		p++;
+	}
+	len = (size_t) ( p - cell );
+	rowEnd = ( end <= p || '\n' == *p );
+	if( end <= p )
+	{
+		cur = end;
+	} else {
+		cur = p + 1;
+		trailing = ( ! rowEnd && cur == end );
+	}
+	if( rowEnd && len && '\r' == cell[ len - 1 ] )
+	{
+		len--;
+	}
+	return true;
+}
 
-CppON  *CppON::diff( CppON &newObj, const char *name )
+/*
+ * The text of a cell:  itself when it isn't quoted, otherwise what is between the quotes, undoubled, in buf.  Anything after
+ * the closing quote is kept as it is.
+ */
+static const char *cellText( const char *s, size_t &n, bool quoted, std::string &buf )
 {
+	if( ! quoted )
+	{
+		return s;
+	}
+	const char *e = s + n;
+	buf.clear();
+	for( s++; s < e; )
+	{
+		const char *q = (const char *) memchr( s, '"', (size_t) ( e - s ) );
+		if( ! q )
+		{
+			buf.append( s, (size_t) ( e - s ) );
+			break;
+		}
+		buf.append( s, (size_t) ( q - s ) );
+		if( q + 1 < e && '"' == q[ 1 ] )
+		{
+			buf += '"';
+			s = q + 2;
+		} else {
+			buf.append( q + 1, (size_t) ( e - q - 1 ) );
+			break;
+		}
+	}
+	n = buf.size();
+	return buf.data();
+}
 
-    if(  typ == newObj.typ )
-    {
-        switch ( typ )
-        {
-            case INTEGER_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                if( *( ( COInteger *) this ) != *(( COInteger *) &newObj) )
-                {
-                    return new COInteger( (( COInteger &) newObj) );
-                }
-                break;
-            case DOUBLE_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                if( *( ( CODouble *) this ) != *(( CODouble *) &newObj) )
-                {
-                    return new CODouble( (( CODouble &) newObj) );
-                }
-                break;
-            case BOOLEAN_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                if( *( ( COBoolean *) this ) != *(( COBoolean *) &newObj) )
-                {
-                    return new COBoolean( (( COBoolean &) newObj) );
-                }
-                break;
-            case MAP_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                return  ((COMap *) this)->diff( (COMap &)newObj, name );
-                break;
-            case ARRAY_CPPON_OBJ_TYPE:
-                // cppcheck-suppress cstyleCast
-                return  ((COArray *) this)->diff( (COArray &)newObj, name );
-                break;
-            case NULL_CPPON_OBJ_TYPE:
-                fprintf(stderr, "CppON:diff - Null being ignored\n");
-                break;
-            default:
-                break;
-        }
-    }
-    return NULL;
+/*
+ * What a cell's text could be.  Integers have at most 18 digits so they always fit in an int64_t;  longer ones, white space,
+ * hex, inf and nan are text.  i gets the value of an integer.
+ */
+static CppONCellKind cellKind( const char *s, size_t n, int64_t &i )
+{
+	const char	*e = s + n;
+	const char	*p = s;
+	bool		neg = false;
+	uint64_t	v = 0;
+
+	if( ! n )
+	{
+		return CPPON_CELL_EMPTY;
+	}
+	if( '-' == *p || '+' == *p )
+	{
+		neg = ( '-' == *p++ );
+	}
+	const char *d = p;
+	for( ; p < e && '0' <= *p && '9' >= *p; p++ )
+	{
+		v = v * 10 + (uint64_t) ( *p - '0' );
+	}
+	size_t digits = (size_t) ( p - d );
+	if( p == e )
+	{
+		if( ! digits || 18 < digits )
+		{
+			return CPPON_CELL_TEXT;
+		}
+		i = ( neg ) ? -(int64_t) v : (int64_t) v;
+		return CPPON_CELL_INTEGER;
+	}
+	if( '.' == *p )
+	{
+		for( p++; p < e && '0' <= *p && '9' >= *p; p++ )
+		{
+			digits++;
+		}
+	}
+	if( ! digits )
+	{
+		return CPPON_CELL_TEXT;
+	}
+	if( p < e && ( 'e' == *p || 'E' == *p ) )
+	{
+		if( ++p < e && ( '+' == *p || '-' == *p ) )
+		{
+			p++;
+		}
+		const char *x = p;
+		while( p < e && '0' <= *p && '9' >= *p )
+		{
+			p++;
+		}
+		if( x == p )
+		{
+			return CPPON_CELL_TEXT;
+		}
+	}
+	return ( p == e ) ? CPPON_CELL_REAL : CPPON_CELL_TEXT;
 }
-#if HAS_XML
 
 /*
- * Routine to trim white space off the beginning and end of the content of a text node
+ * Only the parity matters, it tells whether a point in the text is inside a quoted cell
  */
+static size_t countQuotes( const char *p, const char *e )
+{
+	size_t n = 0;
+#if defined( __SSE2__ )
+	const __m128i q = _mm_set1_epi8( '"' );
+	for( ; p + 16 <= e; p += 16 )
+	{
+		// cppcheck-suppress cstyleCast
+		n += (size_t) __builtin_popcount( (unsigned) _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *) p ), q ) ) );
+	}
+#endif
+	for( ; p < e; p++ )
+	{
+		n += ( '"' == *p );
+	}
+	return n;
+}
 
-static char *trimTag( xmlNodePtr con )
+/*
+ * Run work( 0 ) to work( n - 1 ) at once, the last one on the calling thread
+ */
+template<typename F> static void onThreads( unsigned n, F work )
 {
-    char  *rtn = NULL;
-    if( con )
-    {
-        if( !( xmlStrcmp( con->name, (const xmlChar *) "text" ) )  && con->content )        // Make sure it is a text node with content
-        {
-            char   *oPtr;
-            char   *inPtr = (char *)con->content;
-            char   *ePtr;
-            char   ch;
+	std::vector<std::thread>	pool;
 
-            rtn  = new char[ strlen( (const char *) con->content ) + 1 ];                   // Create a string that is at least the same size
-            oPtr = ePtr = rtn;                                                              //  as the original string
+	pool.reserve( n - 1 );
+	for( unsigned t = 0; n - 1 > t; t++ )
+	{
+		pool.emplace_back( work, t );
+	}
+	work( n - 1 );
+	for( size_t i = 0; pool.size() > i; i++ )
+	{
+		pool[ i ].join();
+	}
+}
 
-            while( ' ' == ( ch = *inPtr++ ) || '\n' == ch || '\t' == ch  );                 // Skip over Leading white space
+/*
+ * One piece of the text, cut at the start of a row, and what was found and made in it
+ */
+struct CppONTableChunk
+{
+	const char							*begin;
+	const char							*end;
+	std::vector<unsigned char>			kinds;									// Highest CppONCellKind in each column
+	std::vector<CppON *>				rows;
+	std::vector<std::vector<CppON *> >	cols;
+	size_t								nRows;
+	bool								broken;									// Ended inside a quoted cell, so the cut was wrong
+};
 
-            if( ch )                                                                        // If string had at least one non-white space character it is good
-            {
-                do                                                                          // Copy all characters until end of string
-                {
-                    *oPtr++ = ch;
-                    if( ' ' != ch && '\t' != ch && '\n' != ch )                             // Remember place of last non-white space, + 1
-                    {
-                        ePtr = oPtr;
-                    }
-                } while( ( ch = *inPtr++ ) );                                               // Keep going until null is found
+/*
+ * parseTable().  The text is cut into one chunk per thread.  Without quotes a cut just moves on to the next newline.  With
+ * them the parity of the quotes before the cut says whether it is inside a quoted cell, which holds for well formed text;
+ * a chunk that ends inside a quoted cell shows a stray quote fooled it and everything is done again as a single chunk.
+ * When types are wanted every chunk is first surveyed for the kinds of its columns, then the chunks build their rows or
+ * columns and those are joined in order.
+ */
+class CppONTable
+{
+public:
+						CppONTable( const char *s, size_t len, const CppONTableOptions &o ) : opt( o ), text( s ), end( s + len ), body( s ) {}
+			CppON		*parse();
+private:
+			void		header();
+			void		cut( unsigned n );
+			void		survey( CppONTableChunk &c, bool last );
+			void		build( CppONTableChunk &c, bool last );
+			void		discard();
+			CppON		*cell( const char *s, size_t n, bool quoted, size_t col, std::string &buf );
+			CppON		*row( std::vector<CppON *> &cells );
+			std::string	name( size_t col );
+			CppON		*assemble();
+
+	const	CppONTableOptions			&opt;
+			const char					*text;
+			const char					*end;
+			const char					*body;									// Where the rows start, after any header
+			std::vector<std::string>	names;
+			std::unordered_map<std::string, size_t>	named;
+			std::vector<unsigned char>	kinds;
+			std::vector<CppONTableChunk>	chunks;
+};
 
-                *ePtr = '\0';                                                               // Put a null at place saved of space after last non white space
-            } else {
-                delete[] rtn;                                                               // empty string so delete it, and return NULL.
-                rtn = NULL;
-            }
-        }
-    }
-    return rtn;
+CppON *CppONTable::parse()
+{
+	unsigned	n = ( opt.threads ) ? opt.threads : std::thread::hardware_concurrency();
+	size_t		max = (size_t) ( end - text ) / CPPON_TABLE_MIN_CHUNK;
+
+	header();
+	if( n > max )
+	{
+		n = (unsigned) max;
+	}
+	if( ! n )
+	{
+		n = 1;
+	}
+	for( ;; )
+	{
+		bool broken = false;
+		cut( n );
+		if( opt.types )
+		{
+			onThreads( n, [ this, n ]( unsigned t ) { survey( chunks[ t ], n - 1 == t ); } );
+			kinds.clear();
+			for( size_t i = 0; chunks.size() > i; i++ )
+			{
+				CppONTableChunk &c = chunks[ i ];
+				broken = broken || c.broken;
+				if( kinds.size() < c.kinds.size() )
+				{
+					kinds.resize( c.kinds.size(), CPPON_CELL_EMPTY );
+				}
+				for( size_t k = 0; c.kinds.size() > k; k++ )
+				{
+					kinds[ k ] = std::max( kinds[ k ], c.kinds[ k ] );
+				}
+			}
+		}
+		if( ! broken )
+		{
+			onThreads( n, [ this, n ]( unsigned t ) { build( chunks[ t ], n - 1 == t ); } );
+			for( size_t i = 0; chunks.size() > i; i++ )
+			{
+				broken = broken || chunks[ i ].broken;
+			}
+		}
+		if( ! broken || 1 == n )
+		{
+			break;
+		}
+		discard();
+		n = 1;
+	}
+	return assemble();
+}
+
+/*
+ * Take the column names off the first row that isn't blank.  Blank and repeated names are replaced by the column's number.
+ */
+void CppONTable::header()
+{
+	if( ! opt.header )
+	{
+		return;
+	}
+	CppONTableScanner	sc( text, end, opt.delimiter, opt.quotes );
+	const char			*s;
+	size_t				n;
+	bool				quoted;
+	bool				rowEnd;
+	std::string			buf;
+	std::vector<std::string> raw;
+
+	while( sc.next( s, n, quoted, rowEnd ) )
+	{
+		if( raw.empty() && rowEnd && ! n )
+		{
+			continue;
+		}
+		s = cellText( s, n, quoted, buf );
+		raw.push_back( std::string( s, n ) );
+		if( rowEnd )
+		{
+			break;
+		}
+	}
+	body = sc.position();
+	for( size_t i = 0; raw.size() > i; i++ )
+	{
+		if( ! raw[ i ].empty() && named.end() == named.find( raw[ i ] ) )
+		{
+			named[ raw[ i ] ] = i;
+		}
+	}
+	for( size_t i = 0; raw.size() > i; i++ )
+	{
+		std::unordered_map<std::string, size_t>::iterator it = named.find( raw[ i ] );
+		names.push_back( ( named.end() != it && i == it->second ) ? raw[ i ] : name( i ) );
+	}
 }
 
 /*
- * Simple static routine to just check if the cursor has any non-text children.
+ * A name for a column the header doesn't name.  Only depends on the header so every chunk comes up with the same one.
  */
-
-static bool hasChildren( xmlNodePtr cur )
+std::string CppONTable::name( size_t col )
 {
-    bool rtn = false;
-    while( cur )
-    {
-        if( 1 == cur->type )
-        {
-            rtn = true;
-        }
-        cur = cur->next;
-    }
-    return rtn;
+	if( names.size() > col )
+	{
+		return names[ col ];
+	}
+	std::string s = std::to_string( col );
+	while( named.end() != named.find( s ) )
+	{
+		s += '_';
+	}
+	return s;
 }
 
-/*
- * Iterative routine to parse XML nodes.
- * A node may be a simple node of type string, integer, double, boolean or null
- * A map that contains children
- * An array that contains children
- * attributes are considered children and will have a '-' prepended to the name.
- * Nodes that have attributes or other children along with text will have the text added as a node named "#text"
- * This routing will call itself to resolve all of its children do do the simple node level
- */
-
-static int parseNode( xmlNodePtr cur, CppON *parent, std:: string indent )
+void CppONTable::cut( unsigned n )
 {
-    xmlNodePtr           childCur;
-    xmlNodePtr           cur2;
-    xmlNodePtr          cur3;
-    CppON              *root = NULL;
-    CppON              *childObj = NULL;
-    _xmlAttr             *attr = NULL;
-    int                  rtn = 0;
-    char                *value;
-    static std::string  preStr = "";
-
-    indent += "  ";
-    if( !cur )
-    {
-        return 0;
-    }
-
-    if( 1 == cur->type )                                                                // Don't parse non-nodes
-    {
-        bool children = hasChildren( cur->xmlChildrenNode );
-        if( ( attr = cur->properties ) || children )                                      // If it has properties it must be at least a map
-        {
-            if( parent->isMap() )
-            {
-                // cppcheck-suppress cstyleCast
-                ((COMap *)parent )->append( (const char * ) cur->name, root = new COMap() );
-            } else if( parent->isArray() ) {
-                // cppcheck-suppress cstyleCast
-                ((COArray *)parent )->append( root = new COMap() );
-            }
-            parent = root;
+	size_t						len = (size_t) ( end - body );
+	std::vector<const char *>	at( n + 1 );
+	std::vector<size_t>			quotes( n, 0 );
 
-            /*
-             * do attributes
-             */
+	at[ 0 ] = body;
+	at[ n ] = end;
+	if( opt.quotes && 1 < n )
+	{
+		onThreads( n, [ &, this ]( unsigned t ) { quotes[ t ] = countQuotes( body + len * t / n, body + len * ( t + 1 ) / n ); } );
+	}
+	bool in = false;
+	for( unsigned t = 1; n > t; t++ )
+	{
+		const char *p = body + len * t / n;
+		in = ( in != ( 1 == ( quotes[ t - 1 ] & 1 ) ) );
+		for( bool q = in; p < end; p++ )
+		{
+			if( opt.quotes && '"' == *p )
+			{
+				q = ! q;
+			} else if( '\n' == *p && ! q ) {
+				p++;
+				break;
+			}
+		}
+		at[ t ] = std::max( p, at[ t - 1 ] );
+	}
+	chunks.clear();
+	chunks.resize( n );
+	for( unsigned t = 0; n > t; t++ )
+	{
+		chunks[ t ].begin = at[ t ];
+		chunks[ t ].end = at[ t + 1 ];
+		chunks[ t ].nRows = 0;
+		chunks[ t ].broken = false;
+	}
+}
 
-            for( ; attr; attr = attr->next )
-            {
-                std::string name = "-";                                                            // Attributes are children with the '-' prepended to their name
-                name += (const char *) attr->name;
+void CppONTable::survey( CppONTableChunk &c, bool last )
+{
+	CppONTableScanner	sc( c.begin, c.end, opt.delimiter, opt.quotes );
+	const char			*s;
+	size_t				n;
+	bool				quoted;
+	bool				rowEnd;
+	size_t				col = 0;
+	int64_t				i;
+	std::string			buf;
 
-                childObj = CppON::guessDataType( (const char *) attr->children->content );  // decide data type from content
+	while( sc.next( s, n, quoted, rowEnd ) )
+	{
+		if( ! col && rowEnd && ! n )
+		{
+			continue;																// Blank line
+		}
+		s = cellText( s, n, quoted, buf );
+		if( c.kinds.size() <= col )
+		{
+			c.kinds.resize( col + 1, CPPON_CELL_EMPTY );
+		}
+		c.kinds[ col ] = std::max( c.kinds[ col ], (unsigned char) cellKind( s, n, i ) );
+		col++;
+		if( rowEnd )
+		{
+			c.nRows++;
+			col = 0;
+		}
+	}
+	c.broken = ! last && sc.unterminated();
+}
 
-                if( parent->isMap() )                                                          // different routines to add node to array or map
-                {
-                    // cppcheck-suppress cstyleCast
-                    ( ( COMap *) parent)->append( name, childObj );
-                } else if( parent->isArray() ) {
-                    // cppcheck-suppress cstyleCast
-                    ( ( COArray *) parent)->append( childObj );
-                }
-            }
+void CppONTable::build( CppONTableChunk &c, bool last )
+{
+	CppONTableScanner		sc( c.begin, c.end, opt.delimiter, opt.quotes );
+	const char				*s;
+	size_t					n;
+	bool					quoted;
+	bool					rowEnd;
+	size_t					col = 0;
+	std::string				buf;
+	std::vector<CppON *>	cells;
 
-            if( ( childCur = cur->xmlChildrenNode ) )
-            {
-                for( cur2 = childCur; cur2; cur2 = cur2->next )                                // Process all children
-                {
-                    if( 1 == cur2->type )
-                    {
-                        bool         arrayMember = false;
-                        std::string  tagName = (const char *)cur2->name;
+	c.nRows = 0;
+	while( sc.next( s, n, quoted, rowEnd ) )
+	{
+		if( ! col && rowEnd && ! n )
+		{
+			continue;
+		}
+		CppON *v = cell( s, n, quoted, col, buf );
+		if( opt.columns )
+		{
+			if( c.cols.size() <= col )
+			{
+				c.cols.resize( col + 1 );
+				for( size_t k = 0; c.nRows > k; k++ )
+				{
+					c.cols[ col ].push_back( new CONull() );						// A new column, earlier rows were short
+				}
+			}
+			c.cols[ col ].push_back( v );
+		} else {
+			cells.push_back( v );
+		}
+		col++;
+		if( rowEnd )
+		{
+			if( opt.columns )
+			{
+				for( ; c.cols.size() > col; col++ )
+				{
+					c.cols[ col ].push_back( new CONull() );
+				}
+			} else {
+				c.rows.push_back( row( cells ) );
+			}
+			c.nRows++;
+			col = 0;
+		}
+	}
+	c.broken = ! last && sc.unterminated();
+}
 
-                        for( cur3 = cur2->next; cur3; cur3 = cur3->next )                          // See if they are part of an array
-                        {
-                            if( !xmlStrcmp( (const xmlChar *)tagName.c_str(), cur3->name ) )
-                            {
-                                arrayMember = true;                                                    //    if the same name appears it must be an array
-                            }
-                        }
-                        if( arrayMember )                                                          // Process all array children together
-                        {
-                            if( parent->isMap() )
-                            {
-                                // cppcheck-suppress cstyleCast
-                                ( ( COMap *) parent)->append( tagName, childObj = new COArray() );
-                            } else if( parent->isArray() ) {
-                                // cppcheck-suppress cstyleCast
-                                ( ( COArray *) parent)->append( childObj = new COArray() );
-                            }
-                            preStr = "\n  ";
-                            preStr += indent;
-                            parseNode( cur2, childObj, indent + "  " );
+CppON *CppONTable::cell( const char *s, size_t n, bool quoted, size_t col, std::string &buf )
+{
+	s = cellText( s, n, quoted, buf );
+	if( opt.types )
+	{
+		int64_t			i = 0;
+		CppONCellKind	k = ( kinds.size() > col ) ? (CppONCellKind) kinds[ col ] : CPPON_CELL_TEXT;
 
-                            for( cur3 = cur2->next; cur3; )                                          // See if they are part of an array
-                            {
-                                xmlNodePtr cur4 = cur3;
-                                cur3 = cur3->next;                                                    // Get next pointer in case we delete this one
-                                if( !xmlStrcmp( (const xmlChar *)tagName.c_str(), cur4->name ) )
-                                {
-                                    parseNode( cur4, childObj, indent + "  " );
-                                    xmlUnlinkNode( cur4 );
-                                    xmlFreeNode( cur4 );
-                                }
-                            }
-                        } else {
-                            preStr = "";
-                            parseNode( cur2, parent, indent );
-                        }
-                    } else if( ( value = trimTag( cur->xmlChildrenNode ) ) ) {                  // Node has attribute and content
-                        // cppcheck-suppress cstyleCast
-                        ( ( COMap *) parent)->append( "#text", childObj = new COString( value ) );
-                        delete[] value;
-                    }
-                }
-            }
-        } else if( ( value = trimTag( cur->xmlChildrenNode ) ) ) {
-            childObj = CppON::guessDataType( value );
-            delete[] value;
+		if( CPPON_CELL_TEXT != k && ! n )
+		{
+			return new CONull();
+		} else if( CPPON_CELL_INTEGER == k ) {
+			cellKind( s, n, i );
+			return new COInteger( i );
+		} else if( CPPON_CELL_REAL == k ) {
+			CppONParser	p( s, n );
+			bool		real;
+			uint64_t	u;
+			double		d = 0.0;
+			p.scalar( real, u, d );
+			return new CODouble( ( real ) ? d : (double) (int64_t) u );
+		}
+	}
+	return new COString( std::string( s, n ) );
+}
 
-            if( parent->isMap() )
-            {
-                // cppcheck-suppress cstyleCast
-                ( ( COMap *) parent)->append( (const char *)cur->name, childObj  );
-            } else if( parent->isArray() ) {
-                // cppcheck-suppress cstyleCast
-                ( ( COArray *) parent)->append( childObj );
-            }
-        }
-    } else {
-        if( (value = trimTag( cur ) ) )
-        {
-            childObj = CppON::guessDataType( value );
-            delete[] value;
+CppON *CppONTable::row( std::vector<CppON *> &cells )
+{
+	CppON *rtn;
+	if( opt.header )
+	{
+		COMap		*m = new COMap();
+		COMapData	*md = (COMapData *) m->data;
+		md->reserve( cells.size() );
+		for( size_t i = 0; cells.size() > i; i++ )
+		{
+			md->push( name( i ), cells[ i ] );
+		}
+		rtn = m;
+	} else {
+		COArray *a = new COArray();
+		( (std::vector<CppON *> *) a->data )->swap( cells );
+		rtn = a;
+	}
+	cells.clear();
+	return rtn;
+}
 
-            if( parent->isMap() )
-            {
-                // cppcheck-suppress cstyleCast
-                ( ( COMap *) parent)->append( indent, childObj );
-            } else if( parent->isArray() ) {
-                // cppcheck-suppress cstyleCast
-                ( ( COArray *) parent)->append( childObj );
-            }
-        }
-    }
-    return rtn;
+/*
+ * Throw away what the chunks built, their cuts were wrong
+ */
+void CppONTable::discard()
+{
+	for( size_t i = 0; chunks.size() > i; i++ )
+	{
+		CppONTableChunk &c = chunks[ i ];
+		for( size_t r = 0; c.rows.size() > r; r++ )
+		{
+			delete c.rows[ r ];
+		}
+		for( size_t k = 0; c.cols.size() > k; k++ )
+		{
+			for( size_t r = 0; c.cols[ k ].size() > r; r++ )
+			{
+				delete c.cols[ k ][ r ];
+			}
+		}
+	}
+	chunks.clear();
 }
 
-// cppcheck-suppress unusedFunction
-CppON *CppON::parseXML( const char *str )
+CppON *CppONTable::assemble()
 {
-    CppON         *rtn = NULL;
-    xmlDocPtr       doc;
-    xmlNodePtr       cur;
+	size_t total = 0;
+	for( size_t i = 0; chunks.size() > i; i++ )
+	{
+		total += chunks[ i ].nRows;
+	}
+	if( ! opt.columns )
+	{
+		COArray					*rtn = new COArray();
+		std::vector<CppON *>	*v = (std::vector<CppON *> *) rtn->data;
+		v->reserve( total );
+		for( size_t i = 0; chunks.size() > i; i++ )
+		{
+			v->insert( v->end(), chunks[ i ].rows.begin(), chunks[ i ].rows.end() );
+		}
+		return rtn;
+	}
 
-    if( ! str )
-    {
-        fprintf( stderr, "Attempt to convert an empty string to a data Object\n");
-    } else if( !( doc = ( '.' == *str || '/' == *str) ? xmlParseFile( str ) : xmlParseDoc( (const xmlChar *)str ) ) ) {
-        fprintf( stderr, "Empty Document!\n" );
-        xmlFreeDoc( doc );
-    } else if( !(cur = xmlDocGetRootElement( doc ) ) ) {
-        fprintf( stderr, "Failed to get root node!\n" );
-        xmlFreeDoc( doc );
-    } else {
-        rtn = new COMap( );                                      // Create the new Map object to return
-        parseNode( cur, rtn, std::string( "" ) );
-        xmlFreeDoc( doc );
-    }
-    return rtn;
+	size_t nCols = names.size();
+	for( size_t i = 0; chunks.size() > i; i++ )
+	{
+		nCols = std::max( nCols, chunks[ i ].cols.size() );
+	}
+	COMap		*map = ( opt.header ) ? new COMap() : NULL;
+	COArray		*arr = ( opt.header ) ? NULL : new COArray();
+	for( size_t k = 0; nCols > k; k++ )
+	{
+		COArray					*column = new COArray();
+		std::vector<CppON *>	*v = (std::vector<CppON *> *) column->data;
+		v->reserve( total );
+		for( size_t i = 0; chunks.size() > i; i++ )
+		{
+			CppONTableChunk &c = chunks[ i ];
+			if( c.cols.size() > k )
+			{
+				v->insert( v->end(), c.cols[ k ].begin(), c.cols[ k ].end() );
+			} else {
+				for( size_t r = 0; c.nRows > r; r++ )
+				{
+					v->push_back( new CONull() );
+				}
+			}
+		}
+		if( map )
+		{
+			( (COMapData *) map->data )->push( name( k ), column );
+		} else {
+			( (std::vector<CppON *> *) arr->data )->push_back( column );
+		}
+	}
+	return ( map ) ? (CppON *) map : (CppON *) arr;
 }
-#endif
 
-// cppcheck-suppress unusedFunction
-CppON *CppON::parseTSV(const char *str )
+CppON *CppON::parseTable( const char *str, size_t len, const CppONTableOptions &opt )
 {
-    COArray   *rtn = NULL;
-    if( ! str || ! str[ 0 ] )
-    {
-        fprintf( stderr, "Attempt to convert an empty string to a data Object\n");
-    }  else {
-        FILE *fd;
-        if( ! ( fd = fopen( str, "r" ) ) )
-        {
-            fprintf( stderr, "Failed to open file %s: %d - %s\n",str, errno, strerror( errno ) );
-        } else {
-            int           ch = 0;
-            std::string   s;
-            COArray       *line= new COArray();
-
-            rtn = new COArray();
+	CppONTable t( ( str ) ? str : "", ( str ) ? len : 0, opt );
+	return t.parse();
+}
 
-            while( EOF != ( ch = fgetc( fd ) ) )
-            {
-                if( '\n' == ch )
-                {
-                    line->append( new COString( s ) );
-                    s.clear();
-                    rtn->append( line );
-                    line = new COArray();
-                } else if( '\t' == ch ) {
-                    line->append( new COString( s ) );
-                    s.clear();
-                } else if( 31 <= ch && 127 > ch ) {
-                    s += ch;
-                }
-            }
+/*
+ * The file is mapped and parsed where it lies, see CppONFileImage
+ */
+CppON *CppON::parseTable( const char *path, const CppONTableOptions &opt )
+{
+	if( ! path || ! path[ 0 ] )
+	{
+		fprintf( stderr, "Attempt to convert an empty string to a data Object\n");
+		return NULL;
+	}
+	CppONFileImage img( path );
+	if( ! img.ok() )
+	{
+		fprintf( stderr, "Failed to open file %s: %d - %s\n", path, errno, strerror( errno ) );
+		return NULL;
+	}
+	return parseTable( img.data(), img.length(), opt );
+}
 
-            delete( line );
-            fclose( fd );
-        }
-    }
-    return rtn;
+// cppcheck-suppress unusedFunction
+CppON *CppON::parseTSV(const char *str )
+{
+    return parseTable( str, CppONTableOptions( '\t' ) );
 }
 
 // cppcheck-suppress unusedFunction
 CppON *CppON::parseCSV(const char *str )
 {
-    COArray   *rtn = NULL;
-    if( ! str || ! str[ 0 ] )
-    {
-        fprintf( stderr, "Attempt to convert an empty string to a data Object\n");
-    }  else {
-        FILE *fd;
-        if( ! ( fd = fopen( str, "r" ) ) )
-        {
-            fprintf( stderr, "Failed to open file %s: %d - %s\n",str, errno, strerror( errno ) );
-        } else {
-            int           ch = 0;
-            std::string   s;
-            COArray       *line= new COArray();
-
-            rtn = new COArray();
-
-            while( EOF != ( ch = fgetc( fd ) ) )
-            {
-                if( '\n' == ch )
-                {
-                    line->append( new COString( s ) );
-                    s.clear();
-                    rtn->append( line );
-                    line = new COArray();
-                } else if( ',' == ch ) {
-                    line->append( new COString( s ) );
-                    s.clear();
-                } else if( 31 <= ch && 127 > ch ) {
-                    s += ch;
-                }
-            }
-
-            delete( line );
-            fclose( fd );
-        }
-    }
-    return rtn;
+    return parseTable( str, CppONTableOptions( ',' ) );
 }
 
 /*
@@ -2124,6 +6378,15 @@ double CppON::toDouble( void )
 
 CppON *CppON::operator = ( CppON &val )
 {
+    touch();
+    if( this == &val )
+    {
+        return this;
+    }
+    if( typ != val.typ )
+    {
+        deleteData();                                               // while typ still says what data is
+    }
     typ = val.typ;
     switch( val.typ )
     {
@@ -2202,21 +6465,25 @@ CppON *CppON::operator = ( CppON &val )
             {
                 deleteData();
                 siz = val.size();
-                data = new map<string, CppON*>();
-                map<string, CppON*> *th = (map<string, CppON*> *) data;
-                COMap  *m = (COMap *) &val;
+                if( copyMembers( val ) )
+                {
+                    break;
+                }
+                data = new COMapData();
+                COMapData *th = (COMapData *) data;
+                COMapData *m = (COMapData *) val.data;
+                th->reserve( m->size() );
                 // cppcheck-suppress postfixOperator
-                for( std::vector<std::string>::iterator itr = m->order.begin(); m->order.end() != itr; itr++ )
+                for( COMapData::iterator itr = m->begin(); m->end() != itr; itr++ )
                 {
-                    CppON *obj = m->findCaseElement( itr->c_str() );
+                    CppON *obj = itr->second;
                     if( obj )
                     {
-                        order.push_back( string( *itr ) );
                         switch( obj->typ )
                         {
                             case INTEGER_CPPON_OBJ_TYPE:
                                 // cppcheck-suppress cstyleCast
-                                th->insert( th->end(), pair< string, CppON* >( itr->c_str(), new COInteger( *((COInteger *)obj ) ) ) );
+                                th->insert( th->end(), pair< string, CppON* >( itr->first, new COInteger( *((COInteger *)obj ) ) ) );
                                 break;
 
                             case DOUBLE_CPPON_OBJ_TYPE:
@@ -2225,7 +6492,7 @@ CppON *CppON::operator = ( CppON &val )
                                     char p = ( (CODouble *)obj )->Precision();
                                     CODouble *d;
                                     // cppcheck-suppress cstyleCast
-                                    th->insert( th->end(), pair< string, CppON* >( itr->c_str(), d = new CODouble( *( (CODouble *)obj ) ) ) );
+                                    th->insert( th->end(), pair< string, CppON* >( itr->first, d = new CODouble( *( (CODouble *)obj ) ) ) );
                                     if( 0 <= p )
                                     {
                                         d->Precision( p );
@@ -2235,27 +6502,27 @@ CppON *CppON::operator = ( CppON &val )
 
                             case STRING_CPPON_OBJ_TYPE:
                                 // cppcheck-suppress cstyleCast
-                                th->insert( th->end(), pair< string, CppON* >( itr->c_str(), new COString( *( (COString *)obj ) ) ) );
+                                th->insert( th->end(), pair< string, CppON* >( itr->first, new COString( *( (COString *)obj ) ) ) );
                                 break;
 
                             case NULL_CPPON_OBJ_TYPE:
                                 // cppcheck-suppress cstyleCast
-                                th->insert( th->end(), pair< string, CppON* >( itr->c_str(), new CONull( *( (CONull *)obj ) ) ) );
+                                th->insert( th->end(), pair< string, CppON* >( itr->first, new CONull( *( (CONull *)obj ) ) ) );
                                 break;
 
                             case BOOLEAN_CPPON_OBJ_TYPE:
                                 // cppcheck-suppress cstyleCast
-                                th->insert( th->end(), pair< string, CppON* >( itr->c_str(), new COBoolean( *( (COBoolean *)obj ) ) ) );
+                                th->insert( th->end(), pair< string, CppON* >( itr->first, new COBoolean( *( (COBoolean *)obj ) ) ) );
                                 break;
 
                             case MAP_CPPON_OBJ_TYPE:
                                 // cppcheck-suppress cstyleCast
-                                th->insert( th->end(), pair< string, CppON* >( itr->c_str(), new COMap( *( (COMap *)obj ) ) ) );
+                                th->insert( th->end(), pair< string, CppON* >( itr->first, new COMap( *( (COMap *)obj ) ) ) );
                                 break;
 
                             case ARRAY_CPPON_OBJ_TYPE:
                                 // cppcheck-suppress cstyleCast
-                                th->insert( th->end(), pair< string, CppON* >( itr->c_str(), new COArray( *( (COArray *)obj ) ) ) );
+                                th->insert( th->end(), pair< string, CppON* >( itr->first, new COArray( *( (COArray *)obj ) ) ) );
                                 break;
 
                             default:
@@ -2269,10 +6536,14 @@ CppON *CppON::operator = ( CppON &val )
             {
                 deleteData();
                 siz = val.size();
+                if( copyMembers( val ) )
+                {
+                    break;
+                }
                 data = new vector<CppON *>();
                 for( int i = 0; siz > i; i++ )
                 {
-                    CppON *jt = ((COArray &) val ).at( i );
+                    CppON *jt = ( *(vector<CppON *> *) val.data )[ i ];
                     switch( jt->type() )
                     {
                         case INTEGER_CPPON_OBJ_TYPE:
@@ -2344,13 +6615,18 @@ string *COBoolean::toNetString()
     {
         return NULL;
     }
-    const char *val = *( (char *) data )  ? "true" : "false";
-    return CppON::toNetString( val, '!' );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn, CPPON_WRITE_TNET );
+    w.write( this ).flush();
+    return rtn;
 }
 
 string *COBoolean::toJsonString()
 {
-    return new string( ((value())? "true" : "false") );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
+    return rtn;
 }
 
 void COBoolean::dump( FILE *fp )
@@ -2367,52 +6643,277 @@ const char  *COBoolean::c_str()
     return str.c_str();
 }
 
+/****************************************************************************************/
+/*                                                                                      */
+/*                                  COMapData                                           */
+/*                                                                                      */
+/****************************************************************************************/
+
+/*
+ * FNV-1a over the key bytes.
+ */
+size_t COMapData::hash( const char *key, size_t len )
+{
+    size_t h = 14695981039346656037ULL;
+    for( size_t i = 0; len > i; i++ )
+    {
+        h ^= (unsigned char) key[ i ];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*
+ * Small maps are scanned, a short key compare is cheaper than hashing.  Larger ones probe the index.
+ */
+COMapData::iterator COMapData::find( const char *key, size_t len )
+{
+    if( index.empty() )
+    {
+        for( iterator it = items.begin(); items.end() != it; ++it )
+        {
+            if( it->first.size() == len && ! memcmp( it->first.data(), key, len ) )
+            {
+                return it;
+            }
+        }
+        return items.end();
+    }
+    size_t mask = index.size() - 1;
+    for( size_t slot = hash( key, len ) & mask; index[ slot ]; slot = ( slot + 1 ) & mask )
+    {
+        value_type &v = items[ index[ slot ] - 1 ];
+        if( v.first.size() == len && ! memcmp( v.first.data(), key, len ) )
+        {
+            return items.begin() + ( index[ slot ] - 1 );
+        }
+    }
+    return items.end();
+}
+
+std::pair<COMapData::iterator, bool> COMapData::insert( const value_type &v )
+{
+    iterator it = find( v.first );
+    if( items.end() != it )
+    {
+        return std::pair<iterator, bool>( it, false );
+    }
+    push( v.first, v.second );
+    return std::pair<iterator, bool>( items.end() - 1, true );
+}
+
+CppON *&COMapData::operator[]( const std::string &key )
+{
+    iterator it = find( key );
+    if( items.end() != it )
+    {
+        return it->second;
+    }
+    push( key, NULL );
+    return items.back().second;
+}
+
+void COMapData::push( const std::string &key, CppON *val )
+{
+    push( std::string( key ), val );
+}
+
+void COMapData::push( std::string &&key, CppON *val )
+{
+    items.push_back( value_type( std::move( key ), val ) );
+    if( ! index.empty() && index.size() >= 2 * items.size() )
+    {
+        addIndex( items.size() - 1 );
+    } else if( COMAP_INDEX_THRESHOLD <= items.size() ) {
+        rebuildIndex();
+    }
+}
+
+COMapData::iterator COMapData::erase( iterator it )
+{
+    size_t pos = it - items.begin();
+
+    if( ! index.empty() )
+    {
+        dropIndex( pos );
+    }
+    it = items.erase( it );
+    if( index.empty() || items.size() <= pos )
+    {
+        return items.begin() + pos;
+    }
+    if( 8 * ( items.size() - pos ) < index.size() )                  // The members after it moved down one, find each
+    {
+        size_t mask = index.size() - 1;
+        for( size_t at = pos; items.size() > at; at++ )
+        {
+            size_t slot = hash( items[ at ].first.data(), items[ at ].first.size() ) & mask;
+            while( index[ slot ] != at + 2 )
+            {
+                slot = ( slot + 1 ) & mask;
+            }
+            index[ slot ] = (uint32_t) ( at + 1 );
+        }
+    } else {                                                          // or sweep the table when most of them moved
+        for( std::vector<uint32_t>::iterator slot = index.begin(); index.end() != slot; ++slot )
+        {
+            *slot -= ( *slot > pos + 1 ) ? 1 : 0;
+        }
+    }
+    return items.begin() + pos;
+}
+
+size_t COMapData::erase( const std::string &key )
+{
+    iterator it = find( key );
+    if( items.end() != it )
+    {
+        erase( it );
+        return 1;
+    }
+    return 0;
+}
+
+void COMapData::addIndex( size_t pos )
+{
+    size_t mask = index.size() - 1;
+    size_t slot = hash( items[ pos ].first.data(), items[ pos ].first.size() ) & mask;
+    while( index[ slot ] )
+    {
+        slot = ( slot + 1 ) & mask;
+    }
+    index[ slot ] = (uint32_t) ( pos + 1 );
+}
+
+/*
+ * Take the member at pos out of the index with backward shift deletion:  each entry after the hole in its probe run that
+ * could live in the hole moves back into it, so no tombstones are left and nothing else is rehashed.
+ */
+void COMapData::dropIndex( size_t pos )
+{
+    size_t mask = index.size() - 1;
+    size_t hole = hash( items[ pos ].first.data(), items[ pos ].first.size() ) & mask;
+
+    while( index[ hole ] != pos + 1 )
+    {
+        hole = ( hole + 1 ) & mask;
+    }
+    for( size_t slot = ( hole + 1 ) & mask; index[ slot ]; slot = ( slot + 1 ) & mask )
+    {
+        const std::string   &key = items[ index[ slot ] - 1 ].first;
+        size_t              home = hash( key.data(), key.size() ) & mask;
+
+        if( ( ( slot - home ) & mask ) >= ( ( slot - hole ) & mask ) )  // home is at or before the hole in the run
+        {
+            index[ hole ] = index[ slot ];
+            hole = slot;
+        }
+    }
+    index[ hole ] = 0;
+}
+
+/*
+ * Size the table to at least four slots per member so it stays sparse until the next rebuild, which happens when it
+ * fills to half.
+ */
+void COMapData::rebuildIndex()
+{
+    index.clear();
+    if( COMAP_INDEX_THRESHOLD <= items.size() )
+    {
+        size_t cap = 2 * COMAP_INDEX_THRESHOLD;
+        while( cap < 4 * items.size() )
+        {
+            cap <<= 1;
+        }
+        index.assign( cap, 0 );
+        for( size_t pos = 0; items.size() > pos; pos++ )
+        {
+            addIndex( pos );
+        }
+    }
+}
+
 /****************************************************************************************/
 /*                                                                                      */
 /*                                    COMap                                             */
 /*                                                                                      */
 /****************************************************************************************/
 
+COMap::COMap( std::map < std::string, CppON *> &m ) : CppON( MAP_CPPON_OBJ_TYPE )
+{
+    COMapData *dm = new COMapData();
+    dm->reserve( m.size() );
+    // cppcheck-suppress postfixOperator
+    for( std::map< std::string, CppON *>::iterator it = m.begin(); m.end() != it; it++ )
+    {
+        dm->push( it->first, it->second );
+    }
+    data = dm;
+}
+
+/*
+ * The keys are not kept separately, so the list is rebuilt from the members on each call.
+ */
+std::vector<std::string> *COMap::getKeys()
+{
+    order.clear();
+    if( data )
+    {
+        COMapData *m = (COMapData *) data;
+        order.reserve( m->size() );
+        for( COMapData::iterator it = m->begin(); m->end() != it; ++it )
+        {
+            order.push_back( it->first );
+        }
+    }
+    return &order;
+}
+
 COMap::COMap( COMap *mt ) : CppON(  MAP_CPPON_OBJ_TYPE )
 {
-    data = new map<string, CppON*>();
-    std::map< std::string, CppON * >  &dm = *( ( map<string, CppON*> * ) data );
+    if( copyMembers( *mt ) )
+    {
+        return;
+    }
+    data = new COMapData();
+    COMapData  &dm = *( ( COMapData * ) data );
 
+    dm.reserve( ( (COMapData *) mt->data )->size() );
     // cppcheck-suppress postfixOperator
-    for( std::vector<std::string>::iterator itr = mt->order.begin(); mt->order.end() != itr; itr++ )
+    for( COMapData::iterator itr = ( (COMapData *) mt->data )->begin(); ( (COMapData *) mt->data )->end() != itr; itr++ )
     {
-        CppON *obj = mt->findCaseElement( itr->c_str() );
-        order.push_back( string( *itr ) );
+        CppON *obj = itr->second;
         switch( obj->type() )
         {
             case INTEGER_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new COInteger( *((COInteger *)obj ) );
+                dm.push( itr->first, new COInteger( *((COInteger *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
              case DOUBLE_CPPON_OBJ_TYPE:
-                 dm[ *itr ] = new CODouble( *( (CODouble *)obj ) );
+                 dm.push( itr->first, new CODouble( *( (CODouble *)obj ) ) );
                  // cppcheck-suppress cstyleCast
                  break;
              case STRING_CPPON_OBJ_TYPE:
-                 dm[ *itr ] = new COString( *( (COString *)obj ) );
+                 dm.push( itr->first, new COString( *( (COString *)obj ) ) );
                  // cppcheck-suppress cstyleCast
                  break;
 
              case NULL_CPPON_OBJ_TYPE:
-                 dm[ *itr ] = new CONull( *( (CONull *)obj ) );
+                 dm.push( itr->first, new CONull( *( (CONull *)obj ) ) );
                  // cppcheck-suppress cstyleCast
                  break;
 
              case BOOLEAN_CPPON_OBJ_TYPE:
-                 dm[ *itr ] = new COBoolean( *( (COBoolean *)obj ) );
+                 dm.push( itr->first, new COBoolean( *( (COBoolean *)obj ) ) );
                  // cppcheck-suppress cstyleCast
                  break;
              case MAP_CPPON_OBJ_TYPE:
-                 dm[ *itr ] = new COMap( *( (COMap *)obj ) );
+                 dm.push( itr->first, new COMap( *( (COMap *)obj ) ) );
                  // cppcheck-suppress cstyleCast
                  break;
              case ARRAY_CPPON_OBJ_TYPE:
-                 dm[ *itr ] = new COArray( *( (COArray *)obj ) );
+                 dm.push( itr->first, new COArray( *( (COArray *)obj ) ) );
                  // cppcheck-suppress cstyleCast
                  break;
              default:
@@ -2423,42 +6924,46 @@ COMap::COMap( COMap *mt ) : CppON(  MAP_CPPON_OBJ_TYPE )
 
 COMap::COMap( COMap & mt ) : CppON(  MAP_CPPON_OBJ_TYPE )
 {
-    data = new map<string, CppON*>();
-    std::map< std::string, CppON * >  &dm = *( ( map<string, CppON*> * ) data );
+    if( copyMembers( mt ) )
+    {
+        return;
+    }
+    data = new COMapData();
+    COMapData  &dm = *( ( COMapData * ) data );
 
+    dm.reserve( ( (COMapData *) mt.data )->size() );
     // cppcheck-suppress postfixOperator
-    for( std::vector<std::string>::iterator itr = mt.order.begin(); mt.order.end() != itr; itr++ )
+    for( COMapData::iterator itr = ( (COMapData *) mt.data )->begin(); ( (COMapData *) mt.data )->end() != itr; itr++ )
     {
-        CppON *obj = mt.findCaseElement( itr->c_str() );
-        order.push_back( string( *itr ) );
+        CppON *obj = itr->second;
         switch( obj->type() )
         {
             case INTEGER_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new COInteger( *((COInteger *)obj ) );
+                dm.push( itr->first, new COInteger( *((COInteger *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             case DOUBLE_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new CODouble( *( (CODouble *)obj ) );
+                dm.push( itr->first, new CODouble( *( (CODouble *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             case STRING_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new COString( *( (COString *)obj ) );
+                dm.push( itr->first, new COString( *( (COString *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             case NULL_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new CONull( *( (CONull *)obj ) );
+                dm.push( itr->first, new CONull( *( (CONull *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             case BOOLEAN_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new COBoolean( *( (COBoolean *)obj ) );
+                dm.push( itr->first, new COBoolean( *( (COBoolean *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             case MAP_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new COMap( *( (COMap *)obj ) );
+                dm.push( itr->first, new COMap( *( (COMap *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             case ARRAY_CPPON_OBJ_TYPE:
-                dm[ *itr ] = new COArray( *( (COArray *)obj ) );
+                dm.push( itr->first, new COArray( *( (COArray *)obj ) ) );
                 // cppcheck-suppress cstyleCast
                 break;
             default:
@@ -2468,89 +6973,40 @@ COMap::COMap( COMap & mt ) : CppON(  MAP_CPPON_OBJ_TYPE )
 };
 
 /*
- * Does not check for null string
+ * Parse a JSON (or TNet) map straight into this one.  Members parsed before an error are kept.
  */
-void COMap::doParse( const char *str )
-{
-	DumpWhiteSpace( str );
-	const char	*sav = str;
-	unsigned 	i;
-	if( '{' == *str )
-	{
-		char 		name[ 256 ];
-		char		ch;
-		CppON		*obj = NULL;
-		++str;
-		DumpWhiteSpace( ch, str );
-		while( *str )
-		{
-			sav = str;
-			if( '"' == *str++ )
-			{
-				for( i = 0; i < 255 && 0 != ( ch = *str++ ) && '"' != ch; i++ )
-				{
-					name[ i ] = ch;
-				}
-				name[ i ] = '\0';
-				if( '"' == ch )
-				{
-					DumpWhiteSpace( ch, str );
-					sav = str;
-//					if( ':' == *str )
-					if( ':' == ch )
-					{
-						++str;
-						DumpWhiteSpace( ch, str );
-						sav = str;
-						while( 0 != (ch = *str ) && ( ' ' == ch || '\t' == ch || '\n' == ch || '\r' == ch ) ) { ++str; }
-						if( '0' <= ch && '9' >= ch )
-						{
-							obj = GetTNetstring( &str );
-						} else if( ch ) {
-							obj =  GetObj( &str );
-						}
-						if( obj )
-						{
-							append( name, obj );
-							obj = NULL;
-							DumpWhiteSpace( ch, str );
-//							if( *str )
-							if( ch )
-							{
-								if( ',' == *str )
-								{
-									str++;
-									DumpWhiteSpace( ch, str );
-								} else if( '}' == *str ) {
-									break;
-								} else {
-									fprintf( stderr, "%s[%d]: Unexpected character: '%c'\n", __FILE__,__LINE__, *str );
-									break;
-								}
-							}
-						} else {
-							std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-							fprintf( stderr, "%s[%d]: Failed to get object: '%s'\n", __FILE__,__LINE__, s.c_str() );
-						}
-					} else {
-						std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-						fprintf( stderr, "%s[%d]: Unexpected character: '%s'\n", __FILE__,__LINE__, sav );
-						break;
-					}
-				} else {
-					std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-					fprintf( stderr, "%s[%d]: Unexpected character: '%s'\n", __FILE__,__LINE__, sav );
-					break;
-				}
-			} else {
-				std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-				fprintf( stderr, "%s[%d]: Unexpected character: '%s'\n", __FILE__,__LINE__, sav );
-				break;
-			}
+void COMap::doParse( const char *str, size_t len )
+{
+	CppONParser	p( str, len );
+
+	p.skipWhiteSpace();
+	if( '{' == p.peek() )
+	{
+		if( ! p.object( this ) )
+		{
+			CppONParseError err;
+			p.getError( err );
+			fprintf( stderr, "%s[%d]: Parse error: %s at line %u column %u\n", __FILE__, __LINE__, err.message(), err.line, err.column );
 		}
-	} else {
-		std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-		fprintf( stderr, "%s[%d]: Parse ERROR: Expected '{' got '%s'\n", __FILE__, __LINE__, sav );
+	} else if( '0' <= p.peek() && '9' >= p.peek() ) {
+		CppON *obj = p.value();
+		if( CppON::isMap( obj ) )
+		{
+			// cppcheck-suppress cstyleCast
+			std::swap( data, ( (COMap *) obj )->data );
+			// cppcheck-suppress cstyleCast
+			std::swap( inArena, ( (COMap *) obj )->inArena );
+		} else {
+			fprintf( stderr, "%s[%d]: Parse ERROR: TNet string is not a map\n", __FILE__, __LINE__ );
+		}
+		if( obj )
+		{
+			delete obj;
+		}
+	} else if( p.peek() ) {
+		size_t		rem = str + len - p.position();
+		std::string	s( p.position(), ( 24 < rem ) ? 24 : rem );
+		fprintf( stderr, "%s[%d]: Parse ERROR: Expected '{' got '%s'\n", __FILE__, __LINE__, s.c_str() );
 	}
 }
 void COMap::parseData( const char *str )
@@ -2558,7 +7014,7 @@ void COMap::parseData( const char *str )
 	if( str )
 	{
 #if 1
-		doParse( str );
+		doParse( str, strlen( str ) );
 #else
         json_t        *root = NULL;
         json_error_t  error;
@@ -2609,46 +7065,19 @@ void COMap::parseData( const char *str )
 
 COMap::COMap( const char *path, const char *file ): CppON( MAP_CPPON_OBJ_TYPE )
 {
-    data = new map<string, CppON*>();
-	struct stat     _stat;
+    data = new COMapData();
 	std::string p( path );
-	FILE    *fp;
 
 	if( '/' != p.back() )
 	{
 		p += '/';
 	}
 	p.append( file );
-	if( ! stat( p.c_str(), &_stat ) && ! ( _stat.st_mode & DIRECTORY_BIT ) && (fp = fopen( p.c_str(), "r" ) ) )
-	{
-	    int     sz = 1024;
-	    char    *buf,*bSave;
-	    int     rd = 0;
-	    int     c;
-
-	    if( !( buf = (char *) malloc( sz ) ) )
-	    {
-	        fclose( fp );
-	        fprintf( stderr, "%s[%.4u]: Failed to allocate memory",__FILE__, __LINE__ );
-	    }
-	    while( EOF != ( c = fgetc( fp ) ) )
-	    {
-	        buf[ rd++ ] = ( char ) c;
-	        if( rd == sz )
-	        {
-	            if( !( buf = (char *) realloc( (void *) (bSave = buf ), sz += 512 ) ) )
-	            {
-	    	        fprintf( stderr, "%s[%.4u]: Failed to reallocate memory: %d bytes!",__FILE__, __LINE__, sz );
-	                free( bSave );
-	            }
-	        }
-	    }
-	    buf[ rd ] = '\0';
-	    fclose( fp );
-//	    fprintf( stderr, "DATA TO PARSE: '%s'\n", buf );
-	    parseData( buf );
 
-	    free(buf );
+	CppONFileImage	img( p.c_str() );
+	if( img.ok() )
+	{
+		doParse( img.data(), img.length() );
 	} else {
         fprintf( stderr, "%s[%.4u]: Failed to open JSON FILE \"%s\"",__FILE__, __LINE__, p.c_str() );
 	}
@@ -2656,7 +7085,7 @@ COMap::COMap( const char *path, const char *file ): CppON( MAP_CPPON_OBJ_TYPE )
 
 COMap::COMap( const char *str ): CppON(  MAP_CPPON_OBJ_TYPE )
 {
-    data = new map<string, CppON*>();
+    data = new COMapData();
 #if 1
     parseData( str );
 #else
@@ -2711,16 +7140,25 @@ COMap::COMap( const char *str ): CppON(  MAP_CPPON_OBJ_TYPE )
 
 COMap *COMap::operator=( const char *str )
 {
+    touch();
 #if 1
+    if( shared )
+    {
+        deleteData();                                               // let go of data shared with copies
+    }
     if( data )
     {
-        (( map <string, CppON *> * ) data)->clear();
+        (( COMapData * ) data)->clear();
+        changed();
     } else {
-        data = new map<string, CppON*>();
+        data = new COMapData();
     }
     order.clear();
 
-    doParse( str );
+    if( str )
+    {
+    	doParse( str, strlen( str ) );
+    }
 
 #else
     if( str )
@@ -2733,16 +7171,17 @@ COMap *COMap::operator=( const char *str )
 
         if( data )
         {
-            map <string, CppON*> *m = ( map <string, CppON *> * ) data;
-            map<string, CppON *>::iterator it;
+            COMapData *m = ( COMapData * ) data;
+            COMapData::iterator it;
             // cppcheck-suppress postfixOperator
             for( it = m->begin(); m->end() != it; it++ )
             {
                 delete( it->second);
             }
             m->clear();
+            changed();
         } else {
-            data = new map<string, CppON*>();
+            data = new COMapData();
         }
         order.clear();
         if( np != str )
@@ -2785,9 +7224,10 @@ COMap *COMap::operator=( const char *str )
     } else {
         if( data )
         {
-            (( map <string, CppON *> * ) data)->clear();
+            (( COMapData * ) data)->clear();
+            changed();
         } else {
-            data = new map<string, CppON*>();
+            data = new COMapData();
         }
         order.clear();
     }
@@ -2796,73 +7236,93 @@ COMap *COMap::operator=( const char *str )
 }
 
 // cppcheck-suppress unusedFunction
-void COMap::replaceObj( string s, CppON *obj )
+void COMap::replaceObj( const string &s, CppON *obj )
 {
-    map <string, CppON *> *m = ( map <string, CppON*> *) data;
-    map <string, CppON *>::iterator it;
+    touch();
+    expose();
+    COMapData *m = ( COMapData *) data;
+    COMapData::iterator it;
     if( m->end( ) != (it = m->find( s ) ) )
     {
         delete it->second;
         it->second = obj;
+        changed();
     }
 }
 
 // cppcheck-suppress unusedFunction
-void COMap::removeVal( string s )
+void COMap::removeVal( const string &s )
 {
-    map <string, CppON *> *m = ( map <string, CppON*> *) data;
-    map <string, CppON *>::iterator it;
+    touch();
+    unshare();
+    COMapData *m = ( COMapData *) data;
+    COMapData::iterator it;
 
     if( m->end( ) != (it = m->find( s ) ) )
     {
         m->erase( it );
-        for( std::vector<std::string>::iterator iter = order.begin(); order.end() != iter; ++iter )
-        {
-            if( ! iter->compare( s ) )
-            {
-                order.erase( iter );
-                break;
-            }
-        }
+        changed();
     }
 }
 
 void COMap::clear( )
 {
-    map <string, CppON*> *m = ( map <string, CppON *> * ) data;
-    map<string, CppON *>::iterator it;
+    touch();
+    unshare();
+    COMapData *m = ( COMapData * ) data;
+    COMapData::iterator it;
     // cppcheck-suppress postfixOperator
     for( it = m->begin(); m->end() != it; it++ )
     {
         delete( it->second);
     }
     m->clear();
+    changed();
     order.clear();
 }
 
+/*
+ * True when a and b hold the same tree.  Hashes that differ prove they don't but equal ones are only a hint, two trees can
+ * collide, so == confirms it.  == stops at the first difference and takes data shared by copies as equal unwalked.
+ */
+static inline bool sameTree( CppON *a, CppON *b )
+{
+    return a == b || ( a->hash() == b->hash() && *a == *b );
+}
+
+/*
+ * The same when both hashes are already cached.  merge() and upDate() skip such members without hashing anything new,
+ * hashing inside them would be wasted on trees they are about to change.
+ */
+static inline bool sameHash( CppON *a, CppON *b )
+{
+    return a && b && a->type() == b->type() && a->hashed() && b->hashed() && a->hash() == b->hash() && *a == *b;
+}
+
 void COMap::merge( COMap *targetObj, const char *name )
 {
+    unshare();
+    CppONPath key( ( name ) ? name : "" );
     if( ! data )
     {
-        data = new std::map<std::string, CppON*>();                         		// data object you are merging too.
+        data = new COMapData();                         		// data object you are merging too.
     }
-    map<string, CppON *> *s = (map<string, CppON *> *) targetObj->data; 			// s is the data object of the map you are merging
-    for( map< string, CppON *>::iterator ti = s->begin(); s->end() != ti; ++ti )	// foreach object in map you are merging
+    COMapData *s = (COMapData *) targetObj->data; 			// s is the data object of the map you are merging
+    for( COMapData::iterator ti = s->begin(); s->end() != ti; ++ti )	// foreach object in map you are merging
     {
         const string                      *targetStr = &(ti->first);      			// get Object name
         CppONType                       _eType = (ti->second)->type();      		// get type of object
         CppON                           *myObj = NULL;                      		// Place to save an object that is found.
-        map<string, CppON *>::iterator  it;                                 		// Used to search destination
+        COMapData::iterator  it;                                 		// Used to search destination
 
-        map<string, CppON *> *m = (map<string, CppON *> *) data;          			// Search the destination for any objects with the same name.
-        // cppcheck-suppress postfixOperator
-        for( it = m->begin(); m->end() != it; it++ )
+        COMapData *m = (COMapData *) data;          			// Search the destination for any objects with the same name.
+        if( m->end() != ( it = m->find( *targetStr ) ) )
         {
-            if( ! strcmp(  (it->first).c_str(), targetStr->c_str() ) )          	// Find the object
-            {
-                myObj = it->second;                                               	// OK we have it already. set "myObj" to it and quit looking
-                break;
-            }
+            myObj = it->second;                                               		// OK we have it already. set "myObj" to it
+        }
+        if( myObj && sameHash( myObj, ti->second ) )                               	// Already the same
+        {
+            continue;
         }
         if( myObj )                                                           		// We found it so we need to merge the reasult
         {
@@ -2875,6 +7335,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                         *((COInteger *) myObj) = (long long)(COInteger *)(ti->second )->toLongInt(); // set it to the new one
                     } else {                                                          //    If not
                         m->erase( it );                                                 //      Delete it and add the new object
+                        changed();
                         delete myObj;
                         // cppcheck-suppress cstyleCast
                         append( targetStr->c_str(), new COInteger( (uint64_t)(COInteger *)( ti->second )->toLongInt( ) ) );
@@ -2887,6 +7348,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                         ((CODouble *) myObj)->set( ((CODouble *)(ti->second ) )->toDouble());  // set it to the new value
                     } else {                                                          //      else if it of a different type than delete the old and replace
                         m->erase( it );
+                        changed();
                         delete myObj;
                         // cppcheck-suppress cstyleCast
                         append( targetStr->c_str(), new CODouble( (double)((CODouble *)( ti->second ))->toLongInt( ) ) );
@@ -2899,6 +7361,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                         *((COString *) myObj) = ((COString *)(ti->second ) )->c_str();
                     } else {
                         m->erase( it );
+                        changed();
                         delete myObj;
                         // cppcheck-suppress cstyleCast
                         append( targetStr->c_str(), new COString( ((COString *)( ti->second ))->c_str() ) );
@@ -2908,6 +7371,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                     if( NULL_CPPON_OBJ_TYPE != myObj->type())                               //  But if the old one exist and it isn't null,
                     {
                         m->erase( it );                                                   //    delete it and set it to null
+                        changed();
                         delete myObj;
                         append( targetStr->c_str(), new CONull() );
                     }
@@ -2919,6 +7383,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                         *((COBoolean *) myObj) = *((COBoolean *)(ti->second ));
                     } else {
                         m->erase( it );
+                        changed();
                         delete myObj;
                         // cppcheck-suppress cstyleCast
                         append( targetStr->c_str(), new COBoolean( ((COBoolean *)( ti->second ))->value() ) );
@@ -2934,6 +7399,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                             ((COMap *)it->second )->merge( pt , name );                     //      merge the two
                         } else {                                                          //    else
                             m->erase( it );                                                 //      delete the old one and merge the new one.
+                            changed();
                             delete myObj;
                             append( targetStr->c_str(), new COMap( *pt ) );
                         }
@@ -2949,7 +7415,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                             COString  *namePtr;
                             COMap     *tMap;
                             // cppcheck-suppress cstyleCast
-                            if( CppON::isMap( tMap = (COMap *)arrTarget->at( k ) ) && CppON::isString( namePtr = (COString *) (tMap->findElement( name ) ) ) )
+                            if( CppON::isMap( tMap = (COMap *)arrTarget->at( k ) ) && CppON::isString( namePtr = (COString *) (tMap->findElement( key ) ) ) )
                             {
                                 // cppcheck-suppress cstyleCast
                                 COArray   *arr = (COArray *) it->second;
@@ -2958,7 +7424,7 @@ void COMap::merge( COMap *targetObj, const char *name )
                                 {
                                     COMap     *uMap;
                                     // cppcheck-suppress cstyleCast
-                                    if( CppON::isMap( uMap = (COMap *)arr->at( i ) ) && CppON::isString( str = (COString *) (uMap->findElement( name ) ) ) && !strcmp( str->c_str(), namePtr->c_str() ) )
+                                    if( CppON::isMap( uMap = (COMap *)arr->at( i ) ) && CppON::isString( str = (COString *) (uMap->findElement( key ) ) ) && !strcmp( str->c_str(), namePtr->c_str() ) )
                                     {
                                         uMap->merge( tMap, name );
                                         break;
@@ -3006,137 +7472,140 @@ void COMap::merge( COMap *targetObj, const char *name )
 
 void COMap::upDate( COMap *target, const char *name )
 {
+    unshare();
     if( data )
     {
-        map<string, CppON *> *s = (map<string, CppON *> *) target->data;
+        COMapData *s = (COMapData *) target->data;
+        CppONPath key( ( name ) ? name : "" );
 
-        for( map< string, CppON *>::iterator ti = s->begin(); s->end() != ti; ++ti )
+        for( COMapData::iterator ti = s->begin(); s->end() != ti; ++ti )
         {
             bool                 				found = false;
-            map<string, CppON *>::iterator   	it;
+            COMapData::iterator   	it;
             const string             			*targetStr = &(ti->first);
             CppONType              				_eType = (ti->second)->type();
 
-            map<string, CppON *> *m = (map<string, CppON *> *) data;
-            // cppcheck-suppress postfixOperator
-            for( it = m->begin(); m->end() != it; it++ )
+            COMapData *m = (COMapData *) data;
+            if( m->end() != ( it = m->find( *targetStr ) ) )
             {
-                if( ! strcmp(  (it->first).c_str(), targetStr->c_str() ) )
+                found = true;
+                if( sameHash( it->second, ti->second ) )                                          // Already the same
+                {
+                    continue;
+                }
+                if( (it->second)->type() == _eType )                                              // If they are the same data type then just update it
                 {
-                    found = true;
-                    if( (it->second)->type() == _eType )                                              // If they are the same data type then just update it
+                    switch( _eType )
                     {
-                        switch( _eType )
-                        {
-                            case INTEGER_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                *((COInteger *)it->second ) =  ( (COInteger *)ti->second )->intValue();
-                                break;
+                        case INTEGER_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            *((COInteger *)it->second ) =  ( (COInteger *)ti->second )->intValue();
+                            break;
+
+                        case DOUBLE_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            *((CODouble *)it->second ) =  ( (CODouble *)ti->second )->doubleValue();
+                            break;
 
-                            case DOUBLE_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                *((CODouble *)it->second ) =  ( (CODouble *)ti->second )->doubleValue();
-                                break;
+                        case STRING_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            *((COString *)it->second ) = ( (COString *)ti->second )->c_str() ;
+                            break;
 
-                            case STRING_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                *((COString *)it->second ) = ( (COString *)ti->second )->c_str() ;
-                                break;
+                        case BOOLEAN_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            *((COBoolean *)it->second ) = ( (COBoolean *)ti->second )->value();
+                            break;
 
-                            case BOOLEAN_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                *((COBoolean *)it->second ) = ( (COBoolean *)ti->second )->value();
-                                break;
+                        case  MAP_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            ((COMap *)it->second )->upDate( ( (COMap *) ti->second ), name );
+                            break;
 
-                            case  MAP_CPPON_OBJ_TYPE:
+                        case  ARRAY_CPPON_OBJ_TYPE:
+                            {
                                 // cppcheck-suppress cstyleCast
-                                ((COMap *)it->second )->upDate( ( (COMap *) ti->second ), name );
-                                break;
-
-                            case  ARRAY_CPPON_OBJ_TYPE:
+                                COArray   *arrTarget = (COArray *) ti->second;
+                                for( int k = 0; arrTarget->size() > k; k++ )
                                 {
+                                    COString *namePtr;
+                                    COMap *tMap;
                                     // cppcheck-suppress cstyleCast
-                                    COArray   *arrTarget = (COArray *) ti->second;
-                                    for( int k = 0; arrTarget->size() > k; k++ )
+                                    if( CppON::isMap( tMap = (COMap *)arrTarget->at( k ) ) && CppON::isString( namePtr = (COString *) (tMap->findElement( key ) ) ) )
                                     {
-                                        COString *namePtr;
-                                        COMap *tMap;
                                         // cppcheck-suppress cstyleCast
-                                        if( CppON::isMap( tMap = (COMap *)arrTarget->at( k ) ) && CppON::isString( namePtr = (COString *) (tMap->findElement( name ) ) ) )
+                                        COArray     *arr = (COArray *) it->second;
+                                        for( int i = 0; arr->size() > i; i++ )
                                         {
+                                            COString *str;
+                                            COMap     *uMap;
                                             // cppcheck-suppress cstyleCast
-                                            COArray     *arr = (COArray *) it->second;
-                                            for( int i = 0; arr->size() > i; i++ )
+                                            if( CppON::isMap( uMap = (COMap *)arr->at( i ) ) && CppON::isString( str = (COString *) (uMap->findElement( key ) ) ) && !strcmp( str->c_str(), namePtr->c_str() ) )
                                             {
-                                                COString *str;
-                                                COMap     *uMap;
-                                                // cppcheck-suppress cstyleCast
-                                                if( CppON::isMap( uMap = (COMap *)arr->at( i ) ) && CppON::isString( str = (COString *) (uMap->findElement( name ) ) ) && !strcmp( str->c_str(), namePtr->c_str() ) )
+                                            	COMap *newMap = new COMap( *tMap );
+                                                if( ! arr->replace( i, newMap ) )                   // replace() deletes uMap
                                                 {
-                                                	COMap *newMap = new COMap( *tMap );
-                                                    if( ! arr->replace( i, newMap ) )
-                                                    {
-                                                    	delete newMap;
-                                                    }
-                                                    delete uMap;
-                                                    break;
+                                                	delete newMap;
                                                 }
+                                                break;
                                             }
                                         }
                                     }
                                 }
-                                break;
+                            }
+                            break;
 
-                            case NULL_CPPON_OBJ_TYPE:
-                                fprintf( stderr, "COMap:update - Null 1st being ignored\n");
+                        case NULL_CPPON_OBJ_TYPE:
+                            fprintf( stderr, "COMap:update - Null 1st being ignored\n");
 
-                                break;
-                            default:
-                                break;
-                        }
-                    } else {
-                        delete ( it->second );                                                                          // replace the data type with the new one.
-                        switch( _eType )
-                        {
-                            case INTEGER_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                it->second =  new COInteger( ( (COInteger *)ti->second )->intValue() );
-                                break;
+                            break;
+                        default:
+                            break;
+                    }
+                } else {
+                    touch();
+                    delete ( it->second );                                                                          // replace the data type with the new one.
+                    changed();
+                    switch( _eType )
+                    {
+                        case INTEGER_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            it->second =  new COInteger( ( (COInteger *)ti->second )->intValue() );
+                            break;
 
-                            case DOUBLE_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                it->second =  new CODouble( ( (CODouble *)ti->second )->doubleValue() );
-                                break;
+                        case DOUBLE_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            it->second =  new CODouble( ( (CODouble *)ti->second )->doubleValue() );
+                            break;
 
-                            case STRING_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                it->second = new COString( ( (COString *)ti->second )->c_str() );
-                                break;
+                        case STRING_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            it->second = new COString( ( (COString *)ti->second )->c_str() );
+                            break;
 
-                            case BOOLEAN_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                it->second = new COBoolean( ( (COBoolean *)ti->second )->value() );
-                                break;
+                        case BOOLEAN_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            it->second = new COBoolean( ( (COBoolean *)ti->second )->value() );
+                            break;
 
-                            case  MAP_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                it->second  = new COMap( * ( (COMap *)ti->second ) );
-                                break;
+                        case  MAP_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            it->second  = new COMap( * ( (COMap *)ti->second ) );
+                            break;
 
-                            case  ARRAY_CPPON_OBJ_TYPE:
-                                // cppcheck-suppress cstyleCast
-                                it->second  = new COArray( * ( (COArray *)ti->second ) );
-                                break;
+                        case  ARRAY_CPPON_OBJ_TYPE:
+                            // cppcheck-suppress cstyleCast
+                            it->second  = new COArray( * ( (COArray *)ti->second ) );
+                            break;
 
-                            case NULL_CPPON_OBJ_TYPE:
-                                it->second = new CONull();
-                                fprintf( stderr, "COMap:update - Null being ignored\n");
-                                target->dump();
-                                break;
+                        case NULL_CPPON_OBJ_TYPE:
+                            it->second = new CONull();
+                            fprintf( stderr, "COMap:update - Null being ignored\n");
+                            target->dump();
+                            break;
 
-                            default:
-                                break;
-                        }
+                        default:
+                            break;
                     }
                 }
             }
@@ -3188,13 +7657,14 @@ void COMap::upDate( COMap *target, const char *name )
 
 CppON *COMap::findEqual( const char * name, CppON &search )
 {
+    expose();
     CppON     *rtn = NULL;
     CppONType    _eType = search.type();
 
     if( data )
     {
-        map<string, CppON *>::iterator it;
-        map<string, CppON *> *m = (map<string, CppON *> *) data;
+        COMapData::iterator it;
+        COMapData *m = (COMapData *) data;
         // cppcheck-suppress postfixOperator
         for( it = m->begin(); !rtn && m->end() != it; it++ )
         {
@@ -3298,6 +7768,7 @@ static void splitPath( const char *str, std::string &val, const char **remainder
 
 CppON *COMap::findElement( const char *str )
 {
+    expose();
     CppON *rtn = NULL;
     if( data && str )
     {
@@ -3326,15 +7797,11 @@ CppON *COMap::findElement( const char *str )
          * OK search the map for an item with a name matching the text in 's'
          */
 
-        map<string, CppON *> *m = (map<string, CppON *> *) data;
-        // cppcheck-suppress postfixOperator
-        for( map<string, CppON *>::iterator it = m->begin(); m->end() != it; it++ )
+        COMapData *m = (COMapData *) data;
+        COMapData::iterator it = m->find( s );
+        if( m->end() != it )                                        	// if found set "rtn" to the object
         {
-            if( ! strcmp(  (it->first).c_str(), s.c_str() ) )         	// if found set "rtn" to the object and quit looking
-            {
-                rtn = it->second;
-                break;
-            }
+            rtn = it->second;
         }
 
         if( rtn && CppON::isMap( rtn ) && *str )               		// But wait! if the object found is a map and there is a remainder from the
@@ -3364,30 +7831,128 @@ CppON *COMap::findElement( const char *str )
     }
     return rtn;
 }
+
+/*
+ * Compile a path using the same rules findElement( const char * ) applies as it goes: slashes separate keys, each key may
+ * be followed by any number of ":n" array indexes and a trailing slash is ignored.
+ */
+CppONPath::CppONPath( const char *p, bool c ) : path( p ? p : "" ), cache( c ), cacheRoot( NULL ), cacheNode( NULL ), cacheSteps( 0 )
+{
+    const char *str = path.c_str();
+    do
+    {
+        const char *end;
+        for( end = str; *end && '/' != *end; end++ );
+
+        const char *colon = (const char *) memchr( str, ':', end - str );
+        Step        step;
+        step.key.assign( str, ( colon ? colon : end ) - str );
+        step.index = -1;
+        step.from = NULL;
+        step.edits = 0;
+        steps.push_back( step );
+
+        while( colon )                                              // Each index must follow directly on the last one
+        {
+            char *r;
+            step.key.clear();
+            step.index = strtol( colon + 1, &r, 10 );
+            if( 0 > step.index )
+            {
+                break;
+            }
+            steps.push_back( step );
+            colon = ( ':' == *r && r < end ) ? r : NULL;
+        }
+        str = ( '/' == *end ) ? end + 1 : end;
+    } while( *str );
+}
+
+/*
+ * True while every container the cached walk went through is as it was then.  The root is checked first, so as long as
+ * each container is unchanged the next one is still its member and safe to look at.
+ */
+bool CppONPath::fresh() const
+{
+    for( size_t i = 0; cacheSteps > i; i++ )
+    {
+        if( steps[ i ].from->generation() != steps[ i ].edits )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Resolve a compiled path.  Nothing is allocated, each key is looked up with the map's index and each array index is a
+ * direct access.  As with the string form, indexes on something that isn't an array are skipped and when the walk reaches
+ * something that isn't a map while keys remain that object is returned.
+ */
+CppON *COMap::findElement( const CppONPath &path )
+{
+    expose();
+    if( path.cache && this == path.cacheRoot && path.fresh() )
+    {
+        return path.cacheNode;
+    }
+
+    CppON   *rtn = this;
+    std::vector<CppONPath::Step>::const_iterator step;
+
+    for( step = path.steps.begin(); rtn && path.steps.end() != step; ++step )
+    {
+        CppON *in = rtn;
+        if( 0 <= step->index )
+        {
+            if( CppON::isArray( rtn ) )
+            {
+                // cppcheck-suppress cstyleCast
+                rtn = ( (COArray *) rtn )->at( step->index );
+            }
+        } else if( CppON::isMap( rtn ) ) {
+            // cppcheck-suppress cstyleCast
+            ( (COMap *) rtn )->expose();
+            // cppcheck-suppress cstyleCast
+            COMapData             *m = (COMapData *) ( (COMap *) rtn )->data;
+            COMapData::iterator   it;
+            rtn = ( m && m->end() != ( it = m->find( step->key.data(), step->key.size() ) ) ) ? it->second : NULL;
+        } else {
+            break;
+        }
+        step->from = in;                                            // read after expose(), whose unshare() counts
+        step->edits = in->generation();
+    }
+    if( path.cache && rtn )
+    {
+        path.cacheRoot = this;
+        path.cacheNode = rtn;
+        path.cacheSteps = step - path.steps.begin();
+    }
+    return rtn;
+}
 // cppcheck-suppress unusedFunction
 CppON *COMap::findNoSplit( const char *str )
 {
+    expose();
     CppON *rtn = NULL;
     if( data && str )
     {
         /*
          * OK search the map for an item with a name matching the text in 's'
          */
-        map<string, CppON *> *m = (map<string, CppON *> *) data;
-        // cppcheck-suppress postfixOperator
-        for( map<string, CppON *>::iterator it = m->begin(); m->end() != it; it++ )
+        COMapData *m = (COMapData *) data;
+        COMapData::iterator it = m->find( str );
+        if( m->end() != it )                                // if found set "rtn" to the object
         {
-            if( ! strcmp( (it->first).c_str(), str ) )         // if found set "rtn" to the object and quit looking
-            {
-                rtn = it->second;
-                break;
-            }
+            rtn = it->second;
         }
     }
     return rtn;
 }
 CppON *COMap::findCaseElement( const char *str )
 {
+    expose();
     CppON *rtn = NULL;
     if( data  && str )
     {
@@ -3412,9 +7977,9 @@ CppON *COMap::findCaseElement( const char *str )
             s = s.substr( 0, idx );                                   // s only contains the text up to the colon
         }
 
-        map<string, CppON *> *m = (map<string, CppON *> *) data;
+        COMapData *m = (COMapData *) data;
         // cppcheck-suppress postfixOperator
-        for( map<string, CppON *>::iterator it = m->begin(); m->end() != it; it++ )
+        for( COMapData::iterator it = m->begin(); m->end() != it; it++ )
         {
             if( ! strcasecmp(  (it->first).c_str(), s.c_str() ) )
             {
@@ -3451,216 +8016,28 @@ CppON *COMap::findCaseElement( const char *str )
 }
 std::string *COMap::toCompactJsonString( )
 {
-    std::string *rtn = new string( "{" );
-    if( data )
-    {
-        map<string, CppON *>::iterator   it;
-        map<string, CppON *>            *m = (map<string, CppON *> *) data;
-        CppON                           *n;
-        std::string                       *sptr;
-        bool                              first = true;
-
-        for( size_t idx = 0; order.size() > idx; ++idx )
-        {
-            it = m->find( order.at( idx ) );
-            if( first )
-            {
-                first = false;
-            } else {
-                rtn->append( "," );
-            }
-            *rtn += '\"';
-            rtn->append( ( ( string ) it->first ).c_str() );
-            rtn->append( "\":" );
-            // cppcheck-suppress cstyleCast
-            n = (CppON *) it->second;
-            sptr = NULL;
-            switch ( n->type() )
-            {
-                case INTEGER_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COInteger *) n )->toJsonString();
-                    break;
-                case DOUBLE_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (CODouble *) n )->toJsonString();
-                    break;
-                case STRING_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COString *) n )->toJsonString();
-                    break;
-                case BOOLEAN_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COBoolean *) n )->toJsonString();
-                    break;
-                case NULL_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = (( CONull *) n )->toJsonString();
-                    break;
-                case MAP_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COMap *) n )->toCompactJsonString( );
-                    break;
-                case ARRAY_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COArray *) n )->toCompactJsonString( );
-                    break;
-                default:
-                    break;
-            }
-            if( sptr )
-            {
-                *rtn += *sptr;
-                delete sptr;
-            }
-        }
-    }
-    *rtn += '}';
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
     return rtn;
 }
 
 std::string *COMap::toJsonString( std::string &indent )
 {
-    std::string *rtn = new string( indent.c_str() );
-    rtn->append( "{\n" );
-    if( data )
-    {
-        map<string, CppON *>::iterator   it;
-        map<string, CppON *>            *m = (map<string, CppON *> *) data;
-        CppON                           *n;
-        std::string                       *sptr;
-        bool                              first = true;
-        std::string                       newIndent = indent;
-
-        newIndent.append( "  " );
-        for( std::vector< std::string >::iterator ito = order.begin(); order.end() != ito; ito++ )
-        {
-            it = m->find( *ito );
-            if( first )
-            {
-                first = false;
-            } else {
-                rtn->append( ",\n" );
-            }
-            rtn->append( newIndent.c_str() );
-            *rtn += '\"';
-            rtn->append( ( ( string ) it->first ).c_str() );
-            rtn->append( "\": " );
-            // cppcheck-suppress cstyleCast
-            n = (CppON *) it->second;
-            sptr = NULL;
-            switch ( n->type() )
-            {
-                case INTEGER_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COInteger *) n )->toJsonString();
-                    break;
-                case DOUBLE_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (CODouble *) n )->toJsonString();
-                    break;
-                case STRING_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COString *) n )->toJsonString();
-                    break;
-                case BOOLEAN_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COBoolean *) n )->toJsonString();
-                    break;
-                case NULL_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = (( CONull *) n )->toJsonString();
-                    break;
-                case MAP_CPPON_OBJ_TYPE:
-                    rtn->append( "\n" );
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COMap *) n )->toJsonString( newIndent );
-                    break;
-                case ARRAY_CPPON_OBJ_TYPE:
-                    rtn->append( "\n" );
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COArray *) n )->toJsonString( newIndent );
-                    break;
-                default:
-                    break;
-            }
-            if( sptr )
-            {
-                *rtn += *sptr;
-                delete sptr;
-            }
-        }
-    }
-    *rtn += '\n';
-    rtn->append( indent.c_str() );
-    *rtn += '}';
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn, CPPON_WRITE_PRETTY );
+    w.write( this, indent.c_str() ).flush();
     return rtn;
 }
 
-string *COMap::toNetString()
-{
-    if( data && MAP_CPPON_OBJ_TYPE == typ )
-    {
-        std::string rt;
-        std::map<std::string, CppON *>::iterator it;
-        std::map<std::string, CppON *> *m = (map<string, CppON *> *) data;
-
-        for( size_t idx = 0; order.size() > idx; ++idx )
-        {
-            std::string *sptr;
-            it = m->find( order.at( idx ) );
-            rt += *( sptr = CppON::toNetString( ( ( string ) it->first).c_str(), ',' ) );
-            delete ( sptr );
-            // cppcheck-suppress cstyleCast
-            CppON *n = (CppON *) it->second;
-            sptr = NULL;
-            switch ( n->type() )
-            {
-                case INTEGER_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COInteger *) n )->COInteger::toNetString();
-                    break;
-
-                case DOUBLE_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (CODouble *) n )->CODouble::toNetString();
-                    break;
-
-                case STRING_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COString *) n )->COString::toNetString();
-                    break;
-
-                case BOOLEAN_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COBoolean *) n )->COBoolean::toNetString();
-                    break;
-                case NULL_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = (( CONull *) n )->CONull:: toNetString();
-                    break;
-
-                case MAP_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COMap *) n )->COMap::toNetString();
-                    break;
-
-                case ARRAY_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COArray *) n )->COArray::toNetString();
-                    break;
-
-                default:
-                    fprintf( stderr, "Map::toNetString: Unknown CppONType\n");
-                    break;
-            }
-            if( sptr )
-            {
-                rt+= *sptr;
-                delete sptr;
-            }
-        }
-        return CppON::toNetString( rt.c_str(), '}' );
+string *COMap::toNetString()
+{
+    if( data && MAP_CPPON_OBJ_TYPE == typ )
+    {
+        std::string *rtn = new std::string();
+        CppONWriter  w( *rtn, CPPON_WRITE_TNET );
+        w.write( this ).flush();
+        return rtn;
     }
     return NULL;
 }
@@ -3670,14 +8047,13 @@ const char  *COMap::c_str( std::string &idnt )
     str = "{";
     if( data )
     {
-        map<string, CppON *>::iterator  it;
-        map<string, CppON *>            *m = (map<string, CppON *> *) data;
+        COMapData::iterator                it;
+        COMapData                         *m = (COMapData *) data;
         const char                        *comma = "\n";
         std::string                       indent = idnt;
 
-        for( size_t idx = 0; order.size() > idx; ++idx )
+        for( it = m->begin(); m->end() != it; ++it )
         {
-            it = m->find( order.at( idx ) );
             str.append( comma );
             comma = ",\n";
             str.append( indent );
@@ -3740,8 +8116,8 @@ void COMap::dump( string &indent, FILE *fp )
 {
     if( data )
     {
-        map<string, CppON *>::iterator   it;
-        map<string, CppON *>            *m = (map<string, CppON *> *) data;
+        COMapData::iterator   it;
+        COMapData            *m = (COMapData *) data;
         bool                              first = true;
         string                            newIndent = indent;
 
@@ -3749,9 +8125,8 @@ void COMap::dump( string &indent, FILE *fp )
 
         fprintf( fp, "%s{",indent.c_str() );
 
-        for( size_t idx = 0; order.size() > idx; ++idx )
+        for( it = m->begin(); m->end() != it; ++it )
         {
-            it = m->find( order.at( idx ) );
             if( first )
             {
                 fprintf( fp, "\n%s\"%s\": ", newIndent.c_str(), ( ( string ) it->first).c_str() );
@@ -3815,14 +8190,13 @@ void COMap::cdump( FILE *fp )
 {
     if( data )
     {
-        map<string, CppON *>::iterator   it;
-        map<string, CppON *>            *m = (map<string, CppON *> *) data;
+        COMapData::iterator   it;
+        COMapData            *m = (COMapData *) data;
         bool                              first = true;
         fprintf( fp, "{" );
 
-        for( size_t idx = 0; order.size() > idx; ++idx )
+        for( it = m->begin(); m->end() != it; ++it )
         {
-            it = m->find( order.at( idx ) );
             if( first )
             {
                 fprintf( fp, "\\\"%s\\\": ", ( ( string ) it->first).c_str() );
@@ -3883,21 +8257,46 @@ void COMap::cdump( FILE *fp )
 }
 
 /*
- * Given a path, write a file to disk
+ * Given a path, write a file to disk.
+ *
+ * The map is written pretty printed with standard JSON escapes (CPPON_WRITE_JSON) so COMap( path, file ), or any other JSON
+ * reader, gets back the same strings.  The text goes through a CppONWriter on the descriptor in 4K chunks, there is no
+ * intermediate string or stdio buffer.  It goes to path.tmp which is renamed over path once it is complete;  the loader maps
+ * the file so truncating it in place could fault a process reading it.  Returns 0 on success, -1 if the file couldn't be
+ * opened or a write failed, in which case path is left as it was.
  */
-
 int  COMap::toFile( const char *path )
 {
-    FILE    *fp = NULL;
+    int     fd;
     int     rtn = 0;
+
+    if( ! path || ! *path )
+    {
+        return -1;
+    }
+    std::string tmp( path );
+    tmp.append( ".tmp" );
     /*
      * Make sure we were passed something as a path and if so attempt to open it for writing
      */
-    if( path && *path && (fp = fopen( path, "w" ) ) )
+    if( 0 <= ( fd = open( tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666 ) ) )
     {
-        dump( fp );
-        fclose( fp );
-
+        {
+            CppONWriter w( fd, CPPON_WRITE_JSON );
+            w.write( this );
+            w.put( '\n' );
+            w.flush();
+            rtn = ( w.failed() || fsync( fd ) ) ? -1 : 0;
+        }
+        if( close( fd ) )
+        {
+            rtn = -1;
+        }
+        if( rtn || rename( tmp.c_str(), path ) )
+        {
+            unlink( tmp.c_str() );
+            rtn = -1;
+        }
     } else {
         rtn = -1;
     }
@@ -4130,110 +8529,189 @@ static void appendTag( string name, CppON *obj, COMap *rtn, CppON *n )
     }
 }
 
-COMap  *COMap::diff( COMap &newObj, const char *name )
+/*
+ * One member of a map diff: "n" is this map's member and "obj" the member of the same name in the new map.  Members that
+ * are the same (see sameTree()) are skipped without being diffed.
+ */
+static void diffMember( const string &key, CppON *n, CppON *obj, COMap *rtn, const char *name )
+{
+    if( sameTree( n, obj ) )
+    {
+        return;
+    }
+    if( n->type() == obj->type() && CppON::isMap( n ) )
+    {
+        COMap                  *nv;
+        // cppcheck-suppress cstyleCast
+        if( (nv = ((COMap *) n )->diff( *((COMap *) obj ), name ) ) )
+        {
+            rtn->append( key, nv );
+        }
+    } else if( n->type() == obj->type() && CppON::isArray( n ) ) {
+        COArray                *na;
+        // cppcheck-suppress cstyleCast
+        if( (na = ( (COArray *) n )->diff( *( ( COArray *) obj ), name ) ) )
+        {
+            rtn->append( key, na );
+        }
+    } else if( CppON::isMap( n ) || CppON::isArray( n ) ) {
+        CppON                  *c;
+        if( ( c = CppON::factory( *obj ) ) )                                // A container replaced by something else
+        {
+            rtn->append( key, c );
+        }
+    } else if( CppON::isObj( n ) ) {
+        appendTag( key, obj, rtn, n );
+    }
+}
+
+/*
+ * A member only the new map has, copied in whole.
+ */
+static void diffAdded( const string &key, CppON *n, COMap *rtn )
 {
-    COMap                                    *rtn   = new COMap();
-    CppON                                 *n;
+    if( n )
+    {
+        switch ( n->type() )
+        {
+            case INTEGER_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                rtn->append( key, new COInteger( *((COInteger *) n ) ) );
+                break;
+            case DOUBLE_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                rtn->append( key, new CODouble( *((CODouble *) n ) ) );
+                break;
+            case STRING_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                rtn->append( key, new COString( *((COString *) n ) ) );
+                break;
+            case BOOLEAN_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                rtn->append( key, new COBoolean( *((COBoolean *) n ) ) );
+                break;
+            case NULL_CPPON_OBJ_TYPE:
+                fprintf( stderr, "COMap:diff - NULL type found, appended a NULL to %s\n", key.c_str() );
+                rtn->append( key, new CONull( ) );
+                break;
+            case MAP_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                rtn->append( key, new COMap( *(( COMap *) n ) ) );
+                break;
+            case ARRAY_CPPON_OBJ_TYPE:
+                // cppcheck-suppress cstyleCast
+                rtn->append( key, new COArray( *(( COArray *) n ) ) );
+                break;
+            default:
+                break;
+        }
+    } else {
+        fprintf( stderr, "appended a NULL to %s\n", key.c_str() );
+        rtn->append( key, new CONull( ) );
+    }
+}
 
-    map<string, CppON *>::iterator        it;
-    map<string, CppON *>                  *m     = (map<string, CppON *> *) data;
+/*
+ * The members of "from" in positions [first, last) diffed against their namesakes in "to" or, with added set, copied when
+ * "to" has no member of that name.
+ */
+static void diffRange( COMapData *from, COMapData *to, size_t first, size_t last, bool added, COMap *rtn, const char *name )
+{
+    COMapData::iterator        it  = from->begin() + first;
+    COMapData::iterator        end = from->begin() + last;
 
-    // cppcheck-suppress postfixOperator
-    for( it = m->begin(); m->end() != it; it++ )
+    for( ; end != it; ++it )
     {
-        CppON                *obj;
-        if( ( obj = newObj.findElement( (string *)&(it->first) ) ) )
+        COMapData::iterator    ot = to->find( it->first );
+        if( added )
         {
-            // cppcheck-suppress cstyleCast
-            if( ( n = (CppON *) it->second ) )
+            if( to->end() == ot )
             {
-                COMap                  *nv;
-                COArray                *na;
-                switch ( n->type() )
-                {
-                    case INTEGER_CPPON_OBJ_TYPE:
-                        appendTag( it->first, obj, rtn, n );
-                        break;
-                    case DOUBLE_CPPON_OBJ_TYPE:
-                        appendTag( it->first, obj, rtn, n );
-                        break;
-                    case STRING_CPPON_OBJ_TYPE:
-                        appendTag( it->first, obj, rtn, n );
-                        break;
-                    case BOOLEAN_CPPON_OBJ_TYPE:
-                        appendTag( it->first, obj, rtn, n );
-                        break;
-                    case NULL_CPPON_OBJ_TYPE:
-                        appendTag( it->first, obj, rtn, n );
-                        break;
-                    case MAP_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        if( (nv = ((COMap *) n )->diff( *((COMap *) obj ), name ) ) )
-                        {
-                            rtn->append( it->first, nv );
-                        }
-                        break;
-                    case ARRAY_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        if( (na = ( (COArray *) n )->diff( *( ( COArray *) obj ), name ) ) )
-                        {
-                            rtn->append( it->first, na );
-                        }
-                        break;
-                    default:
-                        break;
-                }
+                diffAdded( it->first, it->second, rtn );
             }
+        } else if( to->end() != ot && it->second && ot->second ) {
+            diffMember( it->first, it->second, ot->second, rtn, name );
         }
     }
-    m = (map<string, CppON *> *) newObj.getData();
-    // cppcheck-suppress postfixOperator
-    for( it = m->begin(); m->end() != it; it++ )
+}
+
+/*
+ * Returns a map of what changed from this map to newObj or NULL when nothing did: members whose value changed (maps and
+ * arrays recursively) and members only newObj has.  Members are found by key directly and subtrees whose hash() agrees
+ * are skipped; hashes computed here are cached, so diffing the same snapshot again only hashes the new one.
+ */
+COMap  *COMap::diff( COMap &newObj, const char *name )
+{
+    COMap                      *rtn   = new COMap();
+    COMapData                  *m     = (COMapData *) peek();
+    COMapData                  *u     = (COMapData *) newObj.peek();
+
+    diffRange( m, u, 0, m->size(), false, rtn, name );
+    diffRange( u, m, 0, u->size(), true, rtn, name );
+    if( ! rtn->size() )
+    {
+        delete rtn;
+        rtn = NULL;
+    }
+    return rtn;
+}
+
+/*
+ * The same as diff( newObj, name ) with the top level members split into blocks diffed on up to "threads" threads (0 for
+ * one per core).  It pays off for wide maps with big members, the result is the same as the single threaded diff, in the
+ * same order.  Neither map may be changed while this runs.
+ */
+COMap  *COMap::diff( COMap &newObj, const char *name, unsigned threads )
+{
+    COMapData                  *m     = (COMapData *) peek();
+    COMapData                  *u     = (COMapData *) newObj.peek();
+    size_t                     count  = ( m->size() > u->size() ) ? m->size() : u->size();
+
+    if( ! threads )
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    if( threads > count / COMAP_DIFF_BLOCK )
+    {
+        threads = count / COMAP_DIFF_BLOCK;
+    }
+    if( 2 > threads )
+    {
+        return diff( newObj, name );
+    }
+
+    std::vector<COMap>         parts( 2 * threads );
+    std::vector<std::thread>   pool;
+    pool.reserve( threads - 1 );
+    for( unsigned t = 0; threads > t; t++ )
     {
-        if(!( this->findElement( (string *)&(it->first) ) ) )
+        auto work = [ &, t ]()
         {
-            // cppcheck-suppress cstyleCast
-            if( ( n = (CppON *) it->second ) )
-            {
-                switch ( n->type() )
-                {
-                    case INTEGER_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( it->first, new COInteger( *((COInteger *) it->second ) ) );
-                        break;
-                    case DOUBLE_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( it->first, new CODouble( *((CODouble *) it->second ) ) );
-                        break;
-                    case STRING_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( it->first, new COString( *((COString *) it->second ) ) );
-                        break;
-                    case BOOLEAN_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( it->first, new COBoolean( *((COBoolean *) it->second ) ) );
-                        break;
-                    case NULL_CPPON_OBJ_TYPE:
-                        fprintf( stderr, "COMap:diff - NULL type found, appended a NULL to %s\n", it->first.c_str() );
-                        rtn->append( it->first, new CONull( ) );
-                        break;
-                    case MAP_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( it->first, new COMap( *(( COMap *) it->second ) ) );
-                        break;
-                    case ARRAY_CPPON_OBJ_TYPE:
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( it->first, new COArray( *(( COArray *) it->second ) ) );
-                        break;
-                    default:
-                        break;
-                }
-            } else {
-                fprintf( stderr, "appended a NULL to %s\n", it->first.c_str() );
-                rtn->append( it->first, new CONull( ) );
-            }
+            diffRange( m, u, m->size() * t / threads, m->size() * ( t + 1 ) / threads, false, &parts[ t ], name );
+            diffRange( u, m, u->size() * t / threads, u->size() * ( t + 1 ) / threads, true, &parts[ threads + t ], name );
+        };
+        if( threads - 1 == t )
+        {
+            work();
+        } else {
+            pool.emplace_back( work );
         }
     }
+    for( size_t i = 0; pool.size() > i; i++ )
+    {
+        pool[ i ].join();
+    }
+
+    COMap                      *rtn   = new COMap();
+    for( size_t i = 0; parts.size() > i; i++ )
+    {
+        COMapData *p = parts[ i ].value();
+        for( COMapData::iterator it = p->begin(); p->end() != it; ++it )
+        {
+            rtn->append( it->first, it->second );
+        }
+        p->clear();
+    }
     if( ! rtn->size() )
     {
         delete rtn;
@@ -4265,39 +8743,55 @@ COMap  *COMap::diff( COMap &newObj, const char *name )
 
 int COMap::append( std::string key, CppON *n )
 {
+    return put( std::move( key ), n, true );
+}
+
+/*
+ * append() for callers that hold on to n (taken) and for the parsers, whose nodes only the library holds.  Only the
+ * first marks the map that takes n in as exposed, see copyMembers().
+ */
+int COMap::put( std::string key, CppON *n, bool taken )
+{
+    touch();
+    if( taken )
+    {
+        expose();
+    } else {
+        unshare();
+    }
     size_t pos = key.find( '/' );
     int rtn = 0;
 
     if( string::npos == pos )
     {
-        std::map <std::string, CppON *> *m = ( std::map <std::string, CppON*> *) data;
-        std::map <std::string, CppON *>::iterator it = m->find( key );									// If there is already an object by this name delete it and and the new one.
+        COMapData *m = ( COMapData *) data;
+        COMapData::iterator it = m->find( key );									// If there is already an object by this name replace it in place
         if( m->end() != it )
         {
         	delete it->second;
-        	m->erase( it );
-        	std::vector< std::string>::iterator its = std::find( order.begin(), order.end(), key );
-        	if( order.end() != its )
-        	{
-        		order.erase( its );
-        	}
+        	it->second = n;
+        	changed();
+        } else {
+        	m->push( std::move( key ), n );
         }
-        m->insert( m->end(), std::pair < std::string, CppON* >( key, n ) );
-        order.push_back(std::string( key ) );
 
     } else {
         string s = key.substr( 0, pos );
-        key = key.substr( pos + 1 );
-        COMap *mp = (COMap *) findElement( s );
+        key.erase( 0, pos + 1 );
+        COMapData *m = ( COMapData *) data;
+        COMapData::iterator it = m->find( s );                      // not findElement(), that would mark this map exposed
+        COMap *mp = ( m->end() != it ) ? (COMap *) it->second : NULL;
         if(! mp )
         {
-            append( s, mp = new COMap() );
+            put( s, mp = new COMap(), false );
         }
         if( CppON::isMap( mp ) )
         {
-            rtn = mp->append( key, n );
-        } else if( CppON::isArray( mp ) ) {
+            rtn = mp->put( key, n, taken );
+        } else if( CppON::isArray( mp ) && taken ) {
             ((COArray *)mp )->append( n );
+        } else if( CppON::isArray( mp ) ) {
+            ((COArray *)mp )->put( n );
         } else {
              rtn = -1;
         }
@@ -4308,9 +8802,11 @@ int COMap::append( std::string key, CppON *n )
 // cppcheck-suppress unusedFunction
 std::vector<CppON *> *COMap::getValues()
 {
+    expose();
     std::vector<CppON *> *rtn = new std::vector<CppON *>;
+    rtn->reserve( size() );
     // cppcheck-suppress postfixOperator
-    for(std::map< std::string, CppON *>::iterator it = (( std::map<std::string, CppON *> *) data )->begin();(( std::map<std::string, CppON *> *) data )->end() != it; it++)
+    for(COMapData::iterator it = (( COMapData *) data )->begin();(( COMapData *) data )->end() != it; it++)
     {
         rtn->push_back( it->second );
     }
@@ -4320,22 +8816,16 @@ std::vector<CppON *> *COMap::getValues()
 // cppcheck-suppress unusedFunction
 CppON *COMap::extract( const char *name )
 {
+    touch();
+    unshare();
     CppON *rtn = NULL;
-    std::map< std::string, CppON *>::iterator it = (( std::map<std::string, CppON *> *) data )->find( name );
-    if( it != ((std::map< std::string, CppON *> *) data )->end() )
+    COMapData::iterator it = (( COMapData *) data )->find( name );
+    if( it != ((COMapData *) data )->end() )
     {
         rtn = it->second;
-
-        for( std::vector<std::string>::iterator iter = order.begin(); order.end() != iter; ++iter )
-        {
-            if( ! iter->compare( it->first ) )
-            {
-                order.erase( iter );
-                break;
-            }
-        }
-
-        (( std::map<std::string, CppON *> *) data )->erase( it );
+        (( COMapData *) data )->erase( it );
+        changed();
+        orphan( rtn );
 
     }
     return rtn;
@@ -4343,72 +8833,64 @@ CppON *COMap::extract( const char *name )
 
 COMap *COMap::operator=( COMap &val )
 {
-    map< string, CppON*> *ptr;
-    if( data )
+    touch();
+    COMapData *ptr;
+    if( this == &val )
     {
-        map <string, CppON*> *m = ( map <string, CppON *> * ) data;
-        map<string, CppON *>::iterator it;
-        // cppcheck-suppress postfixOperator
-        for( it = m->begin(); m->end() != it; it++ )
-        {
-            delete( it->second);
-        }
-        m->clear();
-    } else {
-        data = new map<string, CppON*>();
+        return this;
     }
-    order.clear();
+    deleteData();                                                   // only lets go of data shared with copies
+    if( copyMembers( val ) )
+    {
+        return this;
+    }
+    data = new COMapData();
     siz = val.size();
 
-    map<string, CppON*> *th = (map<string, CppON*> *) data;
+    COMapData *th = (COMapData *) data;
 
-    if( ( ptr = val.value() ) )
+    // cppcheck-suppress cstyleCast
+    if( ( ptr = (COMapData *) val.data ) )                           // value() would drop val's hash
     {
+        th->reserve( ptr->size() );
         // cppcheck-suppress postfixOperator
-        for( std::map< string, CppON* >::iterator it = ptr->begin(); it != ptr->end(); it++ )
+        for( COMapData::iterator it = ptr->begin(); it != ptr->end(); it++ )
         {
             switch( it->second->type() )
             {
                 case INTEGER_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new COInteger( *((COInteger *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 case DOUBLE_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new CODouble( *( (CODouble *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 case STRING_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new COString( *( (COString *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 case NULL_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new CONull( *( (CONull *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 case BOOLEAN_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new COBoolean( *( (COBoolean *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 case MAP_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new COMap( *( (COMap *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 case ARRAY_CPPON_OBJ_TYPE:
                     // cppcheck-suppress cstyleCast
                     th->insert( th->end(), pair< string, CppON* >( it->first, new COArray( *( (COArray *)it->second ) ) ) );
-                    order.push_back( string( it->first ) );
                     break;
 
                 default:
@@ -4419,15 +8901,33 @@ COMap *COMap::operator=( COMap &val )
     return this;
 }
 
+/*
+ * Same members with equal values, in any order.  Members are looked up by key, not as findElement() paths, and maps whose
+ * hashes are both cached and differ are told apart without a walk.
+ */
 bool COMap::operator == ( COMap &val )
 {
-    map<string, CppON*> *th = (map<string, CppON*> *) data;
+    COMapData *th = (COMapData *) peek();
+    COMapData *vm = (COMapData *) val.peek();
 
+    if( this == &val )
+    {
+        return true;
+    }
+    if( !th || !vm || th == vm )                                    // th == vm when copies share it
+    {
+        return th == vm;
+    }
+    if( th->size() != vm->size() || ( hashed() && val.hashed() && hash() != val.hash() ) )
+    {
+        return false;
+    }
     // cppcheck-suppress postfixOperator
-    for( std::map< string, CppON* >::iterator itr = th->begin(); itr != th->end(); itr++ )
+    for( COMapData::iterator itr = th->begin(); itr != th->end(); itr++ )
     {
         CppON               *t;
-        if( !(t = val.findElement( itr->first.c_str() ) ) )
+        COMapData::iterator vt = vm->find( itr->first );
+        if( vm->end() == vt || !(t = vt->second ) )
         {
             return false;
         }
@@ -4455,40 +8955,44 @@ bool COMap::operator == ( COMap &val )
 
 COArray::COArray( COArray *at ) : CppON( ARRAY_CPPON_OBJ_TYPE )
 {
+    if( copyMembers( *at ) )
+    {
+        return;
+    }
     siz = at->size();
     data = new vector<CppON *>();
     for( int i = 0; at->size() > i; i++ )
     {
-        CppON *jt = at->at( i );
+        CppON *jt = ( *(vector<CppON *> *) at->data )[ i ];
         switch( jt->type() )
         {
             case INTEGER_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COInteger( *((COInteger *)jt ) ) );
+                put( new COInteger( *((COInteger *)jt ) ) );
                 break;
             case DOUBLE_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new CODouble( *( (CODouble *)jt ) ) );
+                put( new CODouble( *( (CODouble *)jt ) ) );
                 break;
             case STRING_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COString( *( (COString *)jt ) ) );
+                put( new COString( *( (COString *)jt ) ) );
                 break;
             case NULL_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new CONull( *( (CONull *)jt ) ) );
+                put( new CONull( *( (CONull *)jt ) ) );
                 break;
             case BOOLEAN_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COBoolean( *( (COBoolean *)jt ) ) );
+                put( new COBoolean( *( (COBoolean *)jt ) ) );
                 break;
             case MAP_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COMap( *( (COMap *)jt ) ) );
+                put( new COMap( *( (COMap *)jt ) ) );
                 break;
             case ARRAY_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COArray( *( (COArray *)jt ) ) );
+                put( new COArray( *( (COArray *)jt ) ) );
                 break;
             default:
                 break;
@@ -4498,40 +9002,44 @@ COArray::COArray( COArray *at ) : CppON( ARRAY_CPPON_OBJ_TYPE )
 
 COArray::COArray( COArray & at ) : CppON( ARRAY_CPPON_OBJ_TYPE )
 {
+    if( copyMembers( at ) )
+    {
+        return;
+    }
     siz = at.size();
     data = new vector<CppON *>();
     for( int i = 0; at.size() > i; i++ )
     {
-        CppON *jt = at.at( i );
+        CppON *jt = ( *(vector<CppON *> *) at.data )[ i ];
         switch( jt->type() )
         {
             case INTEGER_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COInteger( *((COInteger *)jt ) ) );
+                put( new COInteger( *((COInteger *)jt ) ) );
                 break;
             case DOUBLE_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new CODouble( *( (CODouble *)jt ) ) );
+                put( new CODouble( *( (CODouble *)jt ) ) );
                 break;
             case STRING_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COString( *( (COString *)jt ) ) );
+                put( new COString( *( (COString *)jt ) ) );
                 break;
             case NULL_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new CONull( *( (CONull *)jt ) ) );
+                put( new CONull( *( (CONull *)jt ) ) );
                 break;
             case BOOLEAN_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COBoolean( *( (COBoolean *)jt ) ) );
+                put( new COBoolean( *( (COBoolean *)jt ) ) );
                 break;
             case MAP_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COMap( *( (COMap *)jt ) ) );
+                put( new COMap( *( (COMap *)jt ) ) );
                 break;
             case ARRAY_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COArray( *( (COArray *)jt ) ) );
+                put( new COArray( *( (COArray *)jt ) ) );
                 break;
             default:
                 break;
@@ -4569,60 +9077,49 @@ void COArray::parseData( const char *str )
 {
     if( str )
     {
-		DumpWhiteSpace( str );
-		const char	*sav = str;
-		unsigned 	i;
-		if( '[' == *str )
-		{
-//			char 		name[ 256 ];
-			char		ch;
-			CppON		*obj = NULL;
-			++str;
-			DumpWhiteSpace( ch, str );
-//			while( *str )
-			while( ch )
+    	parseData( str, strlen( str ) );
+    }
+}
+
+/*
+ * Parse a JSON (or TNet) array straight into this one.  Elements parsed before an error are kept.
+ */
+void COArray::parseData( const char *str, size_t len )
+{
+    if( str )
+    {
+#if 1
+		CppONParser	p( str, len );
+
+		p.skipWhiteSpace();
+		if( '[' == p.peek() )
+		{
+			if( ! p.array( this ) )
 			{
-				sav = str;
-				while( 0 != (ch = *str ) && ( ' ' == ch || '\t' == ch || '\n' == ch || '\r' == ch ) ) { ++str; }
-				if( '0' <= ch && '9' >= ch )
-				{
-					obj = GetTNetstring( &str );
-				} else if( ']' == ch ) {
-					break;
-				} else if( ch ) {
-					obj =  GetObj( &str );
-				}
-				if( obj )
-				{
-					append( obj );
-					obj = NULL;
-					DumpWhiteSpace( ch, str );
-//					if( *str )
-					if( ch )
-					{
-						if( ',' == *str )
-						{
-							str++;
-							DumpWhiteSpace( ch, str );
-//						} else if( ']' == *str ) {
-						} else if( ']' == ch ) {
-							break;
-						} else {
-							fprintf( stderr, "%s[%d]: Unexpected character: '%c'\n", __FILE__,__LINE__, *str );
-							break;
-						}
-					}
-				} else {
-					std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-					fprintf( stderr, "%s[%d]: Failed to get object: '%s'\n", __FILE__,__LINE__, s.c_str() );
-				}
+				CppONParseError err;
+				p.getError( err );
+				fprintf( stderr, "%s[%d]: Parse error: %s at line %u column %u\n", __FILE__, __LINE__, err.message(), err.line, err.column );
 			}
-		} else {
-			std::string s( sav, (( i = strlen( sav ) ) > 24 )?24:i );
-			fprintf( stderr, "%s[%d]: Parse ERROR: Expected '[' got '%s'\n", __FILE__, __LINE__, sav );
+		} else if( '0' <= p.peek() && '9' >= p.peek() ) {
+			CppON *obj = p.value();
+			if( CppON::isArray( obj ) )
+			{
+				// cppcheck-suppress cstyleCast
+				std::swap( data, ( (COArray *) obj )->data );
+				// cppcheck-suppress cstyleCast
+				std::swap( inArena, ( (COArray *) obj )->inArena );
+			} else {
+				fprintf( stderr, "%s[%d]: Parse ERROR: TNet string is not an array\n", __FILE__, __LINE__ );
+			}
+			if( obj )
+			{
+				delete obj;
+			}
+		} else if( p.peek() ) {
+			size_t		rem = str + len - p.position();
+			std::string	s( p.position(), ( 24 < rem ) ? 24 : rem );
+			fprintf( stderr, "%s[%d]: Parse ERROR: Expected '[' got '%s'\n", __FILE__, __LINE__, s.c_str() );
 		}
-#if 1
-
 #else
         json_t        *root = NULL;
         json_error_t  error;
@@ -4674,49 +9171,21 @@ void COArray::parseData( const char *str )
 
 COArray::COArray( const char *path, const char *file ): CppON( ARRAY_CPPON_OBJ_TYPE )
 {
-	struct stat     _stat;
 	std::string p( path );
-	FILE    *fp;
-
-    data = new vector<CppON *>();
-    siz = 0;
-
-	if( '/' != p.back() )
-	{
-		p += '/';
-	}
-	p.append( file );
 
-	if( ! stat( p.c_str(), &_stat ) && ! ( _stat.st_mode & DIRECTORY_BIT ) && (fp = fopen( p.c_str(), "r" ) ) )
-	{
-	    int     sz = 1024;
-	    char    *buf,*bSave;
-	    int     rd = 0;
-	    int     c;
-
-	    if( !( buf = (char *) malloc( sz ) ) )
-	    {
-	        fclose( fp );
-	        fprintf( stderr, "%s[%.4u]: Failed to allocate memory",__FILE__, __LINE__ );
-	    }
-	    while( EOF != ( c = fgetc( fp ) ) )
-	    {
-	        buf[ rd++ ] = ( char ) c;
-	        if( rd == sz )
-	        {
-	            if( !( buf = (char *) realloc( (void *) (bSave = buf ), sz += 512 ) ) )
-	            {
-	    	        fprintf( stderr, "%s[%.4u]: Failed to reallocate memory: %d bytes!",__FILE__, __LINE__, sz );
-	                free( bSave );
-	            }
-	        }
-	    }
-	    buf[ rd ] = '\0';
-	    fclose( fp );
+    data = new vector<CppON *>();
+    siz = 0;
 
-	    parseData( buf );
+	if( '/' != p.back() )
+	{
+		p += '/';
+	}
+	p.append( file );
 
-	    free(buf );
+	CppONFileImage	img( p.c_str() );
+	if( img.ok() )
+	{
+		parseData( img.data(), img.length() );
 	} else {
         fprintf( stderr, "%s[%.4u]: Failed to open JSON FILE \"%s\"",__FILE__, __LINE__, p.c_str() );
 	}
@@ -4731,157 +9200,46 @@ COArray::COArray( const char *str ): CppON( ARRAY_CPPON_OBJ_TYPE )
 
 void COArray::clear( )
 {
+    touch();
+    unshare();
     vector <CppON *> *v = ( vector<CppON *> * ) data;
     for(unsigned int i = 0; v->size() > i; i++ )
     {
         delete( v->at( i ) );
     }
+    v->clear();
+    changed();
 }
 
 CppON *COArray::remove( size_t idx )
 {
+    touch();
+    unshare();
     vector< CppON *>  *v = ( vector<CppON *> *) data;
     CppON *rtn = NULL;
     if( v->size() > idx )
     {
         rtn = v->at( idx );
         v->erase( v->begin() + idx );
+        orphan( rtn );
+        changed();
     }
     return rtn;
 }
 
 string *COArray::toCompactJsonString( )
 {
-     std::string *rtn = new string( "[" );
-
-    if( data )
-    {
-        vector <CppON *> *v = ( vector <CppON *> * ) data;
-        unsigned       int i;
-        bool         first = true;
-
-        for( i = 0; v->size() > i; i++ )
-        {
-            if( first )
-            {
-                first = false;
-            } else {
-                rtn->append( "," );
-            }
-
-            CppON       *n = v->at( i );
-            std::string *sptr = NULL;
-            switch ( n->type() )
-            {
-                case INTEGER_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COInteger *) n )->toJsonString();
-                    break;
-                case DOUBLE_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (CODouble *) n )->toJsonString();
-                    break;
-                case STRING_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COString *) n )->toJsonString();
-                    break;
-                case BOOLEAN_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COBoolean *) n )->toJsonString();
-                    break;
-                case MAP_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COMap *) n )->toCompactJsonString();
-                    break;
-                case ARRAY_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COArray *) n )->toCompactJsonString( );
-                    break;
-                case NULL_CPPON_OBJ_TYPE:
-                    fprintf( stderr, "COArray: toJsonString -> Dropping NULL\n" );
-                    break;
-                default:
-                    break;
-            }
-            if( sptr )
-            {
-                *rtn += *sptr;
-                delete sptr;
-            }
-        }
-    }
-    *rtn += ']';
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
     return rtn;
 }
 
 string *COArray::toJsonString( std::string &indent )
 {
-    std::string *rtn = new string( indent.c_str() );
-    rtn->append( "[\n" );
-
-    if( data )
-    {
-        vector <CppON *> *v = ( vector <CppON *> * ) data;
-        unsigned       int i;
-        bool         first = true;
-        std::string                       newIndent = indent;
-
-        newIndent.append( "  " );
-
-        for( i = 0; v->size() > i; i++ )
-        {
-            if( first )
-            {
-                first = false;
-            } else {
-                rtn->append( ",\n");
-            }
-            rtn->append( newIndent.c_str() );
-
-            CppON       *n = v->at( i );
-            std::string *sptr = NULL;
-            switch ( n->type() )
-            {
-                case INTEGER_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COInteger *) n )->toJsonString();
-                    break;
-                case DOUBLE_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (CODouble *) n )->toJsonString();
-                    break;
-                case STRING_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COString *) n )->toJsonString();
-                    break;
-                case BOOLEAN_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COBoolean *) n )->toJsonString();
-                    break;
-                case MAP_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COMap *) n )->toJsonString( newIndent );
-                    break;
-                case ARRAY_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COArray *) n )->toJsonString( newIndent );
-                    break;
-                case NULL_CPPON_OBJ_TYPE:
-                    fprintf( stderr, "COArray: toJsonString -> Dropping NULL\n" );
-                    break;
-                default:
-                    break;
-            }
-            if( sptr )
-            {
-                *rtn += *sptr;
-                delete sptr;
-            }
-        }
-    }
-    *rtn += '\n';
-    rtn->append( indent.c_str() );
-    *rtn += ']';
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn, CPPON_WRITE_PRETTY );
+    w.write( this, indent.c_str() ).flush();
     return rtn;
 }
 
@@ -4889,56 +9247,12 @@ string *COArray::toNetString()
 {
     if( data )
     {
-        vector <CppON *> *v = ( vector <CppON *> * ) data;
-        unsigned       int i;
-        std::string    rt;
-
-        for( i = 0; v->size() > i; i++ )
-        {
-            CppON * n = v->at( i );
-            std::string *sptr = NULL;
-            switch ( n->type() )
-            {
-                case INTEGER_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COInteger *) n )->toNetString();
-                    break;
-                case DOUBLE_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (CODouble *) n )->toNetString();
-                    break;
-                case STRING_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COString *) n )->toNetString();
-                    break;
-                case BOOLEAN_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( ( COBoolean *) n )->toNetString();
-                    break;
-                case MAP_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COMap *) n )->toNetString();
-                    break;
-                case ARRAY_CPPON_OBJ_TYPE:
-                    // cppcheck-suppress cstyleCast
-                    sptr = ( (COArray *) n )->toNetString();
-                    break;
-                case NULL_CPPON_OBJ_TYPE:
-                    fprintf( stderr, "COArray: toNetString -> Dropping NULL\n" );
-                    break;
-                default:
-                    break;
-            }
-            if( sptr )
-            {
-                rt += *sptr;
-                delete sptr;
-            }
-        }
-        return CppON::toNetString( rt.c_str(), ']' );
+        std::string *rtn = new std::string();
+        CppONWriter  w( *rtn, CPPON_WRITE_TNET );
+        w.write( this ).flush();
+        return rtn;
     }
-
-  return NULL;
+    return NULL;
 }
 
 const char  *COArray::c_str( std::string &idnt )
@@ -5129,8 +9443,11 @@ COArray  *COArray::diff( COArray &newObj, const char *name )
     COArray                           *na;
     vector< CppON *>::iterator      it;
     vector< CppON *>::iterator      nt;
-    vector< CppON *>                *v     = ( vector <CppON *> * ) data;
-    vector< CppON *>                *u     = ( vector <CppON *> * ) newObj.data;
+    vector< CppON *>                *v     = ( vector <CppON *> * ) peek();
+    vector< CppON *>                *u     = ( vector <CppON *> * ) newObj.peek();
+    CppONPath                       key( ( name ) ? name : "" );
+    unordered_map< string, vector< size_t > > named;                             // positions of the old maps by their "name" member
+    bool                            indexed = false;
     it = v->begin();
     // cppcheck-suppress postfixOperator
     for( nt = u->begin(); u->end() != nt; nt++ )
@@ -5139,23 +9456,34 @@ COArray  *COArray::diff( COArray &newObj, const char *name )
         CppON  *obj = NULL;
         COString *uS;
         // cppcheck-suppress cstyleCast
-        if( CppON::isMap( obj = (CppON *) *nt ) && name && CppON::isString( uS = (COString *)( ( COMap * ) obj)->findElement( name ) ) )   // If array of maps look for name
+        if( CppON::isMap( obj = (CppON *) *nt ) && name && CppON::isString( uS = (COString *)( ( COMap * ) obj)->findElement( key ) ) )   // If array of maps look for name
         {
-            // cppcheck-suppress postfixOperator
-            for( it = v->begin(); v->end() != it; it++ )
+            if( ! indexed )
             {
-                // cppcheck-suppress cstyleCast
-                if( CppON::isMap( n = (CppON *) *it ) && CppON::isString( vS = (COString *) ( ( COMap * ) n )->findElement( name ) ) && !strcmp( uS->c_str(), vS->c_str( ) ) )
+                for( size_t i = 0; v->size() > i; i++ )
                 {
                     // cppcheck-suppress cstyleCast
-                    if( (nv = ((COMap *) n )->diff( *((COMap *) obj ), name ) ) )
+                    if( CppON::isMap( n = (*v)[ i ] ) && CppON::isString( vS = (COString *) ( ( COMap * ) n )->findElement( key ) ) )
                     {
-                        delete( nv );      // send whole map
-                        // cppcheck-suppress cstyleCast
-                        rtn->append( new COMap( *( ( COMap * ) obj ) ) );
-                        break;
+                        named[ vS->c_str() ].push_back( i );
                     }
                 }
+                indexed = true;
+            }
+            it = v->end();
+            unordered_map< string, vector< size_t > >::iterator f = named.find( uS->c_str() );
+            for( size_t i = 0; named.end() != f && f->second.size() > i; i++ )
+            {
+                n = (*v)[ f->second[ i ] ];
+                // cppcheck-suppress cstyleCast
+                if( ! sameTree( n, obj ) && (nv = ((COMap *) n )->diff( *((COMap *) obj ), name ) ) )
+                {
+                    delete( nv );      // send whole map
+                    // cppcheck-suppress cstyleCast
+                    rtn->append( new COMap( *( ( COMap * ) obj ) ) );
+                    it = v->begin() + f->second[ i ];
+                    break;
+                }
             }
         } else if( it != v->end() ) {
             obj = ( CppON * ) *nt;
@@ -5205,7 +9533,7 @@ COArray  *COArray::diff( COArray &newObj, const char *name )
                         break;
                     case MAP_CPPON_OBJ_TYPE:
                         // cppcheck-suppress cstyleCast
-                        if( (nv = ((COMap *) n )->diff( *((COMap *) obj ) ) ) )
+                        if( ! sameTree( n, obj ) && (nv = ((COMap *) n )->diff( *((COMap *) obj ) ) ) )
                         {
                             delete (nv);                                                  // send whole map
                             // cppcheck-suppress cstyleCast
@@ -5214,7 +9542,7 @@ COArray  *COArray::diff( COArray &newObj, const char *name )
                         break;
                     case ARRAY_CPPON_OBJ_TYPE:
                         // cppcheck-suppress cstyleCast
-                        if( (na = ( (COArray *) n )->diff( *( ( COArray *) obj ) ) ) )
+                        if( ! sameTree( n, obj ) && (na = ( (COArray *) n )->diff( *( ( COArray *) obj ) ) ) )
                         {
                             delete (na);                                                  // send whole map
                             // cppcheck-suppress cstyleCast
@@ -5239,52 +9567,52 @@ COArray  *COArray::diff( COArray &newObj, const char *name )
 
 COArray *COArray::operator=( COArray &val )
 {
-    if( data )
+    touch();
+    if( this == &val )
     {
-        vector <CppON *> *v = ( vector<CppON *> * ) data;
-        for(unsigned int i = 0; v->size() > i; i++ )
-        {
-            delete( v->at( i ) );
-        }
-        v->clear();
-    } else {
-        data = new vector<CppON *>();
+        return this;
+    }
+    deleteData();                                                   // only lets go of data shared with copies
+    if( copyMembers( val ) )
+    {
+        return this;
     }
+    data = new vector<CppON *>();
     siz = val.size();
 
     for( int i = 0; val.size() > i; i++ )
     {
-        CppON *jt = val.at( i );
+        CppON *jt = ( *(vector<CppON *> *) val.data )[ i ];
 
         switch( jt->type() )
         {
             case INTEGER_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COInteger( *((COInteger *)jt ) ) );
+                put( new COInteger( *((COInteger *)jt ) ) );
                 break;
             case DOUBLE_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new CODouble( *( (CODouble *)jt ) ) );
+                put( new CODouble( *( (CODouble *)jt ) ) );
                 break;
             case STRING_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COString( *( (COString *)jt ) ) );
+                put( new COString( *( (COString *)jt ) ) );
                 break;
             case NULL_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new CONull( *( (CONull *)jt ) ) );
+                put( new CONull( *( (CONull *)jt ) ) );
                 break;
             case BOOLEAN_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COBoolean( *( (COBoolean *)jt ) ) );
+                put( new COBoolean( *( (COBoolean *)jt ) ) );
                 break;
             case MAP_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COMap( *( (COMap *)jt ) ) );
+                put( new COMap( *( (COMap *)jt ) ) );
                 break;
             case ARRAY_CPPON_OBJ_TYPE:
                 // cppcheck-suppress cstyleCast
-                append( new COArray( *( (COArray *)jt ) ) );
+                put( new COArray( *( (COArray *)jt ) ) );
                 break;
             default:
                 break;
@@ -5300,10 +9628,17 @@ bool COArray::operator == ( COArray &val )
     {
         return false;
     }
-    for( int i = 0; val.size() > i; i++ )
+    if( hashed() && val.hashed() && hash() != val.hash() )
     {
-        // cppcheck-suppress cstyleCast
-        if( ! ( val.at( i ) == ((COArray*)this)->at( i ) ) )
+        return false;
+    }
+    vector<CppON *> *v = (vector<CppON *> *) val.peek();
+    vector<CppON *> *w = (vector<CppON *> *) peek();
+    for( size_t i = 0; v && w && v != w && v->size() > i; i++ )          // v == w when copies share it
+    {
+        CppON   *a = (*v)[ i ];
+        CppON   *b = (*w)[ i ];
+        if( a != b && ( !isObj( a ) || !isObj( b ) || *a != *b ) )          // the members, not their addresses
         {
             return false;
         }
@@ -5327,69 +9662,57 @@ COString::COString( COString &st ) : CppON( STRING_CPPON_OBJ_TYPE )
     data = ( st.data ) ? new std::string( ( ( std::string *) st.data )->c_str() ): NULL;
 }
 
-COString::COString( std::string st ) : CppON( STRING_CPPON_OBJ_TYPE )
+/*
+ * The text of a std::string with '"', '%' and NUL written as %22, %25 and %00.  Text without any of them (the usual case)
+ * is moved over rather than copied.
+ */
+static std::string *escaped( std::string &st )
 {
-	std::string rst;
+	if( std::string::npos == st.find_first_of( "\"%\0", 0, 3 ) )
+	{
+		return new std::string( std::move( st ) );
+	}
 
+	std::string *rst = new std::string();
+	rst->reserve( st.length() + 8 );
 	for( unsigned int i = 0; st.length() > i; i++ )
 	{
 		char ch = st[ i ];
 		switch( ch )
 		{
         	case '"':
-        		rst.append( "%22" );
+        		rst->append( "%22" );
         		break;
         	case '%':
-        		rst.append( "%25" );
+        		rst->append( "%25" );
         		break;
         	case '\0':
-        		rst.append( "%00" );
+        		rst->append( "%00" );
         		break;
         	default:
-        		rst.push_back( ch );
+        		rst->push_back( ch );
         		break;
 		}
 	}
-	data = new std::string( rst.c_str() );
+	return rst;
+}
+
+COString::COString( std::string st ) : CppON( STRING_CPPON_OBJ_TYPE )
+{
+	data = escaped( st );
 }
 
 COString::COString( std::string st, bool base64 ) : CppON( STRING_CPPON_OBJ_TYPE )
 {
 	if( ! base64 )
 	{
-		std::string rst;
-
-		for( unsigned int i = 0; st.length() > i; i++ )
-		{
-			char ch = st[ i ];
-			switch( ch )
-			{
-            	case '"':
-            		rst.append( "%22" );
-            		break;
-            	case '%':
-            		rst.append( "%25" );
-            		break;
-            	case '\0':
-            		rst.append( "%00" );
-            		break;
-            	default:
-            		rst.push_back( ch );
-            		break;
-			}
-		}
-		data = new std::string( rst.c_str() );
+		data = escaped( st );
 	} else {
 		unsigned int	len;
 		char 			out[ st.length() + 3 ];
 		if( base64Decode( st.c_str(), st.length(), len, out ) )
 		{
-			std::string *s = new std::string( );
-			s->reserve( len );
-			for( unsigned i = 0; i < len; i++ )
-			{
-				s[ i ] = out[ i ];
-			}
+			data = new std::string( out, len );
 		} else {
 			data = NULL;
 		}
@@ -5455,6 +9778,7 @@ COString::COString( uint32_t val, bool hex ) : CppON( STRING_CPPON_OBJ_TYPE )
 }
 COString *COString::operator = ( uint64_t val )
 {
+	touch();
 	char buf[ 32 ];
 #if SIXTY_FOUR_BIT
 	if( data && '0' == ((std::string *) data)->at( 0 )  )
@@ -5481,6 +9805,7 @@ COString *COString::operator = ( uint64_t val )
 }
 COString *COString::operator = ( uint32_t val )
 {
+	touch();
 	char buf[ 24 ];
 	if( data && '0' == ((std::string *) data)->at( 0 ) )
 	{
@@ -5498,6 +9823,7 @@ COString *COString::operator = ( uint32_t val )
 }
 COString *COString::operator = ( int val )
 {
+	touch();
 	char buf[ 24 ];
 	snprintf( buf, 23, "%d", val );
 
@@ -5531,7 +9857,10 @@ std::string *COString::toString()
 
 string *COString::toNetString()
 {
-    return CppON::toNetString( ( ( std::string *) data )->c_str(), ',' );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn, CPPON_WRITE_TNET );
+    w.write( this ).flush();
+    return rtn;
 }
 
 static unsigned char dtab[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0A, 0x80, 0x80, 0x80, 0x80, 0x80,
@@ -5659,57 +9988,9 @@ string *COString::toJsonString()
     {
         return NULL;
     }
-    unsigned int len = ( ( std::string *) data)->length();
-    const char *cPtr =  ( ( std::string *) data)->c_str();
-    string *rtn = new string( "\"" );
-    for(unsigned int i = 0; len > i; i++)
-    {
-        char ch = cPtr[ i ];
-        switch( ch )
-        {
-            case '"':
-                rtn->append( "%22");
-                break;
-            case '{':
-                rtn->append( "%7B" );
-                break;
-            case '}':
-                rtn->append( "%7D" );
-                break;
-            case '<':
-                rtn->append( "%3C" );
-                break;
-            case '>':
-                rtn->append( "%3E" );
-                break;
-            case '\\':
-                rtn->append( "%5C" );
-                break;
-            case '\'':
-                rtn->append( "%60" );
-                break;
-            case '^':
-                rtn->append( "%5E" );
-                break;
-            case '&':
-                rtn->append( "%26" );
-                break;
-            case '\r':
-                rtn->append( "%0D" );
-                break;
-            case '\n':
-            case '\a':
-                rtn->append( "%0A" );
-                break;
-            case '\t':
-                rtn->push_back( ' ' );
-                break;
-            default:
-                rtn->push_back( ch );
-                break;
-        }
-    }
-    rtn->push_back( '"');
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
     return rtn;
 }
 
@@ -5745,57 +10026,34 @@ CODouble::CODouble( CODouble &dt ) : CppON( DOUBLE_CPPON_OBJ_TYPE )
         data = new ( double );
     }
     *((double *) data) = dt.doubleValue();
+    precision = dt.Precision();
 }
 
 string *CODouble::toNetString()
 {
-    char buf[ 48 ];
-    buf[ 47 ] = buf[ 0 ] = '\0';
-    if( data )
-    {
-        snprintf( buf, 47, "%.10lf", *(( double *) data ));
-    }
-    return CppON::toNetString( buf, '^' );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn, CPPON_WRITE_TNET );
+    w.write( this ).flush();
+    return rtn;
 };
 
 string *CODouble::toJsonString()
 {
-    char buf[ 128 ];
-    buf[127] = buf[ 0 ] = '\0';
-    if( data )
-    {
-        if( 0 > precision || 16 < precision )
-        {
-        	snprintf( buf, 127, "%.10lf", *(double *)data );
-        } else{
-            char prebuf[ 8 ];
-            prebuf[ 7 ] = buf[ 23 ] = '\0';
-            snprintf( prebuf, 7, "%c.%dlf", '%', (int)precision );
-            snprintf( buf, 23, prebuf, *(double *) data );
-        }
-    }
-    return new string( buf );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
+    return rtn;
 }
 
 const char *CODouble::c_str()
 {
-    char buf[ 32 ];
-    buf[ 31 ] = '\0';
+    char buf[ 64 ];
     if( data )
     {
-        if( 0 > precision || 16 < precision )
-        {
-            snprintf( buf, 31, "%.10lf", *(double *) data );
-        } else{
-            char prebuf[ 8 ];
-            prebuf[ 7 ] = buf[ 23 ] = '\0';
-            snprintf( prebuf, 7, "%c.%dlf", '%', (int)precision );
-            snprintf( buf, 23, prebuf, *(double *) data );
-        }
+        str.assign( buf, formatDouble( this, buf, false ) );
     } else {
-        strcpy( buf, "NULL" );
+        str = "NULL";
     }
-    str = buf;
     return str.c_str();
 }
 
@@ -5821,6 +10079,7 @@ void CODouble::cdump( FILE *fp )
 
 double CODouble::operator = (const double& val)
 {
+    touch();
     if( !data )
     {
         data = new double;
@@ -5846,6 +10105,7 @@ double CODouble::operator = (const double& val)
 
 CODouble *CODouble::operator = ( CODouble &val)
 {
+    touch();
     if( ! data )
     {
         data = new double;
@@ -5877,31 +10137,10 @@ CODouble *CODouble::operator = ( CODouble &val)
 
 string *COInteger::toJsonString()
 {
-    char buf[ 32 ];
-    buf[ 31 ] = buf[ 0 ] = '\0';
-    if( data )
-    {
-        switch ( siz )
-        {
-            case sizeof( char ):
-                snprintf( buf, 31,"%c", *( char *) data );
-                break;
-            case sizeof( short ):
-                snprintf( buf, 31, "%d", ( int ) *(( short *) data ));
-                break;
-            case sizeof( int ):
-                snprintf( buf, 31, "%d", *(( int *) data ));
-                break;
-            case sizeof( long long):
-#if SIXTY_FOUR_BIT
-                snprintf( buf, 31, "%ld", *(( uint64_t *) data ));
-#else
-                snprintf( buf, 31, "%lld", *(( uint64_t *) data ));
-#endif
-                break;
-        }
-    }
-    return new string( buf );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
+    return rtn;
 }
 
 COInteger::COInteger( COInteger *it ) : CppON( INTEGER_CPPON_OBJ_TYPE )
@@ -5976,60 +10215,21 @@ int64_t COInteger::longValue()
 
 string *COInteger::toNetString()
 {
-    char buf[ 32 ];
-    buf[ 31 ] = buf[ 0 ] = '\0';
-    if( data )
-    {
-        switch ( siz )
-        {
-            case 1:
-                snprintf( buf, 31, "%c", *( char *) data );
-                break;
-            case 2:
-                snprintf( buf, 31, "%d", ( int ) *(( short *) data ));
-                break;
-            case 4:
-                snprintf( buf, 31, "%d", *(( int *) data ));
-                break;
-            case 8:
-#if SIXTY_FOUR_BIT
-                snprintf( buf, 31, "%ld", *(( uint64_t *) data ));
-#else
-                snprintf( buf, 31, "%lld", *(( uint64_t *) data ));
-#endif
-                break;
-        }
-    }
-    return CppON::toNetString( buf, '#' );
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn, CPPON_WRITE_TNET );
+    w.write( this ).flush();
+    return rtn;
 }
 
 const char *COInteger::c_str()
 {
-    char buf[ 32 ];
-    buf[ 31 ] = '\0';
+    char buf[ 24 ];
     if( data )
     {
-        switch ( siz )
-        {
-            case sizeof( char ):
-                snprintf( buf, 31, "%c", *(char *) data );
-                break;
-            case sizeof( short ):
-                snprintf( buf, 31, "%d", ( int ) *(short *) data );
-                break;
-            case sizeof( int ):
-                snprintf( buf, 31, "%d", *(int *) data );
-                break;
-            default:
-#if SIXTY_FOUR_BIT
-                snprintf( buf, 31, "%ld", *(uint64_t *) data );
-#else
-                snprintf( buf, 31, "%lld", *(uint64_t *) data );
-#endif
-                break;
-        }
+        str.assign( buf, formatInteger( this, buf ) );
+    } else {
+        str.clear();
     }
-    str = buf;
     return str.c_str();
 }
 
@@ -6092,6 +10292,7 @@ void COInteger::cdump( FILE *fp )
 
 uint64_t COInteger::doOperation( unsigned sz, uint64_t val, CppONOperator op )
 {
+	touch();
 	int64_t rtn = 0;
 	switch( siz )
 	{
@@ -6349,15 +10550,10 @@ bool COInteger::operator == ( COInteger &newObj ) {
 
 COInteger *COInteger::operator=(COInteger &val )
 {
+    touch();
     if( siz != val.siz )
     {
-        switch(siz)
-        {
-            case sizeof(int): delete (int*)data; break;
-            case sizeof(long long): delete (long long*)data; break;
-            case sizeof(short): delete (short*)data; break;
-            case sizeof(char): delete (char*)data; break;
-        }
+        deleteData();
         switch(siz=val.siz)
         {
             case sizeof(int): data=new int;break;
@@ -6392,5 +10588,8 @@ void CONull::cdump( FILE *fp )
 }
 string *CONull::toJsonString()
 {
-    return new string("null");
+    std::string *rtn = new std::string();
+    CppONWriter  w( *rtn );
+    w.write( this ).flush();
+    return rtn;
 }
@@ -15,7 +15,7 @@
  *              when the code loses scope and also when the hierarchy is destroyed.
  *
  *              The route of most "trees" is usually one of the two "container" classes: the Map object or an Array.  Usually a Map.
- *              A Map represents a hashmap and is actually implemented as an extension of a std::map< std::string, CppON *> container.  It is
+ *              A Map represents a hashmap and is actually implemented as an insertion ordered vector of std::pair< std::string, CppON *>.  It is
  *              represented as a map in JSON and TNetStrings as well as an object in JavaScript.  In fact the method value() returns a pointer
  *              to the internal map.  Care should be used not to modify the contents returned from this function.
  *              An Array represents a dynamic list of objects and is implemented as extension of a std::vector< CppON *> container internally. Like
@@ -83,6 +83,10 @@
  *              You could modify the value of two to 20.2
  *                *((CODouble *) myMap.findElement( "param/two" ) = 20.2;
  *
+ *              A path that is looked up often can be compiled once and optionally cache what it finds:
+ *                static CppONPath two( "param/arr:3", true );
+ *                CODouble *d = (CODouble *) myMap.findElement( two );
+ *
  *              You could add a object to the class by doing something like this:
  *                COMap *param;
  *                if( CppON::isMap( param = (COMap*) myMap->findElement( "param" ) ) )
@@ -195,6 +199,10 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <new>
+#include <utility>
+#include <atomic>
+#include <deque>
 #include <semaphore.h>
 
 //#include <jansson.h>
@@ -234,6 +242,325 @@ enum CppONOperator
 	CPPON_DIVIDE
 };
 
+enum CppONParseErrorCode
+{
+	CPPON_PARSE_OK,
+	CPPON_PARSE_UNEXPECTED_CHARACTER,
+	CPPON_PARSE_UNEXPECTED_END,
+	CPPON_PARSE_EXPECTED_KEY,
+	CPPON_PARSE_EXPECTED_COLON,
+	CPPON_PARSE_UNTERMINATED_STRING,
+	CPPON_PARSE_BAD_ESCAPE,
+	CPPON_PARSE_BAD_NUMBER,
+	CPPON_PARSE_BAD_TNET_LENGTH,
+	CPPON_PARSE_BAD_TNET_TYPE,
+	CPPON_PARSE_STOPPED,																	// a CppONHandler callback returned false
+	CPPON_PARSE_BAD_BINARY_TAG,																// parseBinary() met a byte that starts no value
+	CPPON_PARSE_TOO_DEEP,																	// maps and arrays nested deeper than CPPON_MAX_DEPTH
+	CPPON_PARSE_TOO_LARGE																	// a CppONStreamParser message over its limit
+};
+
+#define CPPON_MAX_DEPTH					512													// Nesting the parsers and CppONView accept, deeper input fails
+#define CPPON_STREAM_LIMIT				( 16 * 1024 * 1024 )								// Default CppONStreamParser message limit in bytes
+
+enum CppONWriteMode
+{
+	CPPON_WRITE_COMPACT,																	// what toCompactJsonString() produces
+	CPPON_WRITE_PRETTY,																		// what toJsonString( indent ) produces
+	CPPON_WRITE_TNET,																		// what toNetString() produces
+	CPPON_WRITE_BINARY,																		// what toBinary() produces, see CppONView
+	CPPON_WRITE_JSON																		// pretty printed with standard JSON escapes, what COMap::toFile() writes
+};
+
+/*
+ * Filled in by parseJson( str, len, err ).  On failure offset, line and column (both 1 based) locate the first offending
+ * character.  consumed is the number of bytes taken by the value and any white space after it.
+ */
+struct CppONParseError
+{
+	CppONParseErrorCode						code;
+	size_t									offset;
+	unsigned								line;
+	unsigned								column;
+	size_t									consumed;
+	const char								*message() const;
+};
+
+/*
+ * How parseTable() reads delimited text.  Unless told otherwise every cell is a COString and each row a COArray of them.
+ *
+ * With types set a column whose cells are all integers (up to 18 digits) becomes COIntegers and one whose cells are all
+ * numbers becomes CODoubles;  empty cells in those, and columns with nothing in them at all, are CONulls.  With columns set
+ * the result has one array per column instead of one per row, short rows padded with CONull.  A header names the columns:
+ * rows become COMaps keyed by the names and columns come back in a COMap.  Blank and duplicate names, and columns past the
+ * header, are named by their number.  Blank lines are skipped.
+ */
+struct CppONTableOptions
+{
+	char									delimiter;
+	bool									quotes;											// "..." cells with "" for a quote (RFC 4180)
+	bool									header;											// The first row names the columns
+	bool									types;
+	bool									columns;
+	unsigned								threads;										// Chunks parsed in parallel for big inputs, 0 for one per core
+											// cppcheck-suppress noExplicitConstructor
+											CppONTableOptions( char d = ',' ) : delimiter( d ), quotes( ',' == d ), header( false ), types( false ), columns( false ), threads( 0 ) {}
+};
+
+/*
+ * Receives the events of CppON::parseEvents() in document order, no tree is built.  Every callback returns true to carry on
+ * or false to stop the parse there (it then fails with CPPON_PARSE_STOPPED).  The defaults ignore the event so a handler only
+ * needs to override what it cares about.
+ *
+ * Keys and strings are handed over as a pointer and length that are only good for the duration of the call.  When the text
+ * has no escapes it points straight into the input, otherwise at the decoded copy in a buffer the parser reuses.  TNet
+ * input produces the same events as the equivalent JSON.
+ */
+class CppONHandler
+{
+public:
+	virtual									~CppONHandler() {}
+	virtual	bool							startObject() { return true; }
+	virtual	bool							key( const char *, size_t ) { return true; }
+	virtual	bool							endObject() { return true; }
+	virtual	bool							startArray() { return true; }
+	virtual	bool							endArray() { return true; }
+	virtual	bool							intValue( int64_t ) { return true; }
+	virtual	bool							doubleValue( double ) { return true; }
+	virtual	bool							stringValue( const char *, size_t ) { return true; }
+	virtual	bool							boolValue( bool ) { return true; }
+	virtual	bool							nullValue() { return true; }
+};
+
+/*
+ * An opt in bump allocator for node trees.
+ *
+ * Only node headers and their fixed size payloads come from the arena.  Nodes made with make<>() (the parser does this
+ * when it is handed an arena) are carved out of large blocks, so building a tree costs a pointer bump per node instead of
+ * a malloc() and deleting it costs no free() for those.  Deleting a root still walks every node:  the COMapData,
+ * std::vector and std::string internals behind containers and strings come from the heap, since those types are part of
+ * the API, and their destructors hand them back as usual.
+ *
+ * The arena must outlive every tree built in it.  clear() or the destructor hands the blocks back all at once.
+ */
+class CppONArena
+{
+public:
+	explicit								CppONArena( size_t blkSize = 65536 ) : cur( NULL ), limit( NULL ), blockSize( blkSize ), firstSize( 0 ), total( 0 ) {}
+											~CppONArena();
+			void							*alloc( size_t sz ){ sz = ( sz + 15 ) & ~( (size_t) 15 ); if( (size_t) ( limit - cur ) < sz ) { return grow( sz ); } void *p = cur; cur += sz; return p; }
+			void							clear();
+			size_t							allocated(){ return total; }
+template<typename T, typename... A> T		*make( A&&... args );
+private:
+											CppONArena( const CppONArena & );
+			CppONArena						&operator = ( const CppONArena & );
+			void							*grow( size_t sz );
+
+			std::vector<char *>				blocks;
+			char							*cur;
+			char							*limit;
+			size_t							blockSize;
+			size_t							firstSize;										// blocks[ 0 ] may be bigger than blockSize
+			size_t							total;
+};
+
+class CppON;
+class CppONPath;
+struct CppONRetired;
+
+/*
+ * Serializes a tree straight into a sink with no intermediate strings.  Output is staged in a small buffer inside the
+ * writer and handed to the sink as that fills and when the writer is flushed or destroyed.  The sinks are:
+ *   std::string      appended to, it grows as needed
+ *   char * and size  a fixed buffer, output that doesn't fit is dropped, failed() turns true and length() still counts it
+ *                    so the caller knows how large a buffer was needed.  The buffer is always NUL terminated on flush.
+ *   FILE *           written with fwrite()
+ *   file descriptor  written with write()
+ *
+ * The containers and the leaf classes toCompactJsonString(), toJsonString( indent ) and toNetString() are wrappers around
+ * a writer on a std::string.  The put*() calls write single JSON values so text can be produced without building nodes,
+ * the caller supplies the punctuation.  TNet mode makes one sizing pass over the tree first so each length prefix is known before its
+ * payload is written.
+ */
+class CppONWriter
+{
+public:
+	explicit								CppONWriter( std::string &out, CppONWriteMode mode = CPPON_WRITE_COMPACT );
+											CppONWriter( char *buf, size_t size, CppONWriteMode mode = CPPON_WRITE_COMPACT );
+	explicit								CppONWriter( FILE *fp, CppONWriteMode mode = CPPON_WRITE_COMPACT );
+	explicit								CppONWriter( int fd, CppONWriteMode mode = CPPON_WRITE_COMPACT );
+											~CppONWriter(){ flush(); }
+			CppONWriter						&write( CppON *obj, const char *indent = "" );	// indent only applies to CPPON_WRITE_PRETTY
+			void							put( char ch ){ if( sizeof( chunk ) == used ) { drain(); } chunk[ used++ ] = ch; }
+			void							put( const char *s, size_t len );
+			void							put( const char *s ){ put( s, strlen( s ) ); }
+			void							putInt( int64_t v );
+			void							putDouble( double v, int precision = -1 );		// precision 0 - 16 places, otherwise the shortest text
+			void							putString( const char *s, size_t len );			// Quoted and escaped like a COString, or as JSON for CPPON_WRITE_JSON
+			void							putBool( bool v ){ put( ( v ) ? "true" : "false" ); }
+			void							flush();
+			size_t							length() const { return total + used; }
+			bool							failed() const { return error; }
+private:
+											CppONWriter( const CppONWriter & );
+			CppONWriter						&operator = ( const CppONWriter & );
+			void							drain(){ emit( chunk, used ); used = 0; }
+			void							emit( const char *s, size_t len );
+			void							compact( CppON *obj );
+			void							pretty( CppON *obj, std::string &indent );
+			void							tnet( CppON *obj );
+			size_t							tnetSize( CppON *obj );
+			void							leaf( CppON *obj );
+			void							quoted( const std::string &s ){ putString( s.c_str(), s.length() ); }
+			void							tnetHeader( size_t len );
+			void							binary( CppON *obj );
+			void							binaryInt( int64_t v );
+			void							binaryString( const char *s, size_t len );
+			void							binaryCount( uint8_t fix, uint8_t tag, size_t n );
+			void							binaryLE( uint64_t v, unsigned n );
+
+			std::string						*out;
+			char							*fixed;
+			size_t							fixedSize;
+			FILE							*fp;
+			int								fd;
+			CppONWriteMode					mode;
+			bool							error;
+			size_t							total;											// bytes handed to the sink so far
+			size_t							used;											// bytes staged in chunk
+			std::vector<size_t>				sizes;											// TNet payload sizes, containers in pre-order
+			size_t							nextSize;
+			char							chunk[ 4096 ];
+};
+
+/*
+ * Reads a value written by CPPON_WRITE_BINARY (toBinary()) in place, without building any nodes.  A view is just a position
+ * in the caller's buffer, which has to outlive it, and every read is checked against the end of the buffer so a truncated
+ * or corrupt message gives views whose type() is UNKNOWN_CPPON_OBJ_TYPE rather than reading past it.  Values nested deeper
+ * than CPPON_MAX_DEPTH are treated the same way.
+ *
+ * The encoding is MessagePack-like, one tag byte per value with the numbers and lengths after it little-endian:
+ *   0x00 - 0x7F  integer 0 - 127                 0xE0 - 0xFF  integer -32 - -1
+ *   0x80 - 0x8F  map of 0 - 15 members           0xD6 0xD7    map, 16 or 32 bit member count
+ *   0x90 - 0x9F  array of 0 - 15 elements        0xD4 0xD5    array, 16 or 32 bit element count
+ *   0xA0 - 0xBF  string of 0 - 31 bytes          0xD0 - 0xD2  string, 8, 16 or 32 bit byte count
+ *   0xC4 - 0xC7  8, 16, 32 or 64 bit integer     0xC8 - 0xCB  unsigned 8, 16, 32 or 64 bit integer
+ *   0xCC         double                          0xCD         precision byte then a double (CODouble precision other than 10)
+ *   0xC0         null                            0xC2 0xC3    false, true
+ * A map member is its key, always a string, followed by its value.  Integers come back as the JSON parser makes them.
+ *
+ * first() is the first element of an array, or the first key of a map with its value at first().next(), and next() the
+ * value that follows this one so a container can be walked in a single pass:
+ *   CppONView m( buf, len );
+ *   CppONView k = m.first();
+ *   for( size_t i = 0; m.size() > i; i++, k = k.next().next() ) { size_t l; const char *key = k.stringValue( l ); CppONView v = k.next(); }
+ */
+class CppONView
+{
+public:
+											CppONView() : cur( NULL ), end( NULL ) {}
+											CppONView( const char *buf, size_t len ) : cur( (const uint8_t *) buf ), end( (const uint8_t *) buf + len ) {}
+			bool							valid() const { return UNKNOWN_CPPON_OBJ_TYPE != type(); }
+			CppONType						type() const;
+			size_t							size() const;									// Members of a map, elements of an array, bytes of a string
+			int64_t							intValue() const;								// Numbers and booleans are converted, anything else is 0
+			double							doubleValue() const;
+			bool							boolValue() const;
+			const char						*stringValue( size_t &len ) const;				// Points into the buffer, NULL if it isn't a string
+			CppONView						first() const;
+			CppONView						next() const;
+			CppONView						at( size_t i ) const;
+			CppONView						find( const char *key, size_t len ) const;
+			CppONView						find( const char *key ) const { return find( key, strlen( key ) ); }
+			CppONView						findElement( const CppONPath &path ) const;
+			size_t							bytes() const;									// Encoded size of the value, 0 if it isn't valid
+			CppON							*toCppON( CppONArena *arena = NULL ) const;		// The value as a tree, the caller owns it
+			const char						*data() const { return (const char *) cur; }
+private:
+											CppONView( const uint8_t *c, const uint8_t *e ) : cur( c ), end( e ) {}
+			const uint8_t					*cur;
+			const uint8_t					*end;
+};
+
+/*
+ * Resumable reader for back to back JSON and TNet messages arriving on a socket, pipe or file.
+ *
+ * Bytes are pushed in with feed() in whatever pieces they arrive (or read( fd ) pulls a 64K block and feeds it).  A map or
+ * array that closes in the piece it starts in is parsed in one go straight out of the caller's buffer.  One that doesn't is
+ * built as the bytes go by:  its open maps and arrays are kept on a stack between calls and each string, number, word or
+ * TNet value in it is parsed the moment it ends, only a value that spans pieces being held over.  So nothing but the tree
+ * and one value is ever kept, and only the part of a message before a piece boundary is looked at twice.
+ *
+ * Complete objects are queued for next() or, given a callback, passed to it the moment they close.  Either way the receiver
+ * owns them.  A message is a map, an array, a JSON string or a TNet value;  whitespace and ',' or ';' between messages are
+ * skipped and a bare number or word there is an error.  A message that fails to parse, or grows past the limit (default
+ * CPPON_STREAM_LIMIT bytes), is dropped and counted in errors(), lastError() says why and where in the message, and the
+ * rest of it is stepped over without being kept so reading carries on with the next one.
+ *
+ *   CppONStreamParser sp;
+ *   while( 0 < sp.read( fd ) )
+ *   {
+ *       for( CppON *obj; NULL != ( obj = sp.next() ); delete obj ) { ... }
+ *   }
+ */
+class CppONStreamParser
+{
+public:
+	explicit								CppONStreamParser( void (*f)( CppON *obj, void *ctx ) = NULL, void *ctx = NULL );
+											~CppONStreamParser();
+			size_t							feed( const char *s, size_t len );				// Returns how many messages this piece completed
+			ssize_t							read( int fd );									// One read() fed in, returns its result (0 at EOF, -1 and errno on error)
+			CppON							*next();										// Oldest complete object or NULL, the caller owns it
+			size_t							available() const { return queue.size(); }
+			bool							partial() const { return ! stack.empty() || NONE != tok || discarding; }	// A message has started but not closed
+			void							reset();										// Drop a partial message, queued objects are kept
+			void							setLimit( size_t bytes ){ limit = bytes; }		// Longest message kept
+			size_t							errors() const { return errorCount; }
+			const CppONParseError			&lastError() const { return error; }
+private:
+	enum	Token { NONE, STRING, WORD, TNET_BODY };
+	enum	Expect { VALUE, KEY, COLON, NEXT };
+											CppONStreamParser( const CppONStreamParser & );
+			CppONStreamParser				&operator = ( const CppONStreamParser & );
+			size_t							structural( const char *s, size_t &i, size_t len );
+			size_t							finish( const char *s, size_t i );
+			size_t							place( CppON *obj );
+			size_t							fail( CppONParseErrorCode code, uint64_t at );
+			size_t							discard( const char *s, size_t i, size_t len );
+			void							drop();
+			bool							fits( size_t i ) const { return fed + i - begin <= limit; }
+
+			void							(*callback)( CppON *obj, void *ctx );
+			void							*context;
+			std::deque<CppON *>				queue;
+			std::vector<CppON *>			stack;											// Maps and arrays still open, the first is the message
+			std::vector<std::string>		names;											// The key each of them goes under in the one before
+			std::string						name;											// A key waiting for its value
+			std::string						token;											// The start of a value that spanned pieces
+			std::vector<char>				block;											// read() target
+			Token							tok;
+			Expect							expect;
+			bool							digits;											// The word so far is all digits, it may be a TNet length
+			bool							escape;
+			bool							discarding;										// Stepping over the rest of a dropped message
+			bool							whole;											// Parse maps and arrays in one go while they fit in the piece
+			bool							inString;
+			bool							inNumber;										// A run of digits that may be a nested TNet length
+			char							last;											// Last significant character outside a string
+			unsigned						depth;
+			uint64_t						number;
+			uint64_t						skip;											// TNet payload bytes (and type) still to step over
+			uint64_t						fed;											// Bytes fed before this piece
+			uint64_t						begin;											// Stream offsets of the message, the token and the line
+			uint64_t						tokenBegin;
+			uint64_t						lineBegin;
+			size_t							line;
+			size_t							limit;
+			size_t							errorCount;
+			CppONParseError					error;
+};
+
 /*
  * This is the base class.  It is not meant to be instantiated directly.
  * However you can use the "factory" to create a copy of it if you don't know its derived class
@@ -249,28 +576,42 @@ enum CppONOperator
  * various operators and methods are available for comparing two objects
  *   diff will attempt to compare to like objects and create a object representing their differences
  *   == or != can be used to get a boolean value of whether they contain the same information
+ *   hash() gives a structural hash, cached in each node until it or something under it changes, diff and == use it to tell
+ *   differing subtrees apart without walking them
+ *   copies of maps and arrays get their own member nodes, the maps and arrays under them share data until one side
+ *   changes it (copy on write, see CppON::share())
  *
  *   then there are a number of functions to create a data object from a string:
  *     parse( const char *str, char **rstr );       // Create a CppON object from a net string
  *     parseJson( const char *str );                // Create a CppON object form a json string
+ *     parseJson( const char *str, size_t len );    // Same but length aware, the string need not be NUL terminated
+ *     parseJson( const char *str, size_t len, CppONParseError &err ); // Silent version, reports the error position and code
+ *     parseEvents( const char *str, size_t len, CppONHandler &h, CppONParseError &err ); // SAX style events, no tree is built
+ *     parseSelect( const char *str, size_t len, paths, found, err ); // Build only the subtrees the CppONPaths lead to
  *     parseJson( json_t *ob, std::string &tabs );  // Create a CppON object form a Json object
  *     parseXML( const char *str );
  *     parseCSV(const char *str );                  // parse a CSV file into  and array of arrays;
  *     parseTSV(const char *str );                  // parse a TSV file into  and array of arrays;
+ *     parseTable( const char *path, const CppONTableOptions &opt ); // CSV, TSV or any delimiter with typed or columnar results
  *     parseJsonFile( const char *path );           // Read a file and create a CppON from it.
  *
  * toNetString( const char *str, char styp );  can be used to create a TNet String from the data
+ * serialize( CppONWriter &w ); writes the whole contents to a string, buffer, FILE * or descriptor in JSON or TNet form
  * dump( FILE *fp); can be used to write the whole contents to a file
  *
  * Other methods are available on the individual container classes and object classes to access and minimulate the data
  * As stated the root class is just there for accessing and moving the objects in a generic sense.
  *
  */
+#define CPPON_NODE_HASHED			0x01											// hashValue is good
+#define CPPON_NODE_ADOPTED			0x02											// The members' parent pointers lead here
+#define CPPON_NODE_EXPOSED			0x04											// Has handed out or taken in members, copies can't share its data
+
 class CppON
 {
 public:
 											CppON( CppON &jt );
-											CppON(){ data = NULL; typ=UNKNOWN_CPPON_OBJ_TYPE; siz = 0; precision=-1; }
+											CppON(){ data = NULL; typ=UNKNOWN_CPPON_OBJ_TYPE; siz = 0; precision=-1; inArena = false; flags = 0; edits = 0; hashValue = 0; parent = NULL; shared = NULL; retired = NULL; }
 											CppON( CppONType typ=UNKNOWN_CPPON_OBJ_TYPE );
 											CppON( CppON *jt = NULL );
 	virtual									~CppON();
@@ -281,7 +622,9 @@ public:
     virtual void							dump( FILE *fp = stderr );
     virtual void							cdump( FILE *fp = stderr );
     virtual std::string						*toCompactJsonString();
-			void							*getData(){ return data; }
+			std::string						*toBinary();									// The CppONView encoding, the caller deletes it
+			void							serialize( CppONWriter &w ){ w.write( this ); }
+			void							*getData(){ expose(); touch(); return data; }
 			double							toDouble(void);
 			long long						toLongInt(void);
 			int								toInt(void);
@@ -303,6 +646,8 @@ public:
 			virtual							CppON *operator = ( CppON &val );
                                             // cppcheck-suppress constParameter
 			CppON							*diff( CppON &newObj, const char *name = NULL );
+			uint64_t						hash();											// Structural hash, equal trees hash alike, see CppON.cpp
+			bool							hashed() { return 0 != ( __atomic_load_n( &flags, __ATOMIC_ACQUIRE ) & CPPON_NODE_HASHED ); }	// hash() is cached
 	const	char							*c_str( );
 	static	bool							isNumber( CppON *val ) { return ( val && ( DOUBLE_CPPON_OBJ_TYPE==val->typ || INTEGER_CPPON_OBJ_TYPE==val->typ || BOOLEAN_CPPON_OBJ_TYPE==val->typ ) ); }
 	static  bool							isMap( CppON *val ) { return ( val && MAP_CPPON_OBJ_TYPE == val->typ ); }
@@ -313,9 +658,14 @@ public:
 	static  bool							isDouble( CppON *val ) { return ( val && DOUBLE_CPPON_OBJ_TYPE == val->typ ); }
 	static  bool							isObj( CppON *val ){ return ( val && INTEGER_CPPON_OBJ_TYPE <= val->typ && ARRAY_CPPON_OBJ_TYPE >= val->typ ); }
 
-	static	CppON							*readObj( FILE *fp );
+	static	CppON							*readObj( FILE *fp );							// One object off a stream, CppONStreamParser is the fast way for back to back messages
 	static  CppON							*parse( const char *str, char **rstr );         // Create a CppON object from a net string
 	static  CppON							*parseJson( const char *str );                  // Create a CppON object form a json string
+	static  CppON							*parseJson( const char *str, size_t len );      // Same but the string need not be NUL terminated
+	static  CppON							*parseJson( const char *str, size_t len, CppONParseError &err, CppONArena *arena = NULL );	// Never prints or exits, reports failures in err
+	static	bool							parseEvents( const char *str, size_t len, CppONHandler &h, CppONParseError &err );	// SAX style, see CppONHandler
+	static	CppON							*parseBinary( const char *buf, size_t len, CppONParseError &err, CppONArena *arena = NULL );	// What toBinary() wrote
+	static	size_t							parseSelect( const char *str, size_t len, const std::vector<CppONPath> &paths, std::vector<CppON *> &found, CppONParseError &err );
 //	static  CppON							*parseJson( json_t *ob, std::string &tabs );    // Create a CppON object form a Json object
 	static	void							RemoveWhiteSpace( const char *s, std::string &str );
 	static 	CppON							*GetTNetstring( const char **str );
@@ -327,21 +677,52 @@ public:
 #endif
 	static  CppON							*parseCSV(const char *str );                    // parse a CSV file into  and array of arrays;
 	static  CppON							*parseTSV(const char *str );                    // parse a TSV file into  and array of arrays;
+	static	CppON							*parseTable( const char *path, const CppONTableOptions &opt );	// A delimited file, mapped rather than read
+	static	CppON							*parseTable( const char *str, size_t len, const CppONTableOptions &opt );	// The same from memory
 	static  CppON							*parseJsonFile( const char *path );             // Read a file and create a CppON from it.
 	static  CppON							*guessDataType( const char *str );
 	static  unsigned char					*findTNetStringArg( const char *arg, int argSize, const char *str, const char **next = NULL, int *cnt = NULL );
+			uint32_t						generation() const { return __atomic_load_n( &edits, __ATOMIC_RELAXED ); }	// Bumped when this container loses or replaces a member
 private:
-			void							deleteData();
+	friend	class							CppONParser;
+	friend	class							CppONWriter;
+	friend	class							CppONTable;
 protected:
 	static	std::string						*toNetString( const char *str, char styp );
+			void							changed() { __atomic_add_fetch( &edits, 1, __ATOMIC_RELAXED ); }	// Call after this container loses or replaces a member
+			void							touch() { if( hashed() ) { dropHash(); } }		// Call before changing this node
+			void							dropHash();
+			void							adopt();										// The members' parent is this node
+	static	CppON							*copyMember( CppON *m, CppON *owner );
+	static	void							orphan( CppON *n ) { if( n ) { n->parent = NULL; } }	// n left its container, which may not outlive it
+			bool							share( CppON &from );							// Copy on write, see CppON.cpp
+			bool							copyMembers( CppON &from );						// A copy's own level of members, see CppON.cpp
+			void							*copyData( void *from );
+			void							unshare() { if( __atomic_load_n( &shared, __ATOMIC_ACQUIRE ) ) { doUnshare(); } }	// Call before changing data
+			void							expose() { if( ! ( CPPON_NODE_EXPOSED & __atomic_load_n( &flags, __ATOMIC_ACQUIRE ) ) ) { markExposed(); } unshare(); }	// Call before handing out or taking in a member
+			void							markExposed();
+			void							*peek() { return __atomic_load_n( &data, __ATOMIC_ACQUIRE ); }	// data for walks that only read, unshare() may swap it
+			bool							release();
+			void							doUnshare();
+			void							freeData( void *d );
+			void							dropRetired();
+			void							take( CppON &from );							// Move from's payload here, see CppON.cpp
+			void							deleteData();
 
 			void							*data;											// This is an allocated pointer to the data
 			CppONType						typ;											// This is used to indicate the object type
 			int								siz;											// Either the size of the object as in 1,2 4, 8 bytes
 			std::string						str;											// Used when c_str called;
                                 															// or the number of elements in the list.
-			std::vector<std::string>		order;											// only used for Map.  Order in which keys appear
+			std::vector<std::string>		order;											// only used for Map.  Filled by getKeys()
 			char							precision;										// precision to be used for double numbers
+			bool							inArena;										// data was allocated from a CppONArena
+			unsigned char					flags;											// CPPON_NODE_...
+			uint32_t						edits;											// changed() count, cached CppONPaths check it
+			uint64_t						hashValue;										// hash() result, good while CPPON_NODE_HASHED is set
+			CppON							*parent;										// The container whose hash() last took this one in
+			int								*shared;										// Nodes holding data when copies share it, else NULL
+			CppONRetired					*retired;										// Data unshare() let go of that readers may still be in
 };
 
 /*
@@ -360,6 +741,7 @@ public:
 											COInteger( COInteger *it = NULL );
 #if 1
 template<typename T>						COInteger(T i=0):CppON(INTEGER_CPPON_OBJ_TYPE){unSigned=true;if(std::is_same<T,int8_t>::value||std::is_same<T,int16_t>::value||std::is_same<T,int32_t>::value||std::is_same<T,int64_t>::value){unSigned = false;}data=new(T);*((T*)data)=i;siz=sizeof(T);}
+template<typename T>						COInteger(T i, CppONArena &arena):CppON(INTEGER_CPPON_OBJ_TYPE){unSigned=true;if(std::is_same<T,int8_t>::value||std::is_same<T,int16_t>::value||std::is_same<T,int32_t>::value||std::is_same<T,int64_t>::value){unSigned = false;}data=arena.alloc(sizeof(T));inArena=true;*((T*)data)=i;siz=sizeof(T);}
 
 #else
 											COInteger( int8_t i ='\0' ) : CppON( INTEGER_CPPON_OBJ_TYPE ) { unSigned = false;data = new ( int8_t ); *((int8_t*) data ) = i; siz = sizeof( int8_t );}
@@ -381,7 +763,7 @@ template<typename T>						COInteger(T i=0):CppON(INTEGER_CPPON_OBJ_TYPE){unSigne
 			bool							operator != ( COInteger &newObj ) { return( ! ( *this == newObj ) );}
 											// cppcheck-suppress constParameter
 			bool							operator != ( COInteger *newObj ){ return( ! ( *this == *newObj ) );}
-template<typename T> T                      operator = (const T t ) { if( data ) delete( ( T* ) data ); data = new ( T ); *(( T *) data ) = t; siz = sizeof( T ); return t; }
+template<typename T> T                      operator = (const T t ) { touch(); deleteData(); data = new ( T ); *(( T *) data ) = t; siz = sizeof( T ); return t; }
 template<typename T> T						operator += ( const T t){ return ( T ) doOperation( sizeof( T ), (uint64_t) t, CPPON_ADD ); }
 template<typename T> T						operator -= ( const T t){ return ( T ) doOperation( sizeof( T ), (uint64_t) t, CPPON_SUBTRACT ); }
 template<typename T> T						operator *= ( const T t){ return ( T ) doOperation( sizeof( T ), (uint64_t) t, CPPON_MULTIPLY ); }
@@ -421,6 +803,7 @@ public:
 											CODouble( CODouble &dt );
 											CODouble( CODouble *dt = NULL );
 											CODouble( double d = 0.0 ) : CppON( DOUBLE_CPPON_OBJ_TYPE ) { precision=10; data = new (double); *((double*) data) = d; siz = sizeof(double);}
+											CODouble( double d, CppONArena &arena ) : CppON( DOUBLE_CPPON_OBJ_TYPE ) { precision=10; data = arena.alloc( sizeof( double ) ); inArena = true; *((double*) data) = d; siz = sizeof(double);}
 			unsigned char                	Precision() { return precision; }
 			unsigned char					Precision( unsigned char p ){ precision = p; return precision;}
 			bool							operator == ( CODouble &newObj ) { return(  *( (double *)newObj.data) == *( (double *) data) ); }
@@ -434,10 +817,10 @@ public:
 			CODouble						*operator = ( CODouble &val );
 											// cppcheck-suppress constParameter
 			CODouble						*operator = ( CODouble *val ) { return( *this = *val ); }
-			template<typename T> double     operator += ( T val ) { if( data ) { *( ( double *) data ) += (double) val; return *((double *) data );} return UD_DOUBLE; }
-			template<typename T> double     operator -= ( T val ) { if( data ) { *( ( double *) data ) -= (double) val; return *((double *) data );} return UD_DOUBLE; }
-			template<typename T> double     operator *= ( T val ) { if( data ) { *( ( double *) data ) *= (double) val; return *((double *) data );} return UD_DOUBLE; }
-			template<typename T> double     operator /= ( T val ) { if( data ) { *( ( double *) data ) /= (double) val; return *((double *) data );} return UD_DOUBLE; }
+			template<typename T> double     operator += ( T val ) { touch(); if( data ) { *( ( double *) data ) += (double) val; return *((double *) data );} return UD_DOUBLE; }
+			template<typename T> double     operator -= ( T val ) { touch(); if( data ) { *( ( double *) data ) -= (double) val; return *((double *) data );} return UD_DOUBLE; }
+			template<typename T> double     operator *= ( T val ) { touch(); if( data ) { *( ( double *) data ) *= (double) val; return *((double *) data );} return UD_DOUBLE; }
+			template<typename T> double     operator /= ( T val ) { touch(); if( data ) { *( ( double *) data ) /= (double) val; return *((double *) data );} return UD_DOUBLE; }
 //			double							operator += ( double val ) { if( data ) { *(( double *) data ) += val; return *((double *) data);} return UD_DOUBLE;}
 //			double							operator -= ( double val ) { if( data ) { *(( double *) data ) -= val; return *((double *) data);} return UD_DOUBLE;}
 //			double							operator *= ( double val ) { if( data ) { *(( double *) data ) *= val; return *((double *) data);} return UD_DOUBLE;}
@@ -446,7 +829,7 @@ public:
 			int								size() override { return ( data ) ? siz : 0; }
 			double							value(){ return ( data ) ? *( double *) data : 0.0; }
 			double							doubleValue() { return ( data ) ? *( double *) data : 0.0; }
-			void							set( const double &d ){ *((double*) data) = d; }
+			void							set( const double &d ){ touch(); *((double*) data) = d; }
 			float							floatValue(){ if( data ) return ( float ) *( ( double *) data ); return 0.0; }
 			std::string						*toNetString();                      // convert to net string format
 			std::string						*toJsonString();                     // convert to json string format
@@ -485,6 +868,7 @@ public:
 											COBoolean( COBoolean &bt ): CppON( BOOLEAN_CPPON_OBJ_TYPE ){ if( !data ) { data = new( bool ); } *( ( bool *) data) = bt.value(); siz = sizeof( bool ); }
 											COBoolean( COBoolean *bt = NULL ): CppON( BOOLEAN_CPPON_OBJ_TYPE ){ if( !data ) { data = new( bool ); } *( ( bool *) data) = bt->value(); siz = sizeof( bool ); }
 											COBoolean( bool v = false ) : CppON( BOOLEAN_CPPON_OBJ_TYPE ){ if( !data ) { data = new( bool ); } *( ( bool *) data) = v; siz = sizeof( bool ); }
+											COBoolean( bool v, CppONArena &arena ) : CppON( BOOLEAN_CPPON_OBJ_TYPE ){ data = arena.alloc( sizeof( bool ) ); inArena = true; *( ( bool *) data) = v; siz = sizeof( bool ); }
 			int								size() override { return ( data ) ? sizeof( bool ) : 0; }
 			bool							value(){ return ( ( data ) ? ( ( *( ( bool *) data ) ) ? true : false ) : false ); }
 			std::string						*toNetString();                      // convert to net string format
@@ -499,9 +883,9 @@ public:
 			bool							operator != ( COBoolean &newObj ) { return ( ! ( *this == newObj ) );}
 											// cppcheck-suppress constParameter
 			bool							operator != ( COBoolean *newObj ) { return ( ! ( *this == *newObj ) );}
-			bool							operator = ( bool val ) { *( ( bool *) data) = val; return val; }
-			COBoolean						*operator = ( COBoolean &val) { *( ( bool *) data) = val.value(); return this; }
-			COBoolean						*operator = ( COBoolean *val) { *( ( bool *) data) = val->value(); return this; }
+			bool							operator = ( bool val ) { touch(); *( ( bool *) data) = val; return val; }
+			COBoolean						*operator = ( COBoolean &val) { touch(); *( ( bool *) data) = val.value(); return this; }
+			COBoolean						*operator = ( COBoolean *val) { touch(); *( ( bool *) data) = val->value(); return this; }
 };
 
 
@@ -509,20 +893,24 @@ class COString : public CppON
 {
 public:
 											COString( COString &st );
+											COString( COString &&st ) : CppON( STRING_CPPON_OBJ_TYPE ) { take( st ); }
 											COString( COString *st = NULL );
 											COString( const char *st = "", bool base64 = false );
 											COString( std::string st, bool base64 );
 											COString( std::string st = std::string("") );
 											COString( uint64_t val, bool hex = true );
 											COString( uint32_t val, bool hex = true );
+											COString( const char *st, size_t len, CppONArena &arena ) : CppON( STRING_CPPON_OBJ_TYPE ){ data = new( arena.alloc( sizeof( std::string ) ) ) std::string( st, len ); inArena = true; }
 	static	char							*base64Decode( const char *tmp, unsigned int sz, unsigned int &len, char *out = NULL );
-			COString						*append( std::string &val ) { if( data ) ( ( std::string *) data)->append( val ); else data = new std::string( val );  return this; }
-			COString						*append( const char *val ) { if( data ) ( ( std::string *) data)->append( val ); else data = new std::string( val );  return this; }
-			COString						*operator += ( const char *val ) { if( data ) ((std::string *) data)->append( val ); else data = new std::string( val );  return this; }
-			COString						*operator += ( std::string &val ) { if( data ) ((std::string *) data)->append( val ); else data = new std::string( val ); return this; }
-			COString						*operator = ( const char *val ) { if( data ) delete((std::string*) data ); data = new std::string( val ); return this; }
-			COString						*operator = ( std::string &val) { if( data ) delete((std::string*) data ); data = new std::string( val.c_str() ); return this; }
-			COString						*operator = ( COString &val) { if( data ) delete((std::string*) data ); data = new std::string( val.c_str() ); return this; }
+			COString						*append( std::string &val ) { touch(); if( data ) ( ( std::string *) data)->append( val ); else data = new std::string( val );  return this; }
+			COString						*append( const char *val ) { touch(); if( data ) ( ( std::string *) data)->append( val ); else data = new std::string( val );  return this; }
+			COString						*operator += ( const char *val ) { touch(); if( data ) ((std::string *) data)->append( val ); else data = new std::string( val );  return this; }
+			COString						*operator += ( std::string &val ) { touch(); if( data ) ((std::string *) data)->append( val ); else data = new std::string( val ); return this; }
+			COString						*operator = ( const char *val ) { touch(); std::string *s = new std::string( val ); deleteData(); data = s; return this; }
+			COString						*operator = ( std::string &val) { touch(); std::string *s = new std::string( val.c_str() ); deleteData(); data = s; return this; }
+			COString						*operator = ( std::string &&val) { touch(); std::string *s = new std::string( std::move( val ) ); deleteData(); data = s; return this; }
+			COString						*operator = ( COString &val) { touch(); std::string *s = new std::string( val.c_str() ); deleteData(); data = s; return this; }
+			COString						*operator = ( COString &&val) { touch(); if( this != &val ) { deleteData(); take( val ); } return this; }
 											// cppcheck-suppress constParameter
 			COString						*operator = ( COString *val) { return( *this = *val ); }
 			COString						*operator = ( uint64_t val );
@@ -549,24 +937,124 @@ static		std::string						*toBase64JsonString( const char *cPtr, unsigned int len
 };
 
 
+/*
+ * COMapData is the storage behind a COMap.  The members are kept in one vector of key/value pairs in the order they were
+ * added so iteration, serialization and appends are a straight linear walk and each key is stored only once.  Small maps
+ * are searched by scanning the vector, once a map holds COMAP_INDEX_THRESHOLD members an open addressed hash index of
+ * vector positions is built and maintained as members are appended and erased.  An erase moves the members after it down
+ * the vector and their positions in the index with it, the table itself is never rebuilt for it.
+ *
+ * The interface follows the std::map that used to back COMap (begin, end, find, insert, erase, operator[] ...) so code
+ * that walked value() or begin()/end() keeps compiling.  The difference is that iteration is in insertion order and
+ * erase() invalidates iterators past the erased member.
+ */
+#define COMAP_INDEX_THRESHOLD		16
+#define COMAP_DIFF_BLOCK			64												// Fewest top level members worth a thread in COMap::diff()
+
+class COMapData
+{
+public:
+	typedef std::pair<std::string, CppON *>				value_type;
+	typedef std::vector<value_type>::iterator			iterator;
+	typedef std::vector<value_type>::const_iterator		const_iterator;
+
+											COMapData() {}
+											COMapData( const COMapData &m ) : items( m.items ), index( m.index ) {}
+			COMapData						&operator = ( const COMapData &m ) { items = m.items; index = m.index; return *this; }
+
+			iterator						begin() { return items.begin(); }
+			iterator						end() { return items.end(); }
+			const_iterator					begin() const { return items.begin(); }
+			const_iterator					end() const { return items.end(); }
+			size_t							size() const { return items.size(); }
+			bool							empty() const { return items.empty(); }
+			void							reserve( size_t n ) { items.reserve( n ); }
+			iterator						find( const char *key, size_t len );
+			iterator						find( const char *key ) { return find( key, strlen( key ) ); }
+			iterator						find( const std::string &key ) { return find( key.data(), key.size() ); }
+			size_t							count( const std::string &key ) { return ( end() != find( key ) ) ? 1 : 0; }
+			std::pair<iterator, bool>		insert( const value_type &v );
+			iterator						insert( iterator, const value_type &v ) { return insert( v ).first; }
+			CppON							*&operator[]( const std::string &key );
+			void							push( const std::string &key, CppON *val );	// append a key that is known not to be present
+			void							push( std::string &&key, CppON *val );
+			iterator						erase( iterator it );
+			size_t							erase( const std::string &key );
+			void							clear() { items.clear(); index.clear(); }
+			void							swap( COMapData &m ) { items.swap( m.items ); index.swap( m.index ); }
+private:
+	static	size_t							hash( const char *key, size_t len );
+			void							addIndex( size_t pos );
+			void							dropIndex( size_t pos );
+			void							rebuildIndex();
+
+			std::vector<value_type>			items;											// members in insertion order
+			std::vector<uint32_t>			index;											// position + 1 of each member, 0 is an empty slot
+};
+
+/*
+ * A findElement() path compiled once into its steps so it can be resolved over and over without being split, copied or
+ * converted again.  "config/axisEncoders:2/resolution" becomes the key "config", the key "axisEncoders", the index 2 and
+ * the key "resolution", and COMap::findElement( const CppONPath & ) walks these exactly the way findElement( const char * )
+ * walks the string.
+ *
+ * A path built with cache set remembers the node it last resolved to, the root it was resolved from and how many times
+ * each container it passed through had changed.  The node is handed back directly while none of those containers has
+ * lost or replaced a member since, which takes one load per step instead of a lookup.  Misses are not cached.  Changes
+ * made behind the library's back through value() are not seen, and a root that is deleted while another map is built at
+ * the same address looks unchanged, so invalidate() a path whose root went away.  The cache is not locked: a caching
+ * path belongs to one thread, other threads build their own.
+ */
+class CppONPath
+{
+public:
+	struct Step
+	{
+			std::string						key;											// member name, unused for an index
+			int								index;											// array index or -1 for a key
+	mutable	CppON							*from;											// The container this step was last taken in
+	mutable	uint32_t						edits;											// and its changed() count then
+	};
+	explicit								CppONPath( const char *path, bool cache = false );
+	explicit								CppONPath( const std::string &path, bool cache = false ) : CppONPath( path.c_str(), cache ) {}
+			const std::string				&str() const { return path; }
+			const std::vector<Step>			&getSteps() const { return steps; }
+			void							invalidate() const { cacheRoot = NULL; cacheNode = NULL; }
+private:
+			bool							fresh() const;
+	friend	class							COMap;
+			std::string						path;
+			std::vector<Step>				steps;
+			bool							cache;
+	mutable	CppON							*cacheRoot;
+	mutable	CppON							*cacheNode;
+	mutable	size_t							cacheSteps;										// steps the cached walk took
+};
+
 class COMap : public CppON
 {
 public:
 											COMap( COMap &mt );
+											COMap( COMap &&mt ) : CppON( MAP_CPPON_OBJ_TYPE ) { take( mt ); }
 											// cppcheck-suppress noExplicitConstructor
 											COMap( COMap *mt );
 											// cppcheck-suppress noExplicitConstructor
 											COMap( const char *str );
 											COMap( const char *path, const char *file );
-											COMap( ) : CppON(  MAP_CPPON_OBJ_TYPE ) { data = new std::map<std::string, CppON*>(); }
 											// cppcheck-suppress noExplicitConstructor
-											COMap( std::map < std::string, CppON *> &m ) : CppON( MAP_CPPON_OBJ_TYPE ){ data = new std::map<std::string, CppON *>( m ); }
-			int								size() override { return ( data ) ? ((std::map< std::string, CppON*> *) data)->size() : 0; }
+											COMap( CppONArena &arena ) : CppON( MAP_CPPON_OBJ_TYPE ){ data = new( arena.alloc( sizeof( COMapData ) ) ) COMapData(); inArena = true; }
+											COMap( ) : CppON(  MAP_CPPON_OBJ_TYPE ) { data = new COMapData(); }
+											// cppcheck-suppress noExplicitConstructor
+											COMap( std::map < std::string, CppON *> &m );
+			int								size() override { COMapData *m = (COMapData *) peek(); return ( m ) ? m->size() : 0; }
+			void							reserve( size_t n ) { unshare(); if( data ) { ( (COMapData *) data )->reserve( n ); } }
 
-std::map<std::string,CppON*>::iterator		begin() { return ((std::map< std::string, CppON*> *) data)->begin(); }
-std::map<std::string,CppON*>::iterator		end() { return ((std::map< std::string, CppON*> *) data)->end(); }
+	typedef	COMapData::iterator				iterator;
+			iterator						begin() { expose(); return ((COMapData *) data)->begin(); }
+			iterator						end() { expose(); return ((COMapData *) data)->end(); }
 			COMap							*operator = ( const char *str);
 			COMap							*operator = ( COMap &val );
+			COMap							*operator = ( COMap &&val ) { touch(); if( this != &val ) { deleteData(); take( val ); } return this; }
 											// cppcheck-suppress constParameter
 			COMap							*operator = ( COMap *val ){ return( *this = *val ); }
 			bool							operator == ( COMap &val );
@@ -576,24 +1064,26 @@ std::map<std::string,CppON*>::iterator		end() { return ((std::map< std::string,
 			bool							operator != ( COMap &val ){ return ( ! (*this == val ) );}
 											// cppcheck-suppress constParameter
 			bool							operator != ( COMap *val ){ return ( ! (*this == *val ) );}
-			std::vector<std::string>		*getKeys() { return &order; }
+			std::vector<std::string>		*getKeys();
 			std::vector<CppON *>			*getValues();
-			std::map< std::string, CppON*>	*value() { return ( data ) ? ( std::map < std::string, CppON *> *) data : NULL; }
+			COMapData						*value() { expose(); touch(); return ( data ) ? ( COMapData *) data : NULL; }	// Drops the hash, the caller may change it
 			std::string						*toNetString();
 			CppON							*extract( const char *name );
-			int								append( std::string key, CppON *n );
-			int								append( std::string key, std::string value ){ return append( key, new COString( value ) ); }
-			int								append( std::string key, const char *value){ return append( key, new COString( value ) ); }
-			int								append( std::string key, double value ){ return append( key, new CODouble( value ) ); }
-			int								append( std::string key, int64_t value ){ return append( key, new COInteger( value ) );}
-			int								append( std::string key, int value ){ return append( key, new COInteger( value ) ); }
-			int								append( std::string key, bool value ){ return append( key, new COBoolean( value ) ); }
-			int								append( std::string key ){ return append( key, new CONull() ); }
-			void							removeVal( std::string val );
-			void							replaceObj( std::string s, CppON *obj );
+			int								append( std::string key, CppON *n );			// Keys and strings passed by value are moved in, pass rvalues to skip the copy
+			int								append( std::string key, std::string value ){ return append( std::move( key ), new COString( std::move( value ) ) ); }
+			int								append( std::string key, const char *value){ return append( std::move( key ), new COString( value ) ); }
+			int								append( std::string key, double value ){ return append( std::move( key ), new CODouble( value ) ); }
+			int								append( std::string key, int64_t value ){ return append( std::move( key ), new COInteger( value ) );}
+			int								append( std::string key, int value ){ return append( std::move( key ), new COInteger( value ) ); }
+			int								append( std::string key, bool value ){ return append( std::move( key ), new COBoolean( value ) ); }
+			int								append( std::string key ){ return append( std::move( key ), new CONull() ); }
+template<typename T, typename... A>	T		*emplace( std::string key, A&&... args ){ T *n = new T( std::forward<A>( args )... ); if( 0 > append( std::move( key ), n ) ) { delete n; n = NULL; } return n; }	// Build the member in place
+			void							removeVal( const std::string &val );
+			void							replaceObj( const std::string &s, CppON *obj );
 			void							clear();
 			CppON							*findEqual( const char *name, CppON &search );
 			CppON							*findElement( const char *str );
+			CppON							*findElement( const CppONPath &path );
 			CppON							*findNoSplit( const char *str );
 			CppON							*findElement( const std::string &str ) { return findElement( str.c_str() ); }
 			CppON							*findElement( const std::string *str ) { return findElement( str->c_str() ); }
@@ -611,10 +1101,14 @@ std::map<std::string,CppON*>::iterator		end() { return ((std::map< std::string,
 			void							dump( FILE *fp = stderr )  override { std::string indent(""); dump( indent, fp ); fprintf( fp, "\n" );}
 			void							cdump( FILE *fp = stderr ) override ;
 			COMap							*diff( COMap &newObj, const char *name = NULL);
+			COMap							*diff( COMap &newObj, const char *name, unsigned threads );	// Top level members split over threads, 0 for one per core
 			void							upDate( COMap *map, const char *name );
 			void							merge( COMap *map, const char *name );
 private:
-			void							doParse( const char *str );
+	friend	class							CppONParser;
+	friend	class							CppONStreamParser;
+			int								put( std::string key, CppON *n, bool taken );	// append(), taken says whether the caller keeps n
+			void							doParse( const char *str, size_t len );
 			void							parseData( const char *str );
 };
 
@@ -622,6 +1116,7 @@ class COArray : public CppON
 {
 public:
 											COArray( COArray &at );
+											COArray( COArray &&at ) : CppON( ARRAY_CPPON_OBJ_TYPE ) { take( at ); }
 											// cppcheck-suppress noExplicitConstructor
 											COArray( COArray *at );
 											// cppcheck-suppress noExplicitConstructor
@@ -632,13 +1127,16 @@ public:
 											COArray( ) : CppON( ARRAY_CPPON_OBJ_TYPE ) { data = new std::vector<CppON *>(); }
 											// cppcheck-suppress noExplicitConstructor
 											COArray( std::vector<CppON *> &v ) : CppON( ARRAY_CPPON_OBJ_TYPE ){ data = new std::vector<CppON *>( v ); }
-			int								size() override { return ( data ) ? (( std::vector<CppON *> *) data)->size() : 0; }
-			std::vector< CppON *>			*value() { return ( data ) ? ( std::vector< CppON *> *) data : NULL; }
-			std::vector< CppON* >::iterator	begin() { return ((std::vector< CppON*> *) data)->begin(); }
-			std::vector< CppON* >::iterator	end() { return ((std::vector< CppON*> *) data)->end(); }
+											// cppcheck-suppress noExplicitConstructor
+											COArray( CppONArena &arena ) : CppON( ARRAY_CPPON_OBJ_TYPE ){ data = new( arena.alloc( sizeof( std::vector<CppON *> ) ) ) std::vector<CppON *>(); inArena = true; }
+			int								size() override { std::vector<CppON *> *v = (std::vector<CppON *> *) peek(); return ( v ) ? v->size() : 0; }
+			void							reserve( size_t n ) { unshare(); if( data ) { ( (std::vector<CppON *> *) data )->reserve( n ); } }
+			std::vector< CppON *>			*value() { expose(); touch(); return ( data ) ? ( std::vector< CppON *> *) data : NULL; }	// Drops the hash, the caller may change it
+			std::vector< CppON* >::iterator	begin() { expose(); return ((std::vector< CppON*> *) data)->begin(); }
+			std::vector< CppON* >::iterator	end() { expose(); return ((std::vector< CppON*> *) data)->end(); }
 
 			std::string						*toNetString();
-			bool							replace( size_t i, CppON *n){ std::vector<CppON *> *v = (std::vector< CppON *> *) data; if( v->size() > i ) { delete( (*v)[ i ] ); (*v)[ i ] = n; return true;} return false; }
+			bool							replace( size_t i, CppON *n){ expose(); std::vector<CppON *> *v = (std::vector< CppON *> *) data; if( v->size() > i ) { touch(); delete( (*v)[ i ] ); (*v)[ i ] = n; changed(); return true;} return false; }
 			bool							operator == ( COArray &val );
 											// cppcheck-suppress constParameter
 			bool							operator == ( COArray *val ){ return( *this == *val ); }
@@ -647,22 +1145,25 @@ public:
 											// cppcheck-suppress constParameter
 			bool							operator != ( COArray *val ){ return( ! (*this == *val ) ); }
 			COArray							*operator = ( COArray &val );
+			COArray							*operator = ( COArray &&val ) { touch(); if( this != &val ) { deleteData(); take( val ); } return this; }
 											// cppcheck-suppress constParameter
 			COArray							*operator = ( COArray *val ){ return( *this = *val ); }
 			CppON							*remove( size_t idx );
-			void							append( CppON *n ) { ( (std::vector < CppON *> *) data)->push_back( n ); }
-			void							append( std::string value ){ append( new COString( value ) ); }
+			void							append( CppON *n ) { touch(); expose(); ( (std::vector < CppON *> *) data)->push_back( n ); }
+			void							append( std::string value ){ append( new COString( std::move( value ) ) ); }
 			void							append( double value ){ append( new CODouble( value ) ); }
 			void							append( int64_t value ){ append( new COInteger( value ) ); }
 			void							append( int value ){ append( new COInteger( value ) ); }
 			void							append( bool value ) { append( new COBoolean( value ) ); }
-			void							push_back( CppON *n ){ ( (std::vector < CppON *> *) data)->push_back( n ); }
+			void							push_back( CppON *n ){ append( n ); }
+template<typename T, typename... A>	T		*emplace( A&&... args ){ T *n = new T( std::forward<A>( args )... ); append( n ); return n; }	// Build the element in place
 			CppON							*pop( ){ return remove( size() - 1 ); }
 			CppON							*pop_front(){ return remove( 0 ); }
 			void							push( CppON *n) { append( n ); }
 			void							clear();
 			CppON							*at( unsigned int i )
 											{
+												expose();
 												if( ! data || ((std::vector < CppON *> *) data)->size() <= i )
 												{
 													return NULL;
@@ -679,7 +1180,31 @@ public:
 			void						cdump( FILE *fp = stderr ) override ;
 			COArray						*diff( COArray &newObj, const char *name = NULL);
 private:
+	friend	class						CppONParser;
+	friend	class						CppONStreamParser;
+	friend	class						COMap;
+			void						put( CppON *n ) { touch(); unshare(); ( (std::vector < CppON *> *) data)->push_back( n ); }	// append() of a node only the library holds
 			void						parseData( const char *str );
+			void						parseData( const char *str, size_t len );
+};
+
+/*
+ * A node whose own memory belongs to a CppONArena.  Deleting it (directly or through its parent) runs the destructors as
+ * usual but hands the node itself back to nobody, the blocks are released by the arena.
+ */
+template<typename T>
+class CppONArenaNode : public T
+{
+public:
+											using T::T;
+	static	void							*operator new( size_t sz, CppONArena &arena ) { return arena.alloc( sz ); }
+	static	void							operator delete( void *p ) {}
+	static	void							operator delete( void *p, CppONArena &arena ) {}
 };
 
+template<typename T, typename... A> T *CppONArena::make( A&&... args )
+{
+	return new( *this ) CppONArenaNode<T>( std::forward<A>( args )... );
+}
+
 #endif /* CPPON_HPP_ */
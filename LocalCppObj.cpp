@@ -62,56 +62,26 @@ void LocalCppObj::update( LOCAL_CPP_OBJ *objIn )
 	}
 	STRUCT_LISTS	*fromObj = objIn->obj;
 
+	if( unchanged( objIn ) )
+	{
+		return;
+	}
 	switch ( fromObj->type )
 	{
 		case SL_TYPE_DOUBLE:
-			{
-				shared->waitSem( fromObj->sem );
-				*((double*)(objIn->localObj ) ) = *(double*)(shared->pointer( fromObj ) );
-				sem_post( fromObj->sem );
-			}
-			break;
 		case SL_TYPE_INT64:
-			{
-				shared->waitSem( fromObj->sem );
-				*((int64_t*)(objIn->localObj ) ) =  *(int64_t*)(shared->pointer( fromObj ) );
-				sem_post( fromObj->sem );
-			}
-			break;
 		case SL_TYPE_INT32:
-			{
-				shared->waitSem( fromObj->sem );
-				*((int32_t*)(objIn->localObj ) ) = *(int32_t*)(shared->pointer( fromObj ) );
-				sem_post( fromObj->sem );
-			}
-			break;
 		case SL_TYPE_INT16:
-			{
-				shared->waitSem( fromObj->sem );
-				*((uint16_t*)(objIn->localObj ) ) = *(uint16_t*)(shared->pointer( fromObj ) );
-				sem_post( fromObj->sem );
-			}
-			break;
 		case SL_TYPE_INT8:
-			{
-				shared->waitSem( fromObj->sem );
-				*((uint8_t*)(objIn->localObj ) ) = *(uint8_t*)(shared->pointer( fromObj ) );
-				sem_post( fromObj->sem );
-			}
-			break;
 		case SL_TYPE_BOOL:
-			{
-				shared->waitSem( fromObj->sem );
-				*((uint8_t*)(objIn->localObj ) ) = *(uint8_t*)(shared->pointer( fromObj ) );
-				sem_post( fromObj->sem );
-			}
-			break;
 		case SL_TYPE_CHAR:
 			{
-				shared->waitSem( fromObj->sem );
-				strncpy( ((char *)(objIn->localObj ) ), (const char *)(shared->pointer( fromObj ) ),  fromObj->size );
-				sem_post( fromObj->sem );
-			}
+				uint32_t v = shared->version( fromObj );
+				if( shared->readField( fromObj, objIn->localObj ) )
+				{
+					seen( objIn, v );
+				}
+			}												// Lock free when the value is small enough
 			break;
 		case SL_TYPE_UNIT:
 			{
@@ -146,7 +116,37 @@ bool LocalCppObj::checkChanges( const char *path, CppON *rst, LOCAL_CPP_OBJ *obj
 }
 
 /*
- * Find changes in the data and report them in a COMap
+ * True if nothing in lObj has been written since our copy of it was brought up to date.  The segment keeps a version for
+ * every value and we keep a copy of the versions as of the last time we looked, so a whole unit is checked with one memcmp
+ * over its (contiguous) versions without taking any locks.
+ */
+bool LocalCppObj::unchanged( LOCAL_CPP_OBJ *lObj )
+{
+	uint32_t	offset;
+	uint32_t	bytes;
+
+	if( shared->versionRange( lObj->obj, offset, bytes ) )
+	{
+		return( 0 == memcmp( (char *) basePtr + offset, (char *) shared->getBasePtr() + offset, bytes ) );
+	}
+	return false;
+}
+
+/*
+ * Remember the version our copy of a value is up to date with.  Callers take the version before they read the value so if a
+ * writer gets in between we just look at it again next time.
+ */
+void LocalCppObj::seen( LOCAL_CPP_OBJ *lObj, uint32_t v )
+{
+	uint32_t	*local = shared->versionPointer( lObj->obj, basePtr );
+	if( local )
+	{
+		*local = v;
+	}
+}
+
+/*
+ * Find changes in the data and report them in a COMap.  Units and values that haven't been written since the last call are skipped without being read.
  */
 bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 {
@@ -158,17 +158,20 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 		objIn = root;
 	}
 
-	if( ( isMap  = CppON::isMap( rtn ) ) || CppON::isArray( rtn )  )
+	if( ( ( isMap  = CppON::isMap( rtn ) ) || CppON::isArray( rtn ) ) && ! unchanged( objIn ) )
 	{
 		STRUCT_LISTS	*fromObj = objIn->obj;
+		uint32_t		version = shared->version( fromObj );
 		switch ( fromObj->type )
 		{
 			case SL_TYPE_DOUBLE:
 				{
 					double hyst = ((double) objIn->hysteresis) / 100.0;
-					shared->waitSem( fromObj->sem );
-					double dShare = *(double*)(shared->pointer( fromObj ) );
-					sem_post( fromObj->sem );
+					double dShare;
+					if( ! shared->readField( fromObj, &dShare ) )
+					{
+						break;
+					}
 					double dSave = *((double*)(objIn->localObj ) );
 					if( dShare > ( dSave + hyst) || dShare < (dSave - hyst ) )
 					{
@@ -185,9 +188,11 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 			case SL_TYPE_INT64:
 				{
 					int64_t hyst = (int64_t)( objIn->hysteresis );
-					shared->waitSem( fromObj->sem );
-					int64_t iShare = *(int64_t*)(shared->pointer( fromObj ) );
-					sem_post( fromObj->sem );
+					int64_t iShare;
+					if( ! shared->readField( fromObj, &iShare ) )
+					{
+						break;
+					}
 					int64_t iSave = *((int64_t*)(objIn->localObj ) );
 					if( iShare > ( iSave + hyst) || iShare < (iSave - hyst ) )
 					{
@@ -204,9 +209,11 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 			case SL_TYPE_INT32:
 				{
 					int32_t hyst =  objIn->hysteresis;
-					shared->waitSem( fromObj->sem );
-					int32_t iShare = *(int32_t*)(shared->pointer( fromObj ) );
-					sem_post( fromObj->sem );
+					int32_t iShare;
+					if( ! shared->readField( fromObj, &iShare ) )
+					{
+						break;
+					}
 					int32_t iSave = *((int32_t*)(objIn->localObj ) );
 					if( iShare > ( iSave + hyst) || iShare < (iSave - hyst ) )
 					{
@@ -223,9 +230,12 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 			case SL_TYPE_INT16:
 				{
 					int32_t hyst =  objIn->hysteresis;
-					shared->waitSem( fromObj->sem );
-					int32_t iShare = (int32_t) *(uint16_t*)(shared->pointer( fromObj ) );
-					sem_post( fromObj->sem );
+					uint16_t raw;
+					if( ! shared->readField( fromObj, &raw ) )
+					{
+						break;
+					}
+					int32_t iShare = (int32_t) raw;
 					int32_t iSave = (int32_t) *((uint16_t*)(objIn->localObj ) );
 					if( iShare > ( iSave + hyst) || iShare < (iSave - hyst ) )
 					{
@@ -242,9 +252,12 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 			case SL_TYPE_INT8:
 				{
 					int32_t hyst =  objIn->hysteresis;
-					shared->waitSem( fromObj->sem );
-					int32_t iShare = (int32_t) *(uint8_t*)(shared->pointer( fromObj ) );
-					sem_post( fromObj->sem );
+					uint8_t raw;
+					if( ! shared->readField( fromObj, &raw ) )
+					{
+						break;
+					}
+					int32_t iShare = (int32_t) raw;
 					int32_t iSave = (int32_t) *((uint8_t*)(objIn->localObj ) );
 					if( iShare > ( iSave + hyst) || iShare < (iSave - hyst ) )
 					{
@@ -260,9 +273,12 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 				break;
 			case SL_TYPE_BOOL:
 				{
-					shared->waitSem( fromObj->sem );
-					int32_t iShare = (int32_t) *(uint8_t*)(shared->pointer( fromObj ) );
-					sem_post( fromObj->sem );
+					uint8_t raw;
+					if( ! shared->readField( fromObj, &raw ) )
+					{
+						break;
+					}
+					int32_t iShare = (int32_t) raw;
 					int32_t iSave = (int32_t) *((uint8_t*)(objIn->localObj ) );
 					if( iSave != iShare )
 					{
@@ -278,21 +294,24 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 				break;
 			case SL_TYPE_CHAR:
 				{
-					shared->waitSem( fromObj->sem );
-					const char *sShare = (const char *)(shared->pointer( fromObj ) );
+					std::string sShare( fromObj->size, '\0' );
+					if( ! fromObj->size || ! shared->readField( fromObj, &sShare[ 0 ] ) )
+					{
+						break;
+					}
+					sShare[ fromObj->size - 1 ] = '\0';
 					char *iSave = ((char *)(objIn->localObj ) );
-					if( strncmp( sShare, iSave, fromObj->size ) )
+					if( strncmp( sShare.c_str(), iSave, fromObj->size ) )
 					{
 						changes = true;
-						strncpy(  iSave, sShare, fromObj->size );
+						strncpy(  iSave, sShare.c_str(), fromObj->size );
 						if( isMap )
 						{
-							((COMap * )rtn )->append( fromObj->name.c_str(), new COString( sShare ) );
+							((COMap * )rtn )->append( fromObj->name.c_str(), new COString( sShare.c_str() ) );
 						} else {
-							((COArray * )rtn )->append(  new COString( sShare ) );
+							((COArray * )rtn )->append(  new COString( sShare.c_str() ) );
 						}
 					}
-					sem_post( fromObj->sem );
 				}
 				break;
 			case SL_TYPE_UNIT:
@@ -340,6 +359,13 @@ bool LocalCppObj::checkChanges( CppON *rtn, LOCAL_CPP_OBJ *objIn )
 			default:
 				break;
 		}
+		/*
+		 * A value that moved less than its hysteresis isn't copied so it has to be looked at again until it is.
+		 */
+		if( SL_TYPE_UNIT != fromObj->type && SL_TYPE_ARRAY != fromObj->type && ! memcmp( objIn->localObj, shared->pointer( fromObj ), fromObj->size ) )
+		{
+			seen( objIn, version );
+		}
 	}
 	return changes;
 }
@@ -362,9 +388,22 @@ LocalCppObj::LocalCppObj( SCppObj  *parent )
 
 			basePtr = ::operator new( sz );
 			/*
-			 * Copy the data
+			 * Copy the data.  The versions are copied first so a value written while we copy is seen as changed next time.
 			 */
+			uint32_t	vOffset;
+			uint32_t	vBytes;
+			bool		versions = parent->versionRange( parent->GetBase(), vOffset, vBytes );
+			char		*vCopy = ( versions ) ? new char[ vBytes + 1 ] : NULL;
+			if( versions )
+			{
+				memcpy( vCopy, (char *) parent->getBasePtr() + vOffset, vBytes );
+			}
 			memcpy( basePtr, parent->getBasePtr(), sz );
+			if( versions )
+			{
+				memcpy( (char *) basePtr + vOffset, vCopy, vBytes );
+				delete[] vCopy;
+			}
 
 			/*
 			 *  Recursively Build the device tree
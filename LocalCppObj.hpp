@@ -42,6 +42,8 @@ public:
 	SCppObj			*parent( void ) { return shared; }
 
 private:
+	bool			unchanged( LOCAL_CPP_OBJ *lObj );
+	void			seen( LOCAL_CPP_OBJ *lObj, uint32_t v );
 	void			deleteSub( LOCAL_CPP_OBJ &lObj );
 	void 			addSub( LOCAL_CPP_OBJ *lObj, STRUCT_LISTS &target );
 	void			*basePtr;
@@ -175,7 +175,9 @@
 #include <sys/types.h>
 #include <pwd.h>
 #include <sys/stat.h>
-#include <dirent.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 
 #include "CppON.hpp"
@@ -192,6 +194,85 @@ const char *JCOB_TYPES[] = { "float", "int", "bool", "string", "unit", "array" }
 #define SCppObj_UNIT "unit"
 #define SCppObj_ARRAY "array"
 
+/*
+ * The unit sequence words double as futexes so waiters sleep in the kernel instead of polling.  They live in the shared
+ * segment so these are the process shared (not private) forms.
+ */
+static void futexWait( uint32_t *addr, uint32_t val, uint64_t ns )
+{
+	struct timespec ts;
+	ts.tv_sec = (time_t) ( ns / 1000000000LL );
+	ts.tv_nsec = (long) ( ns % 1000000000LL );
+	syscall( SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0 );
+}
+
+static void futexWake( uint32_t *addr )
+{
+	syscall( SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0 );
+}
+
+static uint64_t fnv64( uint64_t h, const void *p, size_t n )
+{
+	for( const uint8_t *c = (const uint8_t *) p; n--; c++ )
+	{
+		h = ( h ^ *c ) * 0x100000001B3ULL;
+	}
+	return h;
+}
+
+static uint64_t monotonicNs( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( (uint64_t) ts.tv_sec ) * 1000000000LL + (uint64_t) ts.tv_nsec;
+}
+
+/*
+ * getpid() is a system call on every write otherwise, so it is kept and forgotten in the child after a fork.
+ */
+static pid_t			writerPid = 0;
+static pthread_once_t	writerPidOnce = PTHREAD_ONCE_INIT;
+
+static void forgetWriterPid( void )
+{
+	writerPid = 0;
+}
+
+static void watchForks( void )
+{
+	pthread_atfork( NULL, NULL, forgetWriterPid );
+}
+
+static uint32_t selfPid( void )
+{
+	if( ! writerPid )
+	{
+		pthread_once( &writerPidOnce, watchForks );
+		writerPid = getpid();
+	}
+	return (uint32_t) writerPid;
+}
+
+/*
+ * Counters in a lock that only its holder changes are bumped without a locked instruction.
+ */
+static inline void bumpHeld( uint64_t *counter )
+{
+	__atomic_store_n( counter, __atomic_load_n( counter, __ATOMIC_RELAXED ) + 1, __ATOMIC_RELAXED );
+}
+
+/*
+ * Add a wait that started at start to the lock's totals and its maximum
+ */
+static void noteWait( SCPP_LOCK *lock, uint64_t start )
+{
+	uint64_t	ns = monotonicNs() - start;
+	uint64_t	max = __atomic_load_n( &lock->maxWaitNs, __ATOMIC_RELAXED );
+
+	__atomic_fetch_add( &lock->waitNs, ns, __ATOMIC_RELAXED );
+	while( ns > max && ! __atomic_compare_exchange_n( &lock->maxWaitNs, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) );
+}
+
 /*******************************************************************************************/
 /*                                                                                         */
 /*                                 SCppObj                                                   */
@@ -215,14 +296,32 @@ void SCppObj::initializeObject( const char *segmentName, bool *initialized )
     charOffset = 0;
     sharedMemoryAllocated = false;
 
+	/*
+	 * If the segment is already set up from the same description just use the layout its creator left in it.
+	 */
+	try
+	{
+		if( segmentName && attachLayout( segmentName, initialized ) )
+		{
+			return;
+		}
+	} catch( std::invalid_argument & ) {
+		delete config;
+		config = NULL;
+		throw;
+	}
+
 	list = new STRUCT_LISTS;
 
+	CppON *lPtr = config->findCaseElement( "layout" );
+	alignedLayout = ( CppON::isString( lPtr ) && ! strcasecmp( ( (COString *) lPtr )->c_str(), "aligned" ) );
+
 	std::string ident("\t" );
 
 	/*
 	 * Figure out how many units the base has in it then use that to allocate the structure
 	 */
-	for( std::map<std::string, CppON *>::iterator it = config->begin(); config->end() != it; it++ )
+	for( COMap::iterator it = config->begin(); config->end() != it; it++ )
 	{
 		if( CppON::isMap( it->second ) && it->first.compare( "update" ) )
 		{
@@ -282,6 +381,11 @@ void SCppObj::initializeObject( const char *segmentName, bool *initialized )
 				list->size += buildArray( (COMap *) mp, ls, ident, c );
 			} else {
 
+				bool hot = alignedLayout && CppON::isBoolean( oPtr = mp->findCaseElement( "hot" ) ) && ( (COBoolean *) oPtr )->value();
+				if( hot )
+				{
+					alignRegions();
+				}
 				ls->name = c;
 				ls->time = timeOffset;
 				timeOffset += sizeof( uint64_t );
@@ -340,18 +444,70 @@ void SCppObj::initializeObject( const char *segmentName, bool *initialized )
 					ls->offset = (uint32_t) eightBitOffset;
 					eightBitOffset++;
 				}
+				if( hot )
+				{
+					alignRegions();
+				}
 			}
 		}
 	}
 
-	uint32_t doubleStart = timeOffset;
-	uint32_t int64Start = doubleStart + doubleOffset;
-	uint32_t int32Start = int64Start + int64Offset;
-	uint32_t int16Start = int32Start + int32Offset;
-	uint32_t eightBitStart = int16Start + int16Offset;
-	uint32_t charStart = eightBitStart + eightBitOffset;
+	uint32_t doubleStart = lineUp( timeOffset );
+	uint32_t int64Start = lineUp( doubleStart + doubleOffset );
+	uint32_t int32Start = lineUp( int64Start + int64Offset );
+	uint32_t int16Start = lineUp( int32Start + int32Offset );
+	uint32_t eightBitStart = lineUp( int16Start + int16Offset );
+	uint32_t charStart = lineUp( eightBitStart + eightBitOffset );
 	list->size = charStart + charOffset;
 
+	/*
+	 * Work out where each unit is and give every double buffered unit a publish area after the data, starting on a cache line.
+	 */
+	uint32_t regionStart[ SCPP_REGIONS ] = { 0, doubleStart, int64Start, int32Start, int16Start, eightBitStart, charStart };
+	extents.clear();
+	fields.assign( ( doubleStart - 0x20 ) >> 3, NULL );
+	buildExtents( list, regionStart );
+	list->size = ( list->size + 63 ) & ~63U;
+	for( std::vector<SCPP_EXTENT>::iterator it = extents.begin(); extents.end() != it; it++ )
+	{
+		if( it->publish )
+		{
+			it->publish = list->size;
+			list->size += 64 + ( ( 2 * it->size + 63 ) & ~63U );
+		}
+	}
+
+	/*
+	 * Then a version for every value, in the same order as the time stamps.  Writers bump it every time they store the value.
+	 */
+	versionOffset = ( list->size + 63 ) & ~63U;
+	list->size = versionOffset + ( ( doubleStart - 0x20 ) >> 1 );
+
+	/*
+	 * And the change journal if the configuration asks for one with "journal": <number of records>.
+	 */
+	CppON *jPtr = config->findCaseElement( "journal" );
+	journalOffset = 0;
+	journalMask = 0;
+	if( CppON::isNumber( jPtr ) && 0 < jPtr->toInt() )
+	{
+		uint32_t records = 1;
+		while( records < (uint32_t) jPtr->toInt() )
+		{
+			records <<= 1;
+		}
+		journalMask = records - 1;
+		journalOffset = ( list->size + 63 ) & ~63U;
+		list->size = journalOffset + 64 + records * sizeof( SCPP_JOURNAL_RECORD );
+	}
+
+	/*
+	 * The locks go at the end starting on a cache line;  one for the base, one for each unit and array and one used to
+	 * wake anyone waiting on several units.
+	 */
+	lockOffset = ( list->size + 63 ) & ~63U;
+	list->size = lockOffset + ( ( assignLocks( list, 0, false ) + 1 ) * sizeof( SCPP_LOCK ) );
+
 	timeOffset = 0x20;
 	doubleOffset = doubleStart;
 	int64Offset = int64Start;
@@ -360,6 +516,20 @@ void SCppObj::initializeObject( const char *segmentName, bool *initialized )
 	eightBitOffset = eightBitStart;
 	charOffset = charStart;
 
+	buildPathIndex();
+
+	/*
+	 * A segment also gets room for the compiled layout and, at the very end, its trailer.
+	 */
+	if( segmentName )
+	{
+		std::vector<char>	table;
+		SCPP_LAYOUT			head;
+		compileLayout( table, head );
+		layoutOffset = ( list->size + 63 ) & ~63U;
+		list->size = layoutOffset + ( ( (uint32_t) table.size() + 63 ) & ~63U ) + SCPP_LAYOUT_TRAILER;
+	}
+
 	/*
 	 * If we passed it a segmentName we want it to create a shared memory segment and store it in it
 	 */
@@ -395,33 +565,423 @@ void SCppObj::initializeObject( const char *segmentName, bool *initialized )
         sharedMemoryAllocated = true;
         sharedSegmentName = segmentName;
 
-        setBasePointer( ptr, true, initialized );
-
-        const char              *smPath = "/dev/shm";
-        char					smName[ 64 ];
-        DIR                     *dir;
-        struct dirent			*ent;
+        bool fresh = false;
+        setBasePointer( ptr, true, &fresh );
+        if( initialized )
+        {
+        	*initialized = fresh;
+        }
+        if( fresh )
+        {
+        	writeLayout();
+        }
 
-        strcpy( smName, "/dev/shm/" );
-        if( ( dir = opendir( smPath ) ) )
+        if( 0 > fchmod( sm_fd, 0666 ) )
         {
-            while( ( ent = readdir( dir ) ) )
-            {
-                if( '.' != ent->d_name[ 0 ]  )
-                {
-                	strncpy( &smName[ 9 ], ent->d_name, 54 );
-                	if( ! stat( smName, & _stat ) && !( _stat.st_mode & 2 ) )
-                	{
-                		if( 0 > chmod( smName, 0666) )
-                		{
-	    	    			fprintf( stderr, "%s[%d] Failed to change permissions of %s to oscp: %d - %s\n",__FILE__,__LINE__, smName, errno, strerror( errno ) );
-                		}
-                	}
-                }
-            }
-            closedir( dir );
-	   	}
+        	fprintf( stderr, "%s[%d] Failed to change permissions of %s: %d - %s\n",__FILE__,__LINE__, segmentName, errno, strerror( errno ) );
+        }
+        close( sm_fd );
+	}
+}
+
+/*
+ * Hash of a description.  Two descriptions with the same hash build the same layout.
+ */
+uint64_t SCppObj::descriptionHash( CppON *def, uint64_t h )
+{
+	uint8_t		t;
+
+	if( ! def )
+	{
+		return h;
+	}
+	t = (uint8_t) def->type();
+	h = fnv64( h, &t, 1 );
+	if( CppON::isMap( def ) )
+	{
+		for( COMap::iterator it = ( (COMap *) def )->begin(); ( (COMap *) def )->end() != it; it++ )
+		{
+			h = descriptionHash( it->second, fnv64( h, it->first.c_str(), it->first.length() + 1 ) );
+		}
+	} else if( CppON::isArray( def ) ) {
+		for( std::vector<CppON *>::iterator it = ( (COArray *) def )->begin(); ( (COArray *) def )->end() != it; it++ )
+		{
+			h = descriptionHash( *it, h );
+		}
+	} else if( CppON::isString( def ) ) {
+		h = fnv64( h, ( (COString *) def )->c_str(), def->size() + 1 );
+	} else if( CppON::isDouble( def ) ) {
+		double d = def->toDouble();
+		h = fnv64( h, &d, sizeof( d ) );
+	} else if( CppON::isInteger( def ) ) {
+		long long l = def->toLongInt();
+		h = fnv64( h, &l, sizeof( l ) );
+	} else if( CppON::isBoolean( def ) ) {
+		t = ( ( (COBoolean *) def )->value() ) ? 1 : 0;
+		h = fnv64( h, &t, 1 );
+	}
+	return h;
+}
+
+/*
+ * Flatten the STRUCT_LISTS tree, extents and path index into a table (see SCPP_LAYOUT) and fill in head to describe it.
+ */
+void SCppObj::compileLayout( std::vector<char> &table, SCPP_LAYOUT &head )
+{
+	std::vector<SCPP_LAYOUT_NODE>							nodes( 1 );
+	std::vector<std::pair<const STRUCT_LISTS *, uint32_t> >	pending;
+	std::map<const STRUCT_LISTS *, uint32_t>				index;
+	std::string												text( pathText );
+	std::vector<uint32_t>									entries;
+	uint32_t												version = SCPP_LAYOUT_VERSION;
+
+	memset( &nodes[ 0 ], 0, sizeof( SCPP_LAYOUT_NODE ) );
+	nodes[ 0 ].name = nodes[ 0 ].acronym = (uint32_t) text.size();
+	text.append( list->name.c_str(), list->name.length() + 1 );
+	nodes[ 0 ].offset = list->offset;
+	nodes[ 0 ].size = list->size;
+	nodes[ 0 ].time = list->time;
+	nodes[ 0 ].type = list->type;
+	nodes[ 0 ].nSubs = list->nSubs;
+	index[ list ] = 0;
+	pending.push_back( std::make_pair( (const STRUCT_LISTS *) list, 0U ) );
+	while( ! pending.empty() )
+	{
+		const STRUCT_LISTS	*lst = pending.back().first;
+		uint32_t			idx = pending.back().second;
+
+		pending.pop_back();
+		if( SL_TYPE_UNIT != lst->type && SL_TYPE_ARRAY != lst->type )
+		{
+			continue;
+		}
+		nodes[ idx ].subs = (uint32_t) nodes.size();
+		for( unsigned i = 0; lst->nSubs > i; i++ )
+		{
+			const STRUCT_LISTS	*ls = &( (STRUCT_LISTS *) lst->subs )[ i ];
+			SCPP_LAYOUT_NODE	nd;
+			const char			*acronym = ( lst->names && lst->names[ 2 * i ] ) ? lst->names[ 2 * i ] : ls->name.c_str();
+
+			memset( &nd, 0, sizeof( nd ) );
+			nd.name = (uint32_t) text.size();
+			text.append( ls->name.c_str(), ls->name.length() + 1 );
+			nd.acronym = (uint32_t) text.size();
+			text.append( acronym, strlen( acronym ) + 1 );
+			nd.offset = ls->offset;
+			nd.size = ls->size;
+			nd.time = ls->time;
+			nd.type = ls->type;
+			nd.nSubs = ( SL_TYPE_UNIT == ls->type || SL_TYPE_ARRAY == ls->type ) ? ls->nSubs : 0;
+			index[ ls ] = (uint32_t) nodes.size();
+			pending.push_back( std::make_pair( ls, (uint32_t) nodes.size() ) );
+			nodes.push_back( nd );
+		}
+	}
+	for( std::vector<PATH_ENTRY>::iterator it = pathEntries.begin(); pathEntries.end() != it; it++ )
+	{
+		entries.push_back( index[ it->base ] );
+		entries.push_back( index[ it->element ] );
+		entries.push_back( it->offset );
+		entries.push_back( it->length );
+	}
+	while( text.size() & 3 )
+	{
+		text += '\0';
+	}
+
+	table.clear();
+	table.insert( table.end(), (const char *) nodes.data(), (const char *) ( nodes.data() + nodes.size() ) );
+	table.insert( table.end(), (const char *) extents.data(), (const char *) ( extents.data() + extents.size() ) );
+	table.insert( table.end(), (const char *) entries.data(), (const char *) ( entries.data() + entries.size() ) );
+	table.insert( table.end(), text.begin(), text.end() );
+
+	memset( &head, 0, sizeof( head ) );
+	head.version = SCPP_LAYOUT_VERSION;
+	head.hash = descriptionHash( config, fnv64( 0xCBF29CE484222325ULL, &version, sizeof( version ) ) );
+	head.table = layoutOffset;
+	head.nodes = (uint32_t) nodes.size();
+	head.extents = (uint32_t) extents.size();
+	head.entries = (uint32_t) pathEntries.size();
+	head.pathText = (uint32_t) pathText.size();
+	head.text = (uint32_t) text.size();
+	head.fields = (uint32_t) fields.size();
+	head.offsets[ 0 ] = timeOffset;
+	head.offsets[ 1 ] = (uint32_t) doubleOffset;
+	head.offsets[ 2 ] = (uint32_t) int64Offset;
+	head.offsets[ 3 ] = (uint32_t) int32Offset;
+	head.offsets[ 4 ] = (uint32_t) int16Offset;
+	head.offsets[ 5 ] = (uint32_t) eightBitOffset;
+	head.offsets[ 6 ] = (uint32_t) charOffset;
+	head.offsets[ 7 ] = versionOffset;
+	head.offsets[ 8 ] = journalOffset;
+	head.offsets[ 9 ] = journalMask;
+	head.offsets[ 10 ] = lockOffset;
+	head.offsets[ 11 ] = ( alignedLayout ) ? 1 : 0;
+}
+
+/*
+ * Called by the process that initialized the segment to leave the compiled layout in it.  The magic number goes in last so
+ * nobody uses a half written table.
+ */
+void SCppObj::writeLayout( void )
+{
+	std::vector<char>	table;
+	SCPP_LAYOUT			head;
+	// cppcheck-suppress cstyleCast
+	SCPP_LAYOUT			*lay = (SCPP_LAYOUT *) ( (char *) basePtr + list->size - SCPP_LAYOUT_TRAILER );
+
+	compileLayout( table, head );
+	if( ! layoutOffset || layoutOffset + table.size() > list->size - SCPP_LAYOUT_TRAILER )
+	{
+		fprintf( stderr, "%s[%d]: No room for the compiled layout\n", __FILE__, __LINE__ );
+		return;
+	}
+	memcpy( (char *) basePtr + layoutOffset, table.data(), table.size() );
+	memcpy( lay, &head, sizeof( head ) );
+	__atomic_store_n( &lay->magic, SCPP_LAYOUT_MAGIC, __ATOMIC_RELEASE );
+}
+
+/*
+ * Check a compiled layout found in a segment of sz bytes before using anything in it.  Anybody can write to a segment so every
+ * index has to land inside the table, every offset inside the segment and every node other than the base has to be the sub of
+ * exactly one unit or array that comes before it.  Field ids count time stamp slots, and the aligned layout leaves some empty,
+ * so there can be more of them than nodes;  each still needs its time stamp inside the segment.
+ */
+bool SCppObj::layoutSound( const SCPP_LAYOUT *lay, const char *base, size_t sz )
+{
+	// cppcheck-suppress cstyleCast
+	const SCPP_LAYOUT_NODE	*nodes = (const SCPP_LAYOUT_NODE *) ( base + lay->table );
+	const SCPP_EXTENT		*ext = (const SCPP_EXTENT *) ( nodes + lay->nodes );
+	const uint32_t			*ent = (const uint32_t *) ( ext + lay->extents );
+	const char				*text = (const char *) ( ent + 4 * lay->entries );
+	std::vector<bool>		seen( lay->nodes, false );
+	uint64_t				locks = 1;
+
+	if( ! lay->text || text[ lay->text - 1 ] || lay->pathText > lay->text || 0x20 + 8 * (uint64_t) lay->fields > sz || SL_TYPE_UNIT != nodes[ 0 ].type
+			|| sz != nodes[ 0 ].size || ( lay->offsets[ 9 ] & ( lay->offsets[ 9 ] + 1 ) ) )
+	{
+		return false;
+	}
+	for( uint32_t i = 0; lay->nodes > i; i++ )
+	{
+		const SCPP_LAYOUT_NODE	&nd = nodes[ i ];
+
+		if( lay->text <= nd.name || lay->text <= nd.acronym || ( nd.time && (uint64_t) nd.time + 8 > sz ) )
+		{
+			return false;
+		}
+		if( SL_TYPE_UNIT == nd.type || SL_TYPE_ARRAY == nd.type )
+		{
+			locks++;
+			if( nd.nSubs && ( i >= nd.subs || (uint64_t) nd.subs + nd.nSubs > lay->nodes ) )
+			{
+				return false;
+			}
+			for( unsigned j = 0; nd.nSubs > j; j++ )
+			{
+				if( seen[ nd.subs + j ] )
+				{
+					return false;
+				}
+				seen[ nd.subs + j ] = true;
+			}
+		} else if( nd.nSubs || (uint64_t) nd.offset + nd.size > sz ) {
+			return false;
+		}
+	}
+	for( uint32_t i = 1; lay->nodes > i; i++ )
+	{
+		if( ! seen[ i ] )
+		{
+			return false;
+		}
+	}
+	for( uint32_t i = 0; lay->extents > i; i++ )
+	{
+		for( unsigned r = 0; SCPP_REGIONS > r; r++ )
+		{
+			if( ext[ i ].start[ r ] > ext[ i ].end[ r ] || ext[ i ].end[ r ] > sz || (uint64_t) ext[ i ].snap[ r ] + ext[ i ].end[ r ] - ext[ i ].start[ r ] > ext[ i ].size )
+			{
+				return false;
+			}
+		}
+		if( ext[ i ].publish >= sz )
+		{
+			return false;
+		}
+	}
+	for( uint32_t i = 0; lay->entries > i; i++ )
+	{
+		if( lay->nodes <= ent[ 4 * i ] || lay->nodes <= ent[ 4 * i + 1 ] || (uint64_t) ent[ 4 * i + 2 ] + ent[ 4 * i + 3 ] > lay->pathText )
+		{
+			return false;
+		}
+	}
+	for( unsigned i = 0; 8 > i; i++ )
+	{
+		if( lay->offsets[ i ] >= sz )
+		{
+			return false;
+		}
+	}
+	if( ( lay->offsets[ 7 ] && (uint64_t) lay->offsets[ 7 ] + 4 * (uint64_t) lay->fields > sz )
+			|| ( lay->offsets[ 8 ] && (uint64_t) lay->offsets[ 8 ] + 64 + ( (uint64_t) lay->offsets[ 9 ] + 1 ) * sizeof( SCPP_JOURNAL_RECORD ) > sz )
+			|| (uint64_t) lay->offsets[ 10 ] + locks * sizeof( SCPP_LOCK ) > sz )
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Attach to an existing, initialized segment whose compiled layout was built from the same description as ours.  The
+ * STRUCT_LISTS tree, extents and path index come straight from the table.  Returns false, having changed nothing, if there is
+ * no such segment so the caller should build the layout itself.  A segment that is set up but whose layout came from some
+ * other description, or doesn't hold together, throws std::invalid_argument;  building ours over it would resize it under
+ * everybody using it.
+ */
+bool SCppObj::attachLayout( const char *segmentName, bool *initialized )
+{
+	struct stat		_stat;
+	int				fd;
+	void			*ptr;
+	bool			rtn = false;
+	uint32_t		version = SCPP_LAYOUT_VERSION;
+
+	if( 0 > ( fd = shm_open( segmentName, O_RDWR, 0666 ) ) )
+	{
+		return false;
+	}
+	if( 0 == fstat( fd, &_stat ) && SCPP_LAYOUT_TRAILER + 64 <= _stat.st_size && MAP_FAILED != ( ptr = mmap( 0, _stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) ) )
+	{
+		size_t			sz = (size_t) _stat.st_size;
+		// cppcheck-suppress cstyleCast
+		SCPP_LAYOUT		*lay = (SCPP_LAYOUT *) ( (char *) ptr + sz - SCPP_LAYOUT_TRAILER );
+		size_t			bytes = (size_t) lay->nodes * sizeof( SCPP_LAYOUT_NODE ) + (size_t) lay->extents * sizeof( SCPP_EXTENT ) + 4 * (size_t) lay->entries * sizeof( uint32_t ) + lay->text;
+
+		if( 0xA5 == *( (uint8_t *) ptr ) && SCPP_LAYOUT_MAGIC == __atomic_load_n( &lay->magic, __ATOMIC_ACQUIRE ) && SCPP_LAYOUT_VERSION == lay->version
+				&& ( ! lay->nodes || lay->table + bytes > sz - SCPP_LAYOUT_TRAILER || lay->hash != descriptionHash( config, fnv64( 0xCBF29CE484222325ULL, &version, sizeof( version ) ) )
+					|| ! layoutSound( lay, (const char *) ptr, sz ) ) )
+		{
+			char buf[ 160 ];
+			snprintf( buf, 159, "Shared memory segment %s is laid out from a different description", segmentName );
+			munmap( ptr, sz );
+			close( fd );
+			throw std::invalid_argument( buf );
+		}
+		if( 0xA5 == *( (uint8_t *) ptr ) && SCPP_LAYOUT_MAGIC == __atomic_load_n( &lay->magic, __ATOMIC_ACQUIRE ) && SCPP_LAYOUT_VERSION == lay->version )
+		{
+			// cppcheck-suppress cstyleCast
+			const SCPP_LAYOUT_NODE	*nodes = (const SCPP_LAYOUT_NODE *) ( (char *) ptr + lay->table );
+			const SCPP_EXTENT		*ext = (const SCPP_EXTENT *) ( nodes + lay->nodes );
+			const uint32_t			*ent = (const uint32_t *) ( ext + lay->extents );
+			const char				*text = (const char *) ( ent + 4 * lay->entries );
+			std::vector<STRUCT_LISTS *>	byIndex( lay->nodes, NULL );
+
+			byIndex[ 0 ] = list = new STRUCT_LISTS;
+			for( uint32_t i = 0; lay->nodes > i; i++ )
+			{
+				const SCPP_LAYOUT_NODE	&nd = nodes[ i ];
+				STRUCT_LISTS			*ls = byIndex[ i ];
+
+				ls->name = text + nd.name;
+				ls->offset = nd.offset;
+				ls->size = nd.size;
+				ls->time = nd.time;
+				ls->type = nd.type;
+				ls->nSubs = nd.nSubs;
+				ls->lock = NULL;
+				ls->def = NULL;
+				ls->subs = NULL;
+				ls->names = NULL;
+				if( SL_TYPE_UNIT == nd.type || SL_TYPE_ARRAY == nd.type )
+				{
+					ls->subs = new STRUCT_LISTS[ nd.nSubs ];
+					ls->names = new char*[ 2 * nd.nSubs + 1 ];
+					for( unsigned j = 0; nd.nSubs > j; j++ )
+					{
+						const SCPP_LAYOUT_NODE &sub = nodes[ nd.subs + j ];
+						byIndex[ nd.subs + j ] = &ls->subs[ j ];
+						ls->names[ 2 * j ] = strcpy( new char[ strlen( text + sub.acronym ) + 1 ], text + sub.acronym );
+						ls->names[ 2 * j + 1 ] = strcpy( new char[ strlen( text + sub.name ) + 1 ], text + sub.name );
+					}
+					ls->names[ 2 * nd.nSubs ] = NULL;
+				}
+			}
+
+			/*
+			 * The definitions still come from our own copy of the description.
+			 */
+			std::vector<STRUCT_LISTS *> pending( 1, list );
+			list->def = config;
+			while( ! pending.empty() )
+			{
+				STRUCT_LISTS *lst = pending.back();
+				pending.pop_back();
+				if( SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
+				{
+					for( unsigned j = 0; lst->nSubs > j; j++ )
+					{
+						STRUCT_LISTS	*ls = &lst->subs[ j ];
+						CppON			*d = ( lst->def ) ? lst->def->findElement( ls->name.c_str() ) : NULL;
+						ls->def = ( CppON::isMap( d ) ) ? (COMap *) d : NULL;
+						pending.push_back( ls );
+					}
+				}
+			}
+
+			extents.assign( ext, ext + lay->extents );
+			fields.assign( lay->fields, NULL );
+			for( uint32_t i = 0; lay->nodes > i; i++ )
+			{
+				if( SCPP_REGIONS > region( byIndex[ i ]->type ) && fields.size() > fieldId( byIndex[ i ] ) )
+				{
+					fields[ fieldId( byIndex[ i ] ) ] = byIndex[ i ];
+				}
+			}
+			pathEntries.resize( lay->entries );
+			for( uint32_t i = 0; lay->entries > i; i++ )
+			{
+				size_t len;
+
+				pathEntries[ i ].base = byIndex[ ent[ 4 * i ] ];
+				pathEntries[ i ].element = byIndex[ ent[ 4 * i + 1 ] ];
+				pathEntries[ i ].offset = ent[ 4 * i + 2 ];
+				pathEntries[ i ].length = ent[ 4 * i + 3 ];
+				pathEntries[ i ].hash = pathHash( pathEntries[ i ].base, text + pathEntries[ i ].offset, len, pathEntries[ i ].length );
+			}
+			pathText.assign( text, lay->pathText );
+			fillPathIndex();
+
+			timeOffset = lay->offsets[ 0 ];
+			doubleOffset = (int) lay->offsets[ 1 ];
+			int64Offset = (int) lay->offsets[ 2 ];
+			int32Offset = (int) lay->offsets[ 3 ];
+			int16Offset = (int) lay->offsets[ 4 ];
+			eightBitOffset = (int) lay->offsets[ 5 ];
+			charOffset = (int) lay->offsets[ 6 ];
+			versionOffset = lay->offsets[ 7 ];
+			journalOffset = lay->offsets[ 8 ];
+			journalMask = lay->offsets[ 9 ];
+			lockOffset = lay->offsets[ 10 ];
+			alignedLayout = ( 0 != lay->offsets[ 11 ] );
+			layoutOffset = lay->table;
+
+			basePtr = ptr;
+			sharedMemoryAllocated = true;
+			sharedSegmentName = segmentName;
+			assignLocks( list, 0, false );
+			if( initialized )
+			{
+				*initialized = false;
+			}
+			rtn = true;
+		} else {
+			munmap( ptr, sz );
+		}
 	}
+	close( fd );
+	return rtn;
 }
 
 SCppObj::SCppObj( COMap *def, const char *segmentName, bool *initialized )
@@ -471,11 +1031,6 @@ SCppObj::~SCppObj()
 	delete config;
 	deleteStructList( list, "" );
 	delete list;
-	for( std::vector<sem_t *>::iterator it = sems.begin(); sems.end() != it; it++ )
-	{
-		sem_close( *it );
-	}
-	sems.clear();
 	if( sharedMemoryAllocated )
 	{
         munmap( basePtr, sz );
@@ -702,36 +1257,115 @@ CppON *SCppObj::toCppON( STRUCT_LISTS *root )
 	}
 	return NULL;
 }
-bool SCppObj::syncInt( CppON *obj, STRUCT_LISTS *lst )
+/*
+ * The JSON toCOMap( root )->toCompactJsonString() (or toCOArray, or the leaf's) would give, written straight out of the
+ * segment with nothing allocated.  Given snap, a snapshot of root from snapshot(), the values come from it instead so the
+ * text is a consistent picture of the unit.  Without it the values are read as they are, just as toCOMap reads them.
+ */
+bool SCppObj::writeJson( STRUCT_LISTS *root, CppONWriter &w, const void *snap )
 {
-	bool result = false;
+	if( ! root )
+	{
+		root = list;
+	}
+	if( SL_TYPE_NONE == root->type || SL_TYPE_ARRAY < root->type || ( snap && ! extent( root ) ) )
+	{
+		return false;
+	}
+	writeNode( root, w, root, snap );
+	return true;
+}
 
-	if( lst && CppON::isInteger( obj ) )
+void SCppObj::writeNode( STRUCT_LISTS *lst, CppONWriter &w, STRUCT_LISTS *root, const void *snap )
+{
+	const char	*src;
+
+	if( SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
 	{
-		switch( lst->type )
+		w.put( ( SL_TYPE_UNIT == lst->type ) ? '{' : '[' );
+		for( unsigned i = 0; lst->nSubs > i; i++ )
 		{
-			case SL_TYPE_INT64:
-				{
-					long long l = (long long ) *( ( uint64_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) lst->offset ) );
-					if( (result = ( l != ((COInteger*)obj)->toLongInt() ) ) )
-					{
-						*((COInteger*) obj ) =  l;
-					}
-				}
-				break;
-			case SL_TYPE_INT32:
-				{
-					int l = ( int ) *( ( uint32_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) lst->offset ) );
-					if( (result = ( l != ((COInteger*)obj)->toInt() ) ) )
-					{
-						*((COInteger*) obj ) =  l;
-					}
-				}
-				break;
-			case SL_TYPE_INT16:
-				{
-
-					int l = ( int ) *( ( uint16_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) lst->offset ) );
+			STRUCT_LISTS &s = ( (STRUCT_LISTS *) lst->subs )[ i ];
+			if( i )
+			{
+				w.put( ',' );
+			}
+			if( SL_TYPE_UNIT == lst->type )
+			{
+				w.putString( s.name.c_str(), s.name.length() );
+				w.put( ':' );
+			}
+			writeNode( &s, w, root, snap );
+		}
+		w.put( ( SL_TYPE_UNIT == lst->type ) ? '}' : ']' );
+		return;
+	}
+
+	// cppcheck-suppress cstyleCast
+	src = ( snap ) ? (const char *) snapshotPointer( root, lst, snap ) : (const char *) basePtr + lst->offset;
+	if( ! src )
+	{
+		w.put( "null", 4 );
+		return;
+	}
+	switch( lst->type )
+	{
+		case SL_TYPE_DOUBLE:
+			w.putDouble( *( (const double *) src ), 10 );						// CODouble's default precision
+			break;
+		case SL_TYPE_INT64:
+			w.putInt( *( (const int64_t *) src ) );
+			break;
+		case SL_TYPE_INT32:
+			w.putInt( *( (const int32_t *) src ) );
+			break;
+		case SL_TYPE_INT16:
+			w.putInt( *( (const uint16_t *) src ) );
+			break;
+		case SL_TYPE_INT8:
+			w.putInt( *( (const uint8_t *) src ) );
+			break;
+		case SL_TYPE_BOOL:
+			w.putBool( 0 != *( (const uint8_t *) src ) );
+			break;
+		case SL_TYPE_CHAR:
+			w.putString( src, strnlen( src, lst->size ) );
+			break;
+		default:
+			break;
+	}
+}
+
+bool SCppObj::syncInt( CppON *obj, STRUCT_LISTS *lst )
+{
+	bool result = false;
+
+	if( lst && CppON::isInteger( obj ) )
+	{
+		switch( lst->type )
+		{
+			case SL_TYPE_INT64:
+				{
+					long long l = (long long ) *( ( uint64_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) lst->offset ) );
+					if( (result = ( l != ((COInteger*)obj)->toLongInt() ) ) )
+					{
+						*((COInteger*) obj ) =  l;
+					}
+				}
+				break;
+			case SL_TYPE_INT32:
+				{
+					int l = ( int ) *( ( uint32_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) lst->offset ) );
+					if( (result = ( l != ((COInteger*)obj)->toInt() ) ) )
+					{
+						*((COInteger*) obj ) =  l;
+					}
+				}
+				break;
+			case SL_TYPE_INT16:
+				{
+
+					int l = ( int ) *( ( uint16_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) lst->offset ) );
 					if( (result = ( l != ((COInteger*)obj)->toInt() ) ) )
 					{
 						*((COInteger*) obj ) =  l;
@@ -798,7 +1432,7 @@ bool SCppObj::syncMap( CppON *obj, STRUCT_LISTS *lst )
 
 	if( lst &&  SL_TYPE_UNIT == lst->type && CppON::isMap( obj ) )
 	{
-		for( std::map<std::string, CppON *>::iterator it = ((COMap *) obj)->begin(); ((COMap *) obj)->end() != it; it++ )
+		for( COMap::iterator it = ((COMap *) obj)->begin(); ((COMap *) obj)->end() != it; it++ )
 		{
 			const char 	*name = it->first.c_str();
 			CppON		*jobj = it->second;
@@ -949,7 +1583,7 @@ bool SCppObj::waitSem( const char *path, STRUCT_LISTS *lst )
 	STRUCT_LISTS 	*tst = getPointer( path, lst );
 	if( tst )
 	{
-		return( waitSem( tst->sem ) );
+		return( waitSem( tst->lock ) );
 	} else {
 		fprintf( stderr, "%s[%.4u]: ERROR - Failed to get semaphore to wait on: '%s'\n",__FILE__ , __LINE__, path  );
 	}
@@ -960,7 +1594,7 @@ bool SCppObj::postSem( const char *path, STRUCT_LISTS *lst )
 	STRUCT_LISTS 	*tst = getPointer( path, lst );
 	if( tst )
 	{
-		sem_post( tst->sem );
+		postSem( tst->lock );
 		return true;
 	} else {
 		fprintf( stderr, "%s[%.4u]: ERROR - Failed to get semaphore to Post too: '%s'\n",__FILE__ , __LINE__, path );
@@ -968,6 +1602,33 @@ bool SCppObj::postSem( const char *path, STRUCT_LISTS *lst )
 	return false;
 }
 
+/*
+ * Stamp a value written at t (now, in milliseconds, if t is zero), bump its version and journal the write.  The caller
+ * holds the unit's lock.
+ */
+void SCppObj::setUpdateTime( STRUCT_LISTS *lst, uint64_t t )
+{
+	if( lst )
+	{
+		if( ! t )
+		{
+			struct timespec tsp;
+			clock_gettime( CLOCK_MONOTONIC, &tsp );
+			t = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) );
+		}
+		*((uint64_t *)((char*) basePtr + lst->time ) ) = t;
+		uint32_t *v = versionPointer( lst );
+		if( v )
+		{
+			uint32_t n = __atomic_add_fetch( v, 1, __ATOMIC_RELEASE );
+			if( journalOffset )
+			{
+				appendJournal( lst, n, t );
+			}
+		}
+	}
+}
+
 void SCppObj::setUpdateTime( const char *path, STRUCT_LISTS *lst, uint64_t t )
 {
 	STRUCT_LISTS 	*tst = getPointer( path, lst );
@@ -1033,32 +1694,129 @@ STRUCT_LISTS *SCppObj::at( STRUCT_LISTS *lst, uint32_t idx )
 	return rtn;
 }
 
+/*
+ * Hash of a path relative to base.  '.' and '/' hash the same so "a.b" and "a/b" find the same element.  The length of the
+ * path is returned in len so the caller doesn't need a separate strlen.
+ */
+uint32_t SCppObj::pathHash( const STRUCT_LISTS *base, const char *path, size_t &len, size_t max )
+{
+	// cppcheck-suppress cstyleCast
+	uint64_t 	b = (uint64_t) base;
+	uint32_t	h = 2166136261u ^ (uint32_t) ( b ^ ( b >> 32 ) );
+	const char	*p;
+
+	for( p = path; *p && max > (size_t) ( p - path ); p++ )
+	{
+		h ^= (uint8_t) ( ( '.' == *p ) ? '/' : *p );
+		h *= 16777619u;
+	}
+	len = p - path;
+	return h;
+}
+
+/*
+ * Walk the tree adding an entry for every element under each of the units in chain.  chain holds the ancestors of lst along
+ * with where their relative paths start in path.
+ */
+void SCppObj::indexPaths( STRUCT_LISTS *lst, std::string &path, std::vector<std::pair<STRUCT_LISTS *, size_t> > &chain )
+{
+	size_t		l = path.length();
+
+	chain.push_back( std::pair<STRUCT_LISTS *, size_t>( lst, ( l ) ? l + 1 : 0 ) );
+	for( unsigned i = 0; lst->names && lst->names[ 2 * i ] && i < lst->nSubs; i++ )
+	{
+		STRUCT_LISTS *sub = &( (STRUCT_LISTS *) lst->subs )[ i ];
+		if( l )
+		{
+			path += '/';
+		}
+		path += lst->names[ ( 2 * i ) + 1 ];
+
+		for( std::vector<std::pair<STRUCT_LISTS *, size_t> >::iterator it = chain.begin(); chain.end() != it; it++ )
+		{
+			PATH_ENTRY	ent;
+			size_t		len;
+
+			ent.base = it->first;
+			ent.element = sub;
+			ent.offset = (uint32_t) pathText.length();
+			ent.hash = pathHash( ent.base, path.c_str() + it->second, len );
+			ent.length = (uint32_t) len;
+			pathText.append( path, it->second, len );
+			pathEntries.push_back( ent );
+		}
+		if( ( SL_TYPE_UNIT == sub->type || SL_TYPE_ARRAY == sub->type ) && sub->names )
+		{
+			indexPaths( sub, path, chain );
+		}
+		path.resize( l );
+	}
+	chain.pop_back();
+}
+
+/*
+ * Build the open addressing table used by getElement.  Called once the structure is complete; the table holds indexes into
+ * pathEntries plus one so zero marks an empty slot.
+ */
+void SCppObj::buildPathIndex( void )
+{
+	std::string									path;
+	std::vector<std::pair<STRUCT_LISTS *, size_t> >	chain;
+
+	pathEntries.clear();
+	pathText.clear();
+	indexPaths( list, path, chain );
+	fillPathIndex();
+}
+
+/*
+ * Enter pathEntries, hashes already set, in the slots of the table.
+ */
+void SCppObj::fillPathIndex( void )
+{
+	size_t										sz = 16;
+
+	while( sz < 2 * pathEntries.size() )
+	{
+		sz <<= 1;
+	}
+	pathIndex.assign( sz, 0 );
+	for( uint32_t i = 0; pathEntries.size() > i; i++ )
+	{
+		size_t j;
+		for( j = pathEntries[ i ].hash & ( sz - 1 ); pathIndex[ j ]; j = ( j + 1 ) & ( sz - 1 ) );
+		pathIndex[ j ] = i + 1;
+	}
+}
+
 STRUCT_LISTS  *SCppObj::getElement( const char *path, STRUCT_LISTS *base )
 {
-	const char *e;
-	const char *key;
-	for( e = path; *e && '/' != *e && '.' != *e; e++ );
-	unsigned l = e - path;
-	if( path && base  && base->names )
+	return lookup( path, SIZE_MAX, base );
+}
+
+/*
+ * getElement for a path that ends after max characters or at a NUL, whichever comes first.
+ */
+STRUCT_LISTS *SCppObj::lookup( const char *path, size_t max, STRUCT_LISTS *base )
+{
+	if( path && base && ! pathIndex.empty() )
 	{
-		std::string s( path, l );
-		for( unsigned i = 0; ( key = base->names[ i ] ); i += 2 )
+		size_t		len;
+		size_t		mask = pathIndex.size() - 1;
+		uint32_t	h = pathHash( base, path, len, max );
+
+		for( size_t j = h & mask; pathIndex[ j ]; j = ( j + 1 ) & mask )
 		{
-			unsigned j;
-			for( j = 0; j < l && key[ j ] && path[ j ] == key[ j ]; j++);
-			if( ! key[ j ] )											// found
+			const PATH_ENTRY &ent = pathEntries[ pathIndex[ j ] - 1 ];
+			if( h == ent.hash && base == ent.base && len == ent.length )
 			{
-				if( l != strlen( base->names[ i + 1 ] ) )												// Fail! Strings aren't same length
+				const char *key = pathText.data() + ent.offset;
+				size_t i;
+				for( i = 0; i < len && ( key[ i ] == path[ i ] || ( '/' == key[ i ] && '.' == path[ i ] ) ); i++ );
+				if( i == len )
 				{
-				} else if( strncmp( base->names[ i + 1 ], path, l ) ) {									// Fail! Strings aren't equal
-					break;
-				} else if( *e ) {
-					return getElement( ++e, &( ( (STRUCT_LISTS *) base->subs )[ i / 2 ] ) );			// Search for child
-				} else {
-					return &( ( (STRUCT_LISTS *) base->subs )[ i / 2 ] );								// Found IT!
+					return ent.element;											// Found IT!
 				}
-			} else if( key[ j ] > path[ j ] ) {															// Fail!  We passed it without finding it.
-				break;
 			}
 		}
 	}
@@ -1070,7 +1828,10 @@ char *SCppObj::String( STRUCT_LISTS *val, char *var, int sz )
 	char *rtn = NULL;
 	if( val )
 	{
-		waitSem( val->sem );
+		if( ! waitSem( val->lock ) )
+		{
+			return rtn;
+		}
 		if( var && sz )
 		{
 			switch ( val->type )
@@ -1146,7 +1907,7 @@ char *SCppObj::String( STRUCT_LISTS *val, char *var, int sz )
 					break;
 			}
 		}
-		sem_post( val->sem );
+		postSem( val->lock );
 	}
 	return rtn;
 }
@@ -1156,7 +1917,10 @@ uint64_t SCppObj::toLong( STRUCT_LISTS *val )
 	uint64_t rtn = 0;
 	if( val )
 	{
-		waitSem( val->sem );
+		if( ! waitSem( val->lock ) )
+		{
+			return rtn;
+		}
 
 		switch ( val->type )
 		{
@@ -1184,7 +1948,7 @@ uint64_t SCppObj::toLong( STRUCT_LISTS *val )
 			default:
 				break;
 		}
-		sem_post( val->sem );
+		postSem( val->lock );
 	}
 	return rtn;
 }
@@ -1193,7 +1957,10 @@ uint32_t SCppObj::Int( STRUCT_LISTS *val )
 	uint32_t rtn = 0;
 	if( val )
 	{
-		waitSem( val->sem );
+		if( ! waitSem( val->lock ) )
+		{
+			return rtn;
+		}
 
 		switch ( val->type )
 		{
@@ -1221,7 +1988,7 @@ uint32_t SCppObj::Int( STRUCT_LISTS *val )
 			default:
 				break;
 		}
-		sem_post( val->sem );
+		postSem( val->lock );
 	}
 	return rtn;
 }
@@ -1230,7 +1997,10 @@ double SCppObj::toDouble( STRUCT_LISTS *val )
 	double rtn = 0.0;
 	if( val )
 	{
-		waitSem( val->sem );
+		if( ! waitSem( val->lock ) )
+		{
+			return rtn;
+		}
 
 		switch ( val->type )
 		{
@@ -1258,7 +2028,7 @@ double SCppObj::toDouble( STRUCT_LISTS *val )
 			default:
 				break;
 		}
-		sem_post( val->sem );
+		postSem( val->lock );
 	}
 	return rtn;
 }
@@ -1268,7 +2038,10 @@ bool SCppObj::toBoolean( STRUCT_LISTS *val )
 	bool rtn = false;
 	if( val )
 	{
-		waitSem( val->sem );
+		if( ! waitSem( val->lock ) )
+		{
+			return rtn;
+		}
 
 		switch ( val->type )
 		{
@@ -1296,7 +2069,7 @@ bool SCppObj::toBoolean( STRUCT_LISTS *val )
 			default:
 				break;
 		}
-		sem_post( val->sem );
+		postSem( val->lock );
 	}
 	return rtn;
 }
@@ -1306,9 +2079,19 @@ double SCppObj::doubleValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 	double result = 0.0;
 	if( tst )
 	{
-		if( protect )
+		uint64_t	copy[ SCPP_SEQ_MAX / sizeof( uint64_t ) ];
+		uint64_t	addr = ((uint64_t ) basePtr ) + (uint64_t ) tst->offset;
+		bool		locked = false;
+
+		if( protect && seqRead( tst, copy ) )																					// Got a consistent copy without the lock
 		{
-			waitSem( tst->sem );
+			addr = (uint64_t) copy;
+		} else if( protect && ! ( locked = waitSem( tst->lock ) ) ) {
+			if( valid )
+			{
+				*valid = false;
+			}
+			return result;
 		}
 		if( valid )
 		{
@@ -1317,22 +2100,22 @@ double SCppObj::doubleValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 		switch ( tst->type )
 		{
 			case SL_TYPE_CHAR:
-				result = strtod( ( ( char *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ), NULL );
+				result = strtod( ( ( char *)( addr ) ), NULL );
 				break;
 			case SL_TYPE_DOUBLE:
-				result = *((double *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = *((double *)( addr ) );
 				break;
 			case SL_TYPE_INT64:
-				result = (double) *( ( int64_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (double) *( ( int64_t *)( addr ) );
 				break;
 			case SL_TYPE_INT32:
-				result = (double) *( ( int32_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (double) *( ( int32_t *)( addr ) );
 				break;
 			case SL_TYPE_INT8:
-				result = (double) *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (double) *( ( int8_t *)( addr ) );
 				break;
 			case SL_TYPE_BOOL:
-				result = ( 0 != *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) ) ? 1.0 : 0.0;
+				result = ( 0 != *( ( int8_t *)( addr ) ) ) ? 1.0 : 0.0;
 				break;
 			default:
 				if( valid )
@@ -1341,9 +2124,9 @@ double SCppObj::doubleValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 				}
 				break;
 		}
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( locked )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 	} else {
 		if( valid )
@@ -1376,9 +2159,19 @@ uint64_t SCppObj::longValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 	uint64_t result = 0;
 	if( tst )
 	{
-		if( protect )
+		uint64_t	copy[ SCPP_SEQ_MAX / sizeof( uint64_t ) ];
+		uint64_t	addr = ((uint64_t ) basePtr ) + (uint64_t ) tst->offset;
+		bool		locked = false;
+
+		if( protect && seqRead( tst, copy ) )																					// Got a consistent copy without the lock
 		{
-			waitSem( tst->sem );
+			addr = (uint64_t) copy;
+		} else if( protect && ! ( locked = waitSem( tst->lock ) ) ) {
+			if( valid )
+			{
+				*valid = false;
+			}
+			return result;
 		}
 		if( valid )
 		{
@@ -1387,22 +2180,22 @@ uint64_t SCppObj::longValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 		switch ( tst->type )
 		{
 			case SL_TYPE_CHAR:
-				result = strtoll( ( ( char *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ), NULL, 0 );
+				result = strtoll( ( ( char *)( addr ) ), NULL, 0 );
 				break;
 			case SL_TYPE_DOUBLE:
-				result =  (int64_t) *((double *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result =  (int64_t) *((double *)( addr ) );
 				break;
 			case SL_TYPE_INT64:
-				result = (uint64_t) *( ( int64_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint64_t) *( ( int64_t *)( addr ) );
 				break;
 			case SL_TYPE_INT32:
-				result = (uint64_t) *( ( int32_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint64_t) *( ( int32_t *)( addr ) );
 				break;
 			case SL_TYPE_INT8:
-				result = (uint64_t) *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint64_t) *( ( int8_t *)( addr ) );
 				break;
 			case SL_TYPE_BOOL:
-				result = ( 0 != *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) ) ? 1LL : 0LL;
+				result = ( 0 != *( ( int8_t *)( addr ) ) ) ? 1LL : 0LL;
 				break;
 			default:
 				if( valid )
@@ -1412,9 +2205,9 @@ uint64_t SCppObj::longValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 				break;
 		}
 
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( locked )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 	} else {
 		if( valid )
@@ -1448,9 +2241,19 @@ uint32_t SCppObj::intValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 	uint32_t result = 0;
 	if( tst )
 	{
-		if( protect )
+		uint64_t	copy[ SCPP_SEQ_MAX / sizeof( uint64_t ) ];
+		uint64_t	addr = ((uint64_t ) basePtr ) + (uint64_t ) tst->offset;
+		bool		locked = false;
+
+		if( protect && seqRead( tst, copy ) )																					// Got a consistent copy without the lock
 		{
-			waitSem( tst->sem );
+			addr = (uint64_t) copy;
+		} else if( protect && ! ( locked = waitSem( tst->lock ) ) ) {
+			if( valid )
+			{
+				*valid = false;
+			}
+			return result;
 		}
 		if( valid )
 		{
@@ -1459,25 +2262,25 @@ uint32_t SCppObj::intValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 		switch ( tst->type )
 		{
 			case SL_TYPE_CHAR:
-				result = strtol( ( ( char *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ), NULL, 0 );
+				result = strtol( ( ( char *)( addr ) ), NULL, 0 );
 				break;
 			case SL_TYPE_DOUBLE:
-				result =  (int32_t) *((double *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result =  (int32_t) *((double *)( addr ) );
 				break;
 			case SL_TYPE_INT64:
-				result = (uint32_t) *( ( int64_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint32_t) *( ( int64_t *)( addr ) );
 				break;
 			case SL_TYPE_INT32:
-				result = (uint32_t) *( ( int32_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint32_t) *( ( int32_t *)( addr ) );
 				break;
 			case SL_TYPE_INT16:
-				result = (uint32_t) *( ( int16_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint32_t) *( ( int16_t *)( addr ) );
 				break;
 			case SL_TYPE_INT8:
-				result = (uint32_t) *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				result = (uint32_t) *( ( int8_t *)( addr ) );
 				break;
 			case SL_TYPE_BOOL:
-				result = ( 0 != *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) ) ? 1 : 0;
+				result = ( 0 != *( ( int8_t *)( addr ) ) ) ? 1 : 0;
 				break;
 			default:
 				if( valid )
@@ -1486,9 +2289,9 @@ uint32_t SCppObj::intValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 				}
 				break;
 		}
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( locked )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 	} else {
 		if( valid )
@@ -1521,9 +2324,19 @@ bool SCppObj::boolValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 	bool result = false;
 	if( tst )
 	{
-		if( protect )
+		uint64_t	copy[ SCPP_SEQ_MAX / sizeof( uint64_t ) ];
+		uint64_t	addr = ((uint64_t ) basePtr ) + (uint64_t ) tst->offset;
+		bool		locked = false;
+
+		if( protect && seqRead( tst, copy ) )																					// Got a consistent copy without the lock
 		{
-			waitSem( tst->sem );
+			addr = (uint64_t) copy;
+		} else if( protect && ! ( locked = waitSem( tst->lock ) ) ) {
+			if( valid )
+			{
+				*valid = false;
+			}
+			return result;
 		}
 		if( valid )
 		{
@@ -1532,22 +2345,22 @@ bool SCppObj::boolValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 		switch ( tst->type )
 		{
 			case SL_TYPE_CHAR:
-				result = ( 0 == strcasecmp( ( ( char *)( (uint64_t ) basePtr ) + (uint64_t ) tst->offset ),"true" ) );
+				result = ( 0 == strcasecmp( ( ( char *)addr ),"true" ) );
 				break;
 			case SL_TYPE_DOUBLE:
-				result = ( 0.0 != *((double *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				result = ( 0.0 != *((double *)( addr ) ) );
 				break;
 			case SL_TYPE_INT64:
-				result = ( 0 != *( ( int64_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				result = ( 0 != *( ( int64_t *)( addr ) ) );
 				break;
 			case SL_TYPE_INT32:
-				result = ( 0 != *( ( int32_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				result = ( 0 != *( ( int32_t *)( addr ) ) );
 				break;
 			case SL_TYPE_INT8:
-				result = ( 0 != *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				result = ( 0 != *( ( int8_t *)( addr ) ) );
 				break;
 			case SL_TYPE_BOOL:
-				result = ( 0 != *( ( int8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				result = ( 0 != *( ( int8_t *)( addr ) ) );
 				break;
 			default:
 				if( valid )
@@ -1556,9 +2369,9 @@ bool SCppObj::boolValue( STRUCT_LISTS *tst, bool protect, bool *valid )
 				}
 				break;
 		}
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( locked )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 	} else {
 		if( valid )
@@ -1594,9 +2407,9 @@ const char *SCppObj::readBase64String( STRUCT_LISTS *tst, std::string *result, b
 		buffer[ 63 ] = '\0';
 
 		result->clear();
-		if( protect )
+		if( protect && ! waitSem( tst->lock ) )
 		{
-			waitSem( tst->sem );
+			return NULL;
 		}
 		switch ( tst->type )
 		{
@@ -1678,9 +2491,9 @@ const char *SCppObj::readBase64String( STRUCT_LISTS *tst, std::string *result, b
 			default:
 				break;
 		}
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( protect )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 	}
     return result->c_str();
@@ -1694,14 +2507,20 @@ const char *SCppObj::readString( STRUCT_LISTS *tst, std::string *result, bool pr
 		buffer[ 63 ] = '\0';
 
 		result->clear();
-		if( protect )
+		uint64_t	copy[ SCPP_SEQ_MAX / sizeof( uint64_t ) ];
+		uint64_t	addr = ((uint64_t ) basePtr ) + (uint64_t ) tst->offset;
+		bool		locked = false;
+
+		if( protect && seqRead( tst, copy ) )																					// Got a consistent copy without the lock
 		{
-			waitSem( tst->sem );
+			addr = (uint64_t) copy;
+		} else if( protect && ! ( locked = waitSem( tst->lock ) ) ) {
+			return NULL;
 		}
 		switch ( tst->type )
 		{
 			case SL_TYPE_CHAR:
-				*result = ( (char *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) );
+				*result = ( (char *)( addr ) );
 				break;
 			case SL_TYPE_DOUBLE:
 				{
@@ -1715,7 +2534,7 @@ const char *SCppObj::readString( STRUCT_LISTS *tst, std::string *result, bool pr
 						strcpy( fmt, "%lf" );
 					}
 					buffer[ 63 ] = '\0';
-					snprintf( buffer, 63, fmt,*((double*)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+					snprintf( buffer, 63, fmt,*((double*)( addr ) ) );
 					*result = buffer;
 				}
 				break;
@@ -1739,7 +2558,7 @@ const char *SCppObj::readString( STRUCT_LISTS *tst, std::string *result, bool pr
 #endif
 					}
 					buffer[ 63 ] = '\0';
-					snprintf( buffer, 63, fmt,*((uint64_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+					snprintf( buffer, 63, fmt,*((uint64_t *)( addr ) ) );
 					*result = buffer;
 				}
 				break;
@@ -1755,28 +2574,28 @@ const char *SCppObj::readString( STRUCT_LISTS *tst, std::string *result, bool pr
 						strcpy( fmt, "0x%.8X" );
 					}
 					buffer[ 63 ] = '\0';
-					snprintf( buffer, 63, fmt,*((uint32_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+					snprintf( buffer, 63, fmt,*((uint32_t *)( addr ) ) );
 					*result = buffer;
 				}
 				break;
 			case SL_TYPE_INT16:
-				snprintf( buffer, 63, "0x%.4X",(uint16_t) *((uint16_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				snprintf( buffer, 63, "0x%.4X",(uint16_t) *((uint16_t *)( addr ) ) );
 				*result = buffer;
 				break;
 			case SL_TYPE_INT8:
-				snprintf( buffer, 63, "0x%.2X",(uint8_t) *((uint8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) );
+				snprintf( buffer, 63, "0x%.2X",(uint8_t) *((uint8_t *)( addr ) ) );
 				*result = buffer;
 				break;
 			case SL_TYPE_BOOL:
-				sprintf( buffer,"%s", ( 0  != *((uint8_t *)( ((uint64_t ) basePtr ) + (uint64_t ) tst->offset ) ) ) ? "True" : "False" );
+				sprintf( buffer,"%s", ( 0  != *((uint8_t *)( addr ) ) ) ? "True" : "False" );
 				*result = buffer;
 				break;
 			default:
 				break;
 		}
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( locked )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 	}
     return result->c_str();
@@ -1794,9 +2613,13 @@ char *SCppObj::readString( const char *path, char *result, size_t sz, bool prote
 	if( tst )
 	{
 
-		if( protect )
+		if( protect && ! waitSem( tst->lock ) )
 		{
-			waitSem( tst->sem );
+			if( result && sz )
+			{
+				result[ 0 ] = '\0';
+			}
+			return NULL;
 		}
 		switch ( tst->type )
 		{
@@ -1933,9 +2756,9 @@ char *SCppObj::readString( const char *path, char *result, size_t sz, bool prote
 				result = NULL;
 				break;
 		}
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( protect )
 		{
-			sem_post( tst->sem );
+			postSem( tst->lock );
 		}
 
 	} else {
@@ -1968,10 +2791,11 @@ bool SCppObj::updateString( STRUCT_LISTS *lst, const char *str, bool protect )
 	bool 			rtn = true;
 	if( lst )
 	{
-		if( protect )
+		if( protect && ! waitSem( lst->lock ) )
 		{
-			waitSem( lst->sem );
+			return false;
 		}
+		beginWrite( lst->lock );
 		switch( lst->type )
 		{
 			case SL_TYPE_CHAR:
@@ -2000,10 +2824,14 @@ bool SCppObj::updateString( STRUCT_LISTS *lst, const char *str, bool protect )
 				rtn = false;
 				break;
 		}
-		setUpdateTime( lst );
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( rtn )															// A type it can't take wrote nothing
 		{
-			sem_post( lst->sem );
+			setUpdateTime( lst );
+		}
+		endWrite( lst->lock );
+		if( protect )
+		{
+			postSem( lst->lock );
 		}
 	} else {
 		rtn = false;
@@ -2076,10 +2904,11 @@ bool SCppObj::updateDouble( STRUCT_LISTS *lst, double val, bool protect )
 	bool 			rtn = true;
 	if(  lst )
 	{
-		if( protect )
+		if( protect && ! waitSem( lst->lock ) )
 		{
-			waitSem( lst->sem );
+			return false;
 		}
+		beginWrite( lst->lock );
 		switch( lst->type )
 		{
 			case SL_TYPE_CHAR:
@@ -2119,10 +2948,14 @@ bool SCppObj::updateDouble( STRUCT_LISTS *lst, double val, bool protect )
 				break;
 
 		}
-		setUpdateTime( lst );
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( rtn )															// A type it can't take wrote nothing
 		{
-			sem_post( lst->sem );
+			setUpdateTime( lst );
+		}
+		endWrite( lst->lock );
+		if( protect )
+		{
+			postSem( lst->lock );
 		}
 	} else {
 		rtn = false;
@@ -2135,10 +2968,11 @@ bool SCppObj::updateLong( STRUCT_LISTS *lst, uint64_t val, bool protect )
 
 	if(  lst )
 	{
-		if( protect )
+		if( protect && ! waitSem( lst->lock ) )
 		{
-			waitSem( lst->sem );
+			return false;
 		}
+		beginWrite( lst->lock );
 		switch( lst->type )
 		{
 			case SL_TYPE_CHAR:
@@ -2182,10 +3016,14 @@ bool SCppObj::updateLong( STRUCT_LISTS *lst, uint64_t val, bool protect )
 				break;
 
 		}
-		setUpdateTime( lst );
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( rtn )															// A type it can't take wrote nothing
 		{
-			sem_post( lst->sem );
+			setUpdateTime( lst );
+		}
+		endWrite( lst->lock );
+		if( protect )
+		{
+			postSem( lst->lock );
 		}
 	} else {
 		rtn = false;
@@ -2198,10 +3036,11 @@ bool SCppObj::updateInt( STRUCT_LISTS *lst, uint32_t val, bool protect )
 
 	if(  lst )
 	{
-		if( protect )
+		if( protect && ! waitSem( lst->lock ) )
 		{
-			waitSem( lst->sem );
+			return false;
 		}
+		beginWrite( lst->lock );
 		switch( lst->type )
 		{
 			case SL_TYPE_CHAR:
@@ -2241,10 +3080,14 @@ bool SCppObj::updateInt( STRUCT_LISTS *lst, uint32_t val, bool protect )
 				break;
 
 		}
-		setUpdateTime( lst );
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( rtn )															// A type it can't take wrote nothing
 		{
-			sem_post( lst->sem );
+			setUpdateTime( lst );
+		}
+		endWrite( lst->lock );
+		if( protect )
+		{
+			postSem( lst->lock );
 		}
 	} else {
 		fprintf( stderr, "%s[%d]: Failed to update integer because it wasn't found\n",__FILE__, __LINE__ );
@@ -2258,10 +3101,11 @@ bool SCppObj::updateBoolean( STRUCT_LISTS *lst, bool val, bool protect )
 
 	if(  lst )
 	{
-		if( protect )
+		if( protect && ! waitSem( lst->lock ) )
 		{
-			waitSem( lst->sem );
+			return false;
 		}
+		beginWrite( lst->lock );
 		switch( lst->type )
 		{
 			case SL_TYPE_CHAR:
@@ -2301,10 +3145,14 @@ bool SCppObj::updateBoolean( STRUCT_LISTS *lst, bool val, bool protect )
 				break;
 
 		}
-		setUpdateTime( lst );
-		if( protect )																											// If protected post even if we didn't get the semaphore assuming a stuck one.
+		if( rtn )															// A type it can't take wrote nothing
 		{
-			sem_post( lst->sem );
+			setUpdateTime( lst );
+		}
+		endWrite( lst->lock );
+		if( protect )
+		{
+			postSem( lst->lock );
 		}
 	} else {
 		rtn = false;
@@ -2384,7 +3232,7 @@ bool SCppObj::updateObject( STRUCT_LISTS *lst, COMap *obj, bool protect  )
 {
 	if(  lst && CppON::isMap( obj ) )
 	{
-		for( std::map<std::string, CppON *>::iterator it = obj->begin(); obj->end() != it; it++ )
+		for( COMap::iterator it = obj->begin(); obj->end() != it; it++ )
 		{
 			CppON		&ob = *(it->second);
 
@@ -2503,38 +3351,852 @@ bool SCppObj::update( CppON *obj, STRUCT_LISTS *lst )
 				return false;
 		}
 	}
-	return false;
+	return false;
+}
+
+/*
+ * Turns the events of one JSON message into transaction operations.  Keys are resolved through the path index against the
+ * unit they are in, array elements by position, and anything that isn't in the layout or doesn't fit the value's type is
+ * skipped the way updateObject skips it.  The operations and their values go into buffers that belong to the thread and are
+ * reused from one message to the next so applying a message allocates nothing once they have grown.
+ */
+class SCppJsonApplier : public CppONHandler
+{
+public:
+	SCppJsonApplier( SCppObj *o, STRUCT_LISTS *b ) : obj( o ), base( b ), pending( NULL ), ops( opBuf ), values( valueBuf ), text( textBuf ), stack( stackBuf )
+	{
+		ops.clear();
+		values.clear();
+		text.clear();
+		stack.clear();
+	}
+
+	bool	startObject() { return open( SL_TYPE_UNIT ); }
+	bool	startArray() { return open( SL_TYPE_ARRAY ); }
+	bool	endObject() { stack.pop_back(); return true; }
+	bool	endArray() { stack.pop_back(); return true; }
+	bool	key( const char *k, size_t len ) { pending = ( stack.back().first ) ? obj->lookup( k, len, stack.back().first ) : NULL; return true; }
+	bool	intValue( int64_t v ) { return add( target(), (double) v, v, false ); }
+	bool	doubleValue( double v ) { return add( target(), v, (int64_t) v, false ); }
+	bool	boolValue( bool v ) { STRUCT_LISTS *t = target(); if( t && SL_TYPE_BOOL == t->type ) { return add( t, 0, ( v ) ? 0xFF : 0x00, true ); } return true; }
+	bool	nullValue() { target(); return true; }
+	bool	stringValue( const char *s, size_t len )
+	{
+		STRUCT_LISTS *t = target();
+		if( t && SL_TYPE_CHAR == t->type )
+		{
+			values.push_back( text.size() );
+			text.append( s, len );
+			text += '\0';
+			ops.push_back( SCPP_OP{ t, NULL, true } );
+		}
+		return true;
+	}
+
+	/*
+	 * Point each operation at its value, now the buffers are done growing, and run them as transactions of up to
+	 * SCPP_MAX_UNITS units each.
+	 */
+	bool	apply()
+	{
+		SCPP_LOCK	*units[ SCPP_MAX_UNITS ];
+		unsigned	nUnits = 0;
+		size_t		first = 0;
+		bool		rtn = true;
+
+		for( size_t i = 0; ops.size() > i; i++ )
+		{
+			unsigned j;
+
+			ops[ i ].value = ( SL_TYPE_CHAR == ops[ i ].field->type ) ? (void *) ( &text[ values[ i ] ] ) : (void *) &values[ i ];
+			for( j = 0; nUnits > j && units[ j ] != ops[ i ].field->lock; j++ );
+			if( nUnits == j )
+			{
+				if( SCPP_MAX_UNITS == nUnits )
+				{
+					rtn = obj->transact( &ops[ first ], (unsigned) ( i - first ) ) && rtn;
+					first = i;
+					nUnits = 0;
+				}
+				units[ nUnits++ ] = ops[ i ].field->lock;
+			}
+		}
+		if( ops.size() > first )
+		{
+			rtn = obj->transact( &ops[ first ], (unsigned) ( ops.size() - first ) ) && rtn;
+		}
+		return rtn;
+	}
+
+private:
+	bool	open( uint8_t type )
+	{
+		STRUCT_LISTS *t = ( stack.empty() ) ? base : target();
+		stack.push_back( std::make_pair( ( t && type == t->type ) ? t : NULL, 0U ) );
+		return true;
+	}
+
+	/*
+	 * The element the next value is for, NULL if it isn't one of ours.
+	 */
+	STRUCT_LISTS	*target()
+	{
+		STRUCT_LISTS *t = NULL;
+
+		if( stack.empty() )
+		{
+			t = base;
+		} else if( stack.back().first && SL_TYPE_UNIT == stack.back().first->type ) {
+			t = pending;
+		} else if( stack.back().first && stack.back().first->nSubs > stack.back().second ) {
+			t = &( (STRUCT_LISTS *) stack.back().first->subs )[ stack.back().second ];
+		}
+		if( ! stack.empty() )
+		{
+			stack.back().second++;
+		}
+		pending = NULL;
+		return t;
+	}
+
+	/*
+	 * A number for t, stored the way the segment holds t's type.  raw is forced to be used as is for booleans.
+	 */
+	bool	add( STRUCT_LISTS *t, double d, int64_t i, bool raw )
+	{
+		uint64_t	v = 0;
+
+		if( ! t )
+		{
+			return true;
+		}
+		switch( t->type )
+		{
+			case SL_TYPE_DOUBLE:	memcpy( &v, &d, sizeof( d ) ); break;
+			case SL_TYPE_INT64:		v = (uint64_t) i; break;
+			case SL_TYPE_INT32:		v = (uint32_t) i; break;
+			case SL_TYPE_INT16:		v = (uint16_t) i; break;
+			case SL_TYPE_INT8:		v = (uint8_t) i; break;
+			case SL_TYPE_BOOL:
+				if( ! raw )
+				{
+					return true;
+				}
+				v = (uint8_t) i;
+				break;
+			default:
+				return true;
+		}
+		values.push_back( v );
+		ops.push_back( SCPP_OP{ t, NULL, true } );
+		return true;
+	}
+
+	SCppObj											*obj;
+	STRUCT_LISTS									*base;
+	STRUCT_LISTS									*pending;				// Element the last key named
+	std::vector<SCPP_OP>							&ops;
+	std::vector<uint64_t>							&values;				// Each op's value, or for a string where it is in text
+	std::string										&text;
+	std::vector<std::pair<STRUCT_LISTS *, unsigned> >	&stack;					// Open containers and the next array position
+
+	static thread_local std::vector<SCPP_OP>		opBuf;
+	static thread_local std::vector<uint64_t>		valueBuf;
+	static thread_local std::string					textBuf;
+	static thread_local std::vector<std::pair<STRUCT_LISTS *, unsigned> >	stackBuf;
+};
+
+thread_local std::vector<SCPP_OP>						SCppJsonApplier::opBuf;
+thread_local std::vector<uint64_t>						SCppJsonApplier::valueBuf;
+thread_local std::string								SCppJsonApplier::textBuf;
+thread_local std::vector<std::pair<STRUCT_LISTS *, unsigned> >	SCppJsonApplier::stackBuf;
+
+/*
+ * Store a JSON message into the layout under base (the whole object by default) without building a tree.  Every value the
+ * message has for an element of the layout is written, under the locks of the units it touches, once the whole message has
+ * parsed;  a message that doesn't parse changes nothing.  Messages touching up to SCPP_MAX_UNITS units are applied as one
+ * transaction, larger ones as a transaction per SCPP_MAX_UNITS units in document order.  A message that doesn't parse
+ * returns false with the reason in err;  false with err.code CPPON_PARSE_OK means it parsed but a unit couldn't be locked.
+ */
+bool SCppObj::applyJson( const char *json, size_t len, CppONParseError &err, STRUCT_LISTS *base )
+{
+	SCppJsonApplier		h( this, ( base ) ? base : list );
+
+	if( ! json )
+	{
+		err.code = CPPON_PARSE_UNEXPECTED_END;
+		err.offset = 0;
+		err.line = 1;
+		err.column = 1;
+		err.consumed = 0;
+		return false;
+	}
+	if( ! CppON::parseEvents( json, len, h, err ) )
+	{
+		return false;
+	}
+	return h.apply();
+}
+
+/*
+ * Wait up to "to" milliseconds for lst to be updated after "start" (default now.)  Rather than poll the time we sleep on the
+ * unit's generation and check again each time something in the unit is written.
+ */
+bool SCppObj::waitForUpdate( STRUCT_LISTS *lst,  uint64_t start, uint64_t to )
+{
+	struct timespec		tsp;
+	uint64_t			now;
+	bool 				rtn = false;
+
+	clock_gettime( CLOCK_MONOTONIC, &tsp);
+	now = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) );
+	if( ! start )
+	{
+		start = now;
+	}
+	to += now;
+
+	if( lst && lst->lock )
+	{
+		uint32_t		gen = generation( lst );
+		while( ! ( rtn = ( latestUpdate( lst ) > start ) ) && to > now )
+		{
+			waitForChange( lst, gen, ( to - now ) * 1000000LL );
+			clock_gettime( CLOCK_MONOTONIC, &tsp);
+			now = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) );
+		}
+	}
+	return rtn;
+}
+
+/*
+ * Most recent update time of a value, or of anything in a unit or array.
+ */
+uint64_t SCppObj::latestUpdate( STRUCT_LISTS *lst )
+{
+	uint64_t	rtn = 0;
+	if( SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
+	{
+		for( unsigned i = 0; lst->nSubs > i; i++ )
+		{
+			uint64_t t = latestUpdate( &( (STRUCT_LISTS *) lst->subs )[ i ] );
+			if( t > rtn )
+			{
+				rtn = t;
+			}
+		}
+	} else if( lst->time ) {
+		rtn = *((uint64_t *)((char*) basePtr + lst->time ) );
+	}
+	return rtn;
+}
+
+/*
+ * Generations count the writes to a unit (values share the generation of the unit they are in.)  Unlike the millisecond
+ * update times two writes can never look like one.
+ */
+uint32_t SCppObj::generation( STRUCT_LISTS *lst )
+{
+	if( lst && lst->lock )
+	{
+		return __atomic_load_n( &lst->lock->sequence, __ATOMIC_ACQUIRE ) & ~1U;
+	}
+	return 0;
+}
+
+/*
+ * Block up to ns nanoseconds for the generation of lst to move past gen.  Returns true, with gen updated, if it did.
+ */
+bool SCppObj::waitForChange( STRUCT_LISTS *lst, uint32_t &gen, uint64_t ns )
+{
+	bool		rtn = false;
+
+	if( lst && lst->lock )
+	{
+		SCPP_LOCK	*lock = lst->lock;
+		uint64_t	end = monotonicNs() + ns;
+		uint64_t	now;
+
+		__atomic_fetch_add( &lock->waiters, 1, __ATOMIC_SEQ_CST );
+		for( ;; )
+		{
+			uint32_t s = __atomic_load_n( &lock->sequence, __ATOMIC_SEQ_CST );
+			if( ( s & ~1U ) != gen )
+			{
+				gen = s & ~1U;
+				rtn = true;
+				break;
+			}
+			if( end <= ( now = monotonicNs() ) )
+			{
+				break;
+			}
+			futexWait( &lock->sequence, s, end - now );
+		}
+		__atomic_fetch_sub( &lock->waiters, 1, __ATOMIC_SEQ_CST );
+	}
+	return rtn;
+}
+
+/*
+ * Wait on several units at once.  gens holds the generation last seen for each;  returns the index of the first one that
+ * changed (updating its generation) or -1 if none did within ns nanoseconds.
+ */
+int SCppObj::waitForChange( STRUCT_LISTS **lsts, uint32_t *gens, unsigned n, uint64_t ns )
+{
+	int			rtn = -1;
+
+	if( lsts && gens && notify )
+	{
+		uint64_t	end = monotonicNs() + ns;
+		uint64_t	now;
+
+		__atomic_fetch_add( &notify->waiters, 1, __ATOMIC_SEQ_CST );
+		for( ;; )
+		{
+			uint32_t g = __atomic_load_n( &notify->sequence, __ATOMIC_SEQ_CST );
+			for( unsigned i = 0; n > i && 0 > rtn; i++ )
+			{
+				uint32_t s = generation( lsts[ i ] );
+				if( lsts[ i ] && s != gens[ i ] )
+				{
+					gens[ i ] = s;
+					rtn = (int) i;
+				}
+			}
+			if( 0 <= rtn || end <= ( now = monotonicNs() ) )
+			{
+				break;
+			}
+			futexWait( &notify->sequence, g, end - now );
+		}
+		__atomic_fetch_sub( &notify->waiters, 1, __ATOMIC_SEQ_CST );
+	}
+	return rtn;
+}
+
+/*
+ * Apply a list of reads and writes as one transaction.  Every unit involved is locked once, in address order so two
+ * transactions can never deadlock, each unit written gets one sequence bump and all the writes share one time stamp.
+ * Returns false without touching anything if a lock couldn't be had or an op is bad, err says which.
+ */
+bool SCppObj::transact( SCPP_OP *ops, unsigned n, SCPP_TRANSACT_ERROR &err )
+{
+	SCPP_LOCK	*held[ SCPP_MAX_UNITS ];
+	bool		written[ SCPP_MAX_UNITS ];
+	unsigned	nHeld = 0;
+	unsigned	i;
+	unsigned	j;
+
+	err.code = SCPP_TRANSACT_OK;
+	err.op = 0;
+	for( i = 0; n > i; i++ )
+	{
+		STRUCT_LISTS *lst = ops[ i ].field;
+		if( ! lst || ! lst->lock || ! ops[ i ].value || SL_TYPE_NONE == lst->type || SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
+		{
+			err.code = SCPP_TRANSACT_NOT_A_VALUE;
+			err.op = i;
+			return false;
+		}
+		for( j = 0; nHeld > j && held[ j ] != lst->lock; j++ );
+		if( nHeld == j )
+		{
+			if( SCPP_MAX_UNITS == nHeld )
+			{
+				err.code = SCPP_TRANSACT_TOO_MANY_UNITS;
+				err.op = i;
+				return false;
+			}
+			held[ nHeld++ ] = lst->lock;
+		}
+	}
+	std::sort( held, held + nHeld );
+	for( i = 0; nHeld > i; i++ )
+	{
+		if( ! waitSem( held[ i ] ) )
+		{
+			err.code = SCPP_TRANSACT_NO_LOCK;
+			err.op = i;
+			while( i-- )
+			{
+				postSem( held[ i ] );
+			}
+			return false;
+		}
+		written[ i ] = false;
+	}
+
+	for( i = 0; n > i; i++ )
+	{
+		if( ops[ i ].write )
+		{
+			for( j = 0; held[ j ] != ops[ i ].field->lock; j++ );
+			if( ! written[ j ] )
+			{
+				written[ j ] = true;
+				beginWrite( held[ j ] );
+			}
+		}
+	}
+
+	struct timespec tsp;
+	clock_gettime( CLOCK_MONOTONIC, &tsp );
+	uint64_t t = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) );
+
+	for( i = 0; n > i; i++ )
+	{
+		STRUCT_LISTS	*lst = ops[ i ].field;
+		char			*addr = (char *) basePtr + lst->offset;
+		if( ! ops[ i ].write )
+		{
+			memcpy( ops[ i ].value, addr, lst->size );
+		} else {
+			if( SL_TYPE_CHAR == lst->type )
+			{
+				addr[ lst->size - 1 ] = '\0';
+				strncpy( addr, (const char *) ops[ i ].value, lst->size - 1 );
+			} else if( SL_TYPE_BOOL == lst->type ) {
+				*( (uint8_t *) addr ) = ( *( (uint8_t *) ops[ i ].value ) ) ? 0xFF : 0x00;
+			} else {
+				memcpy( addr, ops[ i ].value, lst->size );
+			}
+			setUpdateTime( lst, t );
+		}
+	}
+
+	for( i = nHeld; i--; )
+	{
+		if( written[ i ] )
+		{
+			endWrite( held[ i ] );
+		}
+		postSem( held[ i ] );
+	}
+	return true;
+}
+
+/*
+ * Which of the segment's regions values of a type are stored in.  Returns SCPP_REGIONS for units, arrays and anything else
+ * that doesn't hold a value.
+ */
+unsigned SCppObj::region( uint8_t type )
+{
+	switch( type )
+	{
+		case SL_TYPE_DOUBLE:	return 1;
+		case SL_TYPE_INT64:		return 2;
+		case SL_TYPE_INT32:		return 3;
+		case SL_TYPE_INT16:		return 4;
+		case SL_TYPE_INT8:
+		case SL_TYPE_BOOL:		return 5;
+		case SL_TYPE_CHAR:		return 6;
+		default:				return SCPP_REGIONS;
+	}
+}
+
+/*
+ * Record where lst, and every unit and array in it, is in the segment.  regionStart is the offset of each region (the time
+ * stamp offsets are already absolute.)  The extents are numbered the way assignLocks numbers the locks so a unit's extent is
+ * found from its lock.  A unit whose definition has "doubleBuffer": true is marked to get a publish area.  Returns the number
+ * of lst's extent.
+ */
+uint32_t SCppObj::buildExtents( STRUCT_LISTS *lst, const uint32_t *regionStart )
+{
+	uint32_t	idx = (uint32_t) extents.size();
+	SCPP_EXTENT	ext;
+	CppON		*oPtr;
+	unsigned	r;
+
+	memset( &ext, 0, sizeof( ext ) );
+	for( r = 0; SCPP_REGIONS > r; r++ )
+	{
+		ext.start[ r ] = ~0U;
+	}
+	extents.push_back( ext );
+
+	for( unsigned i = 0; lst->nSubs > i; i++ )
+	{
+		STRUCT_LISTS *ls = &( (STRUCT_LISTS *) lst->subs )[ i ];
+		if( SL_TYPE_UNIT == ls->type || SL_TYPE_ARRAY == ls->type )
+		{
+			SCPP_EXTENT sub = extents[ buildExtents( ls, regionStart ) ];
+			for( r = 0; SCPP_REGIONS > r; r++ )
+			{
+				if( sub.end[ r ] > sub.start[ r ] )
+				{
+					ext.start[ r ] = std::min( ext.start[ r ], sub.start[ r ] );
+					ext.end[ r ] = std::max( ext.end[ r ], sub.end[ r ] );
+				}
+			}
+		} else if( SCPP_REGIONS > ( r = region( ls->type ) ) ) {
+			if( fields.size() > fieldId( ls ) )
+			{
+				fields[ fieldId( ls ) ] = ls;
+			}
+			ext.start[ r ] = std::min( ext.start[ r ], regionStart[ r ] + ls->offset );
+			ext.end[ r ] = std::max( ext.end[ r ], regionStart[ r ] + ls->offset + ls->size );
+			ext.start[ 0 ] = std::min( ext.start[ 0 ], ls->time );
+			ext.end[ 0 ] = std::max( ext.end[ 0 ], ls->time + (uint32_t) sizeof( uint64_t ) );
+		}
+	}
+
+	for( r = 0; SCPP_REGIONS > r; r++ )
+	{
+		if( ext.end[ r ] <= ext.start[ r ] )
+		{
+			ext.start[ r ] = ext.end[ r ] = 0;
+		}
+		ext.snap[ r ] = ext.size;
+		ext.size += ext.end[ r ] - ext.start[ r ];
+	}
+	ext.size = ( ext.size + 7 ) & ~7U;
+	ext.locks = (uint32_t) extents.size() - idx;
+	ext.publish = ( list != lst && lst->def && CppON::isBoolean( oPtr = lst->def->findCaseElement( "doubleBuffer" ) ) && ( (COBoolean *) oPtr )->value() ) ? 1 : 0;
+	extents[ idx ] = ext;
+	return idx;
+}
+
+/*
+ * The extent of a unit or array, NULL for anything else or if we aren't attached to a segment.
+ */
+SCPP_EXTENT *SCppObj::extent( STRUCT_LISTS *unit )
+{
+	if( basePtr && unit && unit->lock && ( SL_TYPE_UNIT == unit->type || SL_TYPE_ARRAY == unit->type ) )
+	{
+		// cppcheck-suppress cstyleCast
+		size_t idx = (size_t) ( unit->lock - (SCPP_LOCK *) ( (char *) basePtr + lockOffset ) );
+		if( extents.size() > idx )
+		{
+			return &extents[ idx ];
+		}
+	}
+	return NULL;
+}
+
+void SCppObj::copyUnit( const SCPP_EXTENT *ext, void *dst )
+{
+	for( unsigned r = 0; SCPP_REGIONS > r; r++ )
+	{
+		if( ext->end[ r ] > ext->start[ r ] )
+		{
+			memcpy( (char *) dst + ext->snap[ r ], (char *) basePtr + ext->start[ r ], ext->end[ r ] - ext->start[ r ] );
+		}
+	}
+}
+
+/*
+ * Copy a whole unit (its values, their time stamps and everything in the units and arrays in it) into dst, which has to hold
+ * at least snapshotSize( unit ) bytes and should be eight byte aligned.  The copy is checked against the sequence of every
+ * lock in the unit and if writers keep getting in the way, or the unit has more than SCPP_MAX_UNITS locks, they are all
+ * taken, in lock table order, for the copy.  If it returns false dst may hold a partial copy.  Use snapshotPointer or an
+ * SCppSnapshot to find values in the copy.
+ */
+bool SCppObj::snapshot( STRUCT_LISTS *unit, void *dst, bool protect )
+{
+	SCPP_EXTENT		*ext = extent( unit );
+	SCPP_LOCK		*locks;
+	unsigned		i;
+	bool			rtn = false;
+
+	if( ! ext || ! dst )
+	{
+		return false;
+	}
+	if( ! protect )
+	{
+		copyUnit( ext, dst );
+		return true;
+	}
+	locks = unit->lock;																		// A unit's locks are consecutive
+	if( seqReads && SCPP_MAX_UNITS >= ext->locks )
+	{
+		uint32_t	seq[ SCPP_MAX_UNITS ];
+		for( unsigned tries = 0; SCPP_SEQ_TRIES > tries; tries++ )
+		{
+			for( i = 0; ext->locks > i && !( 1 & ( seq[ i ] = __atomic_load_n( &locks[ i ].sequence, __ATOMIC_ACQUIRE ) ) ); i++ );
+			if( ext->locks == i )
+			{
+				copyUnit( ext, dst );
+				__atomic_thread_fence( __ATOMIC_ACQUIRE );
+				for( i = 0; ext->locks > i && seq[ i ] == __atomic_load_n( &locks[ i ].sequence, __ATOMIC_RELAXED ); i++ );
+				if( ext->locks == i )
+				{
+					return true;
+				}
+			}
+		}
+	}
+	for( i = 0; ext->locks > i && waitSem( &locks[ i ] ); i++ );
+	if( ext->locks == i )
+	{
+		copyUnit( ext, dst );
+		rtn = true;
+	}
+	while( i )
+	{
+		postSem( &locks[ --i ] );
+	}
+	return rtn;
+}
+
+/*
+ * Where field is in a snapshot of unit.  NULL if it isn't a value in the unit.
+ */
+const void *SCppObj::snapshotPointer( STRUCT_LISTS *unit, STRUCT_LISTS *field, const void *snap )
+{
+	SCPP_EXTENT		*ext = extent( unit );
+	unsigned		r;
+
+	if( ext && snap && field && SCPP_REGIONS > ( r = region( field->type ) ) && ext->start[ r ] <= field->offset && ext->end[ r ] >= field->offset + field->size )
+	{
+		return (const char *) snap + ext->snap[ r ] + ( field->offset - ext->start[ r ] );
+	}
+	return NULL;
+}
+
+/*
+ * Where the versions of a value, or of every value in a unit or array, are in the segment.  A unit's versions are contiguous
+ * so one compare tells if anything in it has been written.  Returns false if the layout has no versions.
+ */
+bool SCppObj::versionRange( STRUCT_LISTS *lst, uint32_t &offset, uint32_t &bytes )
+{
+	SCPP_EXTENT		*ext;
+
+	if( ! versionOffset || ! lst )
+	{
+		return false;
+	}
+	if( ( ext = extent( lst ) ) )
+	{
+		offset = ( ext->end[ 0 ] ) ? versionOffset + ( ( ext->start[ 0 ] - 0x20 ) >> 1 ) : versionOffset;
+		bytes = ( ext->end[ 0 ] - ext->start[ 0 ] ) >> 1;
+		return true;
+	} else if( 0x20 <= lst->time && SL_TYPE_UNIT != lst->type && SL_TYPE_ARRAY != lst->type ) {
+		offset = versionOffset + ( ( lst->time - 0x20 ) >> 1 );
+		bytes = sizeof( uint32_t );
+		return true;
+	}
+	return false;
+}
+
+/*
+ * The change journal.  Every store appends a record holding the field, its new version and (up to SCPP_JOURNAL_VALUE bytes
+ * of) its new value to a ring in the segment.  Writers claim a position with one atomic add and mark the record incomplete
+ * while they fill it in, so subscribers never lock anything:  each keeps its own cursor and reads the records after it.  A
+ * subscriber that falls more than a ring behind is told how many records it lost and moved up to the oldest one left.
+ */
+void SCppObj::appendJournal( STRUCT_LISTS *lst, uint32_t version, uint64_t t )
+{
+	// cppcheck-suppress cstyleCast
+	SCPP_JOURNAL		*jnl = (SCPP_JOURNAL *) ( (char *) basePtr + journalOffset );
+	uint64_t			pos = __atomic_fetch_add( &jnl->head, 1, __ATOMIC_RELAXED );
+	// cppcheck-suppress cstyleCast
+	SCPP_JOURNAL_RECORD	*rec = &( (SCPP_JOURNAL_RECORD *) ( (char *) jnl + 64 ) )[ pos & journalMask ];
+
+	__atomic_store_n( &rec->position, 0, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+	rec->time = t;
+	rec->field = fieldId( lst );
+	rec->version = version;
+	rec->size = lst->size;
+	memcpy( rec->value, (char *) basePtr + lst->offset, std::min( lst->size, (uint32_t) SCPP_JOURNAL_VALUE ) );
+	__atomic_store_n( &rec->position, pos + 1, __ATOMIC_SEQ_CST );
+	if( __atomic_load_n( &jnl->waiters, __ATOMIC_SEQ_CST ) )
+	{
+		__atomic_fetch_add( &jnl->wake, 1, __ATOMIC_SEQ_CST );
+		futexWake( &jnl->wake );
+	}
+}
+
+/*
+ * Where the journal is now.  A new subscriber starts its cursor here to see only changes from now on.
+ */
+uint64_t SCppObj::journalPosition()
+{
+	// cppcheck-suppress cstyleCast
+	return ( journalOffset ) ? __atomic_load_n( &( (SCPP_JOURNAL *) ( (char *) basePtr + journalOffset ) )->head, __ATOMIC_ACQUIRE ) : 0;
+}
+
+/*
+ * Copy up to max records after cursor into out and move the cursor past them.  Stops early at a record that is still being
+ * written.  If lost is given it gets the number of records that were overwritten before we got to them.  Returns the number
+ * of records copied.
+ */
+unsigned SCppObj::readJournal( uint64_t &cursor, SCPP_JOURNAL_RECORD *out, unsigned max, uint64_t *lost )
+{
+	unsigned	n = 0;
+
+	if( lost )
+	{
+		*lost = 0;
+	}
+	if( ! journalOffset || ! out )
+	{
+		return 0;
+	}
+	// cppcheck-suppress cstyleCast
+	SCPP_JOURNAL		*jnl = (SCPP_JOURNAL *) ( (char *) basePtr + journalOffset );
+	// cppcheck-suppress cstyleCast
+	SCPP_JOURNAL_RECORD	*ring = (SCPP_JOURNAL_RECORD *) ( (char *) jnl + 64 );
+
+	while( max > n )
+	{
+		uint64_t head = __atomic_load_n( &jnl->head, __ATOMIC_ACQUIRE );
+		if( head <= cursor )
+		{
+			break;
+		}
+		if( head - cursor > (uint64_t) journalMask + 1 )											// Fell behind
+		{
+			if( lost )
+			{
+				*lost += head - cursor - journalMask - 1;
+			}
+			cursor = head - journalMask - 1;
+		}
+
+		SCPP_JOURNAL_RECORD	*rec = &ring[ cursor & journalMask ];
+		uint64_t			p = __atomic_load_n( &rec->position, __ATOMIC_ACQUIRE );
+		if( p == cursor + 1 )
+		{
+			out[ n ] = *rec;
+			__atomic_thread_fence( __ATOMIC_ACQUIRE );
+			if( p == __atomic_load_n( &rec->position, __ATOMIC_RELAXED ) )
+			{
+				n++;
+				cursor++;
+				continue;
+			}
+		} else if( p <= cursor ) {																	// Not finished yet
+			break;
+		}
+		if( lost )																					// Overwritten while we looked
+		{
+			(*lost)++;
+		}
+		cursor++;
+	}
+	return n;
+}
+
+/*
+ * Sleep until there are records after cursor or ns nanoseconds pass.  Returns true if there are.
+ */
+bool SCppObj::waitJournal( uint64_t cursor, uint64_t ns )
+{
+	bool		rtn = false;
+
+	if( journalOffset )
+	{
+		// cppcheck-suppress cstyleCast
+		SCPP_JOURNAL	*jnl = (SCPP_JOURNAL *) ( (char *) basePtr + journalOffset );
+		uint64_t		end = monotonicNs() + ns;
+		uint64_t		now;
+
+		__atomic_fetch_add( &jnl->waiters, 1, __ATOMIC_SEQ_CST );
+		for( ;; )
+		{
+			uint32_t w = __atomic_load_n( &jnl->wake, __ATOMIC_SEQ_CST );
+			if( __atomic_load_n( &jnl->head, __ATOMIC_SEQ_CST ) > cursor )
+			{
+				rtn = true;
+				break;
+			}
+			if( end <= ( now = monotonicNs() ) )
+			{
+				break;
+			}
+			futexWait( &jnl->wake, w, end - now );
+		}
+		__atomic_fetch_sub( &jnl->waiters, 1, __ATOMIC_SEQ_CST );
+	}
+	return rtn;
+}
+
+/*
+ * Double buffered units.  publish() copies the unit, under all of its locks, into the buffer readers aren't using and then
+ * flips the index, so readPublished() gets the whole unit as of a publish without taking a lock.  Readers don't register
+ * anywhere:  each buffer counts the copies made into it, the way a unit's lock counts writes, and a reader checks the count
+ * it started with is still there when it is done.  The writer never waits on readers, so a reader that dies part way
+ * through a copy holds nothing up.
+ */
+bool SCppObj::publish( STRUCT_LISTS *unit )
+{
+	SCPP_EXTENT		*ext = extent( unit );
+	SCPP_PUBLISH	*pub;
+	unsigned		i;
+	bool			rtn = false;
+
+	if( ! ext || ! ext->publish )
+	{
+		return false;
+	}
+	// cppcheck-suppress cstyleCast
+	pub = (SCPP_PUBLISH *) ( (char *) basePtr + ext->publish );
+	for( i = 0; ext->locks > i && waitSem( &unit->lock[ i ] ); i++ );
+	if( ext->locks == i )
+	{
+		uint32_t	back = 1 ^ __atomic_load_n( &pub->index, __ATOMIC_RELAXED );
+
+		__atomic_fetch_add( &pub->seq[ back ], 1, __ATOMIC_RELAXED );
+		__atomic_thread_fence( __ATOMIC_RELEASE );
+		copyUnit( ext, (char *) pub + 64 + back * ext->size );
+		__atomic_fetch_add( &pub->seq[ back ], 1, __ATOMIC_RELEASE );
+		__atomic_store_n( &pub->index, back, __ATOMIC_SEQ_CST );
+		__atomic_fetch_add( &pub->count, 1, __ATOMIC_RELEASE );
+		rtn = true;
+	}
+	while( i )
+	{
+		postSem( &unit->lock[ --i ] );
+	}
+	return rtn;
 }
 
-bool SCppObj::waitForUpdate( STRUCT_LISTS *lst,  uint64_t start, uint64_t to )
+/*
+ * Copy the last published copy of a double buffered unit into dst (see snapshot.)  Units that aren't double buffered, or
+ * haven't been published yet, get a snapshot of the live unit.  A copy is only torn if the unit is published twice while
+ * it is being made;  after SCPP_SEQ_TRIES of those the copy is made under the unit's lock, which publish() holds.
+ */
+bool SCppObj::readPublished( STRUCT_LISTS *unit, void *dst )
 {
-	struct timespec		tsp;
-	uint64_t			now;
-	bool 				rtn = false;
+	SCPP_EXTENT		*ext = extent( unit );
+	SCPP_PUBLISH	*pub;
+	uint32_t		idx;
 
-	clock_gettime( CLOCK_MONOTONIC, &tsp);
-	now = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) );
-	if( ! start )
+	if( ! ext || ! dst )
 	{
-		start = now;
+		return false;
 	}
-	to += now;
-
-	if( lst )
+	// cppcheck-suppress cstyleCast
+	pub = (SCPP_PUBLISH *) ( (char *) basePtr + ext->publish );
+	if( ! ext->publish || ! __atomic_load_n( &pub->count, __ATOMIC_ACQUIRE ) )
+	{
+		return snapshot( unit, dst );
+	}
+	for( unsigned tries = 0; SCPP_SEQ_TRIES > tries; tries++ )
 	{
-		do
+		idx = __atomic_load_n( &pub->index, __ATOMIC_ACQUIRE );
+		uint32_t	seq = __atomic_load_n( &pub->seq[ idx ], __ATOMIC_ACQUIRE );
+		if( ! ( 1 & seq ) )
 		{
-			if( *((uint64_t *)((char*) basePtr + lst->time ) ) > start )
+			memcpy( dst, (char *) pub + 64 + idx * ext->size, ext->size );
+			__atomic_thread_fence( __ATOMIC_ACQUIRE );
+			if( seq == __atomic_load_n( &pub->seq[ idx ], __ATOMIC_RELAXED ) )
 			{
-				rtn = true;
-				break;
+				return true;
 			}
-            usleep( 50 );
-			clock_gettime( CLOCK_MONOTONIC, &tsp);
-			now = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) );
-		} while( ! rtn && to > now );
+		}
 	}
-	return rtn;
+	if( ! waitSem( unit->lock ) )
+	{
+		return false;
+	}
+	idx = __atomic_load_n( &pub->index, __ATOMIC_ACQUIRE );
+	memcpy( dst, (char *) pub + 64 + idx * ext->size, ext->size );
+	postSem( unit->lock );
+	return true;
 }
 
 bool SCppObj::equals( CppON &obj, STRUCT_LISTS *lst )
@@ -2632,6 +4294,14 @@ bool SCppObj::equals( CppON &obj, STRUCT_LISTS *lst )
 void SCppObj::deleteStructList( STRUCT_LISTS *lst, std::string indent )
 {
 	indent += '\t';
+	if( list == lst )
+	{
+		pathIndex.clear();
+		pathEntries.clear();
+		pathText.clear();
+		extents.clear();
+		fields.clear();
+	}
 	if( SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
 	{
 		unsigned i;
@@ -2703,7 +4373,7 @@ void SCppObj::printStructList( STRUCT_LISTS *lst, std::string indent )
 	}
 }
 
-void SCppObj::arrayDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name, sem_t *sem )
+void SCppObj::arrayDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name )
 {
 	indent += '\t';
 	for( unsigned units = 0; lst->names[ 2 * units ]; units++ )
@@ -2726,13 +4396,10 @@ void SCppObj::arrayDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent,
 			}
 			if( ! strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 			{
-			    ls->sem = openSem();
-				unitDefaults( (COMap *) mp, ls, indent, c, ls->sem );
+				unitDefaults( (COMap *) mp, ls, indent, c );
 			} else if( ! strcasecmp( typ.c_str(), SCppObj_ARRAY ) ) {
-			    ls->sem = openSem();
-				arrayDefaults( (COMap *) mp, ls, indent, c, ls->sem );
+				arrayDefaults( (COMap *) mp, ls, indent, c );
 			} else {
-				ls->sem = sem;
 				if( ! ( dPtr = mp->findCaseElement( "defaultValue" ) )  )
 				{
 					throw std::invalid_argument( "Invalid configuration file.  All base classes must be provided a default value!" );
@@ -2787,7 +4454,7 @@ void SCppObj::arrayDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent,
 	}
 }
 
-void SCppObj::unitDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name, sem_t *sem )
+void SCppObj::unitDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name )
 {
 	indent += '\t';
 
@@ -2811,13 +4478,10 @@ void SCppObj::unitDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, c
 			}
 			if( ! strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 			{
-			    ls->sem = openSem();
-				unitDefaults( (COMap *) mp, ls, indent, c, ls->sem );
+				unitDefaults( (COMap *) mp, ls, indent, c );
 			} else if( ! strcasecmp( typ.c_str(), SCppObj_ARRAY ) ) {
-			    ls->sem = openSem();
-				arrayDefaults( (COMap *) mp, ls, indent, c, ls->sem );
+				arrayDefaults( (COMap *) mp, ls, indent, c );
 			} else {
-				ls->sem = sem;
 				if( ! ( dPtr = mp->findCaseElement( "defaultValue" ) )  )
 				{
 					throw std::invalid_argument( "Invalid configuration file.  All base classes must be provided a default value!" );
@@ -2872,16 +4536,12 @@ void SCppObj::unitDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, c
 	}
 }
 
-void SCppObj::listArraySems( COMap *def, STRUCT_LISTS *lst, sem_t *sem )
+void SCppObj::listArraySems( COMap *def, STRUCT_LISTS *lst )
 {
-	for( unsigned units = 0; lst->names[ 2 * units ]; units++ )
-	{
-		const char 	*c = lst->names[ (2 * units ) + 1 ];
-		fprintf( stderr, "%s[ %.4u]: %s\n", __FILE__, __LINE__, c);
-	}
+	listSems( def, lst );																		// Array elements are laid out the same way as unit members
 }
 
-void SCppObj::listSems( COMap *def, STRUCT_LISTS *lst, sem_t *sem )
+void SCppObj::listSems( COMap *def, STRUCT_LISTS *lst )
 {
 	for( unsigned units = 0; lst->names[ 2 * units ]; units++ )
 	{
@@ -2899,16 +4559,12 @@ void SCppObj::listSems( COMap *def, STRUCT_LISTS *lst, sem_t *sem )
 			}
 			if( ! strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 			{
-			    ls->sem = openSem();
-				listSems( (COMap *) mp, ls, ls->sem );
+				listSems( (COMap *) mp, ls );
 			} else if( !strcasecmp( typ.c_str(), SCppObj_ARRAY ) ) {
-			    ls->sem = openSem();
-			    listArraySems( ( COMap *) mp, ls, ls->sem );
+			    listArraySems( ( COMap *) mp, ls );
 			} else {
-				ls->sem = sem;
 				CppON		*oPtr;
 
-				ls->sem = lst->sem;
 				if( !strcasecmp( typ.c_str(), SCppObj_INT ) ) {
 					int sz = 4;
 
@@ -2943,90 +4599,156 @@ void SCppObj::listSems( COMap *def, STRUCT_LISTS *lst, sem_t *sem )
 	}
 }
 
-void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
+/*
+ * The first word of the segment as bytes:  the marker, then the low three bytes of pid (Linux pids fit in 22 bits.)
+ */
+static uint32_t initWord( uint8_t marker, uint32_t pid )
 {
-	bool	validInit = false;																							// Assume we are doing initialization
-	basePtr = base;
-	if( init )
+	uint8_t		b[ 4 ] = { marker, (uint8_t) pid, (uint8_t) ( pid >> 8 ), (uint8_t) ( pid >> 16 ) };
+	uint32_t	w;
+
+	memcpy( &w, b, sizeof( w ) );
+	return w;
+}
+
+/*
+ * Hands the claim on a segment back if initializing it throws, so the next process to attach starts over rather than
+ * waiting on a pid that is still alive.
+ */
+class SCppInitClaim
+{
+public:
+	SCppInitClaim( uint32_t *w, uint32_t c ) : word( w ), claim( c ), held( false ) {}
+	~SCppInitClaim()
 	{
-		//sem_t *initSem = (sem_t *)( (char*) basePtr + 0x20 );
-		sem_t *initSem = openSem();
-		/*
-		 * First check to make sure it isn't already initialized
-		 */
-		if( 0x5A == *((char *)basePtr) )				// Being initialized
+		if( held && __atomic_compare_exchange_n( word, &claim, 0U, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
 		{
-			struct timespec ts;
-			int				s;
-			usleep( 1000 );								// Wait a millisecond for things to get moving
-
-			if( 0 > clock_gettime( CLOCK_REALTIME, &ts ) )
-			{
-				ts.tv_sec = 0;
-				ts.tv_nsec = 0;
-			} else if( 1000000000 < ( ts.tv_nsec += 400000000 ) ) {
-				ts.tv_nsec -= 1000000000;
-				ts.tv_sec++;
-			}
+			futexWake( word );
+		}
+	}
+	uint32_t	*word;
+	uint32_t	claim;
+	bool		held;
+};
 
-			while( ( s = sem_timedwait( initSem, &ts ) ) == -1 && errno == EINTR ) continue;
-			if( 0 <= s )
+/*
+ * Check the 32 byte header a completed initialization leaves at the start of the segment:  the 0xA5 marker, nineteen random
+ * bytes that are neither zero nor 0xFF, a ten byte sequence and a checksum of all of it.
+ */
+static bool validHeader( const uint8_t *out )
+{
+	if( 0xA5 != out[ 0 ] )
+	{
+		return false;
+	}
+	uint16_t		s = 0;
+	unsigned		i = 0;
+	uint8_t			r;
+	while( 20 > i )
+	{
+		r = out[ i ++ ];
+		if( 0 == r || 0xFF == r )
+		{
+			fprintf( stderr, "\t\tFail  Zeros and 0xFF are not allowed in first twenty bytes!\n" );
+			break;
+		} else  {
+			s += (uint16_t) r;
+		}
+	}
+	if( 20 == i )
+	{
+		while( 30 > i )
+		{
+			r = out[ i ++ ];
+			s += (uint16_t) r;
+		}
+	}
+	if( 30 == i )
+	{
+		if( out[ i++ ] == (uint8_t) s )
+		{
+			if( out[ i ] == (uint8_t) ( s >> 8 ) )
 			{
-				sem_post( initSem );
+				for( i = 20, r = out[ i - 1 ]; 30 > i; i++ )
+				{
+					if( ++r != out[ i ] )
+					{
+						fprintf( stderr, "\t\tSequence not found in bytes 20 through 30!\n" );
+						break;
+					}
+				}
+				if( 30 == i )													// All checks out so we don't need to initialize anything.
+				{
+					return true;
+				}
 			} else {
-				fprintf( stderr, "%s[ %.4d ]: Error waiting for completion of shared memory initialization\n", __FILE__, __LINE__ );
+				fprintf( stderr, "\t\tChecksum error!\n" );
 			}
+		} else {
+			fprintf( stderr, "\t\tChecksum error!\n" );
 		}
+	}
+	return false;
+}
 
-		if( 0xA5 == *((char *) basePtr ) )  			// Is initialized  Check it out
+void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
+{
+	bool	validInit = false;																							// Assume we are doing initialization
+	basePtr = base;
+	if( init )
+	{
+		/*
+		 * The first word of the segment is the handshake.  Whoever swaps it to 0x5A followed by its pid does the
+		 * initialization and everybody else sleeps on it until it turns to 0xA5.  A waiter only takes over once the
+		 * initializer's pid is gone, and only by swapping its own pid in, so two of them can't both take over, nor can one
+		 * take over from an initializer that is merely slow.  Processes sharing a segment must share a pid namespace.
+		 */
+		// cppcheck-suppress cstyleCast
+		uint32_t	*word = (uint32_t *) basePtr;
+		uint32_t	mine = initWord( 0x5A, (uint32_t) getpid() );
+		uint64_t	deadline = monotonicNs() + SCPP_INIT_TIMEOUT;
+		bool		warned = false;
+		SCppInitClaim	claim( word, mine );
+
+		for( ;; )
 		{
-			uint16_t		s = 0;
-			uint8_t			*out = (uint8_t *) basePtr;
-			unsigned		i = 0;
-			uint8_t			r;
-			while( 20 > i )
+			uint32_t	seen = __atomic_load_n( word, __ATOMIC_ACQUIRE );
+			uint8_t		b[ 4 ];
+			uint64_t	now = monotonicNs();
+
+			memcpy( b, &seen, sizeof( b ) );
+			if( 0x5A == b[ 0 ] )										// Being initialized
 			{
-				r = out[ i ++ ];
-				if( 0 == r || 0xFF == r )
+				if( deadline > now )
+				{
+					futexWait( word, seen, deadline - now );
+					continue;
+				}
+				pid_t	pid = (pid_t) ( b[ 1 ] | ( b[ 2 ] << 8 ) | ( b[ 3 ] << 16 ) );
+				if( pid && ( 0 == kill( pid, 0 ) || ESRCH != errno ) )
+				{
+					if( ! warned )
+					{
+						fprintf( stderr, "%s[ %.4d ]: Still waiting for process %d to initialize shared memory\n", __FILE__, __LINE__, (int) pid );
+						warned = true;
+					}
+					deadline = now + SCPP_INIT_TIMEOUT;
+					continue;
+				}
+				if( ( claim.held = __atomic_compare_exchange_n( word, &seen, mine, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ) )
 				{
-					fprintf( stderr, "\t\tFail  Zeros and 0xFF are not allowed in first twenty bytes!\n" );
+					fprintf( stderr, "%s[ %.4d ]: Taking over shared memory initialization from process %d\n", __FILE__, __LINE__, (int) pid );
 					break;
-				} else  {
-					s += (uint16_t) r;
 				}
+				continue;
 			}
-			if( 20 == i )
+			if( ( validInit = validHeader( (uint8_t *) basePtr ) ) )
 			{
-				while( 30 > i )
-				{
-					r = out[ i ++ ];
-					s += (uint16_t) r;
-				}
+				break;
 			}
-			if( 30 == i )
+			if( ( claim.held = __atomic_compare_exchange_n( word, &seen, mine, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ) )
 			{
-				if( out[ i++ ] == (uint8_t) s )
-				{
-					if( out[ i ] == (uint8_t) ( s >> 8 ) )
-					{
-						for( i = 20, r = out[ i - 1 ]; 30 > i; i++ )
-						{
-							if( ++r != out[ i ] )
-							{
-								fprintf( stderr, "\t\tSequence not found in bytes 20 through 30!\n" );
-								break;
-							}
-						}
-						if( 30 == i )													// All checks out so we don't need to initialize anything.
-						{
-							validInit = true;
-						}
-					} else {
-						fprintf( stderr, "\t\tChecksum error!\n" );
-					}
-				} else {
-					fprintf( stderr, "\t\tChecksum error!\n" );
-				}
+				break;
 			}
 		}
 		if( initialized )
@@ -3041,23 +4763,23 @@ void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
 
 			/*
 			 * If we got here the we need to initialize the whole thing.
-			 * Start by signaling That we are doing the initialization.
-			 * Then initialize the Semaphore that is used to tell we are done
+			 * The 0x5A claiming it is already in place.
 			 */
-			*((char *) basePtr ) = 0x5A;
 			memset( ((char*)basePtr + 0x20 ), 0, 0x10 );
 			memset( ((char*)basePtr + 0x30), 0, list->size - 0x30 );
 
 			/*
-			 * Create a block of memory that can be checked to see if We are actually initialized
+			 * Create a block of memory that can be checked to see if We are actually initialized.  Its first word stays our
+			 * claim until everything is done.
 			 */
 			struct timeval	tv;
 			unsigned		i = 1;
 			uint16_t		s = 0xA5;
-			uint8_t			*out = (uint8_t *) basePtr;
+			uint8_t			out[ 32 ];
 
 			gettimeofday( &tv, NULL );
 			srandom( tv.tv_sec );
+			out[ 0 ] = 0xA5;
 			while( 20 > i )
 			{
 				uint8_t r = (uint8_t) random();
@@ -3074,8 +4796,8 @@ void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
 			}
 			out[ i++ ] = (uint8_t) s;
 			out[ i ] = (uint8_t) ( s >> 8 );
+			memcpy( (char *) basePtr + sizeof( uint32_t ), out + sizeof( uint32_t ), sizeof( out ) - sizeof( uint32_t ) );
 
-			list->sem = openSem();
 			memset( (void *)( (char *)basePtr + 0x20 ), 0, doubleOffset - timeOffset );
 
 			std::string		indent;
@@ -3099,13 +4821,10 @@ void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
 					}
 					if( ! strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 					{
-						ls->sem = openSem();
-						unitDefaults( (COMap *) mp, ls, indent, c, ls->sem );
+						unitDefaults( (COMap *) mp, ls, indent, c );
 					} else if( ! strcasecmp ( typ.c_str(), SCppObj_ARRAY ) ) {
-					    ls->sem = openSem();
-						arrayDefaults( (COMap *) mp, ls, indent, c, ls->sem );
+						arrayDefaults( (COMap *) mp, ls, indent, c );
 					} else {
-						ls->sem = list->sem;
 						if( ! ( dPtr = mp->findCaseElement( "defaultValue" ) )  )
 						{
 							throw std::invalid_argument( "Invalid configuration file.  All base classes must be provided a default value!" );
@@ -3149,15 +4868,21 @@ void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
 				}
 			}
 
-			 *((char *) basePtr ) = 0xA5;
-			sem_post( initSem );
+			assignLocks( list, 0, true );
+			uint32_t	done;
+			memcpy( &done, out, sizeof( done ) );
+			claim.held = false;
+			if( ! __atomic_compare_exchange_n( word, &mine, done, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+			{
+				fprintf( stderr, "%s[ %.4d ]: Another process took over initializing the shared memory\n", __FILE__, __LINE__ );
+			}
+			futexWake( word );
 		}
 	}
 
 	if( validInit )
 	{
-		list->sem = openSem();
-
+		assignLocks( list, 0, false );
 		for( unsigned units = 0; list->names[ 2 * units ]; units++ )
 		{
 			COString 	*sPtr;
@@ -3176,14 +4901,11 @@ void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
 				}
 				if( ! strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 				{
-				    ls->sem = openSem();
-					listSems( (COMap *) mp, ls, ls->sem );
+					listSems( (COMap *) mp, ls );
 				} else if( ! strcasecmp( typ.c_str(), SCppObj_ARRAY ) ) {
-				    ls->sem = openSem();
-				    listArraySems( (COMap *) mp, ls, ls->sem );
+				    listArraySems( (COMap *) mp, ls );
 				} else {
 					CppON		*oPtr;
-					ls->sem = list->sem;
 					if( !strcasecmp( typ.c_str(), SCppObj_INT ) ) {
 						int sz = 4;
 
@@ -3216,29 +4938,308 @@ void SCppObj::setBasePointer( void *base, bool init, bool *initialized )
 				}
 			}
 		}
+	} else if( ! init ) {
+		assignLocks( list, 0, false );
 	}
 }
 
+/*
+ * In the aligned layout ( "layout": "aligned" in the configuration ) every unit's values start on new cache lines in each
+ * region, as does every value marked "hot", so processes writing different units never write the same line.  Time stamps are
+ * lined up on 128 bytes so the versions, which are half their size, line up too.
+ */
+void SCppObj::alignRegions( void )
+{
+	if( alignedLayout )
+	{
+		timeOffset = 0x20 + ( ( timeOffset - 0x20 + 127 ) & ~127U );
+		doubleOffset = (int) lineUp( (uint32_t) doubleOffset );
+		int64Offset = (int) lineUp( (uint32_t) int64Offset );
+		int32Offset = (int) lineUp( (uint32_t) int32Offset );
+		int16Offset = (int) lineUp( (uint32_t) int16Offset );
+		eightBitOffset = (int) lineUp( (uint32_t) eightBitOffset );
+		charOffset = (int) lineUp( (uint32_t) charOffset );
+	}
+}
 
-sem_t *SCppObj::openSem( int idx )
+/*
+ * Point every element at its lock.  Units and arrays each own one, starting with the base, and everything else uses the
+ * lock of the unit it is in.  The locks are numbered walking the STRUCT_LISTS tree so every process attaching to the segment
+ * agrees on which is which.  If init is set the mutexes are (re)created.  Returns the next free lock number.
+ */
+uint32_t SCppObj::assignLocks( STRUCT_LISTS *lst, uint32_t idx, bool init )
 {
-	static 	int		semCount = 0;
-			sem_t 	*sem = NULL;
-			char	name[ 16 ];
+	// cppcheck-suppress cstyleCast
+	SCPP_LOCK	*lock = ( basePtr ) ? &( (SCPP_LOCK *) ( (char *) basePtr + lockOffset ) )[ idx ] : NULL;
 
-	if( 0 <= idx )
+	lst->lock = lock;
+	if( lock && init )
 	{
-		semCount = idx;
+		pthread_mutexattr_t		attr;
+
+		memset( lock, 0, sizeof( SCPP_LOCK ) );
+		pthread_mutexattr_init( &attr );
+		pthread_mutexattr_setpshared( &attr, PTHREAD_PROCESS_SHARED );
+		pthread_mutexattr_setrobust( &attr, PTHREAD_MUTEX_ROBUST );
+		pthread_mutex_init( &lock->mutex, &attr );
+		pthread_mutexattr_destroy( &attr );
 	}
-	sprintf( name, "/snSem_%d", semCount++ );
-	if( SEM_FAILED != ( sem = sem_open( name, O_CREAT | O_EXCL, S_IRUSR | S_IWUSR, 1 ) ) )
+	idx++;
+	for( unsigned i = 0; lst->nSubs > i; i++ )
 	{
-		sem_init( sem, 1, 1 );
-	} else {
-		sem = sem_open( name, O_EXCL, S_IRUSR | S_IWUSR, 1 );
+		STRUCT_LISTS *ls = &( (STRUCT_LISTS *) lst->subs )[ i ];
+		if( SL_TYPE_UNIT == ls->type || SL_TYPE_ARRAY == ls->type )
+		{
+			idx = assignLocks( ls, idx, init );
+		} else {
+			ls->lock = lock;
+		}
+	}
+	if( list == lst )																				// The slot after the last lock is the "any unit changed" counter
+	{
+		notify = ( basePtr ) ? &( (SCPP_LOCK *) ( (char *) basePtr + lockOffset ) )[ idx ] : NULL;
+		if( notify && init )
+		{
+			memset( notify, 0, sizeof( SCPP_LOCK ) );
+		}
+	}
+	return idx;
+}
+
+/*
+ * Take the lock for a unit.  An uncontended lock is taken without a system call; otherwise we block for up to lockTimeout
+ * nanoseconds.  If the last owner died holding it the lock is recovered and marked consistent (the data it protects may be
+ * half written.)  Returns false, and doesn't hold the lock, if it couldn't be had.  The clock is only read when the lock is
+ * busy so counting an uncontended acquisition costs one store to a line we already own.
+ */
+bool SCppObj::waitSem( SCPP_LOCK *lock )
+{
+	int			s;
+	uint64_t	start = 0;
+
+	if( ! lock )
+	{
+		return false;
+	}
+	if( EBUSY == ( s = pthread_mutex_trylock( &lock->mutex ) ) )
+	{
+		struct timespec ts;
+		start = monotonicNs();
+		clock_gettime( CLOCK_REALTIME, &ts );
+		ts.tv_sec += (time_t) ( lockTimeout / 1000000000LL );
+		if( 1000000000L <= ( ts.tv_nsec += (long) ( lockTimeout % 1000000000LL ) ) )
+		{
+			ts.tv_nsec -= 1000000000L;
+			ts.tv_sec++;
+		}
+		while( EINTR == ( s = pthread_mutex_timedlock( &lock->mutex, &ts ) ) );
+		noteWait( lock, start );
+	}
+	if( EOWNERDEAD == s )
+	{
+		lock->recovered++;
+		pthread_mutex_consistent( &lock->mutex );
+		fprintf( stderr, "%s[%d]: Recovered a lock left by a process that died holding it\n", __FILE__, __LINE__ );
+		s = 0;
+	} else if( ETIMEDOUT == s ) {
+		__atomic_fetch_add( &lock->timeouts, 1, __ATOMIC_RELAXED );
+	} else if( s ) {
+		fprintf( stderr, "%s[%d]: Failed to get lock: %s\n", __FILE__, __LINE__, strerror( s ) );
+	}
+	if( 0 == s )
+	{
+		bumpHeld( &lock->acquisitions );
+		if( start )
+		{
+			bumpHeld( &lock->contended );
+		}
+	}
+	return( 0 == s );
+}
+
+/*
+ * The lock counters of lst's unit, or of lst if it is a unit or an array, and of every unit and array in it keyed by their
+ * paths relative to lst with dots between the names;  lst's own are under ".".  With idle false the locks nobody has taken
+ * or written through since the last reset are left out.  The counters are read without the lock so those of a busy unit may
+ * be a moment apart from one another.  The caller deletes the COMap.
+ */
+COMap *SCppObj::stats( STRUCT_LISTS *lst, bool idle )
+{
+	COMap		*rtn = new COMap();
+	std::string	path;
+
+	lockStats( ( lst ) ? lst : list, path, rtn, idle );
+	return rtn;
+}
+
+void SCppObj::lockStats( STRUCT_LISTS *lst, std::string &path, COMap *rtn, bool idle )
+{
+	SCPP_LOCK	*lock = lst->lock;
+	size_t		l = path.length();
+
+	if( lock )
+	{
+		uint64_t	acquisitions = __atomic_load_n( &lock->acquisitions, __ATOMIC_RELAXED );
+		uint64_t	updates = __atomic_load_n( &lock->updates, __ATOMIC_RELAXED );
+		uint32_t	timeouts = __atomic_load_n( &lock->timeouts, __ATOMIC_RELAXED );
+
+		if( idle || acquisitions || updates || timeouts )
+		{
+			COMap *m = new COMap();
+			m->append( "acquisitions", (int64_t) acquisitions );
+			m->append( "contended", (int64_t) __atomic_load_n( &lock->contended, __ATOMIC_RELAXED ) );
+			m->append( "timeouts", (int64_t) timeouts );
+			m->append( "recovered", (int64_t) __atomic_load_n( &lock->recovered, __ATOMIC_RELAXED ) );
+			m->append( "waitNs", (int64_t) __atomic_load_n( &lock->waitNs, __ATOMIC_RELAXED ) );
+			m->append( "maxWaitNs", (int64_t) __atomic_load_n( &lock->maxWaitNs, __ATOMIC_RELAXED ) );
+			m->append( "updates", (int64_t) updates );
+			m->append( "lastWriter", (int64_t) __atomic_load_n( &lock->lastWriter, __ATOMIC_RELAXED ) );
+			rtn->append( ( l ) ? path : std::string( "." ), m );
+		}
+	}
+	for( unsigned i = 0; lst->names && lst->names[ 2 * i ] && i < lst->nSubs; i++ )
+	{
+		STRUCT_LISTS *sub = &( (STRUCT_LISTS *) lst->subs )[ i ];
+		if( SL_TYPE_UNIT == sub->type || SL_TYPE_ARRAY == sub->type )
+		{
+			if( l )
+			{
+				path += '.';
+			}
+			path += lst->names[ ( 2 * i ) + 1 ];
+			lockStats( sub, path, rtn, idle );
+			path.resize( l );
+		}
+	}
+}
+
+/*
+ * Zero the counters stats() reports for lst's unit and the units in it.  Each lock is held while it is cleared so an
+ * acquisition in progress isn't half counted, which also means it mustn't be called while holding one of them.  Returns
+ * false if a lock couldn't be had;  its counters are left as they were.
+ */
+bool SCppObj::resetStats( STRUCT_LISTS *lst )
+{
+	return resetLocks( ( lst ) ? lst : list );
+}
+
+bool SCppObj::resetLocks( STRUCT_LISTS *lst )
+{
+	SCPP_LOCK	*lock = lst->lock;
+	bool		rtn = true;
+
+	if( lock )
+	{
+		if( waitSem( lock ) )
+		{
+			__atomic_store_n( &lock->acquisitions, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->contended, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->timeouts, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->recovered, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->waitNs, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->maxWaitNs, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->updates, 0, __ATOMIC_RELAXED );
+			__atomic_store_n( &lock->lastWriter, 0, __ATOMIC_RELAXED );
+			postSem( lock );
+		} else {
+			rtn = false;
+		}
+	}
+	for( unsigned i = 0; lst->nSubs > i; i++ )
+	{
+		STRUCT_LISTS *sub = &( (STRUCT_LISTS *) lst->subs )[ i ];
+		if( SL_TYPE_UNIT == sub->type || SL_TYPE_ARRAY == sub->type )
+		{
+			rtn = resetLocks( sub ) && rtn;
+		}
+	}
+	return rtn;
+}
+
+
+/*
+ * Sequence lock support.  Writers bump the unit's sequence to odd before they store and back to even when they are done, so
+ * a reader that sees the same even sequence before and after copying a value knows it wasn't torn and never has to take
+ * the lock or hold up the writer.
+ */
+void SCppObj::beginWrite( SCPP_LOCK *lock )
+{
+	if( lock )
+	{
+		__atomic_fetch_add( &lock->sequence, 1, __ATOMIC_RELAXED );
+		__atomic_thread_fence( __ATOMIC_RELEASE );
+	}
+}
+
+void SCppObj::endWrite( SCPP_LOCK *lock )
+{
+	if( lock )
+	{
+		uint32_t pid = selfPid();
+		bumpHeld( &lock->updates );																	// Writers without the lock racing each other can lose a count
+		if( pid != __atomic_load_n( &lock->lastWriter, __ATOMIC_RELAXED ) )
+		{
+			__atomic_store_n( &lock->lastWriter, pid, __ATOMIC_RELAXED );
+		}
+		__atomic_fetch_add( &lock->sequence, 1, __ATOMIC_SEQ_CST );
+		if( __atomic_load_n( &lock->waiters, __ATOMIC_SEQ_CST ) )											// Only pay for the system call if someone is waiting
+		{
+			futexWake( &lock->sequence );
+		}
+		if( notify && __atomic_load_n( &notify->waiters, __ATOMIC_SEQ_CST ) )
+		{
+			__atomic_fetch_add( &notify->sequence, 1, __ATOMIC_SEQ_CST );
+			futexWake( &notify->sequence );
+		}
+	}
+}
+
+/*
+ * Copy a value of SCPP_SEQ_MAX bytes or less into dst without locking.  Returns false if lock free reads are off, the value
+ * is too big, or a writer kept getting in the way, in which case the caller should fall back to the lock.
+ */
+bool SCppObj::seqRead( STRUCT_LISTS *lst, void *dst )
+{
+	if( seqReads && lst && lst->lock && SCPP_SEQ_MAX >= lst->size && SL_TYPE_UNIT != lst->type && SL_TYPE_ARRAY != lst->type )
+	{
+		const void 	*src = (const void *) ( (char *) basePtr + lst->offset );
+		for( unsigned i = 0; SCPP_SEQ_TRIES > i; i++ )
+		{
+			uint32_t s = __atomic_load_n( &lst->lock->sequence, __ATOMIC_ACQUIRE );
+			if( !( s & 1 ) )
+			{
+				memcpy( dst, src, lst->size );
+				__atomic_thread_fence( __ATOMIC_ACQUIRE );
+				if( s == __atomic_load_n( &lst->lock->sequence, __ATOMIC_RELAXED ) )
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/*
+ * Copy the raw bytes of a value, lock free if possible and under the lock if not.
+ */
+bool SCppObj::readField( STRUCT_LISTS *lst, void *dst )
+{
+	if( ! lst || SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
+	{
+		return false;
+	}
+	if( seqRead( lst, dst ) )
+	{
+		return true;
 	}
-	sems.push_back( sem );
-	return sem;
+	if( waitSem( lst->lock ) )
+	{
+		memcpy( dst, (char *) basePtr + lst->offset, lst->size );
+		postSem( lst->lock );
+		return true;
+	}
+	return false;
 }
 
 static bool CompareStrings( std::string a, std::string b ) { return a < b; }
@@ -3250,7 +5251,7 @@ void SCppObj::buildArrayNames( COMap *def, std::string indent, char **out[] )
 	unsigned					sz = 0; // 2 * def->size();
 	unsigned 					j = 0;
 
-	for( std::map<std::string, CppON *>::iterator it = def->begin(); def->end() != it; it++ )
+	for( COMap::iterator it = def->begin(); def->end() != it; it++ )
 	{
 		if( CppON::isMap( it->second ) )
 		{
@@ -3284,7 +5285,7 @@ void SCppObj::buildNames( COMap *def, std::string indent, char **out[]  )
 	/*
 	 * Find out how many names/(objects + arrays) we have
 	 */
-	for( std::map<std::string, CppON *>::iterator it = def->begin(); def->end() != it; it++ )
+	for( COMap::iterator it = def->begin(); def->end() != it; it++ )
 	{
 		if( ( CppON::isMap( it->second )  && it->first.compare( "update" ) ) || ! it->first.compare( "threeAxis" ) )
 		{
@@ -3371,7 +5372,7 @@ uint32_t SCppObj::buildArray( COMap *def, STRUCT_LISTS *unit, std::string indent
 	/*
 	 * Figure out how many units the base has in it then use that to allocate the structure
 	 */
-	for( std::map<std::string, CppON *>::iterator it = def->begin(); def->end() != it; it++ )
+	for( COMap::iterator it = def->begin(); def->end() != it; it++ )
 	{
 		if( CppON::isMap( it->second ) )
 		{
@@ -3397,6 +5398,7 @@ uint32_t SCppObj::buildArray( COMap *def, STRUCT_LISTS *unit, std::string indent
 	unit->names = NULL;
 
 	buildArrayNames( def, indent, &( unit->names )  );
+	alignRegions();
 
 	for( units = 0; unit->names[ 2 * units ]; units++ )
 	{
@@ -3418,12 +5420,19 @@ uint32_t SCppObj::buildArray( COMap *def, STRUCT_LISTS *unit, std::string indent
 			}
 			if( !strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 			{
+				ls->offset = 0;
 				ls->time = 0;
 				unit->size += buildUnit( mp, ls, indent, c );
 			} else if ( ! strcasecmp( typ.c_str(), SCppObj_ARRAY ) ) {
+				ls->offset = 0;
 				ls->time = 0;
 				unit->size += buildArray( mp, ls, indent, c );
 			} else {
+				bool hot = alignedLayout && CppON::isBoolean( oPtr = mp->findCaseElement( "hot" ) ) && ( (COBoolean *) oPtr )->value();
+				if( hot )
+				{
+					alignRegions();
+				}
 				ls->name = c;
 				ls->time = timeOffset;
 				timeOffset += sizeof( uint64_t );
@@ -3490,12 +5499,17 @@ uint32_t SCppObj::buildArray( COMap *def, STRUCT_LISTS *unit, std::string indent
 					ls->size = 1;
 					eightBitOffset++;
 				}
+				if( hot )
+				{
+					alignRegions();
+				}
 			}
 		} else {
 			fprintf( stderr, "%s[ %.4u ]: is type %d\n", __FILE__, __LINE__, mp->type() );
 		}
 	}
 
+	alignRegions();
 	unit->size = eightBitOffset + charOffset + doubleOffset + int32Offset + int64Offset + int16Offset;
 	return unit->size;
 }
@@ -3512,7 +5526,7 @@ uint32_t SCppObj::buildUnit( COMap *def, STRUCT_LISTS *unit, std::string indent,
 	/*
 	 * Figure out how many units the base has in it then use that to allocate the structure
 	 */
-	for( std::map<std::string, CppON *>::iterator it = def->begin(); def->end() != it; it++ )
+	for( COMap::iterator it = def->begin(); def->end() != it; it++ )
 	{
 		if( CppON::isMap( it->second) )
 		{
@@ -3539,6 +5553,7 @@ uint32_t SCppObj::buildUnit( COMap *def, STRUCT_LISTS *unit, std::string indent,
 	unit->names = NULL;
 
 	buildNames( def, indent, &(unit->names)  );
+	alignRegions();
 
 	for( units = 0; unit->names[ 2 * units ]; units++ )
 	{
@@ -3561,12 +5576,19 @@ uint32_t SCppObj::buildUnit( COMap *def, STRUCT_LISTS *unit, std::string indent,
 			}
 			if( !strcasecmp( typ.c_str(), SCppObj_UNIT ) )
 			{
+				ls->offset = 0;
 				ls->time = 0;
 				unit->size += buildUnit( mp, ls, indent, c );
 			} else if ( ! strcasecmp( typ.c_str(), SCppObj_ARRAY ) ) {
+				ls->offset = 0;
 				ls->time = 0;
 				unit->size += buildArray( mp, ls, indent, c );
 			} else {
+				bool hot = alignedLayout && CppON::isBoolean( oPtr = mp->findCaseElement( "hot" ) ) && ( (COBoolean *) oPtr )->value();
+				if( hot )
+				{
+					alignRegions();
+				}
 				ls->name = c;
 				ls->time = timeOffset;
 				timeOffset += sizeof( uint64_t );
@@ -3633,9 +5655,14 @@ uint32_t SCppObj::buildUnit( COMap *def, STRUCT_LISTS *unit, std::string indent,
 					ls->size = 1;
 					eightBitOffset++;
 				}
+				if( hot )
+				{
+					alignRegions();
+				}
 			}
 		}
 	}
+	alignRegions();
 	unit->size = eightBitOffset + charOffset + doubleOffset + int32Offset + int64Offset + int16Offset;
 	return unit->size;
 }
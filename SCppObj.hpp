@@ -9,6 +9,7 @@
 #define SCppObj_HPP_
 
 #include <unistd.h>
+#include <pthread.h>
 #include "CppON.hpp"
 
 #define SL_TYPE_NONE		0
@@ -23,11 +24,65 @@
 #define	SL_TYPE_ARRAY		9
 
 #define SIM_WAIT_TO
+#define SCPP_LOCK_TIMEOUT	10000000LL		// Default time, in nanoseconds, to wait for a unit lock
+#define SCPP_INIT_TIMEOUT	400000000LL		// Time, in nanoseconds, to wait for another process to initialize a segment
+#define SCPP_SEQ_MAX		64				// Largest value read without the lock
+#define SCPP_SEQ_TRIES		64				// Torn reads tolerated before falling back to the lock
+
+/*
+ * Every unit and array has one of these in the shared segment.  The mutex is robust and process shared so a process that
+ * dies holding it doesn't lock everyone else out.  Each takes two cache lines of its own so units don't share a line:  the
+ * first has the mutex and what every acquisition and write touches, the second what only waiting touches.  The counters are
+ * for SCppObj::stats() and are cleared by resetStats();  reads that don't take the lock aren't counted.
+ */
+typedef struct SCPP_LOCK
+{
+	pthread_mutex_t	mutex;
+	uint32_t		sequence;				// Odd while a writer is storing into the unit.  Also the futex waiters sleep on
+	uint32_t		lastWriter;				// pid of the process that wrote into it last
+	uint64_t		acquisitions;			// Times the lock was taken.  Only its holder changes it
+	uint64_t		updates;				// Writes into the unit.  Bumped like acquisitions, exact unless writers skip the lock
+	uint32_t		waiters;				// Number of threads sleeping on sequence
+	uint32_t		recovered;				// Times the lock was recovered from an owner that died holding it
+	uint32_t		timeouts;				// Times a waiter gave up
+	uint32_t		pad;
+	uint64_t		contended;				// Acquisitions that found it busy and had to wait.  Also only changed by the holder
+	uint64_t		waitNs;					// Time spent waiting for it, including waits that timed out
+	uint64_t		maxWaitNs;				// Longest of those waits
+} __attribute__( ( aligned( 64 ) ) ) SCPP_LOCK;
+
+#define SCPP_MAX_UNITS		32				// Most units one transaction can lock
+#define SCPP_REGIONS		7				// Time stamps, doubles, 64, 32, 16 and 8 bit integers and strings
+
+/*
+ * Where a unit is in the segment.  Everything in a unit, including the units and arrays in it, is contiguous in each of the
+ * segment's regions so a unit is at most SCPP_REGIONS byte ranges.  A snapshot is those ranges copied back to back.
+ */
+typedef struct SCPP_EXTENT
+{
+	uint32_t		start[ SCPP_REGIONS ];	// First byte of the unit in each region
+	uint32_t		end[ SCPP_REGIONS ];	// Byte after the last one
+	uint32_t		snap[ SCPP_REGIONS ];	// Where the region's bytes go in a snapshot
+	uint32_t		size;					// Bytes in a snapshot
+	uint32_t		locks;					// Locks in the unit:  its own and those of the units and arrays in it
+	uint32_t		publish;				// Offset of the unit's double buffers, zero if it isn't double buffered
+} SCPP_EXTENT;
+
+/*
+ * Head of a double buffered unit's publish area.  It is followed, on the next cache line, by two snapshot sized buffers.
+ */
+typedef struct SCPP_PUBLISH
+{
+	uint32_t		index;					// Buffer readers copy from
+	uint32_t		count;					// Times the unit has been published
+	uint32_t		seq[ 2 ];				// Copies into each buffer begun and finished, odd while one is under way
+} SCPP_PUBLISH;
+
 typedef struct STRUCT_LISTS
 {
 	STRUCT_LISTS	*subs;
 	char 			**names;
-	sem_t			*sem;
+	SCPP_LOCK		*lock;
 	COMap			*def;
 	std::string		name;
 	uint32_t 		offset;
@@ -37,9 +92,109 @@ typedef struct STRUCT_LISTS
 	uint8_t			nSubs;
 } STRUCT_LISTS;
 
+/*
+ * One read or write in a transaction.  value points at a variable of the field's own type (double, uint64_t, uint32_t,
+ * uint16_t or uint8_t for eight bit integers and booleans) or, for strings, at a buffer of at least the field's size.
+ */
+typedef struct SCPP_OP
+{
+	STRUCT_LISTS	*field;
+	void			*value;
+	bool			write;
+} SCPP_OP;
+
+/*
+ * Why transact() refused a list of operations.  op is the one at fault, or for SCPP_TRANSACT_NO_LOCK the number of units
+ * already locked when the next lock couldn't be had.
+ */
+typedef enum SCPP_TRANSACT_CODE
+{
+	SCPP_TRANSACT_OK,
+	SCPP_TRANSACT_NOT_A_VALUE,				// the op's field is missing, has no lock or isn't a value, or value is NULL
+	SCPP_TRANSACT_TOO_MANY_UNITS,			// the op would be in a unit past the first SCPP_MAX_UNITS
+	SCPP_TRANSACT_NO_LOCK					// waitSem() failed
+} SCPP_TRANSACT_CODE;
+
+typedef struct SCPP_TRANSACT_ERROR
+{
+	SCPP_TRANSACT_CODE	code;
+	unsigned			op;
+} SCPP_TRANSACT_ERROR;
+
+
+#define SCPP_JOURNAL_VALUE	32				// Bytes of the new value kept in a journal record
+
+/*
+ * One change in the journal.  position is the record's place in the journal plus one once it is complete and zero while it is
+ * being written.  Values longer than SCPP_JOURNAL_VALUE (long strings) are cut short;  size is always the whole value's size.
+ */
+typedef struct SCPP_JOURNAL_RECORD
+{
+	uint64_t		position;
+	uint64_t		time;					// The value's update time
+	uint32_t		field;					// Field id, see SCppObj::field()
+	uint32_t		version;				// The value's version after the write
+	uint32_t		size;
+	uint32_t		pad;
+	uint8_t			value[ SCPP_JOURNAL_VALUE ];
+} SCPP_JOURNAL_RECORD;
+
+/*
+ * Head of the journal.  The records follow on the next cache line.
+ */
+typedef struct SCPP_JOURNAL
+{
+	uint64_t		head;					// Records ever written
+	uint32_t		wake;					// Bumped, as a futex, when a record is added and someone is waiting
+	uint32_t		waiters;
+} SCPP_JOURNAL;
+
+#define SCPP_LAYOUT_MAGIC	0x4C505053U		// "SPPL"
+#define SCPP_LAYOUT_VERSION	3
+#define SCPP_LAYOUT_TRAILER	128				// Bytes at the end of the segment holding the SCPP_LAYOUT
+
+/*
+ * The compiled layout.  The process that initializes a segment leaves it in the segment's last SCPP_LAYOUT_TRAILER bytes, and
+ * the table it points to just before that, so processes attaching with the same description can use it instead of building
+ * the layout from the JSON again.  Everything in the table is an index or an offset so it works wherever the segment is
+ * mapped, which is why the path index entries are kept without their hashes;  pathHash mixes in the base pointer so the hashes
+ * and slots are rebuilt on attach.  The table is the nodes, the extents, the path index entries and then the text (paths then
+ * names.)
+ */
+typedef struct SCPP_LAYOUT
+{
+	uint32_t		magic;					// SCPP_LAYOUT_MAGIC, set once the table is complete
+	uint32_t		version;				// SCPP_LAYOUT_VERSION
+	uint64_t		hash;					// Of the description the layout was built from
+	uint32_t		table;					// Offset of the table
+	uint32_t		nodes;					// STRUCT_LISTS;  the base first and the subs of each unit or array together
+	uint32_t		extents;
+	uint32_t		entries;				// Path index entries;  base, element, offset and length
+	uint32_t		pathText;				// Bytes of paths at the start of the text
+	uint32_t		text;					// Bytes of text
+	uint32_t		fields;
+	uint32_t		offsets[ 12 ];			// Time, region, version, journal and lock offsets, journalMask and alignedLayout
+} SCPP_LAYOUT;
+
+typedef struct SCPP_LAYOUT_NODE
+{
+	uint32_t		name;					// Offsets in the text
+	uint32_t		acronym;				// Search key for it in its parent's names
+	uint32_t		subs;					// Index of its first sub
+	uint32_t		offset;
+	uint32_t		size;
+	uint32_t		time;
+	uint8_t			type;
+	uint8_t			nSubs;
+	uint16_t		pad;
+} SCPP_LAYOUT_NODE;
+
+template<typename T> class SCppField;
 
 class SCppObj
 {
+	template<typename T> friend class SCppField;
+	friend class SCppJsonApplier;
 
 public:
  										SCppObj( COMap *def, const char *segmentName = NULL, bool *initialized = NULL );
@@ -56,28 +211,11 @@ public:
 				uint32_t				size(){ return list->size; }
 
 				STRUCT_LISTS 			*getElement( const char *path, STRUCT_LISTS *base );
-				bool 					waitSem( sem_t *sem )
-				{
-					struct 	timespec ts;
-					clock_gettime( CLOCK_REALTIME, &ts);
-					struct 	timespec ts2 = { ts.tv_sec, ts.tv_nsec };
-					int 	s;
-					if( (ts.tv_nsec += 10000000LL ) > 1000000000LL )
-					{
-						ts.tv_nsec -= 1000000000LL;
-						ts.tv_sec++;
-					}
-					while( 0 != ( s = sem_trywait( sem ) ) )
-					{
-						usleep( 10 );
-						clock_gettime( CLOCK_REALTIME, &ts2 );
-						if( ( ts.tv_sec < ts2.tv_sec ) || ( ( ts.tv_sec == ts2.tv_sec ) && ( ts.tv_nsec < ts2.tv_nsec ) ) )
-						{
-							break;
-						}
-					}
-					return ( 0 == s );
-				}
+				bool 					waitSem( SCPP_LOCK *lock );
+				bool					postSem( SCPP_LOCK *lock ) { return( lock && 0 == pthread_mutex_unlock( &lock->mutex ) ); }
+				void					setLockTimeout( uint64_t ns ) { lockTimeout = ns; }
+				void					setSeqReads( bool on ) { seqReads = on; }
+				bool					readField( STRUCT_LISTS *lst, void *dst );
 				STRUCT_LISTS			*getElement( const char *path ) { return getElement( path, (STRUCT_LISTS *) list ); }
 				STRUCT_LISTS			*GetBase(){ return list; }
 
@@ -105,7 +243,7 @@ public:
 				bool					update( STRUCT_LISTS *lst, void *obj, bool protect = true );
 				bool					update( const char *path, void *obj, bool protect = true, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return update( lst, obj, protect ); }
 				bool					updateString( STRUCT_LISTS *lst, const char *s, bool protect = true );
-				bool					updateString( STRUCT_LISTS *lst, std::string s, bool protect = true ){ return updateString( lst, s.c_str(), protect ); }
+				bool					updateString( STRUCT_LISTS *lst, const std::string &s, bool protect = true ){ return updateString( lst, s.c_str(), protect ); }
 				bool					updateString( const char *path, const char *str, bool protect = true, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return updateString( lst, str, protect ); }
 				bool					updateDouble( STRUCT_LISTS *lst, double val, bool protect = true );
 				bool 					updateDouble( const char *path, double val, bool protect = true, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return updateDouble( lst, val, protect ); }
@@ -121,18 +259,18 @@ public:
 				bool					updateArray( const char *path, COArray *arr, bool protect = true, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return updateArray( lst, arr, protect ); }
 				bool					update( CppON *obj, STRUCT_LISTS *lst = NULL );
 				bool					update( CppON *obj, const char *path, STRUCT_LISTS *lst = NULL ){ STRUCT_LISTS *tst = getPointer( path, lst ); return update( obj, tst ); }
+				bool					applyJson( const char *json, size_t len, CppONParseError &err, STRUCT_LISTS *base = NULL );
 				STRUCT_LISTS			*at( STRUCT_LISTS *lst, uint32_t idx );
 				STRUCT_LISTS			*at( const char *path, uint32_t idx = 0, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return at( lst, idx ); }
 				STRUCT_LISTS			*getPointer( const char *path, STRUCT_LISTS *lst = NULL ) {	if( ! lst ) { return getElement( path, (STRUCT_LISTS *) list ); } else { return getElement( path, (STRUCT_LISTS *) lst );} }
 				void 					*pointer( STRUCT_LISTS *lst ){ return ( void *) ( ((uint64_t ) basePtr ) + (uint64_t )lst->offset);}
 				void					*getBasePtr(){ return basePtr; }
 				bool					waitSem( const char *path, STRUCT_LISTS *lst = NULL );
-				bool					waitSem( STRUCT_LISTS *lst ) { if( lst ) { return( waitSem( lst->sem ) ); } return false; }
-				bool					postSem( STRUCT_LISTS *lst ) { if( lst ) { sem_post( lst->sem ); return true; } return false; }
+				bool					waitSem( STRUCT_LISTS *lst ) { if( lst ) { return( waitSem( lst->lock ) ); } return false; }
+				bool					postSem( STRUCT_LISTS *lst ) { if( lst ) { return( postSem( lst->lock ) ); } return false; }
 				bool					postSem( const char *path, STRUCT_LISTS *lst = NULL );
-				sem_t					*openSem( int idx = -1 );
 				sem_t *					getTestSem() { return (sem_t *)( (char*) basePtr + 0x20 ); }
-				void					setUpdateTime( STRUCT_LISTS *lst, uint64_t t = 0 ) { if( lst ) { if( ! t ) { struct timespec tsp; clock_gettime( CLOCK_MONOTONIC, &tsp ); t = ((uint64_t) tsp.tv_sec ) * 1000LL + (uint64_t)( (( 500000 + tsp.tv_nsec ) / 1000000) ); } *((uint64_t *)((char*) basePtr + lst->time ) ) = t; } }
+				void					setUpdateTime( STRUCT_LISTS *lst, uint64_t t = 0 );
 				void					setUpdateTime( const char *path, STRUCT_LISTS *lst = NULL, uint64_t t = 0 );
 				uint64_t				getUpdateTime( STRUCT_LISTS *lst ){ if( lst ){ return *((uint64_t *)((char*) basePtr + lst->time ) ); } return 0; }
 				uint64_t				getUpdateTime( const char *path, STRUCT_LISTS *lst = NULL );
@@ -141,7 +279,7 @@ public:
 				bool                    inConfig( const char *path, STRUCT_LISTS *lst = NULL ) { return ( NULL != getPointer( path, lst) ); }
 				CODouble				*toCODouble( STRUCT_LISTS *val ){ if( val && SL_TYPE_DOUBLE == val->type ) { return new CODouble( *( ( double *) ( ( (uint64_t ) basePtr ) + (uint64_t )val->offset) ) ); } return NULL; }
 				COString				*toCOString( STRUCT_LISTS *val ){ if( val && SL_TYPE_CHAR == val->type ) { return new COString( ( ( char *) ( ( (uint64_t ) basePtr ) + (uint64_t )val->offset) ) ); } return NULL; }
-				COBoolean				*toCOBoolean( STRUCT_LISTS *val ){ if( val && SL_TYPE_BOOL == val->type ) { return new COBoolean( *( ( bool *) ( ( (uint64_t ) basePtr ) + (uint64_t )val->offset) ) ); } return NULL; }
+				COBoolean				*toCOBoolean( STRUCT_LISTS *val ){ if( val && SL_TYPE_BOOL == val->type ) { return new COBoolean( 0 != *( ( uint8_t *) ( ( (uint64_t ) basePtr ) + (uint64_t )val->offset) ) ); } return NULL; }
 				COInteger				*toJInt64( STRUCT_LISTS *val ){ if( val && SL_TYPE_INT64 == val->type ) { return  new COInteger( (uint64_t) *( ( uint64_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) val->offset ) ) ); } return NULL; }
 				COInteger				*toJInt32( STRUCT_LISTS *val ){ if( val && SL_TYPE_INT32 == val->type ) { return  new COInteger( (int) *( ( uint32_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) val->offset ) ) ); } return NULL; }
 				COInteger				*toJInt16( STRUCT_LISTS *val ){ if( val && SL_TYPE_INT16 == val->type ) { return  new COInteger( (int) *( ( uint16_t *) ( ( (uint64_t ) basePtr ) + (uint64_t ) val->offset ) ) ); } return NULL; }
@@ -153,6 +291,8 @@ public:
 				COMap					*toCOMap( const char *path, STRUCT_LISTS *root = NULL ){ root = getPointer( path, root ); return toCOMap( root ); }
 				CppON					*toCppON( STRUCT_LISTS *root = NULL );
 				CppON					*toCppON( const char *path, STRUCT_LISTS *lst = NULL ){  lst = getPointer( path, lst ); return toCppON( lst ); }
+				bool					writeJson( STRUCT_LISTS *root, CppONWriter &w, const void *snap = NULL );
+				bool					writeJson( const char *path, CppONWriter &w, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return writeJson( lst, w ); }
 				uint64_t				toLong( STRUCT_LISTS *val );
 				uint64_t				toLong( const char *path, STRUCT_LISTS *val = NULL ){  val = getPointer( path, val ); return toLong( val ); }
 				uint32_t				Int( STRUCT_LISTS *val );
@@ -174,6 +314,11 @@ public:
 				bool					sync( CppON *obj, const char *path, STRUCT_LISTS *root = NULL ){ STRUCT_LISTS *tst = getPointer( path, root ); return sync( obj, tst ); }
 				bool					waitForUpdate( STRUCT_LISTS *lst, uint64_t start = 0, uint64_t to = 0 );
 				bool 					waitForUpdate( const char *path,  STRUCT_LISTS *lst = NULL, uint64_t start = 0, uint64_t to = 0 ) { STRUCT_LISTS *tst = getPointer( path, lst ); return waitForUpdate( tst, start, to ); }
+				uint32_t				generation( STRUCT_LISTS *lst );
+				uint32_t				generation( const char *path, STRUCT_LISTS *lst = NULL ) { return generation( getPointer( path, lst ) ); }
+				bool					waitForChange( STRUCT_LISTS *lst, uint32_t &gen, uint64_t ns );
+				bool					waitForChange( const char *path, uint32_t &gen, uint64_t ns, STRUCT_LISTS *lst = NULL ) { return waitForChange( getPointer( path, lst ), gen, ns ); }
+				int						waitForChange( STRUCT_LISTS **lsts, uint32_t *gens, unsigned n, uint64_t ns );
 		static	bool					isInteger( STRUCT_LISTS *val ) { return ( val && (SL_TYPE_INT64 == val->type || SL_TYPE_INT32 == val->type || SL_TYPE_INT16 == val->type || SL_TYPE_INT8 == val->type ) ); }
 		static	bool					isDouble( STRUCT_LISTS *val ) { return ( val && SL_TYPE_DOUBLE == val->type ); }
 		static	bool					isBoolean( STRUCT_LISTS *val ) { return ( val && SL_TYPE_BOOL == val->type ); }
@@ -186,23 +331,90 @@ public:
 				bool					equals( CppON &obj, STRUCT_LISTS *val  );
 				bool					equals( CppON &obj, const char *path, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return equals( obj, lst ); }
 				COMap					*getConfig(){ return config; }
+				bool					transact( SCPP_OP *ops, unsigned n, SCPP_TRANSACT_ERROR &err );
+				bool					transact( SCPP_OP *ops, unsigned n ) { SCPP_TRANSACT_ERROR err; return transact( ops, n, err ); }
+				uint32_t				snapshotSize( STRUCT_LISTS *unit ){ SCPP_EXTENT *ext = extent( unit ); return ( ext ) ? ext->size : 0; }
+				bool					snapshot( STRUCT_LISTS *unit, void *dst, bool protect = true );
+				bool					snapshot( const char *path, void *dst, bool protect = true, STRUCT_LISTS *lst = NULL ){ return snapshot( getPointer( path, lst ), dst, protect ); }
+				const void				*snapshotPointer( STRUCT_LISTS *unit, STRUCT_LISTS *field, const void *snap );
+				bool					isDoubleBuffered( STRUCT_LISTS *unit ){ SCPP_EXTENT *ext = extent( unit ); return ( ext && ext->publish ); }
+				bool					publish( STRUCT_LISTS *unit );
+				bool					publish( const char *path, STRUCT_LISTS *lst = NULL ){ return publish( getPointer( path, lst ) ); }
+				bool					readPublished( STRUCT_LISTS *unit, void *dst );
+				bool					readPublished( const char *path, void *dst, STRUCT_LISTS *lst = NULL ){ return readPublished( getPointer( path, lst ), dst ); }
+				uint32_t				*versionPointer( STRUCT_LISTS *lst, void *base = NULL ){ if( versionOffset && lst && 0x20 <= lst->time ) { return (uint32_t *) ( (char *) ( ( base ) ? base : basePtr ) + versionOffset + ( ( lst->time - 0x20 ) >> 1 ) ); } return NULL; }
+				uint32_t				version( STRUCT_LISTS *lst ){ uint32_t *v = versionPointer( lst ); return ( v ) ? __atomic_load_n( v, __ATOMIC_ACQUIRE ) : 0; }
+				bool					versionRange( STRUCT_LISTS *lst, uint32_t &offset, uint32_t &bytes );
+				STRUCT_LISTS			*field( uint32_t id ){ return ( fields.size() > id ) ? fields[ id ] : NULL; }
+				uint32_t				fieldId( STRUCT_LISTS *lst ){ return ( lst && 0x20 <= lst->time ) ? ( lst->time - 0x20 ) >> 3 : ~0U; }
+				bool					hasJournal(){ return( 0 != journalOffset ); }
+				uint64_t				journalPosition();
+				unsigned				readJournal( uint64_t &cursor, SCPP_JOURNAL_RECORD *out, unsigned max, uint64_t *lost = NULL );
+				bool					waitJournal( uint64_t cursor, uint64_t ns );
+				COMap					*stats( STRUCT_LISTS *lst = NULL, bool idle = true );	// Lock counters of lst's unit and the units in it, the caller deletes it
+				COMap					*stats( const char *path, bool idle = true, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return ( lst ) ? stats( lst, idle ) : NULL; }
+				bool					resetStats( STRUCT_LISTS *lst = NULL );
+				bool					resetStats( const char *path, STRUCT_LISTS *lst = NULL ){ lst = getPointer( path, lst ); return ( lst ) ? resetStats( lst ) : false; }
 private:
 				void					initializeObject( const char *segmentName, bool *initialized );
+				bool					attachLayout( const char *segmentName, bool *initialized );
+	static		bool					layoutSound( const SCPP_LAYOUT *lay, const char *base, size_t sz );
+				void					compileLayout( std::vector<char> &table, SCPP_LAYOUT &head );
+				void					writeLayout( void );
+	static		uint64_t				descriptionHash( CppON *def, uint64_t h );
 				void					printStructList( STRUCT_LISTS *lst, std::string indent );
 				void					deleteStructList( STRUCT_LISTS *lst, std::string indent );
 
-				void					arrayDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name, sem_t *sem );
-				void 					unitDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name, sem_t *sem );
-				void 					listArraySems( COMap *def, STRUCT_LISTS *lst, sem_t *sem );
-				void 					listSems( COMap *def, STRUCT_LISTS *lst, sem_t *sem );
+				void					arrayDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name );
+				void 					unitDefaults( COMap *def, STRUCT_LISTS *lst, std::string indent, const char *name );
+				void 					listArraySems( COMap *def, STRUCT_LISTS *lst );
+				void 					listSems( COMap *def, STRUCT_LISTS *lst );
+				uint32_t				assignLocks( STRUCT_LISTS *lst, uint32_t idx, bool init );
+				void					lockStats( STRUCT_LISTS *lst, std::string &path, COMap *rtn, bool idle );
+				bool					resetLocks( STRUCT_LISTS *lst );
+				void					alignRegions( void );
+				uint32_t				lineUp( uint32_t off ){ return ( alignedLayout ) ? ( off + 63 ) & ~63U : off; }
+				bool					seqRead( STRUCT_LISTS *lst, void *dst );
+				void					beginWrite( SCPP_LOCK *lock );
+				void					endWrite( SCPP_LOCK *lock );
+				uint64_t				latestUpdate( STRUCT_LISTS *lst );
+				SCPP_EXTENT				*extent( STRUCT_LISTS *unit );
+				void					appendJournal( STRUCT_LISTS *lst, uint32_t version, uint64_t t );
+				uint32_t				buildExtents( STRUCT_LISTS *lst, const uint32_t *regionStart );
+				void					copyUnit( const SCPP_EXTENT *ext, void *dst );
+	static		unsigned				region( uint8_t type );
 				uint32_t 				buildArray( COMap *def, STRUCT_LISTS *unit, std::string indent, const char *name );
 				uint32_t 				buildUnit( COMap *def, STRUCT_LISTS *unit, std::string indent, const char *name );
 				void					buildArrayNames( COMap *def, std::string indent, char **out[] );
 				void 					buildNames( COMap *def,std::string indent, char **out[]  );
 				void 					doTest( const char *path );
+				void					indexPaths( STRUCT_LISTS *lst, std::string &path, std::vector<std::pair<STRUCT_LISTS *, size_t> > &chain );
+				void					buildPathIndex( void );
+				void					fillPathIndex( void );
+				STRUCT_LISTS			*lookup( const char *path, size_t max, STRUCT_LISTS *base );
+				void					writeNode( STRUCT_LISTS *lst, CppONWriter &w, STRUCT_LISTS *root, const void *snap );
+	static		uint32_t				pathHash( const STRUCT_LISTS *base, const char *path, size_t &len, size_t max = SIZE_MAX );
+
+				/*
+				 * pathIndex maps ( base, relative path ) to the element.  Every element is entered once for each of its
+				 * ancestors so getElement can resolve a path from any base with a single probe.  The paths are stored
+				 * with '/' separators in pathText;  lookups treat '.' and '/' as the same character.
+				 */
+				struct PATH_ENTRY
+				{
+					const STRUCT_LISTS	*base;
+					STRUCT_LISTS		*element;
+					uint32_t			offset;
+					uint32_t			length;
+					uint32_t			hash;
+				};
+				std::vector<PATH_ENTRY>	pathEntries;
+				std::vector<uint32_t>	pathIndex;
+				std::string				pathText;
+				std::vector<SCPP_EXTENT>	extents;				// One for each unit and array, in lock order
+				std::vector<STRUCT_LISTS *>	fields;					// Every value, by field id
 
 				std::string				sharedSegmentName;
-				std::vector<sem_t *>	sems;
 				void					*basePtr;
 				COMap					*config;
 				STRUCT_LISTS			*list;
@@ -213,7 +425,257 @@ private:
 				int						int16Offset = 0;
 				int 					eightBitOffset = 0;
 				int						charOffset = 0;
+				uint32_t				versionOffset = 0;
+				uint32_t				journalOffset = 0;
+				uint32_t				journalMask = 0;				// Records in the journal less one
+				uint32_t				layoutOffset = 0;
+				uint32_t				lockOffset = 0;
+				uint64_t				lockTimeout = SCPP_LOCK_TIMEOUT;
+				bool					seqReads = true;
+				bool					alignedLayout = false;
+				SCPP_LOCK				*notify = NULL;
 				bool					sharedMemoryAllocated = false;
 };
 
+/*
+ * A local copy of one unit taken with SCppObj::snapshot (or SCppObj::readPublished for a double buffered unit.)  Typed handles
+ * bound to values in the unit can load from it instead of from the segment.
+ *
+ *		SCppSnapshot	tsp( sysdata, "configuration.tsp" );
+ *		if( tsp.take() ) { temp.load( t, tsp ); }
+ */
+class SCppSnapshot
+{
+public:
+									SCppSnapshot( SCppObj *o, STRUCT_LISTS *u ) : obj( o ), unit( u ), data( ( o ) ? ( o->snapshotSize( u ) + 7 ) / 8 : 0 ) {}
+									SCppSnapshot( SCppObj *o, const char *path, STRUCT_LISTS *base = NULL ) : obj( o ), unit( ( o ) ? o->getPointer( path, base ) : NULL ), data( ( o ) ? ( o->snapshotSize( unit ) + 7 ) / 8 : 0 ) {}
+
+				bool				valid() const { return ! data.empty(); }
+				bool				take( bool protect = true ) { return( valid() && obj->snapshot( unit, data.data(), protect ) ); }
+				bool				takePublished() { return( valid() && obj->readPublished( unit, data.data() ) ); }
+				const void			*locate( STRUCT_LISTS *field ) const { return ( valid() ) ? obj->snapshotPointer( unit, field, data.data() ) : NULL; }
+				const void			*buffer() const { return data.data(); }
+				size_t				size() const { return data.size() * sizeof( uint64_t ); }
+				STRUCT_LISTS		*element() const { return unit; }
+
+private:
+				SCppObj					*obj;
+				STRUCT_LISTS			*unit;
+				std::vector<uint64_t>	data;
+};
+
+/*
+ * Maps the C++ type of a typed handle to the SL_TYPE it has to match and to how it is stored (booleans are a byte that is
+ * 0xFF or 0x00.)
+ */
+template<typename T> struct SCppFieldTraits;
+#define SCPP_FIELD_TRAITS( T, R, S ) \
+	template<> struct SCppFieldTraits<T> { typedef R raw; static const uint8_t type = S; static raw toRaw( T v ) { return (raw) v; } static T fromRaw( raw r ) { return (T) r; } }
+
+SCPP_FIELD_TRAITS( double, double, SL_TYPE_DOUBLE );
+SCPP_FIELD_TRAITS( int64_t, int64_t, SL_TYPE_INT64 );
+SCPP_FIELD_TRAITS( uint64_t, uint64_t, SL_TYPE_INT64 );
+SCPP_FIELD_TRAITS( int32_t, int32_t, SL_TYPE_INT32 );
+SCPP_FIELD_TRAITS( uint32_t, uint32_t, SL_TYPE_INT32 );
+SCPP_FIELD_TRAITS( int16_t, int16_t, SL_TYPE_INT16 );
+SCPP_FIELD_TRAITS( uint16_t, uint16_t, SL_TYPE_INT16 );
+SCPP_FIELD_TRAITS( int8_t, int8_t, SL_TYPE_INT8 );
+SCPP_FIELD_TRAITS( uint8_t, uint8_t, SL_TYPE_INT8 );
+template<> struct SCppFieldTraits<bool> { typedef uint8_t raw; static const uint8_t type = SL_TYPE_BOOL; static raw toRaw( bool v ) { return ( v ) ? 0xFF : 0x00; } static bool fromRaw( raw r ) { return 0 != r; } };
+
+/*
+ * A typed handle to one value in an SCppObj.  It is resolved and type checked once, when it is bound, and after that load()
+ * and store() go straight to the cached address:  load() is a sequence checked copy (falling back to the unit lock if a
+ * writer keeps getting in the way) and store() takes the unit lock, stores and stamps the time.  Given an SCppSnapshot of
+ * the unit the value is in, load() reads the value out of the snapshot instead.
+ *
+ *		SCppField<double>	temp( sysdata, "configuration.tsp.temperature" );
+ *		if( temp.valid() ) { temp.store( temp.load() + 1.0 ); }
+ */
+template<typename T> class SCppField
+{
+public:
+	typedef typename SCppFieldTraits<T>::raw	raw;
+
+									SCppField() : obj( NULL ), field( NULL ), lock( NULL ), addr( NULL ) {}
+									SCppField( SCppObj *o, STRUCT_LISTS *lst ) { bind( o, lst ); }
+									SCppField( SCppObj *o, const char *path, STRUCT_LISTS *base = NULL ) { bind( o, ( o ) ? o->getPointer( path, base ) : NULL ); }
+
+				bool				bind( SCppObj *o, STRUCT_LISTS *lst )
+				{
+					obj = o;
+					field = lst;
+					lock = NULL;
+					addr = NULL;
+					if( o && lst && lst->lock && SCppFieldTraits<T>::type == lst->type && sizeof( raw ) == lst->size )
+					{
+						lock = lst->lock;
+						addr = (raw *) ( (char *) o->getBasePtr() + lst->offset );
+					}
+					return valid();
+				}
+				bool				valid() const { return NULL != addr; }
+				STRUCT_LISTS		*element() const { return field; }
+
+				bool				load( T &v ) const
+				{
+					raw		r;
+					if( ! addr )
+					{
+						return false;
+					}
+					for( unsigned i = 0; SCPP_SEQ_TRIES > i; i++ )
+					{
+						uint32_t s = __atomic_load_n( &lock->sequence, __ATOMIC_ACQUIRE );
+						if( !( s & 1 ) )
+						{
+							r = *( (volatile raw *) addr );
+							__atomic_thread_fence( __ATOMIC_ACQUIRE );
+							if( s == __atomic_load_n( &lock->sequence, __ATOMIC_RELAXED ) )
+							{
+								v = SCppFieldTraits<T>::fromRaw( r );
+								return true;
+							}
+						}
+					}
+					if( obj->waitSem( lock ) )
+					{
+						r = *addr;
+						obj->postSem( lock );
+						v = SCppFieldTraits<T>::fromRaw( r );
+						return true;
+					}
+					return false;
+				}
+				T					load() const { T v = T(); load( v ); return v; }
+				bool				load( T &v, const SCppSnapshot &snap ) const
+				{
+					const void *p = ( addr ) ? snap.locate( field ) : NULL;
+					if( p )
+					{
+						raw		r;
+						memcpy( &r, p, sizeof( raw ) );
+						v = SCppFieldTraits<T>::fromRaw( r );
+						return true;
+					}
+					return false;
+				}
+
+				bool				store( T v, bool protect = true )
+				{
+					if( ! addr || ( protect && ! obj->waitSem( lock ) ) )
+					{
+						return false;
+					}
+					obj->beginWrite( lock );
+					*addr = SCppFieldTraits<T>::toRaw( v );
+					obj->setUpdateTime( field );
+					obj->endWrite( lock );
+					if( protect )
+					{
+						obj->postSem( lock );
+					}
+					return true;
+				}
+
+private:
+				SCppObj				*obj;
+				STRUCT_LISTS		*field;
+				SCPP_LOCK			*lock;
+				raw					*addr;
+};
+
+/*
+ * Strings:  SCppField<char[ N ]> binds to a string value whose storage fits in N characters.
+ */
+template<size_t N> class SCppField<char[ N ]>
+{
+public:
+									SCppField() : obj( NULL ), field( NULL ), lock( NULL ), addr( NULL ) {}
+									SCppField( SCppObj *o, STRUCT_LISTS *lst ) { bind( o, lst ); }
+									SCppField( SCppObj *o, const char *path, STRUCT_LISTS *base = NULL ) { bind( o, ( o ) ? o->getPointer( path, base ) : NULL ); }
+
+				bool				bind( SCppObj *o, STRUCT_LISTS *lst )
+				{
+					obj = o;
+					field = lst;
+					lock = NULL;
+					addr = NULL;
+					if( o && lst && lst->lock && SL_TYPE_CHAR == lst->type && lst->size && N >= lst->size )
+					{
+						lock = lst->lock;
+						addr = (char *) o->getBasePtr() + lst->offset;
+					}
+					return valid();
+				}
+				bool				valid() const { return NULL != addr; }
+				STRUCT_LISTS		*element() const { return field; }
+
+				bool				load( char ( &v )[ N ] ) const
+				{
+					if( ! addr )
+					{
+						return false;
+					}
+					for( unsigned i = 0; SCPP_SEQ_TRIES > i; i++ )
+					{
+						uint32_t s = __atomic_load_n( &lock->sequence, __ATOMIC_ACQUIRE );
+						if( !( s & 1 ) )
+						{
+							memcpy( v, addr, field->size );
+							__atomic_thread_fence( __ATOMIC_ACQUIRE );
+							if( s == __atomic_load_n( &lock->sequence, __ATOMIC_RELAXED ) )
+							{
+								v[ field->size - 1 ] = '\0';
+								return true;
+							}
+						}
+					}
+					if( obj->waitSem( lock ) )
+					{
+						memcpy( v, addr, field->size );
+						obj->postSem( lock );
+						v[ field->size - 1 ] = '\0';
+						return true;
+					}
+					return false;
+				}
+
+				bool				load( char ( &v )[ N ], const SCppSnapshot &snap ) const
+				{
+					const void *p = ( addr ) ? snap.locate( field ) : NULL;
+					if( p )
+					{
+						memcpy( v, p, field->size );
+						v[ field->size - 1 ] = '\0';
+						return true;
+					}
+					return false;
+				}
+
+				bool				store( const char *v, bool protect = true )
+				{
+					if( ! addr || ! v || ( protect && ! obj->waitSem( lock ) ) )
+					{
+						return false;
+					}
+					obj->beginWrite( lock );
+					addr[ field->size - 1 ] = '\0';
+					strncpy( addr, v, field->size - 1 );
+					obj->setUpdateTime( field );
+					obj->endWrite( lock );
+					if( protect )
+					{
+						obj->postSem( lock );
+					}
+					return true;
+				}
+
+private:
+				SCppObj				*obj;
+				STRUCT_LISTS		*field;
+				SCPP_LOCK			*lock;
+				char				*addr;
+};
+
 #endif /* SCppObj_HPP_ */
@@ -0,0 +1,739 @@
+/*
+ * CppONBench.cpp
+ *
+ *  Created on: October 14, 2026
+ *
+ *      Benchmark harness for the library.  From the Release directory "make bench" builds it against the library objects
+ *      and runs it, BENCH_ARGS is passed through to the program:
+ *
+ *          make bench BENCH_ARGS="-t 2 -o ../bench_baseline.json"      // longer runs, save the results
+ *          make bench BENCH_ARGS="-c ../bench_baseline.json -r 15"     // fail (exit 1) if any case lost more than 15% ops/s
+ *
+ *      Options:
+ *          -t seconds      time spent on each case (default 0.5)
+ *          -f text         only run the cases whose name contains text
+ *          -p n            number of reader (and writer) processes in the contention cases (default 3)
+ *          -s seed         seed for the generated corpora (default 1), the same seed always gives the same documents
+ *          -o file         write the results as a JSON object keyed by case name
+ *          -c file         compare ops/s against results written by -o
+ *          -r percent      regression tolerance for -c (default 10)
+ *
+ *      Every document is generated from the seed so runs on different machines measure the same input.  The corpora are:
+ *          small           a handful of records, about 1KB, what a single message looks like
+ *          medium          a few hundred records, about 64KB
+ *          huge            records to about 8MB
+ *          deep            maps and arrays nested 512 levels deep, one member each
+ *          wide            one map with 50000 members
+ *
+ *      Cases that take less than a microsecond are timed in batches and every operation in the batch is given the batch's
+ *      average, so percentiles for them describe batches rather than single calls.  The contention cases fork reader and
+ *      writer processes on one shared segment and time every call on its own.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <vector>
+
+#include "../CppON.hpp"
+#include "../SCppObj.hpp"
+#include "../LocalCppObj.hpp"
+
+#define BENCH_SUB_BITS			4														// each power of two is split into 16 buckets
+#define BENCH_BUCKETS			( 64 << BENCH_SUB_BITS )
+#define BENCH_MIN_SAMPLES		5														// timed batches per case however long they take
+#define BENCH_BATCH_NS			2000													// target length of one timed batch
+#define BENCH_UNITS				16														// units in the shared segment
+#define BENCH_DEEP				512
+#define BENCH_WIDE				50000
+
+static inline uint64_t nowNs()
+{
+	struct timespec tsp;
+	clock_gettime( CLOCK_MONOTONIC, &tsp );
+	return ( (uint64_t) tsp.tv_sec ) * 1000000000ULL + (uint64_t) tsp.tv_nsec;
+}
+
+static volatile uint64_t		sink;													// keeps the measured work from being optimised away
+
+/*
+ * Log-linear latency histogram.  Values under 16ns get a bucket each, above that every power of two is split into 16 buckets
+ * so a bucket is never wider than a sixteenth of the values in it.  It is a flat array so a forked worker can hand its
+ * histogram back through a pipe as it is.
+ */
+class LatencyHistogram
+{
+public:
+								LatencyHistogram() { clear(); }
+			void				clear() { memset( counts, 0, sizeof( counts ) ); total = 0; }
+			void				record( uint64_t ns, uint64_t n = 1 ) { counts[ bucket( ns ) ] += n; total += n; }
+			void				add( const LatencyHistogram &h ) { for( unsigned i = 0; BENCH_BUCKETS > i; i++ ) { counts[ i ] += h.counts[ i ]; } total += h.total; }
+			uint64_t			count() const { return total; }
+			uint64_t			percentile( double p ) const;
+private:
+	static	unsigned			bucket( uint64_t ns ) { if( 16 > ns ) { return (unsigned) ns; } unsigned msb = 63 - __builtin_clzll( ns ); return ( ( msb - 3 ) << BENCH_SUB_BITS ) + (unsigned)( ( ns >> ( msb - 4 ) ) & 15 ); }
+	static	uint64_t			middle( unsigned b ) { if( 16 > b ) { return b; } unsigned shift = ( b >> BENCH_SUB_BITS ) - 1; return ( ( 16ULL + ( b & 15 ) ) << shift ) + ( ( 1ULL << shift ) >> 1 ); }
+			uint64_t			counts[ BENCH_BUCKETS ];
+			uint64_t			total;
+};
+
+/*
+ * The value below which a fraction p of the recorded values fall, reported as the middle of its bucket.
+ */
+uint64_t LatencyHistogram::percentile( double p ) const
+{
+	if( ! total )
+	{
+		return 0;
+	}
+	uint64_t want = (uint64_t)( p * (double) total + 0.5 );
+	if( ! want )
+	{
+		want = 1;
+	}
+	uint64_t seen = 0;
+	for( unsigned i = 0; BENCH_BUCKETS > i; i++ )
+	{
+		if( want <= ( seen += counts[ i ] ) )
+		{
+			return middle( i );
+		}
+	}
+	return middle( BENCH_BUCKETS - 1 );
+}
+
+typedef struct BENCH_RESULT
+{
+	std::string				name;
+	uint64_t				ops;
+	double					seconds;
+	double					bytes;															// 0 when MB/s means nothing for the case
+	LatencyHistogram		hist;
+} BENCH_RESULT;
+
+/*
+ * What a forked contention worker writes back to its parent
+ */
+typedef struct BENCH_WORKER_REPORT
+{
+	uint64_t				ops;
+	LatencyHistogram		hist;
+} BENCH_WORKER_REPORT;
+
+typedef struct BENCH_START
+{
+	uint64_t				start;
+	uint64_t				end;
+	int						go;
+} BENCH_START;
+
+static double					benchSeconds = 0.5;
+static const char				*benchFilter = NULL;
+static unsigned					benchProcs = 3;
+static uint64_t					benchSeed = 1;
+static std::vector<BENCH_RESULT *>	results;
+
+/*
+ * xorshift64, all that is needed is the same documents for the same seed everywhere
+ */
+class BenchRandom
+{
+public:
+	explicit					BenchRandom( uint64_t seed ) : s( seed ? seed : 1 ) {}
+			uint64_t			next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+			unsigned			below( unsigned n ) { return (unsigned)( next() % n ); }
+			double				real() { return (double) ( next() >> 11 ) / 9007199254740992.0; }
+private:
+			uint64_t			s;
+};
+
+static bool wanted( const std::string &name )
+{
+	return( ! benchFilter || std::string::npos != name.find( benchFilter ) );
+}
+
+static void report( BENCH_RESULT *r )
+{
+	double ops = ( 0.0 < r->seconds ) ? (double) r->ops / r->seconds : 0.0;
+	char mbs[ 32 ];
+	if( 0.0 < r->bytes && 0.0 < r->seconds )
+	{
+		snprintf( mbs, sizeof( mbs ), "%10.1f", r->bytes / r->seconds / 1e6 );
+	} else {
+		snprintf( mbs, sizeof( mbs ), "%10s", "-" );
+	}
+	printf( "%-36s %12.0f %s %10.3f %10.3f %10.3f %10llu\n", r->name.c_str(), ops, mbs, (double) r->hist.percentile( 0.5 ) / 1000.0,
+			(double) r->hist.percentile( 0.99 ) / 1000.0, (double) r->hist.percentile( 0.999 ) / 1000.0, (unsigned long long) r->ops );
+	fflush( stdout );
+	results.push_back( r );
+}
+
+/*
+ * Time op() for benchSeconds.  A calibration pass, which also warms the caches and the allocator, picks how many calls go in
+ * one timed batch so that the clock reads stay small next to the work.  bytes is what one call processes, 0 for no MB/s.
+ */
+template<typename F> static void runCase( const std::string &name, size_t bytes, F op )
+{
+	if( ! wanted( name ) )
+	{
+		return;
+	}
+	uint64_t calls = 0;
+	uint64_t t0 = nowNs();
+	uint64_t t;
+	do
+	{
+		op();
+		calls++;
+	} while( 1000000ULL > ( t = nowNs() ) - t0 );
+	uint64_t per = ( t - t0 ) / calls;
+	unsigned batch = ( per >= BENCH_BATCH_NS ) ? 1 : (unsigned)( BENCH_BATCH_NS / ( per ? per : 1 ) );
+
+	BENCH_RESULT *r = new BENCH_RESULT();
+	r->name = name;
+	r->ops = 0;
+	unsigned samples = 0;
+	uint64_t limit = (uint64_t)( benchSeconds * 1e9 );
+	uint64_t start = nowNs();
+	do
+	{
+		t0 = nowNs();
+		for( unsigned i = 0; batch > i; i++ )
+		{
+			op();
+		}
+		t = nowNs();
+		r->hist.record( ( t - t0 ) / batch, batch );
+		r->ops += batch;
+		samples++;
+	} while( limit > t - start || BENCH_MIN_SAMPLES > samples );
+	r->seconds = (double)( t - start ) / 1e9;
+	r->bytes = (double) bytes * (double) r->ops;
+	report( r );
+}
+
+/*
+ * The corpora
+ */
+static const char *benchWords[] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel", "india", "juliet",
+		"kilo", "lima", "mike", "november", "oscar", "papa", "quebec", "romeo", "sierra", "tango", "uniform", "victor" };
+#define BENCH_N_WORDS			( sizeof( benchWords ) / sizeof( benchWords[ 0 ] ) )
+
+static void appendRecord( std::string &out, BenchRandom &rnd, unsigned id )
+{
+	char buf[ 256 ];
+	snprintf( buf, sizeof( buf ), "{\"id\":%u,\"name\":\"%s %s\",\"score\":%.6f,\"active\":%s,\"count\":%u,\"tags\":[", id,
+			benchWords[ rnd.below( BENCH_N_WORDS ) ], benchWords[ rnd.below( BENCH_N_WORDS ) ], rnd.real() * 1000.0,
+			( rnd.next() & 1 ) ? "true" : "false", rnd.below( 100000 ) );
+	out += buf;
+	unsigned nTags = 1 + rnd.below( 4 );
+	for( unsigned i = 0; nTags > i; i++ )
+	{
+		if( i )
+		{
+			out += ',';
+		}
+		out += '"';
+		out += benchWords[ rnd.below( BENCH_N_WORDS ) ];
+		out += '"';
+	}
+	snprintf( buf, sizeof( buf ), "],\"pos\":{\"x\":%.6f,\"y\":%.6f,\"z\":%.6f},\"note\":\"%s \\\"%s\\\" %s\",\"parent\":null}",
+			rnd.real() * 360.0 - 180.0, rnd.real() * 180.0 - 90.0, rnd.real() * 10000.0, benchWords[ rnd.below( BENCH_N_WORDS ) ],
+			benchWords[ rnd.below( BENCH_N_WORDS ) ], benchWords[ rnd.below( BENCH_N_WORDS ) ] );
+	out += buf;
+}
+
+static std::string makeRecords( size_t targetBytes, uint64_t seed )
+{
+	BenchRandom rnd( seed );
+	std::string out( "{\"source\":\"CppONBench\",\"records\":[" );
+	out.reserve( targetBytes + 512 );
+	unsigned n = 0;
+	while( out.size() < targetBytes || ! n )
+	{
+		if( n )
+		{
+			out += ',';
+		}
+		appendRecord( out, rnd, n++ );
+	}
+	char buf[ 64 ];
+	snprintf( buf, sizeof( buf ), "],\"count\":%u}", n );
+	out += buf;
+	return out;
+}
+
+/*
+ * Maps and arrays alternate down to the bottom: { "v": 0, "n": [ 1, { "v": 2, "n": [ 3, ... ] } ] }.  path gets the route to
+ * the innermost value.
+ */
+static std::string makeDeep( unsigned depth, std::string &path )
+{
+	std::string out;
+	path.clear();
+	for( unsigned i = 0; depth > i; i++ )
+	{
+		char buf[ 32 ];
+		if( i & 1 )
+		{
+			snprintf( buf, sizeof( buf ), "[%u,", i );
+			path += "1/";
+		} else {
+			snprintf( buf, sizeof( buf ), "{\"v\":%u,\"n\":", i );
+			path += "n/";
+		}
+		out += buf;
+	}
+	out += "{\"v\":-1}";
+	path += "v";
+	for( unsigned i = depth; i--; )
+	{
+		out += ( i & 1 ) ? ']' : '}';
+	}
+	return out;
+}
+
+static std::string makeWide( unsigned n, uint64_t seed )
+{
+	BenchRandom rnd( seed );
+	std::string out( "{" );
+	char buf[ 64 ];
+	for( unsigned i = 0; n > i; i++ )
+	{
+		switch( i & 3 )
+		{
+			case 0: snprintf( buf, sizeof( buf ), "%s\"k%06u\":%u", i ? "," : "", i, rnd.below( 1000000 ) ); break;
+			case 1: snprintf( buf, sizeof( buf ), ",\"k%06u\":%.6f", i, rnd.real() ); break;
+			case 2: snprintf( buf, sizeof( buf ), ",\"k%06u\":\"%s\"", i, benchWords[ rnd.below( BENCH_N_WORDS ) ] ); break;
+			default: snprintf( buf, sizeof( buf ), ",\"k%06u\":%s", i, ( rnd.next() & 1 ) ? "true" : "false" ); break;
+		}
+		out += buf;
+	}
+	out += '}';
+	return out;
+}
+
+/*
+ * parseJson, toCompactJsonString and toNetString over one document, every corpus is an object at the top
+ */
+static COMap *benchDocument( const char *name, const std::string &json )
+{
+	CppON *parsed = CppON::parseJson( json.c_str(), json.size() );
+	if( ! CppON::isMap( parsed ) )
+	{
+		fprintf( stderr, "%s[%d]: corpus %s did not parse\n", __FILE__, __LINE__, name );
+		delete parsed;
+		return NULL;
+	}
+	COMap *doc = (COMap *) parsed;
+	runCase( std::string( "parse/" ) + name, json.size(), [&]() {
+		CppON *p = CppON::parseJson( json.c_str(), json.size() );
+		sink += (uint64_t) p->size();
+		delete p;
+	} );
+
+	std::string *s = doc->toCompactJsonString();
+	size_t len = s->size();
+	delete s;
+	runCase( std::string( "compact/" ) + name, len, [&]() {
+		std::string *out = doc->toCompactJsonString();
+		sink += out->size();
+		delete out;
+	} );
+
+	s = doc->toNetString();
+	len = s->size();
+	delete s;
+	runCase( std::string( "tnet/" ) + name, len, [&]() {
+		std::string *out = doc->toNetString();
+		sink += out->size();
+		delete out;
+	} );
+	return doc;
+}
+
+/*
+ * The same lookup as a string, as a compiled CppONPath and as a caching CppONPath
+ */
+static void benchFind( const char *name, COMap *doc, const std::string &path )
+{
+	if( ! doc || ! doc->findElement( path.c_str() ) )
+	{
+		fprintf( stderr, "%s[%d]: %s not found in %s\n", __FILE__, __LINE__, path.c_str(), name );
+		return;
+	}
+	runCase( std::string( "find/" ) + name + "/string", 0, [&]() { sink += (uint64_t) doc->findElement( path.c_str() ); } );
+	CppONPath compiled( path );
+	runCase( std::string( "find/" ) + name + "/path", 0, [&]() { sink += (uint64_t) doc->findElement( compiled ); } );
+	CppONPath cached( path, true );
+	runCase( std::string( "find/" ) + name + "/cached", 0, [&]() { sink += (uint64_t) doc->findElement( cached ); } );
+}
+
+static COMap *segmentDefinition()
+{
+	std::string def( "{" );
+	char buf[ 512 ];
+	for( unsigned i = 0; BENCH_UNITS > i; i++ )
+	{
+		snprintf( buf, sizeof( buf ), "%s\"u%u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0},"
+				"\"l\":{\"type\":\"int\",\"size\":8,\"defaultValue\":0},\"d\":{\"type\":\"float\",\"defaultValue\":0.0},"
+				"\"b\":{\"type\":\"bool\",\"defaultValue\":false},\"s\":{\"type\":\"string\",\"size\":32,\"defaultValue\":\"\"}}",
+				i ? "," : "", i );
+		def += buf;
+	}
+	def += '}';
+	return (COMap *) CppON::parseJson( def.c_str(), def.size() );
+}
+
+/*
+ * Fork nReaders processes calling doubleValue() and nWriters calling updateDouble(), all locking.  With spread false every
+ * one of them works on u0, otherwise each call moves on to the next unit.  Every call is timed on its own.
+ */
+static void benchContention( SCppObj &obj, unsigned nReaders, unsigned nWriters, bool spread )
+{
+	char name[ 64 ];
+	snprintf( name, sizeof( name ), "contend/r%uw%u-%s", nReaders, nWriters, spread ? "spread" : "same" );
+	std::string base( name );
+	if( ! wanted( base + "/read" ) && ! wanted( base + "/write" ) )
+	{
+		return;
+	}
+	STRUCT_LISTS *fields[ BENCH_UNITS ];
+	for( unsigned i = 0; BENCH_UNITS > i; i++ )
+	{
+		snprintf( name, sizeof( name ), "u%u/d", i );
+		fields[ i ] = obj.getElement( name );
+	}
+	// cppcheck-suppress cstyleCast
+	BENCH_START *go = (BENCH_START *) mmap( NULL, sizeof( BENCH_START ), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+	if( MAP_FAILED == go )
+	{
+		fprintf( stderr, "%s[%d]: mmap failed: %s\n", __FILE__, __LINE__, strerror( errno ) );
+		return;
+	}
+	go->go = 0;
+	unsigned nProcs = nReaders + nWriters;
+	std::vector<int> fds;
+	std::vector<pid_t> pids;
+	for( unsigned p = 0; nProcs > p; p++ )
+	{
+		int pfd[ 2 ];
+		if( pipe( pfd ) )
+		{
+			fprintf( stderr, "%s[%d]: pipe failed: %s\n", __FILE__, __LINE__, strerror( errno ) );
+			break;
+		}
+		pid_t pid = fork();
+		if( 0 == pid )
+		{
+			close( pfd[ 0 ] );
+			bool writer = ( p >= nReaders );
+			BENCH_WORKER_REPORT *rpt = new BENCH_WORKER_REPORT();
+			rpt->ops = 0;
+			while( ! __atomic_load_n( &go->go, __ATOMIC_ACQUIRE ) )
+			{
+				sched_yield();
+			}
+			double v = (double) p;
+			unsigned u = p % BENCH_UNITS;
+			uint64_t t = nowNs();
+			while( go->end > t )
+			{
+				if( spread )
+				{
+					u = ( u + 1 ) % BENCH_UNITS;
+				}
+				uint64_t t0 = t;
+				if( writer )
+				{
+					obj.updateDouble( fields[ u ], v += 1.0 );
+				} else {
+					v += obj.doubleValue( fields[ u ] );
+				}
+				t = nowNs();
+				rpt->hist.record( t - t0 );
+				rpt->ops++;
+			}
+			sink += (uint64_t) v;
+			const char *ptr = (const char *) rpt;
+			size_t left = sizeof( BENCH_WORKER_REPORT );
+			while( left )
+			{
+				ssize_t n = write( pfd[ 1 ], ptr, left );
+				if( 0 >= n )
+				{
+					break;
+				}
+				ptr += n;
+				left -= (size_t) n;
+			}
+			_exit( 0 );
+		}
+		close( pfd[ 1 ] );
+		if( 0 > pid )
+		{
+			fprintf( stderr, "%s[%d]: fork failed: %s\n", __FILE__, __LINE__, strerror( errno ) );
+			close( pfd[ 0 ] );
+			break;
+		}
+		fds.push_back( pfd[ 0 ] );
+		pids.push_back( pid );
+	}
+	go->start = nowNs();
+	go->end = go->start + (uint64_t)( benchSeconds * 1e9 );
+	__atomic_store_n( &go->go, 1, __ATOMIC_RELEASE );
+
+	BENCH_RESULT *rd = new BENCH_RESULT();
+	BENCH_RESULT *wr = new BENCH_RESULT();
+	rd->name = base + "/read";
+	wr->name = base + "/write";
+	rd->ops = wr->ops = 0;
+	BENCH_WORKER_REPORT *rpt = new BENCH_WORKER_REPORT();
+	for( unsigned p = 0; fds.size() > p; p++ )
+	{
+		char *ptr = (char *) rpt;
+		size_t left = sizeof( BENCH_WORKER_REPORT );
+		while( left )
+		{
+			ssize_t n = read( fds[ p ], ptr, left );
+			if( 0 >= n )
+			{
+				break;
+			}
+			ptr += n;
+			left -= (size_t) n;
+		}
+		close( fds[ p ] );
+		if( left )
+		{
+			fprintf( stderr, "%s[%d]: worker %u sent no report\n", __FILE__, __LINE__, p );
+			continue;
+		}
+		BENCH_RESULT *r = ( p >= nReaders ) ? wr : rd;
+		r->ops += rpt->ops;
+		r->hist.add( rpt->hist );
+	}
+	for( unsigned p = 0; pids.size() > p; p++ )
+	{
+		waitpid( pids[ p ], NULL, 0 );
+	}
+	delete rpt;
+	rd->seconds = wr->seconds = (double)( go->end - go->start ) / 1e9;
+	rd->bytes = wr->bytes = 0.0;
+	munmap( go, sizeof( BENCH_START ) );
+	if( wanted( rd->name ) && nReaders )
+	{
+		report( rd );
+	} else {
+		delete rd;
+	}
+	if( wanted( wr->name ) && nWriters )
+	{
+		report( wr );
+	} else {
+		delete wr;
+	}
+}
+
+/*
+ * The SCppObj accessors, LocalCppObj::checkChanges and then readers against writers in separate processes
+ */
+static void benchShared()
+{
+	char segment[ 64 ];
+	snprintf( segment, sizeof( segment ), "/CppONBench.%d", (int) getpid() );
+	shm_unlink( segment );
+	COMap *def = segmentDefinition();
+	{
+		SCppObj obj( def, segment );
+		STRUCT_LISTS *iFld = obj.getElement( "u7/i" );
+		STRUCT_LISTS *dFld = obj.getElement( "u7/d" );
+		STRUCT_LISTS *sFld = obj.getElement( "u7/s" );
+		if( ! iFld || ! dFld || ! sFld )
+		{
+			fprintf( stderr, "%s[%d]: segment layout is missing fields\n", __FILE__, __LINE__ );
+		} else {
+			double v = 0.0;
+			std::string str;
+			runCase( "scpp/int/path", 0, [&]() { sink += obj.intValue( "u7/i" ); } );
+			runCase( "scpp/int/field", 0, [&]() { sink += obj.intValue( iFld ); } );
+			runCase( "scpp/int/unlocked", 0, [&]() { sink += obj.intValue( iFld, false ); } );
+			runCase( "scpp/double/update", 0, [&]() { obj.updateDouble( dFld, v += 1.0 ); } );
+			runCase( "scpp/string/read", 0, [&]() { obj.readString( sFld, &str ); sink += str.size(); } );
+			runCase( "scpp/string/update", 0, [&]() { obj.updateString( sFld, ( 1 & (uint64_t) v++ ) ? "benchmark one" : "benchmark two" ); } );
+
+			LocalCppObj local( &obj );
+			COMap settle;
+			local.checkChanges( &settle );
+			runCase( "local/checkChanges/idle", 0, [&]() { COMap changes; sink += local.checkChanges( &changes ); } );
+			runCase( "local/checkChanges/one", 0, [&]() {
+				obj.updateDouble( dFld, v += 1.0 );
+				COMap changes;
+				sink += local.checkChanges( &changes );
+			} );
+			runCase( "local/checkChanges/all", 0, [&]() {
+				v += 1.0;
+				for( unsigned i = 0; BENCH_UNITS > i; i++ )
+				{
+					char path[ 16 ];
+					snprintf( path, sizeof( path ), "u%u/d", i );
+					obj.updateDouble( path, v );
+				}
+				COMap changes;
+				sink += local.checkChanges( &changes );
+			} );
+
+			benchContention( obj, benchProcs, 0, false );
+			benchContention( obj, benchProcs, 1, false );
+			benchContention( obj, benchProcs, benchProcs, false );
+			benchContention( obj, benchProcs, benchProcs, true );
+		}
+	}
+	delete def;
+	shm_unlink( segment );
+}
+
+static bool saveResults( const char *path )
+{
+	COMap out;
+	for( unsigned i = 0; results.size() > i; i++ )
+	{
+		BENCH_RESULT *r = results[ i ];
+		COMap *m = new COMap();
+		m->append( "ops_s", ( 0.0 < r->seconds ) ? (double) r->ops / r->seconds : 0.0 );
+		if( 0.0 < r->bytes && 0.0 < r->seconds )
+		{
+			m->append( "mb_s", r->bytes / r->seconds / 1e6 );
+		}
+		m->append( "p50_ns", (int64_t) r->hist.percentile( 0.5 ) );
+		m->append( "p99_ns", (int64_t) r->hist.percentile( 0.99 ) );
+		m->append( "p999_ns", (int64_t) r->hist.percentile( 0.999 ) );
+		m->append( "ops", (int64_t) r->ops );
+		out.append( r->name, m );
+	}
+	if( out.toFile( path ) )
+	{
+		fprintf( stderr, "%s[%d]: failed to write %s\n", __FILE__, __LINE__, path );
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Returns the number of cases whose ops/s fell more than tolerance percent below the baseline
+ */
+static int compareResults( const char *path, double tolerance )
+{
+	CppON *base = CppON::parseJsonFile( path );
+	if( ! CppON::isMap( base ) )
+	{
+		fprintf( stderr, "%s[%d]: %s is not a results file\n", __FILE__, __LINE__, path );
+		delete base;
+		return 1;
+	}
+	int bad = 0;
+	printf( "\n%-36s %12s %12s %8s\n", "case", "baseline", "now", "change" );
+	for( unsigned i = 0; results.size() > i; i++ )
+	{
+		BENCH_RESULT *r = results[ i ];
+		CppON *was = ( (COMap *) base )->findElement( r->name + "/ops_s" );
+		if( ! CppON::isNumber( was ) || 0.0 >= was->toDouble() )
+		{
+			continue;
+		}
+		double old = was->toDouble();
+		double now = ( 0.0 < r->seconds ) ? (double) r->ops / r->seconds : 0.0;
+		double change = ( now - old ) * 100.0 / old;
+		bool regressed = ( -tolerance > change );
+		printf( "%-36s %12.0f %12.0f %+7.1f%%%s\n", r->name.c_str(), old, now, change, regressed ? "  REGRESSION" : "" );
+		if( regressed )
+		{
+			bad++;
+		}
+	}
+	delete base;
+	return bad;
+}
+
+static void usage( const char *prog )
+{
+	fprintf( stderr, "usage: %s [-t seconds] [-f filter] [-p procs] [-s seed] [-o results.json] [-c baseline.json] [-r percent]\n", prog );
+}
+
+int main( int argc, char **argv )
+{
+	const char *savePath = NULL;
+	const char *comparePath = NULL;
+	double tolerance = 10.0;
+	int opt;
+	while( -1 != ( opt = getopt( argc, argv, "t:f:p:s:o:c:r:h" ) ) )
+	{
+		switch( opt )
+		{
+			case 't': benchSeconds = atof( optarg ); break;
+			case 'f': benchFilter = optarg; break;
+			case 'p': benchProcs = (unsigned) atoi( optarg ); break;
+			case 's': benchSeed = strtoull( optarg, NULL, 0 ); break;
+			case 'o': savePath = optarg; break;
+			case 'c': comparePath = optarg; break;
+			case 'r': tolerance = atof( optarg ); break;
+			default: usage( argv[ 0 ] ); return 2;
+		}
+	}
+	if( 0.0 >= benchSeconds || ! benchProcs )
+	{
+		usage( argv[ 0 ] );
+		return 2;
+	}
+
+	std::string small = makeRecords( 1024, benchSeed );
+	std::string medium = makeRecords( 64 * 1024, benchSeed );
+	std::string huge = makeRecords( 8 * 1024 * 1024, benchSeed );
+	std::string deepPath;
+	std::string deep = makeDeep( BENCH_DEEP, deepPath );
+	std::string wide = makeWide( BENCH_WIDE, benchSeed );
+	printf( "corpora: small %zu, medium %zu, huge %zu, deep %zu (%u levels), wide %zu (%u members) bytes; %.2fs per case\n\n",
+			small.size(), medium.size(), huge.size(), deep.size(), BENCH_DEEP, wide.size(), BENCH_WIDE, benchSeconds );
+	printf( "%-36s %12s %10s %10s %10s %10s %10s\n", "case", "ops/s", "MB/s", "p50 us", "p99 us", "p99.9 us", "ops" );
+
+	delete benchDocument( "small", small );
+	COMap *mDoc = benchDocument( "medium", medium );
+	delete benchDocument( "huge", huge );
+	COMap *dDoc = benchDocument( "deep", deep );
+	COMap *wDoc = benchDocument( "wide", wide );
+
+	char path[ 64 ];
+	CppON *count = ( mDoc ) ? mDoc->findElement( "count" ) : NULL;
+	snprintf( path, sizeof( path ), "records/%lld/pos/y", ( CppON::isNumber( count ) ) ? count->toLongInt() / 2 : 0LL );
+	benchFind( "medium", mDoc, path );
+	benchFind( "deep", dDoc, deepPath );
+	snprintf( path, sizeof( path ), "k%06u", BENCH_WIDE / 2 );
+	benchFind( "wide", wDoc, path );
+	delete mDoc;
+	delete dDoc;
+	delete wDoc;
+
+	benchShared();
+
+	int rtn = 0;
+	if( savePath && ! saveResults( savePath ) )
+	{
+		rtn = 1;
+	}
+	if( comparePath && compareResults( comparePath, tolerance ) )
+	{
+		rtn = 1;
+	}
+	for( unsigned i = 0; results.size() > i; i++ )
+	{
+		delete results[ i ];
+	}
+	return rtn;
+}
@@ -0,0 +1,2230 @@
+/*
+ * CppONCheck.cpp
+ *
+ *  Created on: October 14, 2026
+ *
+ *      Behaviour checks for the library.  From the Release directory "make check" builds it against the library objects
+ *      and runs it.  Every failed check is printed with its line and the program exits 1 if any failed.
+ *
+ *      Options:
+ *          -f text         only run the groups whose name contains text
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <signal.h>
+
+#include <stdexcept>
+
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../CppON.hpp"
+#include "../SCppObj.hpp"
+#include "../LocalCppObj.hpp"
+
+static const char				*checkFilter = NULL;
+static unsigned					checksRun = 0;
+static unsigned					checksFailed = 0;
+
+#define CHECK( cond )			check( ( cond ), #cond, __LINE__ )
+
+static void check( bool ok, const char *what, int line )
+{
+	checksRun++;
+	if( ! ok )
+	{
+		checksFailed++;
+		fprintf( stderr, "%s[%d]: check failed: %s\n", __FILE__, line, what );
+	}
+}
+
+static bool wanted( const char *name )
+{
+	return ! checkFilter || strstr( name, checkFilter );
+}
+
+/*
+ * The compact JSON of a node, as a value
+ */
+static std::string json( CppON *o )
+{
+	std::string	rtn;
+	std::string	*s = ( o ) ? o->toCompactJsonString() : NULL;
+
+	if( s )
+	{
+		rtn = *s;
+		delete s;
+	}
+	return rtn;
+}
+
+/*
+ * The same for a node the caller is handed, which is deleted
+ */
+static std::string taken( CppON *o )
+{
+	std::string	rtn = json( o );
+
+	delete o;
+	return rtn;
+}
+
+/*
+ * A copy of a double writes the same text as the double it was copied from
+ */
+static void checkDoubles()
+{
+	CppON	*parsed = CppON::parseJson( "{\"d\":2.5,\"e\":[3.25]}" );
+	CODouble	shortest( 2.5 );
+
+	shortest.Precision( (unsigned char) -1 );
+	for( int p = -1; 16 >= p; p++ )
+	{
+		CODouble	d( 1.0 / 3.0 );
+		d.Precision( (unsigned char) p );
+		CODouble	ref( d );
+		CODouble	ptr( &d );
+		CppON		*f = CppON::factory( d );
+		CHECK( json( &d ) == json( &ref ) );
+		CHECK( json( &d ) == json( &ptr ) );
+		CHECK( json( &d ) == json( f ) );
+		delete f;
+	}
+	{
+		CODouble	ref( shortest );
+		CHECK( json( &shortest ) == json( &ref ) );
+	}
+	if( parsed )
+	{
+		CppON	*f = CppON::factory( parsed );
+		COMap	copy( *(COMap *) parsed );
+		CHECK( json( parsed ) == json( f ) );
+		copy.findElement( "e" );												// splits the copy from parsed
+		CHECK( json( parsed ) == json( f ) );
+		CHECK( json( parsed ) == json( &copy ) );
+		delete f;
+	}
+	CHECK( NULL != parsed );
+	delete parsed;
+
+	CppON	*a = CppON::parseJson( "{\"x\":1.5,\"y\":{\"z\":2.5}}" );
+	CppON	*b = CppON::parseJson( "{\"x\":3.5,\"y\":{\"z\":4.5}}" );
+	if( a && b )
+	{
+		COMap	copy( *(COMap *) b );
+		CppON	*d1 = a->diff( copy );
+		CppON	*d2 = a->diff( copy );
+		CHECK( json( d1 ) == json( d2 ) );
+		CHECK( std::string::npos != json( d1 ).find( "3.5000000000" ) );
+		delete d1;
+		delete d2;
+	}
+	delete a;
+	delete b;
+}
+
+/*
+ * Numbers are written as the shortest text that reads back exactly, and JSON has no NaN or infinity.
+ */
+static void checkNumbers()
+{
+	unsigned	seed = 777;
+	bool		exact = true;
+
+	for( unsigned i = 0; 20000 > i && exact; i++ )
+	{
+		uint64_t	bits = 0;
+		double		v;
+		for( int k = 0; 4 > k; k++ )
+		{
+			seed = seed * 1103515245 + 12345;
+			bits = ( bits << 16 ) | ( ( seed >> 8 ) & 0xFFFF );
+		}
+		memcpy( &v, &bits, sizeof( v ) );
+		if( ! std::isfinite( v ) )
+		{
+			continue;
+		}
+		CODouble			d( v );
+		d.Precision( (unsigned char) -1 );
+		std::string			text = json( &d );
+		exact = ( strtod( text.c_str(), NULL ) == v && std::string::npos != text.find_first_of( ".eE" ) );
+	}
+	CHECK( exact );
+	{
+		CODouble	d( 0.1 );
+		CODouble	e( 1e21 );
+		CODouble	f( -2.0 );
+		d.Precision( (unsigned char) -1 );
+		e.Precision( (unsigned char) -1 );
+		f.Precision( (unsigned char) -1 );
+		CHECK( "0.1" == json( &d ) && "1e+21" == json( &e ) && "-2.0" == json( &f ) );
+	}
+	{
+		COInteger	i( (int64_t) -9223372036854775807LL - 1 );
+		COInteger	j( (int64_t) 1234567890123LL );
+		CHECK( "-9223372036854775808" == json( &i ) && "1234567890123" == json( &j ) );
+	}
+
+	double		odd[] = { NAN, INFINITY, -INFINITY };
+	for( unsigned i = 0; 3 > i; i++ )
+	{
+		CODouble	d( odd[ i ] );
+		CODouble	p( odd[ i ] );
+		COMap		m;
+		std::string	out;
+		p.Precision( 3 );
+		CHECK( "null" == json( &d ) && "null" == json( &p ) );
+		m.append( "x", new CODouble( odd[ i ] ) );
+		CHECK( "{\"x\":null}" == json( &m ) );
+		{
+			CppONWriter	w( out );
+			w.putDouble( odd[ i ], 2 );
+			w.put( ',' );
+			w.putDouble( odd[ i ] );
+		}
+		CHECK( "null,null" == out );
+		out.clear();
+		{
+			CppONWriter	w( out, CPPON_WRITE_TNET );
+			w.write( &m );
+		}
+		CppON	*back = CppON::parseJson( out.c_str() );
+		CHECK( "{\"x\":null}" == taken( back ) );
+	}
+}
+
+/*
+ * A change drops the cached hashes on its way up to the root and nowhere else
+ */
+/*
+ * Trees built in an arena read, change and delete like heap trees, and clear() keeps the first block whatever its size.
+ */
+static void checkArena()
+{
+	const char			*text = "{\"a\":[1,2.5,\"three\",true,null,{\"b\":[]}],\"c\":{\"d\":\"e\",\"f\":-7}}";
+	CppONParseError		err;
+	CppON				*heap = CppON::parseJson( text );
+	{
+		CppONArena		arena( 1024 );
+		CppON			*tree = CppON::parseJson( text, strlen( text ), err, &arena );
+
+		CHECK( CppON::isMap( tree ) && json( heap ) == json( tree ) && 0 < arena.allocated() );
+		if( CppON::isMap( tree ) )
+		{
+			COMap		*m = (COMap *) tree;
+			delete m->extract( "c" );
+			m->append( "g", new COString( "heap" ) );
+			// cppcheck-suppress cstyleCast
+			( (COArray *) m->findElement( "a" ) )->append( new CODouble( 0.5 ) );
+			CHECK( "{\"a\":[1,2.5000000000,\"three\",true,null,{\"b\":[]},0.5000000000],\"g\":\"heap\"}" == json( tree ) );
+		}
+		delete tree;
+
+		std::string		*bin = heap->toBinary();
+		tree = CppON::parseBinary( bin->data(), bin->size(), err, &arena );
+		delete bin;
+		CHECK( json( heap ) == taken( tree ) );
+
+		COMap			*made = arena.make<COMap>();
+		made->append( "n", arena.make<COInteger>( (int64_t) 42 ) );
+		made->append( "s", arena.make<COString>( "x", (size_t) 1, arena ) );
+		CHECK( "{\"n\":42,\"s\":\"x\"}" == taken( made ) );
+	}
+	delete heap;
+
+	CppONArena	small( 256 );
+	small.alloc( 4096 );
+	small.alloc( 16 );
+	CHECK( 4096 + 256 == small.allocated() );
+	small.clear();
+	CHECK( 4096 == small.allocated() );
+	small.alloc( 4000 );
+	CHECK( 4096 == small.allocated() );
+}
+
+static void checkHashes()
+{
+	COMap	*a = (COMap *) CppON::parseJson( "{\"x\":1,\"y\":{\"z\":[1,2,{\"w\":\"s\"}]},\"v\":{\"u\":2}}" );
+	COMap	*b = (COMap *) CppON::parseJson( "{\"x\":1}" );
+
+	CHECK( a && b );
+	if( ! a || ! b )
+	{
+		delete a;
+		delete b;
+		return;
+	}
+	uint64_t	h = a->hash();
+	CppON		*w = a->findElement( "y/z:2/w" );
+	CppON		*v = a->findElement( "v" );
+	CHECK( CppON::isString( w ) && CppON::isMap( v ) );
+	h = a->hash();
+	b->hash();
+	*(COString *) w = "t";
+	CHECK( ! a->hashed() );
+	CHECK( v->hashed() );															// not on the path to w
+	CHECK( b->hashed() );															// another tree entirely
+	CHECK( h != a->hash() );
+	*(COString *) w = "s";
+	CHECK( h == a->hash() );
+
+	COMap	*y = (COMap *) a->extract( "y" );
+	CHECK( NULL != y );
+	a->hash();
+	delete a;																		// y must not lead back to a
+	CHECK( y && y->hashed() );
+	if( y )
+	{
+		COArray *z = (COArray *) y->findElement( "z" );
+		z->append( 3 );
+		CHECK( ! y->hashed() );
+	}
+	delete y;
+	delete b;
+}
+
+/*
+ * A pointer into a map taken before it was copied never leads into the copy, and each side changes on its own
+ */
+static void checkCopies()
+{
+	COMap	*orig = (COMap *) CppON::parseJson( "{\"a\":1,\"b\":{\"c\":2,\"d\":[3,{\"e\":4}]},\"f\":{\"g\":5}}" );
+
+	CHECK( NULL != orig );
+	if( ! orig )
+	{
+		return;
+	}
+	CppON		*a = orig->findElement( "a" );
+	CppON		*c = orig->findElement( "b/c" );
+	CppON		*e = orig->findElement( "b/d:1/e" );
+	COInteger	*kept = new COInteger( 6 );
+	orig->append( "f/h", kept );
+	std::string	before = json( orig );
+	CHECK( a && c && e );
+	if( a && c && e )
+	{
+		COMap	copy( *orig );
+		COMap	assigned;
+		assigned = *orig;
+		CppON	*f = CppON::factory( orig );
+		*(COInteger *) a = 10;
+		*(COInteger *) c = 20;
+		*(COInteger *) e = 40;
+		*kept = 60;
+		CHECK( before == json( &copy ) );
+		CHECK( before == json( &assigned ) );
+		CHECK( before == json( f ) );
+		CHECK( json( orig ) != before );
+
+		*(COInteger *) copy.findElement( "f/g" ) = 50;									// and the other way round
+		CHECK( 5 == ( (COInteger *) orig->findElement( "f/g" ) )->intValue() );
+		CHECK( 5 == ( (COInteger *) assigned.findElement( "f/g" ) )->intValue() );
+		CHECK( 50 == ( (COInteger *) copy.findElement( "f/g" ) )->intValue() );
+		delete f;
+	}
+
+	COMap	*src = (COMap *) CppON::parseJson( "{\"p\":{\"q\":{\"r\":1}}}" );
+	CHECK( NULL != src );
+	if( src )
+	{
+		COMap	first( *src );
+		COMap	second( first );														// a copy of a copy
+		CppON	*r = first.findElement( "p/q/r" );
+		CHECK( NULL != r );
+		if( r )
+		{
+			*(COInteger *) r = 2;
+		}
+		CHECK( "{\"p\":{\"q\":{\"r\":1}}}" == json( src ) );
+		CHECK( "{\"p\":{\"q\":{\"r\":1}}}" == json( &second ) );
+		CHECK( "{\"p\":{\"q\":{\"r\":2}}}" == json( &first ) );
+	}
+	delete src;
+	delete orig;
+}
+
+/*
+ * One message fanned out to handlers on several threads: lookups, walks and copies of a shared copy from all of them at
+ * once see the same tree.  Run under -fsanitize=thread to see the races, here only the results are checked.
+ */
+static void checkFanOut()
+{
+	const char	*text = "{\"a\":1,\"b\":{\"c\":{\"x\":2},\"d\":[1,2,{\"e\":3}]},\"f\":[4,5]}";
+
+	for( int round = 0; 20 > round; round++ )
+	{
+		COMap		*orig = (COMap *) CppON::parseJson( text );
+		COMap		*copy = ( orig ) ? new COMap( *orig ) : NULL;
+		unsigned	bad[ 4 ] = { 0, 0, 0, 0 };
+		std::vector<std::thread>	handlers;
+
+		CHECK( NULL != copy );
+		if( ! copy )
+		{
+			delete orig;
+			return;
+		}
+		for( int t = 0; 4 > t; t++ )
+		{
+			handlers.emplace_back( [ copy, text, t, &bad ]() {
+				for( int k = 0; 50 > k; k++ )
+				{
+					CppON   *c = copy->findElement( "b/c" );
+					CppON   *e = copy->findElement( "b/d:2/e" );
+					COMap   mine( *copy );
+					if( ! CppON::isMap( c ) || ! CppON::isInteger( e ) || json( copy ) != text )
+					{
+						bad[ t ]++;
+					}
+					*(COInteger *) mine.findElement( "b/d:2/e" ) = t;
+				}
+			} );
+		}
+		delete orig;																// the handlers' copy outlives it
+		for( size_t t = 0; handlers.size() > t; t++ )
+		{
+			handlers[ t ].join();
+		}
+		CHECK( 0 == bad[ 0 ] + bad[ 1 ] + bad[ 2 ] + bad[ 3 ] );
+		CHECK( json( copy ) == text );
+		delete copy;
+	}
+}
+
+/*
+ * Parse failures come back as a code and a position, never a crash or a message on stderr
+ */
+/*
+ * Whatever the parser reads, each writer's output reads back as the same tree.
+ */
+static void checkRoundTrips()
+{
+	const char	*docs[] = {
+		"{}", "[]", "{\"a\":{},\"b\":[[],{}]}",
+		"{\"int\":-42,\"big\":9223372036854775807,\"neg\":-9223372036854775807,\"d\":-0.25,\"e\":1.5e300,\"tiny\":4.9e-324}",
+		"[true,false,null,0,-0.0,1e3,\"\"]",
+		" { \"sp aced\" :\t[ 1 ,\n 2 ] ,\r\n \"x\" : \"y\" } ",
+		"{\"esc\":\"q\\\"b\\\\s\\/t\\tn\\nu\\u00e9\\u20ac\"}",
+		"{\"nest\":[{\"a\":[{\"b\":[{\"c\":\"d\"}]}]}]}",
+	};
+
+	for( size_t i = 0; sizeof( docs ) / sizeof( docs[ 0 ] ) > i; i++ )
+	{
+		CppON		*tree = CppON::parseJson( docs[ i ] );
+		std::string	once = json( tree );
+		std::string	pretty;
+		std::string	tnet;
+		std::string	standard;
+
+		CHECK( NULL != tree && ! once.empty() );
+		if( ! tree )
+		{
+			continue;
+		}
+		CHECK( once == taken( CppON::parseJson( once.c_str() ) ) );
+		{
+			CppONWriter	p( pretty, CPPON_WRITE_PRETTY );
+			CppONWriter	t( tnet, CPPON_WRITE_TNET );
+			CppONWriter	j( standard, CPPON_WRITE_JSON );
+			p.write( tree );
+			t.write( tree );
+			j.write( tree );
+		}
+		CHECK( once == taken( CppON::parseJson( pretty.c_str() ) ) );
+		CHECK( once == taken( CppON::parseJson( tnet.c_str() ) ) );
+		CHECK( once == taken( CppON::parseJson( standard.c_str() ) ) );
+
+		std::string	cut = std::string( docs[ i ] ) + "garbage";
+		CHECK( once == taken( CppON::parseJson( cut.data(), strlen( docs[ i ] ) ) ) );
+		delete tree;
+	}
+
+	CppON	*values = CppON::parseJson( docs[ 3 ] );
+	CHECK( CppON::isMap( values ) );
+	if( CppON::isMap( values ) )
+	{
+		COMap	*m = (COMap *) values;
+		CHECK( CppON::isInteger( m->findElement( "big" ) ) && 9223372036854775807LL == m->findElement( "big" )->toLongInt() );
+		CHECK( CppON::isDouble( m->findElement( "d" ) ) && -0.25 == m->findElement( "d" )->toDouble() );
+		CHECK( 4.9e-324 == m->findElement( "tiny" )->toDouble() && 1.5e300 == m->findElement( "e" )->toDouble() );
+	}
+	delete values;
+
+	values = CppON::parseJson( docs[ 6 ] );
+	CHECK( CppON::isMap( values ) );
+	if( CppON::isMap( values ) )
+	{
+		CppON	*e = ( (COMap *) values )->findElement( "esc" );
+		CHECK( CppON::isString( e ) && 0 == strcmp( "q\"b\\s/t\tn\nu\xc3\xa9\xe2\x82\xac", e->c_str() ) );
+	}
+	delete values;
+}
+
+/*
+ * Every sink gets the same bytes, which are what the node's own serializers produce.
+ */
+static void checkWriter()
+{
+	COArray		big;
+	for( int i = 0; 5000 > i; i++ )
+	{
+		COMap	*m = new COMap();
+		m->append( "i", new COInteger( (int64_t) i ) );
+		m->append( "s", new COString( "some text to fill chunks" ) );
+		m->append( "d", new CODouble( i / 8.0 ) );
+		big.append( m );
+	}
+
+	std::string	compact;
+	std::string	pretty;
+	std::string	tnet;
+	std::string	binary;
+	{
+		CppONWriter	c( compact );
+		CppONWriter	p( pretty, CPPON_WRITE_PRETTY );
+		CppONWriter	t( tnet, CPPON_WRITE_TNET );
+		CppONWriter	b( binary, CPPON_WRITE_BINARY );
+		c.write( &big );
+		p.write( &big );
+		t.write( &big );
+		b.write( &big );
+		c.flush();
+		CHECK( compact.size() == c.length() && ! c.failed() );
+	}
+	std::string	*s;
+	CHECK( ( s = big.toCompactJsonString() ) && *s == compact );
+	delete s;
+	CHECK( ( s = big.toJsonString() ) && *s == pretty );
+	delete s;
+	CHECK( ( s = big.toNetString() ) && *s == tnet );
+	delete s;
+	CHECK( ( s = big.toBinary() ) && *s == binary );
+	delete s;
+
+	std::vector<char>	buf( compact.size() + 1 );
+	{
+		CppONWriter	w( &buf[ 0 ], buf.size() );
+		w.write( &big ).flush();
+		CHECK( ! w.failed() && compact == &buf[ 0 ] );
+	}
+	{
+		CppONWriter	w( &buf[ 0 ], compact.size() );
+		w.write( &big ).flush();
+		CHECK( w.failed() && compact.size() == w.length() && compact.substr( 0, compact.size() - 1 ) == &buf[ 0 ] );
+	}
+
+	FILE	*fp = tmpfile();
+	CHECK( NULL != fp );
+	if( fp )
+	{
+		{
+			CppONWriter	w( fp );
+			w.write( &big );
+		}
+		std::string	back( compact.size() + 1, '\0' );
+		rewind( fp );
+		CHECK( compact.size() == fread( &back[ 0 ], 1, back.size(), fp ) && compact == back.c_str() );
+		fclose( fp );
+	}
+
+	char	name[] = "/tmp/CppONCheck.XXXXXX";
+	int		fd = mkstemp( name );
+	CHECK( 0 <= fd );
+	if( 0 <= fd )
+	{
+		unlink( name );
+		{
+			CppONWriter	w( fd, CPPON_WRITE_TNET );
+			w.write( &big );
+		}
+		std::string	back( tnet.size() + 1, '\0' );
+		CHECK( (ssize_t) tnet.size() == pread( fd, &back[ 0 ], back.size(), 0 ) && tnet == back.c_str() );
+		close( fd );
+	}
+
+	std::string	parts;
+	{
+		CppONWriter	w( parts );
+		w.put( '[' );
+		w.putInt( -5 );
+		w.put( ',' );
+		w.putDouble( 0.1 );
+		w.put( ',' );
+		w.putDouble( 1.0 / 3.0, 2 );
+		w.put( ',' );
+		w.putBool( false );
+		w.put( ',' );
+		w.putString( "a\"b", 3 );
+		w.put( ']' );
+	}
+	CHECK( "[-5,0.1,0.33,false,\"a%22b\"]" == parts );
+}
+
+/*
+ * Writes each event down so two parses can be compared, and can stop after a given number of them.
+ */
+class TraceHandler : public CppONHandler
+{
+public:
+	explicit	TraceHandler( size_t stop = 0 ) : stopAt( stop ), events( 0 ) {}
+	bool		startObject() { return note( "{" ); }
+	bool		key( const char *k, size_t len ) { return note( "k:" + std::string( k, len ) ); }
+	bool		endObject() { return note( "}" ); }
+	bool		startArray() { return note( "[" ); }
+	bool		endArray() { return note( "]" ); }
+	bool		intValue( int64_t v ) { return note( "i:" + std::to_string( v ) ); }
+	bool		doubleValue( double v ) { return note( "d:" + std::to_string( v ) ); }
+	bool		stringValue( const char *v, size_t len ) { return note( "s:" + std::string( v, len ) ); }
+	bool		boolValue( bool v ) { return note( ( v ) ? "true" : "false" ); }
+	bool		nullValue() { return note( "null" ); }
+
+	std::string	trace;
+private:
+	bool		note( const std::string &e ) { trace += e + ' '; return ! stopAt || ++events < stopAt; }
+	size_t		stopAt;
+	size_t		events;
+};
+
+/*
+ * Events and selections see the same document a full parse does.
+ */
+static void checkEvents()
+{
+	const char		*doc = "{\"a\":{\"b\":[1,2.5,\"x\\ty\"],\"c\":true},\"list\":[null,{\"deep\":false},-3],\"s\":\"plain\"}";
+	CppONParseError	err;
+	TraceHandler	fromJson;
+	TraceHandler	fromTnet;
+	CppON			*tree = CppON::parseJson( doc );
+	// cppcheck-suppress cstyleCast
+	std::string		*tnet = ( (COMap *) tree )->toNetString();
+
+	CHECK( CppON::parseEvents( doc, strlen( doc ), fromJson, err ) );
+	CHECK( "{ k:a { k:b [ i:1 d:2.500000 s:x\ty ] k:c true } k:list [ null { k:deep false } i:-3 ] k:s s:plain } " == fromJson.trace );
+	CHECK( CppON::parseEvents( tnet->data(), tnet->size(), fromTnet, err ) && fromJson.trace == fromTnet.trace );
+	delete tnet;
+
+	TraceHandler	stopping( 4 );
+	CHECK( ! CppON::parseEvents( doc, strlen( doc ), stopping, err ) && CPPON_PARSE_STOPPED == err.code );
+	CHECK( "{ k:a { k:b " == stopping.trace );
+
+	std::vector<CppONPath>	paths;
+	std::vector<CppON *>	found;
+	const char				*names[] = { "a/b", "list:1", "s", "missing", "list:9", "a/c/x", "a/b:2", "list:1/deep", "a:0" };
+	for( size_t i = 0; sizeof( names ) / sizeof( names[ 0 ] ) > i; i++ )
+	{
+		paths.push_back( CppONPath( names[ i ] ) );
+	}
+	CHECK( 5 == CppON::parseSelect( doc, strlen( doc ), paths, found, err ) && paths.size() == found.size() );
+	CHECK( 9 == found.size() && NULL == found[ 3 ] && NULL == found[ 4 ] && NULL == found[ 5 ] && NULL == found[ 8 ] );
+	for( size_t i = 0; found.size() > i; i++ )
+	{
+		if( found[ i ] )
+		{
+			// cppcheck-suppress cstyleCast
+			CHECK( json( ( (COMap *) tree )->findElement( names[ i ] ) ) == json( found[ i ] ) );
+		}
+		delete found[ i ];
+	}
+
+	std::string				wide = "{";
+	paths.clear();
+	for( int i = 0; 150 > i; i++ )
+	{
+		wide += ( i ? ",\"k" : "\"k" ) + std::to_string( i ) + "\":" + std::to_string( i );
+		paths.push_back( CppONPath( "k" + std::to_string( 149 - i ) ) );
+	}
+	wide += "}";
+	CHECK( 150 == CppON::parseSelect( wide.data(), wide.size(), paths, found, err ) );
+	bool	match = ( 150 == found.size() );
+	for( size_t i = 0; found.size() > i; i++ )
+	{
+		match = match && CppON::isInteger( found[ i ] ) && (int64_t) ( 149 - i ) == found[ i ]->toLongInt();
+		delete found[ i ];
+	}
+	CHECK( match );
+
+	std::string				broken = "{\"a\":{\"b\":[1,2,}";
+	paths.assign( 1, CppONPath( "z" ) );
+	CHECK( 0 == CppON::parseSelect( broken.data(), broken.size(), paths, found, err ) && CPPON_PARSE_OK != err.code && NULL == found[ 0 ] );
+	delete tree;
+}
+
+/*
+ * A table split across threads comes back the same as one read on a single thread, whatever the options.
+ */
+static void checkTables()
+{
+	std::string		csv = "id,half,note,tag,late\n";
+	for( int i = 0; 80000 > i; i++ )
+	{
+		csv += std::to_string( i ) + ',' + std::to_string( i / 4.0 ) + ",\"a,\"\"b\"\"\nc" + std::to_string( i ) + "\",t" + std::to_string( i % 7 ) + ',';
+		csv += ( 75000 == i ) ? "x" : std::to_string( i % 3 );
+		csv += ( 0 == i % 997 ) ? "\n\n" + std::to_string( -i ) + "\n" : "\n";
+	}
+	for( int mode = 0; 8 > mode; mode++ )
+	{
+		CppONTableOptions	one;
+		one.header = ( 0 != ( mode & 1 ) );
+		one.types = ( 0 != ( mode & 2 ) );
+		one.columns = ( 0 != ( mode & 4 ) );
+		one.threads = 1;
+		CppONTableOptions	many( one );
+		many.threads = 3;
+		std::string			single = taken( CppON::parseTable( csv.data(), csv.size(), one ) );
+		CHECK( 1000000 < single.size() && taken( CppON::parseTable( csv.data(), csv.size(), many ) ) == single );
+	}
+}
+
+static CppONParseErrorCode parseCode( const std::string &text, CppONParseError &err )
+{
+	CppON	*o = CppON::parseJson( text.data(), text.size(), err );
+
+	delete o;
+	return err.code;
+}
+
+static void checkErrors()
+{
+	CppONParseError	err;
+	CppONHandler	ignore;
+
+	CHECK( CPPON_PARSE_OK == parseCode( "{\"a\":1,\"b\":[1,2,],}", err ) );					// trailing commas are tolerated
+	CHECK( CPPON_PARSE_EXPECTED_COLON == parseCode( "{\"a\" 1}", err ) );
+	CHECK( 5 == err.offset && 1 == err.line && 6 == err.column );
+	CHECK( CPPON_PARSE_UNEXPECTED_CHARACTER == parseCode( "{\"a\":1,\n  \"b\":tru}", err ) );
+	CHECK( 2 == err.line && 7 == err.column && 14 == err.offset );
+	CHECK( CPPON_PARSE_UNTERMINATED_STRING == parseCode( "[\"abc", err ) );
+	CHECK( CPPON_PARSE_BAD_ESCAPE == parseCode( "\"a\\u12G4\"", err ) );
+	CHECK( CPPON_PARSE_UNEXPECTED_END == parseCode( "[1,", err ) );
+	CHECK( CPPON_PARSE_EXPECTED_KEY == parseCode( "{1:2}", err ) );
+	CHECK( 0 == strcmp( "Unexpected end of input", ( parseCode( "", err ), err.message() ) ) );
+
+	std::string	deep( CPPON_MAX_DEPTH, '[' );
+	deep.append( CPPON_MAX_DEPTH, ']' );
+	CHECK( CPPON_PARSE_OK == parseCode( deep, err ) );
+	CHECK( CppON::parseEvents( deep.data(), deep.size(), ignore, err ) );
+	deep.insert( 0, "[" );
+	deep.append( "]" );
+	CHECK( CPPON_PARSE_TOO_DEEP == parseCode( deep, err ) );
+	CHECK( CPPON_MAX_DEPTH == err.offset && 1 == err.line && CPPON_MAX_DEPTH + 1 == err.column );
+	CHECK( 0 == strcmp( "Nested too deep", err.message() ) );
+
+	std::string	flood( 1 << 20, '[' );												// one message from a bad peer
+	CHECK( CPPON_PARSE_TOO_DEEP == parseCode( flood, err ) );
+	CHECK( ! CppON::parseEvents( flood.data(), flood.size(), ignore, err ) && CPPON_PARSE_TOO_DEEP == err.code );
+	std::vector<CppONPath>	paths;
+	std::vector<CppON *>	found;
+	paths.push_back( CppONPath( "0:0:0" ) );
+	CHECK( 0 == CppON::parseSelect( flood.data(), flood.size(), paths, found, err ) && CPPON_PARSE_TOO_DEEP == err.code );
+	flood.assign( 100000, ' ' );
+	for( size_t i = 0; 100000 > i; i++ )
+	{
+		flood += "{\"a\":";
+	}
+	CHECK( CPPON_PARSE_TOO_DEEP == parseCode( flood, err ) );
+	CHECK( 100000 + 5 * CPPON_MAX_DEPTH == err.offset );
+	std::string	tnet;
+	for( int i = 0; 2 * CPPON_MAX_DEPTH > i; i++ )
+	{
+		tnet = std::to_string( tnet.size() ) + ":" + tnet + "]";
+	}
+	CHECK( CPPON_PARSE_TOO_DEEP == parseCode( tnet, err ) );
+}
+
+/*
+ * toBinary() and back, CppONView reads in place, and a short or corrupt buffer is refused rather than read past its end
+ */
+static void checkBinary()
+{
+	const char	*text = "{\"i\":-5,\"big\":1234567890123,\"d\":2.5,\"s\":\"h\\u00e9llo\",\"t\":true,\"n\":null,\"a\":[1,[2,{\"k\":\"v\"}],{}]}";
+	CppON		*src = CppON::parseJson( text );
+	std::string	*bin = ( src ) ? src->toBinary() : NULL;
+	CppONParseError	err;
+
+	CHECK( src && bin );
+	if( ! src || ! bin )
+	{
+		delete src;
+		return;
+	}
+	CppON	*back = CppON::parseBinary( bin->data(), bin->size(), err );
+	CHECK( CPPON_PARSE_OK == err.code && bin->size() == err.consumed );
+	CHECK( back && *back == *src );
+	CHECK( json( back ) == json( src ) );
+	delete back;
+
+	CppONView	v( bin->data(), bin->size() );
+	size_t		len;
+	const char	*str = v.find( "s" ).stringValue( len );
+	CHECK( MAP_CPPON_OBJ_TYPE == v.type() && 7 == v.size() && bin->size() == v.bytes() );
+	CHECK( -5 == v.find( "i" ).intValue() && 1234567890123LL == v.find( "big" ).intValue() );
+	CHECK( 2.5 == v.find( "d" ).doubleValue() && v.find( "t" ).boolValue() );
+	CHECK( str && std::string( "h\xc3\xa9llo" ) == std::string( str, len ) );
+	CHECK( NULL_CPPON_OBJ_TYPE == v.find( "n" ).type() && ! v.find( "missing" ).valid() );
+	str = v.find( "a" ).at( 1 ).at( 1 ).find( "k" ).stringValue( len );
+	CHECK( str && std::string( "v" ) == std::string( str, len ) );
+	CHECK( 2 == v.findElement( CppONPath( "a:1" ) ).first().intValue() );
+	CHECK( ! v.findElement( CppONPath( "a:3" ) ).valid() );
+
+	for( size_t n = 0; bin->size() > n; n++ )											// every truncation
+	{
+		CppON	*t = CppON::parseBinary( bin->data(), n, err );
+		CHECK( ! t && CPPON_PARSE_UNEXPECTED_END == err.code );
+		CHECK( 0 == CppONView( bin->data(), n ).bytes() );
+		delete t;
+	}
+	CHECK( ! CppON::parseBinary( "\xc1", 1, err ) && CPPON_PARSE_BAD_BINARY_TAG == err.code );
+
+	std::string	deep( CPPON_MAX_DEPTH - 1, '\x91' );								// arrays of one element
+	deep += '\x90';
+	back = CppON::parseBinary( deep.data(), deep.size(), err );
+	CHECK( back && CPPON_PARSE_OK == err.code );
+	CHECK( deep.size() == CppONView( deep.data(), deep.size() ).bytes() );
+	delete back;
+	deep.insert( 0, "\x91" );
+	CHECK( ! CppON::parseBinary( deep.data(), deep.size(), err ) && CPPON_PARSE_TOO_DEEP == err.code );
+	CHECK( 0 == CppONView( deep.data(), deep.size() ).bytes() );
+
+	std::string	flood( 1 << 20, '\x91' );
+	CppONView	fv( flood.data(), flood.size() );
+	CHECK( ! CppON::parseBinary( flood.data(), flood.size(), err ) && CPPON_PARSE_TOO_DEEP == err.code );
+	CHECK( 0 == fv.bytes() && ! fv.next().valid() && NULL == fv.toCppON() );
+	delete bin;
+	delete src;
+}
+
+/*
+ * COMap keeps insertion order and finds every member through its index while members are erased from anywhere in it
+ */
+static void checkMaps()
+{
+	COMap						m;
+	std::vector<std::string>	model;
+	unsigned					seed = 12345;
+	bool						ok = true;
+
+	for( unsigned i = 0; 2000 > i; i++ )
+	{
+		std::string	key = "k" + std::to_string( i * 7919 % 2003 );
+		m.append( key, new COInteger( (int64_t) i ) );
+		model.push_back( key );
+	}
+	while( model.size() > 10 )
+	{
+		seed = seed * 1103515245 + 12345;
+		size_t	pos = ( seed >> 8 ) % model.size();
+		delete m.extract( model[ pos ].c_str() );
+		model.erase( model.begin() + pos );
+		if( 0 == model.size() % 97 )
+		{
+			size_t	i = 0;
+			for( COMap::iterator it = m.begin(); m.end() != it && ok; ++it, i++ )
+			{
+				ok = ( model.size() > i && model[ i ] == it->first );
+			}
+			ok = ok && model.size() == i;
+			for( size_t j = 0; model.size() > j && ok; j++ )
+			{
+				ok = ( NULL != m.findNoSplit( model[ j ].c_str() ) );
+			}
+			seed ^= 1;
+		}
+	}
+	CHECK( ok );
+	CHECK( 10 == m.size() && NULL == m.findNoSplit( "k1" ) );
+	m.append( "k1", new COInteger( 1 ) );
+	CHECK( 11 == m.size() && CppON::isInteger( m.findNoSplit( "k1" ) ) && "k1" == m.begin()[ 10 ].first );
+}
+
+/*
+ * CppONStreamParser gives the same messages however the bytes are split, reports what it can't use and keeps a message
+ * that never closes to its limit
+ */
+/*
+ * A caching CppONPath follows the containers it went through and nothing else.
+ */
+static void checkPaths()
+{
+	COMap		m( "{\"config\":{\"axes\":[{\"res\":1},{\"res\":2}]},\"other\":{\"x\":1}}" );
+	CppONPath	p( "config/axes:1/res", true );
+	CppON		*r = m.findElement( p );
+
+	CHECK( CppON::isInteger( r ) && 2 == r->toLongInt() );
+	CHECK( r == m.findElement( p ) );
+	CHECK( r == m.findElement( CppONPath( "config/axes:1/res" ) ) );
+
+	uint32_t		gen = m.generation();
+	delete new COMap( "{\"a\":{\"b\":1}}" );
+	// cppcheck-suppress cstyleCast
+	( (COMap *) m.findNoSplit( "other" ) )->replaceObj( "x", new COInteger( 2 ) );
+	CHECK( gen == m.generation() && r == m.findElement( p ) );
+
+	// cppcheck-suppress cstyleCast
+	COArray		*axes = (COArray *) m.findElement( "config/axes" );
+	axes->replace( 1, new COMap( "{\"res\":3}" ) );
+	r = m.findElement( p );
+	CHECK( CppON::isInteger( r ) && 3 == r->toLongInt() );
+	// cppcheck-suppress cstyleCast
+	( (COMap *) axes->at( 1 ) )->replaceObj( "res", new COInteger( 4 ) );
+	r = m.findElement( p );
+	CHECK( CppON::isInteger( r ) && 4 == r->toLongInt() );
+
+	COMap		other( "{\"config\":{\"axes\":[0,5]}}" );
+	r = other.findElement( p );
+	CHECK( CppON::isInteger( r ) && 5 == r->toLongInt() );
+	delete m.extract( "config" );
+	CHECK( NULL == m.findElement( p ) );
+	CHECK( NULL == m.findElement( p ) );
+}
+
+static std::string streamed( const std::string &text, size_t piece, size_t *errors = NULL )
+{
+	CppONStreamParser	sp;
+	std::string			rtn;
+
+	for( size_t i = 0; text.size() > i; i += piece )
+	{
+		sp.feed( text.data() + i, ( piece < text.size() - i ) ? piece : text.size() - i );
+	}
+	for( CppON *obj; NULL != ( obj = sp.next() ); delete obj )
+	{
+		rtn += json( obj ) + "\n";
+	}
+	if( errors )
+	{
+		*errors = sp.errors();
+	}
+	return rtn;
+}
+
+static void checkStream()
+{
+	std::string	text( "{\"a\":[1,2.5,\"x\\\"y\",-3e2],\"b\":{\"c\":null,\"d\":[]}}\n[true,false,{}] \"top\" 5:hello, {\"t\":3:abc,,5:inner,:[1,],}" );
+	std::string	whole = streamed( text, text.size() );
+	size_t		errors = 0;
+
+	CHECK( 5 == std::count( whole.begin(), whole.end(), '\n' ) );
+	CHECK( taken( CppON::parseJson( "{\"a\":[1,2.5,\"x\\\"y\",-3e2],\"b\":{\"c\":null,\"d\":[]}}" ) ) + "\n" == whole.substr( 0, whole.find( '\n' ) + 1 ) );
+	for( size_t piece = 1; 17 >= piece; piece++ )
+	{
+		CHECK( whole == streamed( text, piece, &errors ) && 0 == errors );
+	}
+
+	CppONStreamParser	sp;
+	CppONParseError		err;
+	const char			*bad = "12 true {\"a\" 1} {\"b\":2}";
+	CHECK( 1 == sp.feed( bad, strlen( bad ) ) && 3 == sp.errors() );
+	CHECK( CPPON_PARSE_EXPECTED_COLON == sp.lastError().code && 5 == sp.lastError().offset && 6 == sp.lastError().column );
+	CHECK( "{\"b\":2}" == taken( sp.next() ) );
+	CHECK( ! sp.partial() );
+
+	/*
+	 * A peer that opens an array and never closes it
+	 */
+	sp.setLimit( 4096 );
+	sp.feed( "[", 1 );
+	for( unsigned i = 0; 10000 > i; i++ )
+	{
+		sp.feed( "{\"k\":\"v\"},", 10 );
+	}
+	CHECK( 4 == sp.errors() && CPPON_PARSE_TOO_LARGE == sp.lastError().code && sp.partial() && 0 == sp.available() );
+	CHECK( 1 == sp.feed( "]{\"z\":1}", 8 ) && "{\"z\":1}" == taken( sp.next() ) && ! sp.partial() );
+	std::string	big( "9999:" );
+	big.append( 9999, '}' );
+	big += ",[2]";
+	CHECK( 1 == sp.feed( big.data(), big.size() ) && 5 == sp.errors() && "[2]" == taken( sp.next() ) );
+
+	std::string	deep( CPPON_MAX_DEPTH + 1, '[' );
+	deep.append( CPPON_MAX_DEPTH + 1, ']' );
+	CHECK( 0 == sp.feed( deep.data(), deep.size() ) && CPPON_PARSE_TOO_DEEP == sp.lastError().code && ! sp.partial() );
+	CHECK( 1 == sp.feed( "\"x\"", 3 ) && "\"x\"" == taken( sp.next() ) );
+}
+
+/*
+ * COMap::toFile() writes standard JSON that COMap( path, file ) reads back to the same strings, through a temporary it renames
+ */
+static void checkFiles()
+{
+	char		name[ 64 ];
+	std::string	path( "/tmp/" );
+	COMap		m;
+	COArray		*arr = new COArray();
+	std::string	odd( "a\"b\\c&d<e>{f}^'g\nh\ri\tj\x01k\xC3\xA9" );
+
+	snprintf( name, sizeof( name ), "CppONCheck.%d.json", (int) getpid() );
+	path.append( name );
+	m.append( odd, new COString( odd.c_str() ) );
+	m.append( "n", arr );
+	arr->append( new COInteger( 1 ) );
+	arr->append( new CODouble( 2.5 ) );
+	arr->append( new COBoolean( true ) );
+	arr->append( new CONull() );
+	arr->append( new COMap( "{\"x\":\"y\"}" ) );
+
+	CHECK( 0 == m.toFile( path.c_str() ) );
+	CHECK( 0 != access( ( path + ".tmp" ).c_str(), F_OK ) );
+	{
+		COMap	back( "/tmp", name );
+		CHECK( json( &m ) == json( &back ) );
+		CHECK( CppON::isString( back.findNoSplit( odd.c_str() ) ) && odd == ( (COString *) back.findNoSplit( odd.c_str() ) )->c_str() );
+	}
+	{
+		CppON	*text = CppON::parseJsonFile( path.c_str() );
+		CHECK( CppON::isMap( text ) && 2 == ( (COMap *) text )->size() );
+		delete text;
+	}
+	CHECK( -1 == m.toFile( "/tmp/CppONCheck.missing/dir/file.json" ) );
+	unlink( path.c_str() );
+}
+
+/*
+ * A second SCppObj on a segment takes the layout its creator left in it.  One built from another description, or finding a
+ * damaged layout, is refused and leaves the segment as it was.
+ */
+static off_t segmentSize( const char *segment )
+{
+	struct stat	st;
+	int			fd = shm_open( segment, O_RDONLY, 0 );
+	off_t		rtn = -1;
+
+	if( 0 <= fd )
+	{
+		if( 0 == fstat( fd, &st ) )
+		{
+			rtn = st.st_size;
+		}
+		close( fd );
+	}
+	return rtn;
+}
+
+static bool refused( COMap *def, const char *segment )
+{
+	try
+	{
+		SCppObj obj( def, segment );
+	} catch( std::invalid_argument & ) {
+		return true;
+	}
+	return false;
+}
+
+static void checkAttach()
+{
+	char		segment[ 64 ];
+	bool		initialized = false;
+	const char	*unit = "{\"journal\":8,\"u\":{\"type\":\"unit\",\"doubleBuffer\":true,\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":7},"
+					"\"s\":{\"type\":\"string\",\"size\":16,\"defaultValue\":\"x\"},\"a\":{\"type\":\"array\",\"0\":{\"type\":\"float\",\"defaultValue\":1.5},"
+					"\"1\":{\"type\":\"float\",\"defaultValue\":2.5}}";
+	std::string	textA = std::string( unit ) + "}}";
+	std::string	textB = std::string( unit ) + ",\"j\":{\"type\":\"int\",\"size\":4,\"defaultValue\":9}}}";
+	COMap		*defA = (COMap *) CppON::parseJson( textA.c_str() );
+	COMap		*defB = (COMap *) CppON::parseJson( textB.c_str() );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj		first( defA, segment, &initialized );
+		off_t		size = segmentSize( segment );
+
+		CHECK( initialized );
+		CHECK( 7 == first.intValue( "u/i" ) );
+		CHECK( first.updateInt( "u/i", 42 ) );
+		{
+			SCppObj	second( defA, segment, &initialized );
+			CHECK( ! initialized );
+			CHECK( 42 == second.intValue( "u/i" ) );
+			CHECK( 2.5 == second.doubleValue( "u/a/1" ) );
+			CHECK( second.hasJournal() );
+		}
+
+		CHECK( refused( defB, segment ) );
+		CHECK( size == segmentSize( segment ) );
+		CHECK( 42 == first.intValue( "u/i" ) );
+
+		/*
+		 * Point the lock table past the end of the segment
+		 */
+		int		fd = shm_open( segment, O_RDWR, 0 );
+		void	*ptr = ( 0 <= fd ) ? mmap( 0, (size_t) size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) : MAP_FAILED;
+		CHECK( MAP_FAILED != ptr );
+		if( MAP_FAILED != ptr )
+		{
+			SCPP_LAYOUT	*lay = (SCPP_LAYOUT *) ( (char *) ptr + size - SCPP_LAYOUT_TRAILER );
+			uint32_t	lockOffset = lay->offsets[ 10 ];
+
+			lay->offsets[ 10 ] = (uint32_t) size - 8;
+			CHECK( refused( defA, segment ) );
+			CHECK( size == segmentSize( segment ) );
+			lay->offsets[ 10 ] = lockOffset;
+			munmap( ptr, (size_t) size );
+		}
+		if( 0 <= fd )
+		{
+			close( fd );
+		}
+		CHECK( ! refused( defA, segment ) );
+	}
+	shm_unlink( segment );
+	delete defA;
+	delete defB;
+}
+
+/*
+ * Leave the segment claimed for initialization by pid, as if that process were still at it.
+ */
+static void claimSegment( const char *segment, pid_t pid )
+{
+	int			fd = shm_open( segment, O_RDWR, 0 );
+	uint8_t		b[ 4 ] = { 0x5A, (uint8_t) pid, (uint8_t) ( pid >> 8 ), (uint8_t) ( pid >> 16 ) };
+
+	if( 0 <= fd )
+	{
+		if( sizeof( b ) != pwrite( fd, b, sizeof( b ), 0 ) )
+		{
+			fprintf( stderr, "Can't claim %s\n", segment );
+		}
+		close( fd );
+	}
+}
+
+/*
+ * A segment left half initialized is only taken over once the process that claimed it is gone.
+ */
+static void checkClaim()
+{
+	char		segment[ 64 ];
+	bool		initialized = false;
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":7}}}" );
+	pid_t		pid;
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.c.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj	first( def, segment, &initialized );
+		CHECK( initialized && first.updateInt( "u/i", 42 ) );
+	}
+
+	if( 0 == ( pid = fork() ) )
+	{
+		_exit( 0 );
+	}
+	waitpid( pid, NULL, 0 );
+	claimSegment( segment, pid );
+	{
+		SCppObj	dead( def, segment, &initialized );
+		CHECK( initialized && 7 == dead.intValue( "u/i" ) );
+		CHECK( dead.updateInt( "u/i", 42 ) );
+	}
+
+	if( 0 == ( pid = fork() ) )
+	{
+		sleep( 30 );
+		_exit( 0 );
+	}
+	claimSegment( segment, pid );
+	std::atomic<bool>	attached( false );
+	std::thread			waiter( [ & ]() { SCppObj obj( def, segment, &initialized ); initialized = initialized && 7 == obj.intValue( "u/i" ); attached = true; } );
+	usleep( 3 * SCPP_INIT_TIMEOUT / 2000 );
+	CHECK( ! attached );
+	kill( pid, SIGKILL );
+	waitpid( pid, NULL, 0 );
+	waiter.join();
+	CHECK( attached && initialized );
+
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Readers of a double buffered unit see whole publishes, and only publishes.
+ */
+static void checkPublish()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"doubleBuffer\":true,\"a\":{\"type\":\"int\",\"size\":8,\"defaultValue\":1},"
+					"\"b\":{\"type\":\"int\",\"size\":8,\"defaultValue\":1}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.p.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj				obj( def, segment );
+		STRUCT_LISTS		*u = obj.getElement( "u" );
+		STRUCT_LISTS		*a = obj.getElement( "u/a" );
+		STRUCT_LISTS		*b = obj.getElement( "u/b" );
+		std::vector<char>	snap( obj.snapshotSize( u ) );
+		uint64_t			va;
+		uint64_t			vb;
+
+		CHECK( obj.isDoubleBuffered( u ) && ! snap.empty() );
+		CHECK( obj.updateLong( a, 5 ) && obj.readPublished( u, &snap[ 0 ] ) );
+		memcpy( &va, obj.snapshotPointer( u, a, &snap[ 0 ] ), sizeof( va ) );
+		CHECK( 5 == va );
+		CHECK( obj.publish( u ) && obj.updateLong( a, 6 ) && obj.readPublished( u, &snap[ 0 ] ) );
+		memcpy( &va, obj.snapshotPointer( u, a, &snap[ 0 ] ), sizeof( va ) );
+		CHECK( 5 == va );
+		CHECK( obj.updateLong( b, 6 ) && obj.publish( u ) );
+
+		std::atomic<bool>	stop( false );
+		std::atomic<bool>	torn( false );
+		std::thread			reader( [ & ]()
+		{
+			std::vector<char>	copy( snap.size() );
+			while( ! stop )
+			{
+				uint64_t	x;
+				uint64_t	y;
+				if( obj.readPublished( u, &copy[ 0 ] ) )
+				{
+					memcpy( &x, obj.snapshotPointer( u, a, &copy[ 0 ] ), sizeof( x ) );
+					memcpy( &y, obj.snapshotPointer( u, b, &copy[ 0 ] ), sizeof( y ) );
+					if( x != y )
+					{
+						torn = true;
+					}
+				}
+			}
+		} );
+		bool	published = true;
+		for( uint64_t k = 10; 20000 > k && published; k++ )
+		{
+			uint64_t	x = k;
+			SCPP_OP		ops[] = { { a, &x, true }, { b, &x, true } };
+			published = obj.transact( ops, 2 ) && obj.publish( u );
+		}
+		stop = true;
+		reader.join();
+		CHECK( published );
+		CHECK( ! torn );
+		CHECK( obj.readPublished( u, &snap[ 0 ] ) );
+		memcpy( &va, obj.snapshotPointer( u, a, &snap[ 0 ] ), sizeof( va ) );
+		memcpy( &vb, obj.snapshotPointer( u, b, &snap[ 0 ] ), sizeof( vb ) );
+		CHECK( 19999 == va && 19999 == vb );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * A write the element's type can't take leaves no trace:  no time stamp, version or journal record.
+ */
+static void checkStamps()
+{
+	char		segment[ 64 ];
+	bool		initialized = true;
+	COMap		*def = (COMap *) CppON::parseJson( "{\"journal\":8,\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":7},"
+					"\"a\":{\"type\":\"array\",\"0\":{\"type\":\"float\",\"defaultValue\":1.5}}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.s.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		STRUCT_LISTS	*u = obj.getElement( "u" );
+		STRUCT_LISTS	*a = obj.getElement( "u/a" );
+		STRUCT_LISTS	*i = obj.getElement( "u/i" );
+		uint64_t		before = obj.getUpdateTime( i );
+		uint64_t		position = obj.journalPosition();
+		uint32_t		version = obj.version( i );
+		uint8_t			header[ 32 ];
+
+		memcpy( header, obj.getBasePtr(), sizeof( header ) );
+		usleep( 2000 );
+		CHECK( ! obj.updateDouble( u, 1.0 ) && ! obj.updateLong( a, 1 ) && ! obj.updateInt( u, 1 ) );
+		CHECK( ! obj.updateBoolean( a, true ) && ! obj.updateString( u, "x" ) );
+		CHECK( 0 == memcmp( header, obj.getBasePtr(), sizeof( header ) ) );
+		CHECK( before == obj.getUpdateTime( i ) && version == obj.version( i ) && position == obj.journalPosition() );
+		{
+			SCppObj		again( def, segment, &initialized );
+			CHECK( ! initialized && 7 == again.intValue( "u/i" ) );
+		}
+		CHECK( obj.updateInt( i, 8 ) && version + 1 == obj.version( i ) && before < obj.getUpdateTime( i ) && position + 1 == obj.journalPosition() );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Every element is found by its full path from the base, with '.' or '/' between the names, and by the rest of the path
+ * from any unit or array above it.  Both objects on a segment, the one that built the layout and the one that attached
+ * to it, agree.
+ */
+static void checkLookup( SCppObj &obj, SCppObj &other, STRUCT_LISTS *lst, std::vector<std::pair<STRUCT_LISTS *, std::string> > &above, bool &ok )
+{
+	for( uint32_t k = 0; lst->nSubs > k; k++ )
+	{
+		STRUCT_LISTS	*sub = obj.at( lst, k );
+		for( size_t a = 0; above.size() > a; a++ )
+		{
+			std::string	path = above[ a ].second + sub->name;
+			std::string	dotted = path;
+			std::replace( dotted.begin(), dotted.end(), '/', '.' );
+			STRUCT_LISTS	*twin = other.getElement( path.c_str() );
+			ok = ok && sub == obj.getElement( path.c_str(), above[ a ].first ) && sub == obj.getElement( dotted.c_str(), above[ a ].first );
+			ok = ok && ( a || ( twin && twin->offset == sub->offset && twin->type == sub->type && twin->size == sub->size ) );
+		}
+		if( sub->nSubs )
+		{
+			for( size_t a = 0; above.size() > a; a++ )
+			{
+				above[ a ].second += sub->name + "/";
+			}
+			above.push_back( std::make_pair( sub, std::string() ) );
+			checkLookup( obj, other, sub, above, ok );
+			above.pop_back();
+			for( size_t a = 0; above.size() > a; a++ )
+			{
+				above[ a ].second.resize( above[ a ].second.size() - sub->name.size() - 1 );
+			}
+		}
+	}
+}
+
+static void checkIndex()
+{
+	char		segment[ 64 ];
+	bool		initialized = true;
+	std::string	text = "{\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":1},\"ii\":{\"type\":\"int\",\"size\":2,\"defaultValue\":2},"
+					"\"v\":{\"type\":\"unit\",\"d\":{\"type\":\"float\",\"defaultValue\":0.5},\"a\":{\"type\":\"array\",\"0\":{\"type\":\"bool\",\"defaultValue\":true},"
+					"\"1\":{\"type\":\"string\",\"size\":8,\"defaultValue\":\"x\"}}}}";
+	for( int k = 0; 200 > k; k++ )
+	{
+		text += ",\"f" + std::to_string( k ) + "\":{\"type\":\"int\",\"size\":8,\"defaultValue\":" + std::to_string( k ) + "}";
+	}
+	text += "}";
+	COMap		*def = (COMap *) CppON::parseJson( text.c_str() );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.x.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		SCppObj			other( def, segment, &initialized );
+		std::vector<std::pair<STRUCT_LISTS *, std::string> >	above( 1, std::make_pair( obj.GetBase(), std::string() ) );
+		bool			ok = true;
+
+		checkLookup( obj, other, obj.GetBase(), above, ok );
+		CHECK( ! initialized && ok && 199 == obj.longValue( "f199" ) && 2 == other.intValue( "u.ii" ) );
+		CHECK( NULL == obj.getElement( "u/i/x" ) && NULL == obj.getElement( "u/" ) && NULL == obj.getElement( "" ) && NULL == obj.getElement( "u/iii" ) );
+		CHECK( NULL == obj.getElement( "f200" ) && NULL == obj.getElement( "v/d" ) && NULL == obj.getElement( "d", obj.getElement( "u" ) ) );
+		CHECK( NULL == obj.getElement( NULL ) && obj.getElement( "a/1", obj.getElement( "u/v" ) ) == obj.at( "u.v.a", 1 ) );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Unit locks keep threads and processes out of each other's way, give up after the timeout without touching the value, and
+ * are recovered from a process that died holding one.
+ */
+static void checkLocks()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"n\":{\"type\":\"int\",\"size\":8,\"defaultValue\":0}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.l.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		STRUCT_LISTS	*u = obj.getElement( "u" );
+		STRUCT_LISTS	*n = obj.getElement( "u/n" );
+		auto			bump = [ &obj, u, n ]() {
+							for( int k = 0; 2000 > k; k++ )
+							{
+								if( obj.waitSem( u ) )
+								{
+									obj.updateLong( n, obj.longValue( n, false ) + 1, false );
+									obj.postSem( u );
+								}
+							}
+						};
+		pid_t			pid;
+		int				status = -1;
+
+		if( 0 == ( pid = fork() ) )
+		{
+			bump();
+			_exit( 0 );
+		}
+		std::vector<std::thread>	pool;
+		for( int t = 0; 4 > t; t++ )
+		{
+			pool.push_back( std::thread( bump ) );
+		}
+		for( size_t t = 0; pool.size() > t; t++ )
+		{
+			pool[ t ].join();
+		}
+		waitpid( pid, &status, 0 );
+		CHECK( 0 == status && 10000 == obj.longValue( n ) );
+
+		std::atomic<bool>	held( false );
+		bool				valid = true;
+		std::thread			holder( [ &obj, u, &held ]() { obj.waitSem( u ); held = true; usleep( 200000 ); obj.postSem( u ); } );
+		while( ! held )
+		{
+			usleep( 100 );
+		}
+		obj.setLockTimeout( 20000000 );
+		obj.setSeqReads( false );
+		auto				start = std::chrono::steady_clock::now();
+		CHECK( ! obj.waitSem( u ) && std::chrono::milliseconds( 20 ) <= std::chrono::steady_clock::now() - start );
+		CHECK( ! obj.updateLong( n, 7 ) && ( obj.longValue( n, true, &valid ), ! valid ) );
+		holder.join();
+		CHECK( 10000 == obj.longValue( n ) );
+
+		if( 0 == ( pid = fork() ) )
+		{
+			obj.waitSem( u );
+			obj.updateLong( n, 5, false );
+			_exit( 0 );
+		}
+		waitpid( pid, NULL, 0 );
+		CHECK( obj.waitSem( u ) && obj.postSem( u ) && obj.waitSem( u ) && obj.postSem( u ) && 5 == obj.longValue( n ) );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Lock free reads of small values never see half of a store, and don't wait for, or count as, a lock holder.
+ */
+static void checkSeqReads()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"s\":{\"type\":\"string\",\"size\":48,\"defaultValue\":\"aaaaaaaaaaaaaaaaaaaa\"},"
+					"\"d\":{\"type\":\"float\",\"defaultValue\":0.25}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.q.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj				obj( def, segment );
+		STRUCT_LISTS		*u = obj.getElement( "u" );
+		STRUCT_LISTS		*str = obj.getElement( "u/s" );
+		STRUCT_LISTS		*d = obj.getElement( "u/d" );
+		std::atomic<bool>	done( false );
+		std::thread			writer( [ &obj, str, &done ]() {
+								for( int k = 0; ! done; k++ )
+								{
+									obj.updateString( str, std::string( 20 + k % 26, (char) ( 'a' + k % 26 ) ) );
+								}
+							} );
+		bool				whole = true;
+		std::string			got;
+		char				raw[ 48 ];
+
+		for( int k = 0; 200000 > k && whole; k++ )
+		{
+			if( k & 1 )
+			{
+				whole = obj.readField( str, raw ) && ( got = raw, true );
+			} else {
+				whole = NULL != obj.readString( str, &got );
+			}
+			whole = whole && ! got.empty() && 'a' <= got[ 0 ] && 20 + (size_t) ( got[ 0 ] - 'a' ) == got.size() && std::string::npos == got.find_first_not_of( got[ 0 ] );
+		}
+		done = true;
+		writer.join();
+		CHECK( whole );
+
+		std::atomic<bool>	storing( false );
+		char				*target = (char *) obj.pointer( str );
+		std::thread			slow( [ &obj, u, str, target, &storing ]() {
+								obj.waitSem( u );
+								__atomic_fetch_add( &str->lock->sequence, 1, __ATOMIC_SEQ_CST );
+								memset( target, 'y', 10 );
+								storing = true;
+								usleep( 50000 );
+								memcpy( target, "yyyyyyyyyyyyyyyyyyyyyyyy", 25 );
+								__atomic_fetch_add( &str->lock->sequence, 1, __ATOMIC_SEQ_CST );
+								obj.postSem( u );
+							} );
+		obj.setLockTimeout( 1000000000 );
+		while( ! storing )
+		{
+			usleep( 100 );
+		}
+		CHECK( NULL != obj.readString( str, &got ) && std::string( 24, 'y' ) == got );
+		slow.join();
+
+		std::atomic<bool>	held( false );
+		bool				valid = false;
+		std::thread			holder( [ &obj, u, &held, &done ]() { obj.waitSem( u ); held = true; while( done ) { usleep( 100 ); } obj.postSem( u ); } );
+		while( ! held )
+		{
+			usleep( 100 );
+		}
+		obj.setLockTimeout( 20000000 );
+		COMap				*before = obj.stats( u );
+		CHECK( 0.25 == obj.doubleValue( d, true, &valid ) && valid && NULL != obj.readString( str, &got ) );
+		COMap				*after = obj.stats( u );
+		CHECK( json( before ) == json( after ) );
+		obj.setSeqReads( false );
+		CHECK( ( obj.doubleValue( d, true, &valid ), ! valid ) );
+		done = false;
+		holder.join();
+		delete before;
+		delete after;
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Every write moves its unit's generation, even two in the same millisecond, and waiters on one unit or several wake when
+ * a write lands rather than when they give up.
+ */
+static void checkWakeups()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0}},"
+					"\"v\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0}},\"w\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.w.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		STRUCT_LISTS	*units[ 3 ] = { obj.getElement( "u" ), obj.getElement( "v" ), obj.getElement( "w" ) };
+		STRUCT_LISTS	*i = obj.getElement( "u/i" );
+		STRUCT_LISTS	*vi = obj.getElement( "v/i" );
+		uint32_t		gen = obj.generation( i );
+		uint32_t		first = gen;
+		uint32_t		gens[ 3 ];
+
+		obj.updateInt( i, 1 );
+		uint32_t		middle = obj.generation( units[ 0 ] );
+		obj.updateInt( i, 2 );
+		CHECK( first != middle && middle != obj.generation( i ) && first != obj.generation( i ) );
+		CHECK( obj.waitForChange( i, gen, 1000 ) && obj.generation( i ) == gen );
+
+		auto			start = std::chrono::steady_clock::now();
+		CHECK( ! obj.waitForChange( i, gen, 20000000 ) && obj.generation( i ) == gen && std::chrono::milliseconds( 20 ) <= std::chrono::steady_clock::now() - start );
+		CHECK( ! obj.waitForUpdate( i, 0, 20 ) );
+
+		std::thread		writer( [ &obj, i ]() { usleep( 20000 ); obj.updateInt( i, 3 ); } );
+		start = std::chrono::steady_clock::now();
+		CHECK( obj.waitForChange( i, gen, 5000000000ULL ) && obj.generation( i ) == gen && std::chrono::seconds( 2 ) > std::chrono::steady_clock::now() - start );
+		writer.join();
+
+		writer = std::thread( [ &obj, i ]() { usleep( 20000 ); obj.updateInt( i, 4 ); } );
+		start = std::chrono::steady_clock::now();
+		CHECK( obj.waitForUpdate( i, 0, 5000 ) && 4 == obj.intValue( i ) && std::chrono::seconds( 2 ) > std::chrono::steady_clock::now() - start );
+		writer.join();
+
+		for( int k = 0; 3 > k; k++ )
+		{
+			gens[ k ] = obj.generation( units[ k ] );
+		}
+		uint32_t		was[ 3 ] = { gens[ 0 ], gens[ 1 ], gens[ 2 ] };
+		CHECK( -1 == obj.waitForChange( units, gens, 3, 20000000 ) );
+		writer = std::thread( [ &obj, vi ]() { usleep( 20000 ); obj.updateInt( vi, 5 ); } );
+		start = std::chrono::steady_clock::now();
+		CHECK( 1 == obj.waitForChange( units, gens, 3, 5000000000ULL ) && std::chrono::seconds( 2 ) > std::chrono::steady_clock::now() - start );
+		CHECK( was[ 0 ] == gens[ 0 ] && was[ 1 ] != gens[ 1 ] && obj.generation( vi ) == gens[ 1 ] && was[ 2 ] == gens[ 2 ] );
+		writer.join();
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Typed handles only bind to a value of their own type and size, and read and write it the way the path accessors do:  a
+ * store is seen by them and counts as a write, and a load from a snapshot sees the unit as it was.
+ */
+static void checkFields()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"journal\":8,\"u\":{\"type\":\"unit\",\"d\":{\"type\":\"float\",\"defaultValue\":0.5},"
+					"\"n\":{\"type\":\"int\",\"size\":8,\"defaultValue\":-2},\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":3},"
+					"\"h\":{\"type\":\"int\",\"size\":2,\"defaultValue\":4},\"c\":{\"type\":\"int\",\"size\":1,\"defaultValue\":5},"
+					"\"b\":{\"type\":\"bool\",\"defaultValue\":true},\"s\":{\"type\":\"string\",\"size\":12,\"defaultValue\":\"abc\"}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.f.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj				obj( def, segment );
+		SCppField<double>	d( &obj, "u/d" );
+		SCppField<int64_t>	n( &obj, "u.n" );
+		SCppField<uint32_t>	i( &obj, "u/i" );
+		SCppField<int16_t>	h( &obj, "u/h" );
+		SCppField<uint8_t>	c( &obj, "u/c" );
+		SCppField<bool>		b( &obj, "u/b" );
+		SCppField<char[ 12 ]>	str( &obj, "u/s" );
+		char				text[ 12 ];
+		std::string			got;
+
+		CHECK( d.valid() && n.valid() && i.valid() && h.valid() && c.valid() && b.valid() && str.valid() );
+		CHECK( ! SCppField<double>( &obj, "u/n" ).valid() && ! SCppField<int32_t>( &obj, "u/n" ).valid() && ! SCppField<int64_t>( &obj, "u/i" ).valid() );
+		CHECK( ! SCppField<bool>( &obj, "u/c" ).valid() && ! SCppField<char[ 8 ]>( &obj, "u/s" ).valid() && ! SCppField<double>( &obj, "u" ).valid() );
+		double				none = 0;
+		CHECK( ! SCppField<double>( &obj, "u/none" ).valid() && ! SCppField<double>( NULL, "u/d" ).valid() && ! SCppField<double>( &obj, "u/n" ).load( none ) );
+		CHECK( 0.5 == d.load() && -2 == n.load() && 3 == i.load() && 4 == h.load() && 5 == c.load() && b.load() && str.load( text ) && 0 == strcmp( "abc", text ) );
+
+		SCppSnapshot		snap( &obj, "u" );
+		CHECK( snap.take() );
+		uint64_t			position = obj.journalPosition();
+		uint32_t			version = obj.version( d.element() );
+		uint32_t			gen = obj.generation( "u" );
+		CHECK( d.store( 1.25 ) && n.store( -7 ) && i.store( 8 ) && h.store( -9 ) && c.store( 10 ) && b.store( false ) && str.store( "a longer one" ) );
+		CHECK( 1.25 == obj.doubleValue( "u/d" ) && (uint64_t) -7 == obj.longValue( "u/n" ) && 8 == obj.intValue( "u/i" ) && ! obj.boolValue( "u/b" ) );
+		CHECK( (uint16_t) -9 == (uint16_t) obj.intValue( "u/h" ) && 10 == obj.intValue( "u/c" ) && 0 == strcmp( "a longer on", obj.readString( "u/s", &got ) ) );
+		CHECK( version + 1 == obj.version( d.element() ) && position + 7 == obj.journalPosition() && gen + 14 == obj.generation( "u" ) );
+		CHECK( obj.updateInt( "u/i", 11 ) && 11 == i.load() && obj.updateString( "u/s", "xyz" ) && str.load( text ) && 0 == strcmp( "xyz", text ) );
+
+		double				old = 0;
+		bool				was = false;
+		CHECK( d.load( old, snap ) && 0.5 == old && b.load( was, snap ) && was && str.load( text, snap ) && 0 == strcmp( "abc", text ) );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * A local copy reports only the values that changed since it last looked, and doesn't read (or lock) a unit nobody wrote.
+ * Rewriting a value with what it already held and moves inside the hysteresis are not changes.
+ */
+static void checkLocal()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":1},"
+					"\"s\":{\"type\":\"string\",\"size\":12,\"defaultValue\":\"abc\"}},\"v\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":2},"
+					"\"d\":{\"type\":\"float\",\"defaultValue\":1.0,\"hysteresis\":50},\"a\":{\"type\":\"array\",\"0\":{\"type\":\"bool\",\"defaultValue\":false}}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.o.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		LocalCppObj		local( &obj );
+		STRUCT_LISTS	*u = obj.getElement( "u" );
+		COMap			rst;
+
+		CHECK( ! local.checkChanges( &rst ) && 0 == rst.size() );
+		obj.updateInt( "v/i", 5 );
+		obj.updateBoolean( "v/a/0", true );
+		CHECK( local.checkChanges( &rst ) && "{\"base\":{\"v\":{\"a\":[true],\"i\":5}}}" == json( &rst ) );
+		rst.clear();
+		CHECK( ! local.checkChanges( &rst ) && 0 == rst.size() );
+
+		obj.updateInt( "v/i", 5 );
+		obj.updateDouble( "v/d", 1.25 );
+		CHECK( ! local.checkChanges( &rst ) && 0 == rst.size() );
+		obj.updateDouble( "v/d", 1.75 );
+		CHECK( local.checkChanges( &rst ) && "{\"base\":{\"v\":{\"d\":1.7500000000}}}" == json( &rst ) );
+		rst.clear();
+
+		std::atomic<bool>	held( false );
+		std::atomic<bool>	release( false );
+		std::thread			holder( [ &obj, u, &held, &release ]() { obj.waitSem( u ); held = true; while( ! release ) { usleep( 100 ); } obj.postSem( u ); } );
+		while( ! held )
+		{
+			usleep( 100 );
+		}
+		obj.setSeqReads( false );
+		obj.setLockTimeout( 1000000000 );
+		obj.updateInt( "v/i", 6 );
+		auto				start = std::chrono::steady_clock::now();
+		CHECK( local.checkChanges( &rst ) && "{\"base\":{\"v\":{\"i\":6}}}" == json( &rst ) && std::chrono::milliseconds( 500 ) > std::chrono::steady_clock::now() - start );
+		rst.clear();
+		start = std::chrono::steady_clock::now();
+		local.update();
+		CHECK( std::chrono::milliseconds( 500 ) > std::chrono::steady_clock::now() - start );
+		release = true;
+		holder.join();
+		obj.setSeqReads( true );
+
+		obj.updateString( "u/s", "changed" );
+		local.update( "u" );
+		CHECK( ! local.checkChanges( &rst ) && 0 == rst.size() );
+		obj.updateString( "u/s", "again" );
+		CHECK( local.checkChanges( "u", &rst ) && "{\"u\":{\"s\":\"again\"}}" == json( &rst ) );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Note which top level unit (or the hot value, given a number of its own) owns each cache line a value, its time stamp or
+ * its version touches.  Returns false if a line has two owners.
+ */
+static bool ownLines( SCppObj &obj, STRUCT_LISTS *lst, int owner, std::vector<int> &lines )
+{
+	bool	rtn = true;
+
+	if( SL_TYPE_UNIT == lst->type || SL_TYPE_ARRAY == lst->type )
+	{
+		for( uint32_t k = 0; lst->nSubs > k; k++ )
+		{
+			rtn = ownLines( obj, obj.at( lst, k ), ( 0 > owner ) ? (int) k : owner, lines ) && rtn;
+		}
+		return rtn;
+	}
+	int		who = ( CppON::isBoolean( lst->def->findElement( "hot" ) ) ) ? 1000 + owner : owner;
+	size_t	ranges[ 3 ][ 2 ] = { { lst->offset, lst->size }, { lst->time, sizeof( uint64_t ) },
+							{ (size_t) ( (char *) obj.versionPointer( lst ) - (char *) obj.getBasePtr() ), sizeof( uint32_t ) } };
+	for( int r = 0; 3 > r; r++ )
+	{
+		for( size_t l = ranges[ r ][ 0 ] / 64; ( ranges[ r ][ 0 ] + ranges[ r ][ 1 ] - 1 ) / 64 >= l; l++ )
+		{
+			if( lines.size() <= l )
+			{
+				lines.resize( l + 1, -1 );
+			}
+			rtn = rtn && ( -1 == lines[ l ] || who == lines[ l ] );
+			lines[ l ] = who;
+		}
+	}
+	return rtn;
+}
+
+/*
+ * In the aligned layout no cache line holds values, time stamps or versions of two units, a hot value has its lines to
+ * itself and every lock is a line of its own.  The values read the same as in the packed layout, and a process attaching
+ * to the segment gets the aligned layout too.
+ */
+static void checkAligned()
+{
+	char		segment[ 64 ];
+	bool		initialized = true;
+	std::string	units;
+	for( int k = 0; 3 > k; k++ )
+	{
+		units += ",\"u" + std::to_string( k ) + "\":{\"type\":\"unit\",\"d\":{\"type\":\"float\",\"defaultValue\":" + std::to_string( k ) + ".5},"
+				"\"n\":{\"type\":\"int\",\"size\":8,\"defaultValue\":" + std::to_string( k ) + "},\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":1},"
+				"\"h\":{\"type\":\"int\",\"size\":2,\"defaultValue\":2},\"c\":{\"type\":\"int\",\"size\":1,\"defaultValue\":3},"
+				"\"b\":{\"type\":\"bool\",\"defaultValue\":true},\"s\":{\"type\":\"string\",\"size\":6,\"defaultValue\":\"x\"},"
+				"\"a\":{\"type\":\"array\",\"0\":{\"type\":\"int\",\"size\":4,\"defaultValue\":4},\"1\":{\"type\":\"float\",\"defaultValue\":0.5}}"
+				+ ( ( 1 == k ) ? ",\"hot\":{\"type\":\"float\",\"defaultValue\":9.0,\"hot\":true}" : "" ) + "}";
+	}
+	COMap		*packed = (COMap *) CppON::parseJson( ( "{" + units.substr( 1 ) + "}" ).c_str() );
+	COMap		*aligned = (COMap *) CppON::parseJson( ( "{\"layout\":\"aligned\"" + units + "}" ).c_str() );
+	std::string	values;
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.g.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj				obj( packed, segment );
+		std::vector<int>	lines;
+		CHECK( ! ownLines( obj, obj.GetBase(), -1, lines ) );
+		values = taken( obj.toCOMap() );
+	}
+	shm_unlink( segment );
+	{
+		SCppObj				obj( aligned, segment );
+		SCppObj				other( aligned, segment, &initialized );
+		std::vector<int>	lines;
+		std::vector<int>	again;
+		bool				locks = true;
+		CHECK( ownLines( obj, obj.GetBase(), -1, lines ) && ! initialized && ownLines( other, other.GetBase(), -1, again ) && lines == again );
+		for( int k = 0; 3 > k; k++ )
+		{
+			STRUCT_LISTS	*u = obj.at( obj.GetBase(), k );
+			STRUCT_LISTS	*a = obj.getElement( "a", u );
+			locks = locks && 0 == ( (size_t) u->lock & 63 ) && 0 == ( (size_t) a->lock & 63 ) && u->lock != a->lock && u->lock != obj.GetBase()->lock;
+		}
+		CHECK( locks && 0 == sizeof( SCPP_LOCK ) % 64 );
+		CHECK( values == taken( obj.toCOMap() ) && 9.0 == other.doubleValue( "u1/hot" ) );
+	}
+	shm_unlink( segment );
+	delete packed;
+	delete aligned;
+}
+
+/*
+ * writeJson() writes what toCppON() would have serialized, for the whole object and any unit, array or value in it, and
+ * from a snapshot writes the unit as it was.  applyJson() takes the text back.
+ */
+static void checkExport()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"d\":{\"type\":\"float\",\"defaultValue\":-1.5},"
+					"\"n\":{\"type\":\"int\",\"size\":8,\"defaultValue\":123456789012},\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":7},"
+					"\"h\":{\"type\":\"int\",\"size\":2,\"defaultValue\":300},\"c\":{\"type\":\"int\",\"size\":1,\"defaultValue\":9},"
+					"\"b\":{\"type\":\"bool\",\"defaultValue\":true},\"s\":{\"type\":\"string\",\"size\":16,\"defaultValue\":\"plain\"},"
+					"\"v\":{\"type\":\"unit\",\"e\":{\"type\":\"string\",\"size\":8,\"defaultValue\":\"\"}},"
+					"\"a\":{\"type\":\"array\",\"0\":{\"type\":\"float\",\"defaultValue\":0.25},\"1\":{\"type\":\"bool\",\"defaultValue\":false}}},"
+					"\"w\":{\"type\":\"unit\",\"x\":{\"type\":\"int\",\"size\":4,\"defaultValue\":1}}}" );
+	const char	*paths[] = { "u", "u/d", "u/n", "u/i", "u/h", "u/c", "u/b", "u/s", "u/v", "u/v/e", "u/a", "u/a/0", "u/a/1", "w" };
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.e.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		STRUCT_LISTS	*u = obj.getElement( "u" );
+		std::string		out;
+		bool			same = true;
+		CppONParseError	err;
+
+		obj.updateString( "u/v/e", "a\"b\\c" );
+		{
+			CppONWriter	w( out );
+			CHECK( obj.writeJson( (STRUCT_LISTS *) NULL, w ) );
+		}
+		CHECK( taken( obj.toCppON() ) == out );
+		for( size_t k = 0; sizeof( paths ) / sizeof( paths[ 0 ] ) > k; k++ )
+		{
+			out.clear();
+			{
+				CppONWriter	w( out );
+				same = same && obj.writeJson( paths[ k ], w );
+			}
+			same = same && taken( obj.toCppON( paths[ k ] ) ) == out;
+		}
+		CHECK( same );
+
+		char			small[ 16 ];
+		std::string		whole;
+		{
+			CppONWriter	w( whole );
+			obj.writeJson( u, w );
+		}
+		{
+			CppONWriter	w( small, sizeof( small ) );
+			obj.writeJson( u, w );
+			w.flush();
+			CHECK( w.failed() && whole.size() == w.length() );
+		}
+
+		SCppSnapshot	snap( &obj, u );
+		CHECK( snap.take() );
+		obj.updateDouble( "u/d", 2.0 );
+		obj.updateString( "u/s", "other" );
+		obj.updateBoolean( "u/a/1", true );
+		out.clear();
+		{
+			CppONWriter	w( out );
+			CHECK( obj.writeJson( u, w, snap.buffer() ) && ! obj.writeJson( obj.getElement( "u/d" ), w, snap.buffer() ) );
+		}
+		CHECK( whole == out );
+		out.clear();
+		{
+			CppONWriter	w( out );
+			obj.writeJson( u, w );
+		}
+		CHECK( whole != out && taken( obj.toCppON( u ) ) == out );
+
+		obj.updateString( "u/v/e", "" );
+		whole.clear();
+		{
+			CppONWriter	w( whole );
+			obj.writeJson( u, w );
+		}
+		obj.updateInt( "u/i", 70 );
+		obj.updateString( "u/s", "third" );
+		CHECK( obj.applyJson( whole.data(), whole.size(), err, u ) );
+		out.clear();
+		{
+			CppONWriter	w( out );
+			obj.writeJson( u, w );
+		}
+		CHECK( whole == out );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Read one lock counter out of stats() and free the map.
+ */
+static int64_t counter( COMap *stats, const char *unit, const char *name )
+{
+	CppON	*m = stats->findElement( unit );
+	// cppcheck-suppress cstyleCast
+	CppON	*v = ( CppON::isMap( m ) ) ? ( (COMap *) m )->findElement( name ) : NULL;
+	int64_t	rtn = ( CppON::isInteger( v ) ) ? v->toLongInt() : -1;
+
+	delete stats;
+	return rtn;
+}
+
+/*
+ * The lock counters count what happened to each unit, by whom, and reset to nothing.
+ */
+static void checkStats()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0},"
+					"\"v\":{\"type\":\"unit\",\"j\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0}}},\"w\":{\"type\":\"unit\",\"k\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.c.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj			obj( def, segment );
+		STRUCT_LISTS	*u = obj.getElement( "u" );
+		COMap			*all;
+
+		CHECK( obj.resetStats() );
+		all = obj.stats( (STRUCT_LISTS *) NULL, false );
+		CHECK( 0 == all->size() );
+		delete all;
+		all = obj.stats( u );
+		CHECK( NULL != all->findElement( "." ) && NULL != all->findElement( "v" ) && NULL == all->findElement( "w" ) );
+		delete all;
+
+		obj.setSeqReads( false );
+		obj.updateInt( "u/i", 1 );
+		obj.updateInt( "u/i", 2 );
+		obj.intValue( "u/i" );
+		obj.updateInt( "u/v/j", 3 );
+		CHECK( 3 == counter( obj.stats( u ), ".", "acquisitions" ) && 2 == counter( obj.stats( u ), ".", "updates" ) );
+		CHECK( 0 == counter( obj.stats( u ), ".", "contended" ) && getpid() == counter( obj.stats( u ), ".", "lastWriter" ) );
+		CHECK( 1 == counter( obj.stats( u ), "v", "updates" ) && 1 == counter( obj.stats(), "u.v", "acquisitions" ) );
+		all = obj.stats( (STRUCT_LISTS *) NULL, false );
+		CHECK( NULL != all->findElement( "u" ) && NULL != all->findElement( "u.v" ) && NULL == all->findElement( "w" ) );
+		delete all;
+
+		std::atomic<bool>	held( false );
+		std::thread			holder( [ &obj, u, &held ]() { obj.waitSem( u ); held = true; usleep( 50000 ); obj.postSem( u ); } );
+		while( ! held )
+		{
+			usleep( 100 );
+		}
+		obj.setLockTimeout( 10000000 );
+		CHECK( ! obj.waitSem( u ) );
+		obj.setLockTimeout( 1000000000 );
+		CHECK( obj.waitSem( u ) && obj.postSem( u ) );
+		holder.join();
+		CHECK( 1 == counter( obj.stats( u ), ".", "timeouts" ) && 1 == counter( obj.stats( u ), ".", "contended" ) );
+		CHECK( 5 == counter( obj.stats( u ), ".", "acquisitions" ) && 20000000 <= counter( obj.stats( u ), ".", "waitNs" ) );
+		CHECK( counter( obj.stats( u ), ".", "maxWaitNs" ) <= counter( obj.stats( u ), ".", "waitNs" ) && 10000000 <= counter( obj.stats( u ), ".", "maxWaitNs" ) );
+
+		pid_t	pid;
+		if( 0 == ( pid = fork() ) )
+		{
+			obj.updateInt( "w/k", 4 );
+			_exit( 0 );
+		}
+		waitpid( pid, NULL, 0 );
+		CHECK( pid == counter( obj.stats(), "w", "lastWriter" ) && 1 == counter( obj.stats(), "w", "updates" ) );
+
+		CHECK( obj.resetStats( u ) && 0 == counter( obj.stats( u ), ".", "acquisitions" ) && 0 == counter( obj.stats( u ), "v", "updates" ) );
+		CHECK( 0 == counter( obj.stats( u ), ".", "waitNs" ) && 0 == counter( obj.stats( u ), ".", "timeouts" ) && 1 == counter( obj.stats(), "w", "updates" ) );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Journal subscribers see every change in order, are told how many they lost once the ring wraps past them, and are woken
+ * by the next change.
+ */
+static void checkJournal()
+{
+	char		segment[ 64 ];
+	COMap		*def = (COMap *) CppON::parseJson( "{\"journal\":5,\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0},"
+					"\"s\":{\"type\":\"string\",\"size\":64,\"defaultValue\":\"\"}}}" );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.j.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj				obj( def, segment );
+		STRUCT_LISTS		*i = obj.getElement( "u/i" );
+		STRUCT_LISTS		*s = obj.getElement( "u/s" );
+		SCPP_JOURNAL_RECORD	out[ 16 ];
+		uint64_t			cursor = obj.journalPosition();
+		uint64_t			start = cursor;
+		uint64_t			lost = 99;
+		uint32_t			v;
+		std::string			big( 50, 'z' );
+
+		CHECK( obj.hasJournal() && 0 == obj.readJournal( cursor, out, 16, &lost ) && 0 == lost && start == cursor );
+		obj.updateInt( i, 1 );
+		obj.updateString( s, big.c_str() );
+		obj.updateInt( i, 2 );
+		CHECK( 2 == obj.readJournal( cursor, out, 2, &lost ) && 0 == lost && start + 2 == cursor );
+		CHECK( obj.fieldId( i ) == out[ 0 ].field && obj.version( i ) - 1 == out[ 0 ].version && 4 == out[ 0 ].size );
+		CHECK( 0 == memcmp( &( v = 1 ), out[ 0 ].value, 4 ) && obj.field( out[ 1 ].field ) == s );
+		CHECK( s->size == out[ 1 ].size && SCPP_JOURNAL_VALUE < s->size && 0 == memcmp( big.data(), out[ 1 ].value, SCPP_JOURNAL_VALUE ) );
+		CHECK( 1 == obj.readJournal( cursor, out, 16, &lost ) && 0 == memcmp( &( v = 2 ), out[ 0 ].value, 4 ) );
+
+		for( uint32_t k = 10; 30 > k; k++ )
+		{
+			obj.updateInt( i, k );
+		}
+		CHECK( 8 == obj.readJournal( cursor, out, 16, &lost ) && 12 == lost && obj.journalPosition() == cursor );
+		bool	ordered = true;
+		for( uint32_t k = 0; 8 > k; k++ )
+		{
+			ordered = ordered && 0 == memcmp( &( v = 22 + k ), out[ k ].value, 4 ) && out[ k ].position == cursor - 7 + k;
+		}
+		CHECK( ordered );
+
+		CHECK( ! obj.waitJournal( cursor, 5000000 ) );
+		std::thread	writer( [ &obj, i ]() { usleep( 20000 ); obj.updateInt( i, 99 ); } );
+		CHECK( obj.waitJournal( cursor, 5000000000ULL ) && 1 == obj.readJournal( cursor, out, 16, &lost ) && 0 == lost );
+		writer.join();
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+/*
+ * Transactions and applyJson() report why they refused instead of printing it, and a refusal writes nothing.
+ */
+static void checkTransact()
+{
+	char		segment[ 64 ];
+	std::string	text = "{\"u\":{\"type\":\"unit\",\"i\":{\"type\":\"int\",\"size\":4,\"defaultValue\":1},\"d\":{\"type\":\"float\",\"defaultValue\":0.5},"
+					"\"s\":{\"type\":\"string\",\"size\":16,\"defaultValue\":\"x\"},\"b\":{\"type\":\"bool\",\"defaultValue\":false}},"
+					"\"v\":{\"type\":\"unit\",\"n\":{\"type\":\"int\",\"size\":8,\"defaultValue\":2}}";
+	for( int k = 0; SCPP_MAX_UNITS >= k; k++ )
+	{
+		text += ",\"w" + std::to_string( k ) + "\":{\"type\":\"unit\",\"x\":{\"type\":\"int\",\"size\":4,\"defaultValue\":0}}";
+	}
+	text += "}";
+	COMap		*def = (COMap *) CppON::parseJson( text.c_str() );
+
+	snprintf( segment, sizeof( segment ), "/CppONCheck.t.%d", (int) getpid() );
+	shm_unlink( segment );
+	{
+		SCppObj				obj( def, segment );
+		SCPP_TRANSACT_ERROR	terr;
+		CppONParseError		perr;
+		uint32_t			i = 5;
+		double				d = 2.5;
+		uint64_t			n = 9;
+		char				str[ 16 ] = "hi";
+		uint32_t			ri = 0;
+		uint64_t			rn = 0;
+		SCPP_OP				ops[] = { { obj.getElement( "u/i" ), &i, true }, { obj.getElement( "u/d" ), &d, true },
+									  { obj.getElement( "v/n" ), &n, true }, { obj.getElement( "u/s" ), str, true } };
+		SCPP_OP				reads[] = { { obj.getElement( "u/i" ), &ri, false }, { obj.getElement( "v/n" ), &rn, false } };
+		std::string			got;
+
+		CHECK( obj.transact( ops, 4, terr ) && SCPP_TRANSACT_OK == terr.code );
+		CHECK( obj.transact( reads, 2, terr ) && 5 == ri && 9 == rn );
+		CHECK( 2.5 == obj.doubleValue( "u/d" ) && 0 == strcmp( "hi", obj.readString( "u/s", &got ) ) );
+
+		i = 6;
+		ops[ 2 ].field = obj.getElement( "v" );
+		CHECK( ! obj.transact( ops, 4, terr ) && SCPP_TRANSACT_NOT_A_VALUE == terr.code && 2 == terr.op );
+		CHECK( 5 == obj.intValue( "u/i" ) );
+
+		std::vector<SCPP_OP>	wide;
+		std::vector<uint32_t>	xs( SCPP_MAX_UNITS + 1, 3 );
+		for( unsigned k = 0; SCPP_MAX_UNITS >= k; k++ )
+		{
+			wide.push_back( SCPP_OP{ obj.getElement( ( "w" + std::to_string( k ) + "/x" ).c_str() ), &xs[ k ], true } );
+		}
+		CHECK( ! obj.transact( &wide[ 0 ], SCPP_MAX_UNITS + 1, terr ) && SCPP_TRANSACT_TOO_MANY_UNITS == terr.code && SCPP_MAX_UNITS == terr.op );
+		CHECK( 0 == obj.intValue( "w0/x" ) );
+		CHECK( obj.transact( &wide[ 0 ], SCPP_MAX_UNITS, terr ) && 3 == obj.intValue( "w0/x" ) );
+
+		ops[ 2 ].field = obj.getElement( "v/n" );
+		uint32_t	gu = obj.generation( "u" );
+		uint32_t	gv = obj.generation( "v" );
+		usleep( 2000 );
+		CHECK( obj.transact( ops, 4, terr ) && gu + 2 == obj.generation( "u" ) && gv + 2 == obj.generation( "v" ) );
+		uint64_t	stamp = obj.getUpdateTime( "u/i" );
+		CHECK( stamp == obj.getUpdateTime( "u/d" ) && stamp == obj.getUpdateTime( "v/n" ) && stamp == obj.getUpdateTime( "u/s" ) );
+
+		std::atomic<int>	failed( 0 );
+		auto				pair = [ &obj, &failed ]( bool forward ) {
+								STRUCT_LISTS	*a = obj.getElement( "u/i" );
+								STRUCT_LISTS	*b = obj.getElement( "v/n" );
+								for( uint32_t k = 0; 3000 > k; k++ )
+								{
+									uint32_t	x = k;
+									uint64_t	y = k;
+									SCPP_OP		both[] = { { ( forward ) ? a : b, ( forward ) ? (void *) &x : (void *) &y, true },
+														   { ( forward ) ? b : a, ( forward ) ? (void *) &y : (void *) &x, true } };
+									SCPP_OP		look[] = { { b, &y, false }, { a, &x, false } };
+									if( ! obj.transact( both, 2 ) || ! obj.transact( look, 2 ) || y != x )
+									{
+										failed++;
+									}
+								}
+							};
+		obj.setLockTimeout( 1000000000 );
+		std::thread			one( pair, true );
+		std::thread			two( pair, false );
+		one.join();
+		two.join();
+		CHECK( 0 == failed );
+
+		std::string	msg = "{\"u\":{\"i\":11,\"s\":\"abc\",\"b\":true,\"zz\":1},\"v\":{\"n\":12}}";
+		CHECK( obj.applyJson( msg.data(), msg.size(), perr ) );
+		CHECK( 11 == obj.intValue( "u/i" ) && 12 == obj.longValue( "v/n" ) && obj.boolValue( "u/b" ) );
+		CHECK( 0 == strcmp( "abc", obj.readString( "u/s", &got ) ) );
+
+		msg = "{\"u\":{\"i\":13,\"s\":}}";
+		CHECK( ! obj.applyJson( msg.data(), msg.size(), perr ) && CPPON_PARSE_OK != perr.code && 1 == perr.line );
+		CHECK( 11 == obj.intValue( "u/i" ) );
+		CHECK( ! obj.applyJson( NULL, 0, perr ) && CPPON_PARSE_OK != perr.code );
+
+		msg = "{\"i\":14}";
+		CHECK( obj.applyJson( msg.data(), msg.size(), perr, obj.getElement( "u" ) ) && 14 == obj.intValue( "u/i" ) );
+
+		msg = "{";
+		for( int k = 0; SCPP_MAX_UNITS >= k; k++ )
+		{
+			msg += ( k ? ",\"w" : "\"w" ) + std::to_string( k ) + "\":{\"x\":" + std::to_string( k + 100 ) + "}";
+		}
+		msg += "}";
+		CHECK( obj.applyJson( msg.data(), msg.size(), perr ) );
+		CHECK( 100 == obj.intValue( "w0/x" ) && 100 + SCPP_MAX_UNITS == obj.intValue( ( "w" + std::to_string( SCPP_MAX_UNITS ) + "/x" ).c_str() ) );
+	}
+	shm_unlink( segment );
+	delete def;
+}
+
+static void usage( const char *prog )
+{
+	fprintf( stderr, "usage: %s [-f text]\n", prog );
+}
+
+int main( int argc, char **argv )
+{
+	int	opt;
+
+	while( -1 != ( opt = getopt( argc, argv, "f:h" ) ) )
+	{
+		switch( opt )
+		{
+			case 'f':
+				checkFilter = optarg;
+				break;
+			default:
+				usage( argv[ 0 ] );
+				return 2;
+		}
+	}
+	if( wanted( "roundtrip" ) )
+	{
+		checkRoundTrips();
+	}
+	if( wanted( "writer" ) )
+	{
+		checkWriter();
+	}
+	if( wanted( "events" ) )
+	{
+		checkEvents();
+	}
+	if( wanted( "errors" ) )
+	{
+		checkErrors();
+	}
+	if( wanted( "binary" ) )
+	{
+		checkBinary();
+	}
+	if( wanted( "doubles" ) )
+	{
+		checkDoubles();
+	}
+	if( wanted( "numbers" ) )
+	{
+		checkNumbers();
+	}
+	if( wanted( "arena" ) )
+	{
+		checkArena();
+	}
+	if( wanted( "tables" ) )
+	{
+		checkTables();
+	}
+	if( wanted( "hashes" ) )
+	{
+		checkHashes();
+	}
+	if( wanted( "copies" ) )
+	{
+		checkCopies();
+	}
+	if( wanted( "fanout" ) )
+	{
+		checkFanOut();
+	}
+	if( wanted( "maps" ) )
+	{
+		checkMaps();
+	}
+	if( wanted( "paths" ) )
+	{
+		checkPaths();
+	}
+	if( wanted( "stream" ) )
+	{
+		checkStream();
+	}
+	if( wanted( "files" ) )
+	{
+		checkFiles();
+	}
+	if( wanted( "attach" ) )
+	{
+		checkAttach();
+	}
+	if( wanted( "claim" ) )
+	{
+		checkClaim();
+	}
+	if( wanted( "publish" ) )
+	{
+		checkPublish();
+	}
+	if( wanted( "stamps" ) )
+	{
+		checkStamps();
+	}
+	if( wanted( "index" ) )
+	{
+		checkIndex();
+	}
+	if( wanted( "locks" ) )
+	{
+		checkLocks();
+	}
+	if( wanted( "seqlock" ) )
+	{
+		checkSeqReads();
+	}
+	if( wanted( "wakeups" ) )
+	{
+		checkWakeups();
+	}
+	if( wanted( "fields" ) )
+	{
+		checkFields();
+	}
+	if( wanted( "local" ) )
+	{
+		checkLocal();
+	}
+	if( wanted( "aligned" ) )
+	{
+		checkAligned();
+	}
+	if( wanted( "export" ) )
+	{
+		checkExport();
+	}
+	if( wanted( "stats" ) )
+	{
+		checkStats();
+	}
+	if( wanted( "journal" ) )
+	{
+		checkJournal();
+	}
+	if( wanted( "transact" ) )
+	{
+		checkTransact();
+	}
+	printf( "%u checks, %u failed\n", checksRun, checksFailed );
+	return ( checksFailed ) ? 1 : 0;
+}